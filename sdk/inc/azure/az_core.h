@@ -16,6 +16,7 @@
 #define _az_CORE_H
 
 #include <azure/core/az_base64.h>
+#include <azure/core/az_cbor.h>
 #include <azure/core/az_config.h>
 #include <azure/core/az_context.h>
 #include <azure/core/az_credentials.h>
@@ -23,9 +24,11 @@
 #include <azure/core/az_http_transport.h>
 #include <azure/core/az_json.h>
 #include <azure/core/az_log.h>
+#include <azure/core/az_lz4.h>
 #include <azure/core/az_platform.h>
 #include <azure/core/az_precondition.h>
 #include <azure/core/az_result.h>
+#include <azure/core/az_sha256.h>
 #include <azure/core/az_span.h>
 #include <azure/core/az_version.h>
 
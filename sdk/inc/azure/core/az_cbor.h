@@ -0,0 +1,628 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief This header defines the types and functions your application uses to read or write CBOR
+ * (Concise Binary Object Representation, RFC 8949) data, and to transcode it to or from JSON.
+ *
+ * @details The API mirrors the one for JSON within az_json.h, so the same data model (objects with
+ * text property names, arrays, strings, numbers, booleans, and null) can be written in either
+ * format. CBOR is typically 30 to 50 percent smaller than the equivalent JSON text.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_CBOR_H
+#define _az_CBOR_H
+
+#include <azure/core/az_json.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief Defines symbols for the various kinds of CBOR tokens that make up any CBOR data item.
+ */
+typedef enum
+{
+  AZ_CBOR_TOKEN_NONE, ///< There is no value (as distinct from #AZ_CBOR_TOKEN_NULL).
+  AZ_CBOR_TOKEN_BEGIN_OBJECT, ///< The token kind is the start of a CBOR map.
+  AZ_CBOR_TOKEN_END_OBJECT, ///< The token kind is the end of a CBOR map.
+  AZ_CBOR_TOKEN_BEGIN_ARRAY, ///< The token kind is the start of a CBOR array.
+  AZ_CBOR_TOKEN_END_ARRAY, ///< The token kind is the end of a CBOR array.
+  AZ_CBOR_TOKEN_PROPERTY_NAME, ///< The token kind is a CBOR text string used as a map key.
+  AZ_CBOR_TOKEN_STRING, ///< The token kind is a CBOR text string.
+  AZ_CBOR_TOKEN_BYTE_STRING, ///< The token kind is a CBOR byte string.
+  AZ_CBOR_TOKEN_INTEGER, ///< The token kind is a CBOR unsigned or negative integer.
+  AZ_CBOR_TOKEN_FLOAT, ///< The token kind is a CBOR half, single, or double precision float.
+  AZ_CBOR_TOKEN_TRUE, ///< The token kind is the CBOR simple value `true`.
+  AZ_CBOR_TOKEN_FALSE, ///< The token kind is the CBOR simple value `false`.
+  AZ_CBOR_TOKEN_NULL, ///< The token kind is the CBOR simple value `null` (or `undefined`).
+} az_cbor_token_kind;
+
+/**
+ * @brief A limited stack used by the #az_cbor_reader and #az_cbor_writer to track the containers
+ * they are within.
+ */
+typedef struct
+{
+  struct
+  {
+    // For each level of nesting, the number of items left within a definite-length container, or
+    // -1 minus the number of items read so far within an indefinite-length container.
+    int32_t remaining_items[32];
+    uint32_t is_object; // One bit per level of nesting, set for maps.
+    int32_t current_depth;
+  } _internal;
+} _az_cbor_stack;
+
+/**
+ * @brief Represents a CBOR token. The kind field indicates the type of the CBOR token and the
+ * slice represents the portion of the CBOR data that makes up the token.
+ */
+typedef struct
+{
+  /// This read-only field gives access to the slice of the CBOR data that contains the content of
+  /// a text or byte string token, or the encoded bytes of any other token.
+  az_span slice;
+
+  /// This read-only field gives access to the type of the token returned by the #az_cbor_reader,
+  /// and it shouldn't be modified by the caller.
+  az_cbor_token_kind kind;
+
+  struct
+  {
+    /// The argument of an integer token, i.e. its value, or -1 minus its value if negative.
+    uint64_t integer_argument;
+
+    /// Whether an integer token is negative.
+    bool is_negative;
+
+    /// The value of a float token.
+    double float_value;
+  } _internal;
+} az_cbor_token;
+
+/**
+ * @brief Gets the CBOR token's integer as a 64-bit signed integer.
+ *
+ * @param[in] cbor_token A pointer to an #az_cbor_token instance.
+ * @param[out] out_value A pointer to a variable to receive the value.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The integer is returned.
+ * @retval #AZ_ERROR_CBOR_INVALID_STATE The kind is not #AZ_CBOR_TOKEN_INTEGER.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The integer is outside the range of an `int64_t`.
+ */
+AZ_NODISCARD az_result
+az_cbor_token_get_int64(az_cbor_token const* cbor_token, int64_t* out_value);
+
+/**
+ * @brief Gets the CBOR token's integer as a 32-bit signed integer.
+ *
+ * @param[in] cbor_token A pointer to an #az_cbor_token instance.
+ * @param[out] out_value A pointer to a variable to receive the value.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The integer is returned.
+ * @retval #AZ_ERROR_CBOR_INVALID_STATE The kind is not #AZ_CBOR_TOKEN_INTEGER.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The integer is outside the range of an `int32_t`.
+ */
+AZ_NODISCARD az_result
+az_cbor_token_get_int32(az_cbor_token const* cbor_token, int32_t* out_value);
+
+/**
+ * @brief Gets the CBOR token's number as a `double`.
+ *
+ * @param[in] cbor_token A pointer to an #az_cbor_token instance.
+ * @param[out] out_value A pointer to a variable to receive the value.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The number is returned.
+ * @retval #AZ_ERROR_CBOR_INVALID_STATE The kind is not #AZ_CBOR_TOKEN_FLOAT or
+ * #AZ_CBOR_TOKEN_INTEGER.
+ */
+AZ_NODISCARD az_result
+az_cbor_token_get_double(az_cbor_token const* cbor_token, double* out_value);
+
+/**
+ * @brief Gets the CBOR token's boolean.
+ *
+ * @param[in] cbor_token A pointer to an #az_cbor_token instance.
+ * @param[out] out_value A pointer to a variable to receive the value.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The boolean value is returned.
+ * @retval #AZ_ERROR_CBOR_INVALID_STATE The kind is not #AZ_CBOR_TOKEN_TRUE or
+ * #AZ_CBOR_TOKEN_FALSE.
+ */
+AZ_NODISCARD az_result
+az_cbor_token_get_boolean(az_cbor_token const* cbor_token, bool* out_value);
+
+/**
+ * @brief Determines whether the text string or property name within the CBOR token matches the
+ * \p expected_text.
+ *
+ * @param[in] cbor_token A pointer to an #az_cbor_token instance containing the CBOR text string.
+ * @param[in] expected_text The UTF-8 encoded text to compare against.
+ *
+ * @return `true` if the token is a text string or property name with the same content as \p
+ * expected_text; otherwise, `false`.
+ */
+AZ_NODISCARD bool
+az_cbor_token_is_text_equal(az_cbor_token const* cbor_token, az_span expected_text);
+
+/**
+ * @brief Allows the user to define custom behavior when writing CBOR using the #az_cbor_writer.
+ */
+typedef struct
+{
+  struct
+  {
+    /// Currently, this is unused, but needed as a placeholder since we can't have an empty struct.
+    bool unused;
+  } _internal;
+} az_cbor_writer_options;
+
+/**
+ * @brief Gets the default CBOR writer options.
+ *
+ * @details Call this to obtain an initialized #az_cbor_writer_options structure that can be
+ * modified and passed to #az_cbor_writer_init().
+ *
+ * @return The default #az_cbor_writer_options.
+ */
+AZ_NODISCARD AZ_INLINE az_cbor_writer_options az_cbor_writer_options_default()
+{
+  az_cbor_writer_options options = {
+    ._internal = {
+      .unused = false,
+    },
+  };
+
+  return options;
+}
+
+/**
+ * @brief Provides forward-only, non-cached writing of UTF-8 encoded CBOR data into the provided
+ * buffer.
+ *
+ * @details #az_cbor_writer builds CBOR data with the same shape as #az_json_writer builds JSON
+ * text. Objects and arrays are written with an indefinite length, so that items can be appended
+ * without knowing their count up front.
+ */
+typedef struct
+{
+  /// The total number of bytes written by the writer to the destination buffer(s).
+  /// This read-only field tracks the number of bytes of CBOR written so far, and it shouldn't be
+  /// modified by the caller.
+  int32_t total_bytes_written;
+
+  struct
+  {
+    /// The destination to write the CBOR data into.
+    az_span destination_buffer;
+
+    /// The bytes written in the current destination buffer.
+    int32_t bytes_written;
+
+    /// Allocator used to support non-contiguous buffer as a destination.
+    az_span_allocator_fn allocator_callback;
+
+    /// Any struct that was provided by the user for their specific implementation, passed through
+    /// to the #az_span_allocator_fn.
+    void* user_context;
+
+    /// The kind of the last token written, used to validate what can be written next.
+    az_cbor_token_kind token_kind;
+
+    /// The objects and arrays the writer is within.
+    _az_cbor_stack stack;
+
+    /// A copy of the options provided by the user.
+    az_cbor_writer_options options;
+  } _internal;
+} az_cbor_writer;
+
+/**
+ * @brief Initializes an #az_cbor_writer which writes CBOR data into a buffer.
+ *
+ * @param[out] out_cbor_writer A pointer to an #az_cbor_writer the instance to initialize.
+ * @param[in] destination_buffer An #az_span over the byte buffer where the CBOR data is to be
+ * written.
+ * @param[in] options __[nullable]__ A reference to an #az_cbor_writer_options
+ * structure which defines custom behavior of the #az_cbor_writer. If `NULL` is passed, the writer
+ * will use the default options (i.e. #az_cbor_writer_options_default()).
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_cbor_writer is initialized successfully.
+ * @retval other Initialization failed.
+ */
+AZ_NODISCARD az_result az_cbor_writer_init(
+    az_cbor_writer* out_cbor_writer,
+    az_span destination_buffer,
+    az_cbor_writer_options const* options);
+
+/**
+ * @brief Initializes an #az_cbor_writer which writes CBOR data into a destination that can contain
+ * non-contiguous buffers.
+ *
+ * @param[out] out_cbor_writer A pointer to an #az_cbor_writer the instance to initialize.
+ * @param[in] first_destination_buffer An #az_span over the byte buffer where the CBOR data is to
+ * be written at the start.
+ * @param[in] allocator_callback An #az_span_allocator_fn callback function that provides the
+ * destination span to write the CBOR data to once the previous buffer is full or too small to
+ * contain the next token.
+ * @param user_context A context specific user-defined struct or set of fields that is passed
+ * through to calls to the #az_span_allocator_fn.
+ * @param[in] options __[nullable]__ A reference to an #az_cbor_writer_options
+ * structure which defines custom behavior of the #az_cbor_writer. If `NULL` is passed, the writer
+ * will use the default options (i.e. #az_cbor_writer_options_default()).
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_cbor_writer is initialized successfully.
+ * @retval other Failure.
+ */
+AZ_NODISCARD az_result az_cbor_writer_chunked_init(
+    az_cbor_writer* out_cbor_writer,
+    az_span first_destination_buffer,
+    az_span_allocator_fn allocator_callback,
+    void* user_context,
+    az_cbor_writer_options const* options);
+
+/**
+ * @brief Returns the #az_span containing the CBOR data written to the underlying buffer so far, in
+ * the last provided destination buffer.
+ *
+ * @param[in] cbor_writer A pointer to an #az_cbor_writer instance wrapping the destination buffer.
+ *
+ * @return An #az_span containing the CBOR data built so far.
+ *
+ * @remarks When the destination is a set of non-contiguous buffers (using
+ * #az_cbor_writer_chunked_init()), this function only returns the data written into the last
+ * provided destination buffer from the allocator callback.
+ */
+AZ_NODISCARD AZ_INLINE az_span
+az_cbor_writer_get_bytes_used_in_destination(az_cbor_writer const* cbor_writer)
+{
+  return az_span_slice(
+      cbor_writer->_internal.destination_buffer, 0, cbor_writer->_internal.bytes_written);
+}
+
+/**
+ * @brief Appends the UTF-8 text value as a CBOR text string.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the string value to.
+ * @param[in] value The UTF-8 encoded value to be written as a CBOR text string.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The string value was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result
+az_cbor_writer_append_string(az_cbor_writer* ref_cbor_writer, az_span value);
+
+/**
+ * @brief Appends the binary value as a CBOR byte string.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the byte string to.
+ * @param[in] value The bytes to be written as a CBOR byte string.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The byte string was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result
+az_cbor_writer_append_byte_string(az_cbor_writer* ref_cbor_writer, az_span value);
+
+/**
+ * @brief Appends the UTF-8 property name as a CBOR text string map key.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the property name to.
+ * @param[in] name The UTF-8 encoded property name of the CBOR value to be written.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The property name was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result
+az_cbor_writer_append_property_name(az_cbor_writer* ref_cbor_writer, az_span name);
+
+/**
+ * @brief Appends a boolean value as a CBOR simple value.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the boolean to.
+ * @param[in] value The value to be written as a CBOR `true` or `false`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The boolean was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result az_cbor_writer_append_bool(az_cbor_writer* ref_cbor_writer, bool value);
+
+/**
+ * @brief Appends an `int32_t` number value as a CBOR integer.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the number to.
+ * @param[in] value The value to be written as a CBOR integer.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The number was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result az_cbor_writer_append_int32(az_cbor_writer* ref_cbor_writer, int32_t value);
+
+/**
+ * @brief Appends an `int64_t` number value as a CBOR integer.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the number to.
+ * @param[in] value The value to be written as a CBOR integer.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The number was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result az_cbor_writer_append_int64(az_cbor_writer* ref_cbor_writer, int64_t value);
+
+/**
+ * @brief Appends a `double` number value as a CBOR float.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the number to.
+ * @param[in] value The value to be written as a CBOR float.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The number was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ *
+ * @remarks The value is written in single precision when that represents it exactly, and in double
+ * precision otherwise. Only finite `double` values are supported.
+ */
+AZ_NODISCARD az_result az_cbor_writer_append_double(az_cbor_writer* ref_cbor_writer, double value);
+
+/**
+ * @brief Appends the CBOR simple value `null`.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the `null` value to.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK `null` was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result az_cbor_writer_append_null(az_cbor_writer* ref_cbor_writer);
+
+/**
+ * @brief Appends the beginning of an indefinite-length CBOR map.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the start of the map to.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Map start was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ * @retval #AZ_ERROR_CBOR_NESTING_OVERFLOW The depth of the CBOR exceeds the maximum allowed
+ * depth of 32.
+ */
+AZ_NODISCARD az_result az_cbor_writer_append_begin_object(az_cbor_writer* ref_cbor_writer);
+
+/**
+ * @brief Appends the beginning of an indefinite-length CBOR array.
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the start of the array to.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Array start was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ * @retval #AZ_ERROR_CBOR_NESTING_OVERFLOW The depth of the CBOR exceeds the maximum allowed
+ * depth of 32.
+ */
+AZ_NODISCARD az_result az_cbor_writer_append_begin_array(az_cbor_writer* ref_cbor_writer);
+
+/**
+ * @brief Appends the end of the current CBOR map (i.e. the `break` stop code).
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the end of the map to.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Map end was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result az_cbor_writer_append_end_object(az_cbor_writer* ref_cbor_writer);
+
+/**
+ * @brief Appends the end of the current CBOR array (i.e. the `break` stop code).
+ *
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance containing the buffer to
+ * append the end of the array to.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Array end was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result az_cbor_writer_append_end_array(az_cbor_writer* ref_cbor_writer);
+
+/**
+ * @brief Allows the user to define custom behavior when reading CBOR using the #az_cbor_reader.
+ */
+typedef struct
+{
+  struct
+  {
+    /// Currently, this is unused, but needed as a placeholder since we can't have an empty struct.
+    bool unused;
+  } _internal;
+} az_cbor_reader_options;
+
+/**
+ * @brief Gets the default CBOR reader options.
+ *
+ * @details Call this to obtain an initialized #az_cbor_reader_options structure that can be
+ * modified and passed to #az_cbor_reader_init().
+ *
+ * @return The default #az_cbor_reader_options.
+ */
+AZ_NODISCARD AZ_INLINE az_cbor_reader_options az_cbor_reader_options_default()
+{
+  az_cbor_reader_options options = {
+    ._internal = {
+      .unused = false,
+    },
+  };
+
+  return options;
+}
+
+/**
+ * @brief Returns the CBOR tokens contained within a CBOR buffer, one at a time.
+ *
+ * @details Both definite and indefinite-length maps and arrays are supported. Map keys must be
+ * text strings, which are returned as #AZ_CBOR_TOKEN_PROPERTY_NAME tokens. Tags are skipped over,
+ * and the tagged data item is returned as is. Indefinite-length (chunked) strings and simple values
+ * other than `false`, `true`, `null`, and `undefined` are not supported.
+ */
+typedef struct
+{
+  /// This read-only field gives access to the current token that the #az_cbor_reader has
+  /// processed, and it shouldn't be modified by the caller.
+  az_cbor_token token;
+
+  struct
+  {
+    /// The CBOR data to read.
+    az_span cbor_buffer;
+
+    /// The number of bytes consumed so far.
+    int32_t bytes_consumed;
+
+    /// The maps and arrays the reader is within.
+    _az_cbor_stack stack;
+
+    /// A copy of the options provided by the user.
+    az_cbor_reader_options options;
+  } _internal;
+} az_cbor_reader;
+
+/**
+ * @brief Initializes an #az_cbor_reader to read the CBOR payload contained within the provided
+ * buffer.
+ *
+ * @param[out] out_cbor_reader A pointer to an #az_cbor_reader instance to initialize.
+ * @param[in] cbor_buffer An #az_span over the byte buffer containing the CBOR data to process.
+ * @param[in] options __[nullable]__ A reference to an #az_cbor_reader_options structure which
+ * defines custom behavior of the #az_cbor_reader. If `NULL` is passed, the reader will use the
+ * default options (i.e. #az_cbor_reader_options_default()).
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_cbor_reader is initialized successfully.
+ * @retval other Initialization failed.
+ */
+AZ_NODISCARD az_result az_cbor_reader_init(
+    az_cbor_reader* out_cbor_reader,
+    az_span cbor_buffer,
+    az_cbor_reader_options const* options);
+
+/**
+ * @brief Reads the next token in the CBOR data and updates the reader state.
+ *
+ * @param[in,out] ref_cbor_reader A pointer to an #az_cbor_reader instance containing the CBOR to
+ * read.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The token was read successfully.
+ * @retval #AZ_ERROR_UNEXPECTED_END The end of the CBOR data was reached, within a data item.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR Invalid or unsupported CBOR data was found.
+ * @retval #AZ_ERROR_CBOR_NESTING_OVERFLOW The depth of the CBOR data exceeds the maximum allowed
+ * depth of 32.
+ * @retval #AZ_ERROR_CBOR_READER_DONE No more CBOR data left to read.
+ */
+AZ_NODISCARD az_result az_cbor_reader_next_token(az_cbor_reader* ref_cbor_reader);
+
+/**
+ * @brief Reads and skips over any nested CBOR elements.
+ *
+ * @param[in,out] ref_cbor_reader A pointer to an #az_cbor_reader instance containing the CBOR to
+ * read.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The children of the current CBOR token are skipped successfully.
+ * @retval #AZ_ERROR_UNEXPECTED_END The end of the CBOR data is reached.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR Invalid or unsupported CBOR data was found.
+ *
+ * @remarks If the current token kind is a property name, the reader first moves to the property
+ * value. Then, if the token kind is start of a map or array, the reader moves to the matching
+ * end map or array. For all other token kinds, the reader doesn't move and returns #AZ_OK.
+ */
+AZ_NODISCARD az_result az_cbor_reader_skip_children(az_cbor_reader* ref_cbor_reader);
+
+/**
+ * @brief Reads the next complete CBOR data item and writes it as JSON text.
+ *
+ * @param[in,out] ref_cbor_reader A pointer to an #az_cbor_reader instance, positioned right before
+ * the data item to transcode.
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance to append the JSON text
+ * to.
+ * @param[in] scratch_buffer A buffer used to base64 encode byte strings. It needs to be large
+ * enough for the largest byte string, once encoded, and can be empty if there are none.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The data item was transcoded successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The JSON writer destination or \p scratch_buffer is too
+ * small.
+ * @retval other The CBOR data is invalid.
+ *
+ * @remarks Byte strings are written as base64 encoded JSON strings, and non-finite floats as
+ * `null`, since JSON has no equivalent for these.
+ * @remarks Integers are written exactly, including those outside the range of an `int64_t`. Floats
+ * are written with up to 15 significant digits, in exponent form beyond 2^53.
+ */
+AZ_NODISCARD az_result az_cbor_transcode_to_json(
+    az_cbor_reader* ref_cbor_reader,
+    az_json_writer* ref_json_writer,
+    az_span scratch_buffer);
+
+/**
+ * @brief Reads the next complete JSON value and writes it as CBOR data.
+ *
+ * @param[in,out] ref_json_reader A pointer to an #az_json_reader instance, positioned right before
+ * the JSON value to transcode.
+ * @param[in,out] ref_cbor_writer A pointer to an #az_cbor_writer instance to append the CBOR data
+ * to.
+ * @param[in] scratch_buffer A buffer used to unescape JSON strings that contain escaped characters
+ * or span multiple buffers. It needs to be larger than the longest such string, and can be empty
+ * if there are none.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The JSON value was transcoded successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The CBOR writer destination or \p scratch_buffer is too
+ * small.
+ * @retval other The JSON text is invalid.
+ *
+ * @remarks JSON numbers without a fraction or exponent that fit in an `int64_t` are written as CBOR
+ * integers, and all others as CBOR floats.
+ */
+AZ_NODISCARD az_result az_cbor_transcode_from_json(
+    az_json_reader* ref_json_reader,
+    az_cbor_writer* ref_cbor_writer,
+    az_span scratch_buffer);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_CBOR_H
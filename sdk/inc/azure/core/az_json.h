@@ -260,6 +260,62 @@ AZ_NODISCARD bool az_json_token_is_text_equal(
     az_json_token const* json_token,
     az_span expected_text);
 
+/**
+ * @brief Iterates over the #az_span fragments that make up the JSON text of an #az_json_token,
+ * without copying them.
+ *
+ * @remarks An instance of #az_json_token_segment_iterator must not outlive the lifetime of the
+ * #az_json_token it was initialized with.
+ */
+typedef struct
+{
+  struct
+  {
+    /// The token whose segments are being iterated over.
+    az_json_token const* json_token;
+
+    /// The index of the next buffer segment to return. For a contiguous token, this is 0 before the
+    /// token slice has been returned, and 1 afterwards.
+    int32_t next_buffer_index;
+  } _internal;
+} az_json_token_segment_iterator;
+
+/**
+ * @brief Initializes an #az_json_token_segment_iterator to walk the fragments of a JSON token.
+ *
+ * @param[out] out_iterator A pointer to an #az_json_token_segment_iterator instance to initialize.
+ * @param[in] json_token A pointer to the #az_json_token to iterate over.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_json_token_segment_iterator is initialized successfully.
+ */
+AZ_NODISCARD az_result az_json_token_segment_iterator_init(
+    az_json_token_segment_iterator* out_iterator,
+    az_json_token const* json_token);
+
+/**
+ * @brief Returns the next non-empty fragment of the JSON token text.
+ *
+ * @param[in,out] ref_iterator A pointer to an initialized #az_json_token_segment_iterator.
+ * @param[out] out_segment A pointer to an #az_span to receive the next fragment. It is a slice of
+ * one of the buffers the #az_json_reader was initialized with.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The next fragment was returned.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND There are no more fragments left within the token.
+ *
+ * @remarks A token within a single contiguous buffer is returned as one fragment, identical to
+ * az_json_token.slice. Tokens that straddle the buffers of a chunked #az_json_reader are returned
+ * as one fragment per segment, in order.
+ *
+ * @remarks JSON strings are returned as they appear in the JSON text, without the surrounding
+ * quotes and with escape sequences left as is. An escape sequence may be split across two
+ * consecutive fragments.
+ */
+AZ_NODISCARD az_result az_json_token_segment_iterator_next(
+    az_json_token_segment_iterator* ref_iterator,
+    az_span* out_segment);
+
 /************************************ JSON WRITER ******************/
 
 /**
@@ -267,6 +323,14 @@ AZ_NODISCARD bool az_json_token_is_text_equal(
  */
 typedef struct
 {
+  /// When set to `true`, the #az_json_writer runs every append call and its validation, but only
+  /// counts the bytes that would be written, rather than writing the JSON text out. The destination
+  /// buffer passed to #az_json_writer_init() is then used as scratch space and must be at least 64
+  /// bytes in size. Once done, az_json_writer.total_bytes_written contains the exact size needed
+  /// for a destination buffer to hold the JSON text, and #az_json_writer_get_max_depth() returns
+  /// its maximum nesting depth.
+  bool compute_size_only;
+
   struct
   {
     /// Currently, this is unused, but needed as a placeholder since we can't have an empty struct.
@@ -286,6 +350,7 @@ typedef struct
 AZ_NODISCARD AZ_INLINE az_json_writer_options az_json_writer_options_default()
 {
   az_json_writer_options options = {
+    .compute_size_only = false,
     ._internal = {
       .unused = false,
     },
@@ -335,6 +400,9 @@ typedef struct
     /// overflow the maximum supported depth.
     _az_json_bit_stack bit_stack; // needed for validation, potentially #if/def with preconditions.
 
+    /// The deepest level of nested JSON objects or arrays written so far.
+    int32_t max_depth;
+
     /// A copy of the options provided by the user.
     az_json_writer_options options;
   } _internal;
@@ -385,6 +453,164 @@ AZ_NODISCARD az_result az_json_writer_chunked_init(
     void* user_context,
     az_json_writer_options const* options);
 
+/**
+ * @brief Defines the information about a completed chunk of JSON text, passed to the
+ * #az_json_writer_flush_fn.
+ */
+typedef struct
+{
+  /// Any struct that was provided by the user for their specific implementation, passed through to
+  /// the #az_json_writer_flush_fn.
+  void* user_context;
+
+  /// The JSON text written into the buffer, which must be sent (or otherwise consumed) before the
+  /// buffer is released back to the writer.
+  az_span chunk;
+
+  /// The index of the buffer holding the \p chunk, which must be passed to
+  /// #az_json_writer_buffer_pool_release() once the buffer can be reused.
+  int32_t buffer_index;
+} az_json_writer_flush_context;
+
+/**
+ * @brief Defines the signature of the callback function that hands a completed chunk of JSON text
+ * over to the application, for example to be queued for sending on the network.
+ *
+ * @param[in] flush_context The completed chunk and the user-defined context.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval other Failure, which stops the #az_json_writer with #AZ_ERROR_NOT_ENOUGH_SPACE.
+ *
+ * @remarks The callback should return as soon as it has taken ownership of the chunk, without
+ * waiting for it to be sent, so that the writer can keep going into the next free buffer.
+ */
+typedef az_result (*az_json_writer_flush_fn)(az_json_writer_flush_context* flush_context);
+
+/**
+ * @brief Defines the signature of the callback function that is called when all the buffers are in
+ * flight and the #az_json_writer needs another one.
+ *
+ * @param user_context The user-defined context provided to #az_json_writer_buffer_pool_init().
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK At least one buffer might have been released, and the writer checks again.
+ * @retval other Failure, for example on a timeout, which stops the #az_json_writer with
+ * #AZ_ERROR_NOT_ENOUGH_SPACE.
+ *
+ * @remarks This is where back-pressure is applied, for example by running the network loop until
+ * a pending send completes and its buffer is released with #az_json_writer_buffer_pool_release().
+ */
+typedef az_result (*az_json_writer_wait_fn)(void* user_context);
+
+/**
+ * @brief A set of pre-registered buffers that an #az_json_writer writes into in turn, handing each
+ * completed one over to a flush callback, without waiting for it to be consumed.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span* buffers;
+    int32_t buffer_count;
+    int32_t current_index;
+    uint32_t buffers_in_flight;
+    az_json_writer_flush_fn flush_callback;
+    az_json_writer_wait_fn wait_callback;
+    void* user_context;
+  } _internal;
+} az_json_writer_buffer_pool;
+
+/**
+ * @brief Initializes an #az_json_writer_buffer_pool over a set of buffers.
+ *
+ * @param[out] out_buffer_pool A pointer to an #az_json_writer_buffer_pool instance to initialize.
+ * @param[in] buffers A pointer to an array of buffers, each at least 64 bytes in size, that must
+ * remain valid for as long as the pool is in use.
+ * @param[in] buffer_count The number of buffers within the \p buffers array, between 1 and 32.
+ * @param[in] flush_callback An #az_json_writer_flush_fn callback function that is handed each
+ * completed chunk of JSON text.
+ * @param[in] wait_callback __[nullable]__ An #az_json_writer_wait_fn callback function that is
+ * called when all the buffers are in flight. If `NULL`, the #az_json_writer fails with
+ * #AZ_ERROR_NOT_ENOUGH_SPACE in that case instead.
+ * @param user_context A context specific user-defined struct or set of fields that is passed
+ * through to the callbacks.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_json_writer_buffer_pool is initialized successfully.
+ */
+AZ_NODISCARD az_result az_json_writer_buffer_pool_init(
+    az_json_writer_buffer_pool* out_buffer_pool,
+    az_span* buffers,
+    int32_t buffer_count,
+    az_json_writer_flush_fn flush_callback,
+    az_json_writer_wait_fn wait_callback,
+    void* user_context);
+
+/**
+ * @brief Releases a buffer, that was handed over to the flush callback, back to the pool so that it
+ * can be written into again.
+ *
+ * @param[in,out] ref_buffer_pool A pointer to an #az_json_writer_buffer_pool instance.
+ * @param[in] buffer_index The az_json_writer_flush_context.buffer_index of the flushed chunk.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The buffer was released successfully.
+ *
+ * @remarks The pool isn't thread-safe. This must not be called concurrently with the
+ * #az_json_writer that is using the pool, for example from an interrupt handler.
+ */
+AZ_NODISCARD az_result az_json_writer_buffer_pool_release(
+    az_json_writer_buffer_pool* ref_buffer_pool,
+    int32_t buffer_index);
+
+/**
+ * @brief Returns the number of buffers that were handed over to the flush callback and not yet
+ * released.
+ *
+ * @param[in] buffer_pool A pointer to an #az_json_writer_buffer_pool instance.
+ *
+ * @return The number of buffers in flight.
+ */
+AZ_NODISCARD int32_t
+az_json_writer_buffer_pool_get_in_flight_count(az_json_writer_buffer_pool const* buffer_pool);
+
+/**
+ * @brief Initializes an #az_json_writer which writes JSON text into the buffers of an
+ * #az_json_writer_buffer_pool, flushing each one as soon as it is full.
+ *
+ * @param[out] out_json_writer A pointer to an #az_json_writer the instance to initialize.
+ * @param[in,out] ref_buffer_pool A pointer to an #az_json_writer_buffer_pool instance, which must
+ * remain valid for as long as the writer is in use.
+ * @param[in] options __[nullable]__ A reference to an #az_json_writer_options
+ * structure which defines custom behavior of the #az_json_writer. If `NULL` is passed, the writer
+ * will use the default options (i.e. #az_json_writer_options_default()).
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_json_writer is initialized successfully.
+ *
+ * @remarks Once done writing, call #az_json_writer_buffered_flush() to hand over the last,
+ * partially filled, chunk.
+ */
+AZ_NODISCARD az_result az_json_writer_buffered_init(
+    az_json_writer* out_json_writer,
+    az_json_writer_buffer_pool* ref_buffer_pool,
+    az_json_writer_options const* options);
+
+/**
+ * @brief Hands the JSON text written so far into the current buffer over to the flush callback.
+ *
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance initialized with
+ * #az_json_writer_buffered_init().
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The JSON text was flushed successfully, or there was nothing to flush.
+ * @retval other The flush callback failed.
+ *
+ * @remarks The writer can keep appending afterwards, continuing into the next free buffer.
+ */
+AZ_NODISCARD az_result az_json_writer_buffered_flush(az_json_writer* ref_json_writer);
+
 /**
  * @brief Returns the #az_span containing the JSON text written to the underlying buffer so far, in
  * the last provided destination buffer.
@@ -409,6 +635,22 @@ az_json_writer_get_bytes_used_in_destination(az_json_writer const* json_writer)
       json_writer->_internal.destination_buffer, 0, json_writer->_internal.bytes_written);
 }
 
+/**
+ * @brief Returns the maximum depth of nested JSON objects or arrays written so far.
+ *
+ * @param[in] json_writer A pointer to an #az_json_writer instance.
+ *
+ * @return The deepest level of nesting reached, including any nested JSON text appended with
+ * #az_json_writer_append_json_text(). This is 0 if no object or array has been written.
+ *
+ * @remarks This is most useful along with az_json_writer_options.compute_size_only, to find out
+ * the shape of the JSON text before writing it out for real.
+ */
+AZ_NODISCARD AZ_INLINE int32_t az_json_writer_get_max_depth(az_json_writer const* json_writer)
+{
+  return json_writer->_internal.max_depth;
+}
+
 /**
  * @brief Appends the UTF-8 text value (as a JSON string) into the buffer.
  *
@@ -568,6 +810,103 @@ AZ_NODISCARD az_result az_json_writer_append_double(
  */
 AZ_NODISCARD az_result az_json_writer_append_null(az_json_writer* ref_json_writer);
 
+/**
+ * @brief Appends a JSON array containing the specified `int32_t` numbers (i.e. `[1,2,3]`).
+ *
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance containing the buffer to
+ * append the array to.
+ * @param[in] values A pointer to the numbers to write, in order.
+ * @param[in] count The number of elements within \p values.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The array was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ * @retval #AZ_ERROR_JSON_NESTING_OVERFLOW The depth of the JSON exceeds the maximum allowed
+ * depth of 64.
+ *
+ * @remark This is equivalent to, but much faster than, appending the beginning of an array, each
+ * of the numbers, and then the end of the array, since the writer state is only validated once.
+ *
+ * @remark If the writer was initialized with #az_json_writer_chunked_init(), a failure can leave
+ * part of the array written within the destination buffers already handed out by the allocator
+ * callback. Otherwise, nothing is written on failure.
+ */
+AZ_NODISCARD az_result az_json_writer_append_int32_array(
+    az_json_writer* ref_json_writer,
+    int32_t const* values,
+    int32_t count);
+
+/**
+ * @brief Appends a JSON array containing the specified `int64_t` numbers (i.e. `[1,2,3]`).
+ *
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance containing the buffer to
+ * append the array to.
+ * @param[in] values A pointer to the numbers to write, in order.
+ * @param[in] count The number of elements within \p values.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The array was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ * @retval #AZ_ERROR_JSON_NESTING_OVERFLOW The depth of the JSON exceeds the maximum allowed
+ * depth of 64.
+ *
+ * @remark The same remarks as for #az_json_writer_append_int32_array() apply.
+ */
+AZ_NODISCARD az_result az_json_writer_append_int64_array(
+    az_json_writer* ref_json_writer,
+    int64_t const* values,
+    int32_t count);
+
+/**
+ * @brief Appends a JSON array containing the specified `double` numbers (i.e. `[1.5,2,3.25]`).
+ *
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance containing the buffer to
+ * append the array to.
+ * @param[in] values A pointer to the numbers to write, in order.
+ * @param[in] count The number of elements within \p values.
+ * @param[in] fractional_digits The number of digits of each value to write after the decimal
+ * point and truncate the rest.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The array was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ * @retval #AZ_ERROR_JSON_NESTING_OVERFLOW The depth of the JSON exceeds the maximum allowed
+ * depth of 64.
+ *
+ * @remark The same remarks as for #az_json_writer_append_int32_array() and
+ * #az_json_writer_append_double() apply.
+ *
+ * @remark Unlike #az_json_writer_append_double(), numbers with an integer component larger than
+ * `2^53 - 1` are written in exponent form (i.e. `2.95147905179352e+20`), with 15 significant
+ * digits, rather than failing with #AZ_ERROR_NOT_SUPPORTED.
+ */
+AZ_NODISCARD az_result az_json_writer_append_double_array(
+    az_json_writer* ref_json_writer,
+    double const* values,
+    int32_t count,
+    int32_t fractional_digits);
+
+/**
+ * @brief Appends a JSON array containing the specified boolean values (i.e. `[true,false]`).
+ *
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance containing the buffer to
+ * append the array to.
+ * @param[in] values A pointer to the values to write, in order.
+ * @param[in] count The number of elements within \p values.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The array was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ * @retval #AZ_ERROR_JSON_NESTING_OVERFLOW The depth of the JSON exceeds the maximum allowed
+ * depth of 64.
+ *
+ * @remark The same remarks as for #az_json_writer_append_int32_array() apply.
+ */
+AZ_NODISCARD az_result az_json_writer_append_bool_array(
+    az_json_writer* ref_json_writer,
+    bool const* values,
+    int32_t count);
+
 /**
  * @brief Appends the beginning of a JSON object (i.e. `{`).
  *
@@ -815,6 +1154,270 @@ AZ_NODISCARD az_result az_json_reader_skip_children(az_json_reader* ref_json_rea
  */
 AZ_NODISCARD az_span az_json_string_unescape(az_span json_string, az_span destination);
 
+/**
+ * @brief Defines symbols for the kinds of values that can be filled into an #az_json_template
+ * slot.
+ */
+typedef enum
+{
+  AZ_JSON_TEMPLATE_SLOT_INT32 = 1, ///< The slot holds a JSON number written from an `int32_t`.
+  AZ_JSON_TEMPLATE_SLOT_DOUBLE = 2, ///< The slot holds a JSON number written from a `double`.
+  AZ_JSON_TEMPLATE_SLOT_STRING = 3, ///< The slot holds a JSON string.
+  AZ_JSON_TEMPLATE_SLOT_BOOL = 4, ///< The slot holds the JSON literal `true` or `false`.
+} az_json_template_slot_kind;
+
+/**
+ * @brief A placeholder for a value within the fixed JSON text of an #az_json_template.
+ */
+typedef struct
+{
+  struct
+  {
+    az_json_template_slot_kind kind;
+    int32_t offset;
+    int32_t placeholder_size;
+  } _internal;
+} az_json_template_slot;
+
+/**
+ * @brief A precompiled JSON document of a fixed shape, where only the values within its slots
+ * change from one use to the next.
+ *
+ * @details The constant parts of the JSON text (property names, punctuation, and any constant
+ * values) are validated, escaped, and laid out once, when the template is created. Writing a
+ * document from the template with an #az_json_template_writer then only copies those bytes and
+ * formats the slot values in between, without tracking any JSON state.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span json;
+    az_json_template_slot* slots;
+    int32_t slots_capacity;
+    int32_t slot_count;
+  } _internal;
+} az_json_template;
+
+/**
+ * @brief Writes JSON text from an #az_json_template, by filling in the values of its slots.
+ */
+typedef struct
+{
+  struct
+  {
+    az_json_template const* json_template;
+    az_span destination_buffer;
+    int32_t bytes_written;
+    int32_t json_offset;
+    int32_t slot_index;
+  } _internal;
+} az_json_template_writer;
+
+/**
+ * @brief Initializes an empty #az_json_template, which is then recorded from an #az_json_writer
+ * session using #az_json_template_append_slot() and #az_json_template_complete().
+ *
+ * @param[out] out_json_template A pointer to an #az_json_template instance to initialize.
+ * @param[in] slots A pointer to an array of #az_json_template_slot that the template uses to
+ * keep track of its slots. It must remain valid for as long as the template is in use.
+ * @param[in] slots_capacity The number of elements within the \p slots array.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_json_template is initialized successfully.
+ */
+AZ_NODISCARD az_result az_json_template_init(
+    az_json_template* out_json_template,
+    az_json_template_slot* slots,
+    int32_t slots_capacity);
+
+/**
+ * @brief Appends a slot for a value to both the #az_json_writer and the #az_json_template.
+ *
+ * @details Use this wherever a value would be appended with the #az_json_writer, to leave a hole
+ * that gets filled in when writing from the template. The leading comma, if needed, is written as
+ * part of the fixed JSON text.
+ *
+ * @param[in,out] ref_json_template A pointer to an #az_json_template instance, initialized with
+ * #az_json_template_init(), to record the slot into.
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance that is writing the fixed
+ * JSON text of the template into a contiguous buffer.
+ * @param[in] kind The kind of value that the slot holds.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The slot was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The \p ref_json_writer buffer or the slots array of the
+ * template is too small.
+ *
+ * @remarks The \p ref_json_writer must be initialized with #az_json_writer_init() right before
+ * recording the template, and the chunked and compute size only modes are not supported.
+ */
+AZ_NODISCARD az_result az_json_template_append_slot(
+    az_json_template* ref_json_template,
+    az_json_writer* ref_json_writer,
+    az_json_template_slot_kind kind);
+
+/**
+ * @brief Completes recording the #az_json_template, taking the JSON text written so far as its
+ * fixed JSON text.
+ *
+ * @param[in,out] ref_json_template A pointer to an #az_json_template instance that was recorded
+ * from the \p json_writer.
+ * @param[in] json_writer A pointer to the #az_json_writer instance that wrote the complete JSON
+ * text of the template.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The template is ready to be used.
+ *
+ * @remarks The buffer the \p json_writer wrote into must remain valid and unchanged for as long as
+ * the template is in use.
+ */
+AZ_NODISCARD az_result
+az_json_template_complete(az_json_template* ref_json_template, az_json_writer const* json_writer);
+
+/**
+ * @brief Initializes an #az_json_template from JSON text where the slots are marked with
+ * placeholder string values.
+ *
+ * @details A JSON string value (not a property name) that is exactly one of `"${int32}"`,
+ * `"${double}"`, `"${string}"`, or `"${bool}"` is a slot of the matching kind. For example:
+ * `{"temperature":"${double}","status":"${string}","alarm":"${bool}"}`.
+ *
+ * @param[out] out_json_template A pointer to an #az_json_template instance to initialize.
+ * @param[in] json_text The JSON text, with placeholders, of the template. It can be a string
+ * literal and must remain valid for as long as the template is in use.
+ * @param[in] slots A pointer to an array of #az_json_template_slot that the template uses to
+ * keep track of its slots. It must remain valid for as long as the template is in use.
+ * @param[in] slots_capacity The number of elements within the \p slots array.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_json_template is initialized successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The \p slots array is too small.
+ * @retval #AZ_ERROR_UNEXPECTED_END The provided \p json_text is invalid, needing more characters.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The provided \p json_text is invalid, with an unexpected
+ * character.
+ * @retval #AZ_ERROR_JSON_NESTING_OVERFLOW The depth of the \p json_text exceeds the maximum allowed
+ * depth of 64.
+ */
+AZ_NODISCARD az_result az_json_template_init_from_json(
+    az_json_template* out_json_template,
+    az_span json_text,
+    az_json_template_slot* slots,
+    int32_t slots_capacity);
+
+/**
+ * @brief Returns the number of slots within the #az_json_template.
+ *
+ * @param[in] json_template A pointer to an #az_json_template instance.
+ *
+ * @return The number of slots, each of which must be filled in order when writing from the
+ * template.
+ */
+AZ_NODISCARD AZ_INLINE int32_t
+az_json_template_get_slot_count(az_json_template const* json_template)
+{
+  return json_template->_internal.slot_count;
+}
+
+/**
+ * @brief Initializes an #az_json_template_writer which writes JSON text from an #az_json_template
+ * into a buffer.
+ *
+ * @param[out] out_template_writer A pointer to an #az_json_template_writer instance to initialize.
+ * @param[in] json_template A pointer to the #az_json_template to write from.
+ * @param[in] destination_buffer An #az_span over the byte buffer where the JSON text is to be
+ * written.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_json_template_writer is initialized successfully.
+ *
+ * @remarks The slots must then be filled in the same order they appear within the template, using
+ * the `az_json_template_writer_append_*` functions matching their kind, followed by
+ * #az_json_template_writer_complete().
+ */
+AZ_NODISCARD az_result az_json_template_writer_init(
+    az_json_template_writer* out_template_writer,
+    az_json_template const* json_template,
+    az_span destination_buffer);
+
+/**
+ * @brief Fills the next slot, of kind #AZ_JSON_TEMPLATE_SLOT_INT32, with an `int32_t` number.
+ *
+ * @param[in,out] ref_template_writer A pointer to an #az_json_template_writer instance.
+ * @param[in] value The value to be written as a JSON number.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The number was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result
+az_json_template_writer_append_int32(az_json_template_writer* ref_template_writer, int32_t value);
+
+/**
+ * @brief Fills the next slot, of kind #AZ_JSON_TEMPLATE_SLOT_DOUBLE, with a `double` number.
+ *
+ * @param[in,out] ref_template_writer A pointer to an #az_json_template_writer instance.
+ * @param[in] value The value to be written as a JSON number.
+ * @param[in] fractional_digits The number of digits of the \p value to write after the decimal
+ * point and truncate the rest.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The number was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ *
+ * @remarks The same restrictions on the \p value and \p fractional_digits as for
+ * #az_json_writer_append_double() apply.
+ */
+AZ_NODISCARD az_result az_json_template_writer_append_double(
+    az_json_template_writer* ref_template_writer,
+    double value,
+    int32_t fractional_digits);
+
+/**
+ * @brief Fills the next slot, of kind #AZ_JSON_TEMPLATE_SLOT_STRING, with a JSON string.
+ *
+ * @param[in,out] ref_template_writer A pointer to an #az_json_template_writer instance.
+ * @param[in] value The UTF-8 encoded value to be written as a JSON string. The value is escaped
+ * before writing.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The string value was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result
+az_json_template_writer_append_string(az_json_template_writer* ref_template_writer, az_span value);
+
+/**
+ * @brief Fills the next slot, of kind #AZ_JSON_TEMPLATE_SLOT_BOOL, with the JSON literal `true` or
+ * `false`.
+ *
+ * @param[in,out] ref_template_writer A pointer to an #az_json_template_writer instance.
+ * @param[in] value The value to be written as a JSON literal.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The bool value was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result
+az_json_template_writer_append_bool(az_json_template_writer* ref_template_writer, bool value);
+
+/**
+ * @brief Writes the rest of the fixed JSON text after the last slot, and returns the complete JSON
+ * text.
+ *
+ * @param[in,out] ref_template_writer A pointer to an #az_json_template_writer instance, where all
+ * the slots have been filled.
+ * @param[out] out_json_text A pointer to an #az_span that receives the slice of the destination
+ * buffer containing the complete JSON text.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The JSON text was completed successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result az_json_template_writer_complete(
+    az_json_template_writer* ref_template_writer,
+    az_span* out_json_text);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_JSON_H
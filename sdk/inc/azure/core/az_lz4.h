@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Defines APIs to compress and decompress binary data using the LZ4 block format.
+ *
+ * @details The compressor trades some compression ratio for speed and a small, fixed amount of
+ * memory, which makes it a good fit for repetitive payloads such as JSON telemetry. Neither the
+ * compressor nor the decompressor allocate any memory: the output is written into a caller
+ * provided buffer and the compressor's hash table is kept in a caller provided
+ * #az_lz4_compress_workspace, which can be reused across calls.
+ *
+ * The output is a raw LZ4 block (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md),
+ * without any frame header, so it can be decompressed by any LZ4 implementation, given the maximum
+ * size of the decompressed data.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_LZ4_H
+#define _az_LZ4_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+enum
+{
+  // The number of entries in the hash table used to find matches, 4 KiB worth of positions.
+  _az_LZ4_HASH_TABLE_SIZE = 1 << 10,
+};
+
+/**
+ * @brief The scratch memory used by az_lz4_compress() to find repeated sequences.
+ *
+ * @details It is about 4 KiB in size, so consider keeping it in static storage rather than on the
+ * stack of constrained devices. Its contents don't need to be initialized and don't carry over from
+ * one call to the next.
+ */
+typedef struct
+{
+  struct
+  {
+    uint32_t hash_table[_az_LZ4_HASH_TABLE_SIZE];
+  } _internal;
+} az_lz4_compress_workspace;
+
+/**
+ * @brief Compresses the span of binary data into an LZ4 block.
+ *
+ * @param[in,out] workspace The #az_lz4_compress_workspace to use as scratch memory.
+ * @param destination_bytes The output #az_span where the compressed data should be copied to as a
+ * result of the operation.
+ * @param[in] source_bytes The input #az_span that contains the data to be compressed.
+ * @param[out] out_written A pointer to an `int32_t` that receives the number of bytes written into
+ * the destination #az_span.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The \p destination_bytes is not large enough to contain the
+ * compressed data. A buffer of az_lz4_get_max_compressed_size() bytes is always large enough.
+ */
+AZ_NODISCARD az_result az_lz4_compress(
+    az_lz4_compress_workspace* workspace,
+    az_span destination_bytes,
+    az_span source_bytes,
+    int32_t* out_written);
+
+/**
+ * @brief Returns the maximum length of the result if you were to compress an #az_span of the
+ * specified length, which is slightly more than the input size for data that doesn't compress.
+ *
+ * @param source_bytes_size The size of the span containing the data to compress.
+ *
+ * @return The maximum length of the result.
+ */
+AZ_NODISCARD int32_t az_lz4_get_max_compressed_size(int32_t source_bytes_size);
+
+/**
+ * @brief Decompresses an LZ4 block into binary data.
+ *
+ * @param destination_bytes The output #az_span where the decompressed data should be copied to as
+ * a result of the operation.
+ * @param[in] source_lz4_block The input #az_span that contains the LZ4 block to be decompressed.
+ * @param[out] out_written A pointer to an `int32_t` that receives the number of bytes written into
+ * the destination #az_span.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The \p destination_bytes is not large enough to contain the
+ * decompressed data.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The \p source_lz4_block refers back to data before the start of
+ * the decompressed data.
+ * @retval #AZ_ERROR_UNEXPECTED_END The \p source_lz4_block is incomplete.
+ */
+AZ_NODISCARD az_result
+az_lz4_decompress(az_span destination_bytes, az_span source_lz4_block, int32_t* out_written);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_LZ4_H
@@ -0,0 +1,219 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Defines APIs to compute SHA-256 digests and HMAC-SHA256 message authentication codes, such
+ * as the signature of a Shared Access Signature (SAS) token.
+ *
+ * @details The data can be hashed all at once or streamed in pieces of any size. For HMAC, the key
+ * is processed once into an #az_hmac_sha256_key, which can then be used for any number of messages
+ * without hashing the key again.
+ *
+ * When the SDK is compiled for a CPU with SHA instructions, that is with `-msha -msse4.1` (or an
+ * `-march` which includes them) on x86, or `-march=armv8-a+crypto` on AArch64, these instructions
+ * are used. Otherwise, a portable C implementation is used. Either way, none of the APIs allocate
+ * any memory.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_SHA256_H
+#define _az_SHA256_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/// The size, in bytes, of a SHA-256 digest and of an HMAC-SHA256 message authentication code.
+#define AZ_SHA256_DIGEST_SIZE 32
+
+enum
+{
+  // SHA-256 processes data in blocks of 64 bytes.
+  _az_SHA256_BLOCK_SIZE = 64,
+};
+
+/**
+ * @brief The state of a SHA-256 digest being computed.
+ */
+typedef struct
+{
+  struct
+  {
+    uint32_t state[8];
+    uint64_t total_size;
+    uint8_t block[_az_SHA256_BLOCK_SIZE];
+    int32_t block_size;
+  } _internal;
+} az_sha256_context;
+
+/**
+ * @brief Starts computing a SHA-256 digest.
+ *
+ * @param[out] context The #az_sha256_context to initialize.
+ * @pre \p context must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ */
+AZ_NODISCARD az_result az_sha256_init(az_sha256_context* context);
+
+/**
+ * @brief Adds data to a SHA-256 digest being computed.
+ *
+ * @param[in,out] context The #az_sha256_context to use for this call.
+ * @param[in] data The data to add, which can be empty.
+ * @pre \p context must not be `NULL`.
+ * @pre \p data must be a valid span.
+ * @return An #az_result value indicating the result of the operation.
+ */
+AZ_NODISCARD az_result az_sha256_update(az_sha256_context* context, az_span data);
+
+/**
+ * @brief Finishes computing a SHA-256 digest.
+ *
+ * @param[in,out] context The #az_sha256_context to use for this call. It needs to be initialized
+ * again to compute another digest.
+ * @param[in] destination The #az_span to write the digest to.
+ * @param[out] out_digest The #AZ_SHA256_DIGEST_SIZE bytes of the digest, at the start of
+ * \p destination.
+ * @pre \p context must not be `NULL`.
+ * @pre \p destination must be a valid span.
+ * @pre \p out_digest must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The digest was written.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is smaller than #AZ_SHA256_DIGEST_SIZE.
+ */
+AZ_NODISCARD az_result
+az_sha256_finalize(az_sha256_context* context, az_span destination, az_span* out_digest);
+
+/**
+ * @brief Computes the SHA-256 digest of data.
+ *
+ * @param[in] data The data to hash, which can be empty.
+ * @param[in] destination The #az_span to write the digest to.
+ * @param[out] out_digest The #AZ_SHA256_DIGEST_SIZE bytes of the digest, at the start of
+ * \p destination.
+ * @pre \p data must be a valid span.
+ * @pre \p destination must be a valid span.
+ * @pre \p out_digest must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The digest was written.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is smaller than #AZ_SHA256_DIGEST_SIZE.
+ */
+AZ_NODISCARD az_result az_sha256(az_span data, az_span destination, az_span* out_digest);
+
+/**
+ * @brief An HMAC-SHA256 key, processed so that it can be used for any number of messages.
+ *
+ * @details It holds the SHA-256 states after hashing the key combined with the inner and outer
+ * padding of HMAC, which is what every message starts from. Like the key itself, it should be
+ * kept secret.
+ */
+typedef struct
+{
+  struct
+  {
+    az_sha256_context inner;
+    az_sha256_context outer;
+  } _internal;
+} az_hmac_sha256_key;
+
+/**
+ * @brief Processes a key for HMAC-SHA256.
+ *
+ * @param[out] key The #az_hmac_sha256_key to initialize.
+ * @param[in] key_bytes The bytes of the key, such as a decoded SAS key. Keys longer than 64 bytes
+ * are first hashed, as HMAC requires.
+ * @pre \p key must not be `NULL`.
+ * @pre \p key_bytes must be a valid span.
+ * @return An #az_result value indicating the result of the operation.
+ */
+AZ_NODISCARD az_result az_hmac_sha256_key_init(az_hmac_sha256_key* key, az_span key_bytes);
+
+/**
+ * @brief The state of an HMAC-SHA256 message authentication code being computed.
+ */
+typedef struct
+{
+  struct
+  {
+    az_sha256_context inner;
+    az_hmac_sha256_key const* key;
+  } _internal;
+} az_hmac_sha256_context;
+
+/**
+ * @brief Starts computing an HMAC-SHA256 message authentication code.
+ *
+ * @param[out] context The #az_hmac_sha256_context to initialize.
+ * @param[in] key The #az_hmac_sha256_key to use. It must remain valid until
+ * az_hmac_sha256_finalize() is called.
+ * @pre \p context must not be `NULL`.
+ * @pre \p key must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ */
+AZ_NODISCARD az_result
+az_hmac_sha256_init(az_hmac_sha256_context* context, az_hmac_sha256_key const* key);
+
+/**
+ * @brief Adds data to an HMAC-SHA256 message authentication code being computed.
+ *
+ * @param[in,out] context The #az_hmac_sha256_context to use for this call.
+ * @param[in] data The data to add, which can be empty.
+ * @pre \p context must not be `NULL`.
+ * @pre \p data must be a valid span.
+ * @return An #az_result value indicating the result of the operation.
+ */
+AZ_NODISCARD az_result az_hmac_sha256_update(az_hmac_sha256_context* context, az_span data);
+
+/**
+ * @brief Finishes computing an HMAC-SHA256 message authentication code.
+ *
+ * @param[in,out] context The #az_hmac_sha256_context to use for this call. It needs to be
+ * initialized again to compute another code.
+ * @param[in] destination The #az_span to write the code to.
+ * @param[out] out_mac The #AZ_SHA256_DIGEST_SIZE bytes of the code, at the start of
+ * \p destination.
+ * @pre \p context must not be `NULL`.
+ * @pre \p destination must be a valid span.
+ * @pre \p out_mac must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The code was written.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is smaller than #AZ_SHA256_DIGEST_SIZE.
+ */
+AZ_NODISCARD az_result
+az_hmac_sha256_finalize(az_hmac_sha256_context* context, az_span destination, az_span* out_mac);
+
+/**
+ * @brief Computes the HMAC-SHA256 message authentication code of data, such as the signature of a
+ * SAS token.
+ *
+ * @param[in] key The #az_hmac_sha256_key to use.
+ * @param[in] data The data to authenticate, which can be empty.
+ * @param[in] destination The #az_span to write the code to.
+ * @param[out] out_mac The #AZ_SHA256_DIGEST_SIZE bytes of the code, at the start of
+ * \p destination.
+ * @pre \p key must not be `NULL`.
+ * @pre \p data must be a valid span.
+ * @pre \p destination must be a valid span.
+ * @pre \p out_mac must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The code was written.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is smaller than #AZ_SHA256_DIGEST_SIZE.
+ */
+AZ_NODISCARD az_result az_hmac_sha256(
+    az_hmac_sha256_key const* key,
+    az_span data,
+    az_span destination,
+    az_span* out_mac);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_SHA256_H
@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Defines internals used by json.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_JSON_INTERNAL_H
+#define _az_JSON_INTERNAL_H
+
+#include <azure/core/az_json.h>
+#include <azure/core/az_result.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+// The type of the values appended by the JSON writer from their binary representation.
+typedef enum
+{
+  _az_JSON_ARRAY_ELEMENT_INT32 = 1,
+  _az_JSON_ARRAY_ELEMENT_INT64 = 2,
+  _az_JSON_ARRAY_ELEMENT_DOUBLE = 3,
+  _az_JSON_ARRAY_ELEMENT_BOOL = 4,
+} _az_json_array_element_kind;
+
+// Appends a JSON array of count values of the given kind, stride bytes apart from each other, such
+// as the same field of consecutive structures. The values don't need to be aligned for their type.
+// Doubles with an integer part larger than 2^53 - 1 are written in exponent form.
+AZ_NODISCARD az_result _az_json_writer_append_array(
+    az_json_writer* ref_json_writer,
+    _az_json_array_element_kind element_kind,
+    void const* values,
+    int32_t count,
+    size_t stride,
+    int32_t fractional_digits);
+
+// Appends a single value of the given kind, the same way as the elements of
+// _az_json_writer_append_array().
+AZ_NODISCARD az_result _az_json_writer_append_value(
+    az_json_writer* ref_json_writer,
+    _az_json_array_element_kind element_kind,
+    void const* value,
+    int32_t fractional_digits);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_JSON_INTERNAL_H
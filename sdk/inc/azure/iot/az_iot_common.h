@@ -16,6 +16,7 @@
 #define _az_IOT_CORE_H
 
 #include <azure/core/az_log.h>
+#include <azure/core/az_lz4.h>
 #include <azure/core/az_result.h>
 #include <azure/core/az_span.h>
 
@@ -148,6 +149,22 @@ typedef enum
 /// #AZ_SPAN_FROM_STR macro as a parameter, where needed.
 #define AZ_IOT_MESSAGE_COMPONENT_NAME "%24.sub"
 
+/**
+ * @brief An entry of the index of an #az_iot_message_properties.
+ *
+ * @details See az_iot_message_properties_build_index().
+ */
+typedef struct
+{
+  struct
+  {
+    uint32_t name_hash;
+    int32_t name_offset;
+    int32_t name_size;
+    int32_t value_size;
+  } _internal;
+} az_iot_message_properties_index_entry;
+
 /**
  * @brief Telemetry or C2D properties.
  *
@@ -159,6 +176,8 @@ typedef struct
     az_span properties_buffer;
     int32_t properties_written;
     uint32_t current_property_index;
+    az_iot_message_properties_index_entry* index;
+    uint32_t index_mask;
   } _internal;
 } az_iot_message_properties;
 
@@ -243,6 +262,293 @@ AZ_NODISCARD az_result az_iot_message_properties_next(
     az_span* out_name,
     az_span* out_value);
 
+/**
+ * @brief Parses the properties once into an index, so that az_iot_message_properties_find() takes
+ * constant time rather than going through all of the properties.
+ *
+ * @details This is worth it when looking up several properties of a message, such as the
+ * properties of a received C2D message. Appending a property with
+ * az_iot_message_properties_append() drops the index, after which it can be built again.
+ *
+ * @param[in,out] properties The #az_iot_message_properties to use for this call.
+ * @param[in] index The array to use as the index. It needs no initialization and must remain valid
+ * for as long as \p properties is used.
+ * @param[in] index_size The number of elements of \p index. It must be a power of two greater
+ * than the number of properties. Twice the number of properties, or more, keeps lookups fast.
+ * @pre \p properties must not be `NULL`.
+ * @pre \p index must not be `NULL`.
+ * @pre \p index_size must be a power of two greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The index was built.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE There are too many properties for \p index_size, in which
+ * case lookups keep going through all of the properties.
+ */
+AZ_NODISCARD az_result az_iot_message_properties_build_index(
+    az_iot_message_properties* properties,
+    az_iot_message_properties_index_entry* index,
+    int32_t index_size);
+
+/**
+ * @brief Decodes a percent-encoded property name or value, such as one returned by
+ * az_iot_message_properties_find() or az_iot_message_properties_next().
+ *
+ * @param[in] encoded The percent-encoded #az_span to decode.
+ * @param[in] destination The #az_span to write the decoded bytes to. It can be \p encoded itself
+ * to decode in place, since decoding never makes the data any larger.
+ * @param[out] out_decoded The decoded bytes, at the start of \p destination.
+ * @pre \p encoded must be a valid span.
+ * @pre \p destination must be a valid span.
+ * @pre \p out_decoded must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The value was decoded.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is too small for the decoded bytes.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR A `%` isn't followed by two hexadecimal digits.
+ * @retval #AZ_ERROR_UNEXPECTED_END \p encoded ends in the middle of a `%` escape.
+ */
+AZ_NODISCARD az_result
+az_iot_message_properties_url_decode(az_span encoded, az_span destination, az_span* out_decoded);
+
+/// The value of the #AZ_IOT_MESSAGE_PROPERTIES_CONTENT_ENCODING property for a payload which is
+/// an LZ4 block, as written by az_iot_message_payload_compress().
+/// @note It can be used with IoT message property APIs by wrapping the macro in a
+/// #AZ_SPAN_FROM_STR macro as a parameter, where needed.
+#define AZ_IOT_MESSAGE_CONTENT_ENCODING_LZ4 "lz4"
+
+/**
+ * @brief Compresses a Telemetry payload and marks it as such in its properties.
+ *
+ * @details The payload is compressed into \p destination as an LZ4 block (see az_lz4_compress())
+ * and the #AZ_IOT_MESSAGE_PROPERTIES_CONTENT_ENCODING property is set to
+ * #AZ_IOT_MESSAGE_CONTENT_ENCODING_LZ4, so that the service side can recognize it.
+ *
+ * If compressing doesn't make the payload any smaller, or the result doesn't fit in
+ * \p destination, the original payload is returned instead and no property is added, since it can
+ * always be sent as is. A \p destination the same size as \p payload is therefore enough.
+ *
+ * @param[in,out] workspace The #az_lz4_compress_workspace to use as scratch memory.
+ * @param[in] properties The #az_iot_message_properties to add the content encoding to.
+ * @param[in] payload The payload to compress.
+ * @param[out] destination The #az_span to write the compressed payload to.
+ * @param[out] out_payload The payload to send, which is either a slice of \p destination or
+ * \p payload itself.
+ * @pre \p workspace must not be `NULL`.
+ * @pre \p properties must not be `NULL`.
+ * @pre \p payload must be a valid span of size greater than 0.
+ * @pre \p destination must be a valid span of size greater than 0.
+ * @pre \p out_payload must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The operation was performed successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE There was not enough space to append the property.
+ */
+AZ_NODISCARD az_result az_iot_message_payload_compress(
+    az_lz4_compress_workspace* workspace,
+    az_iot_message_properties* properties,
+    az_span payload,
+    az_span destination,
+    az_span* out_payload);
+
+/**
+ * @brief Decompresses a received C2D payload, if its properties mark it as compressed.
+ *
+ * @details If the #AZ_IOT_MESSAGE_PROPERTIES_CONTENT_ENCODING property is
+ * #AZ_IOT_MESSAGE_CONTENT_ENCODING_LZ4, the payload is decompressed into \p destination.
+ * Otherwise, the payload is returned as is.
+ *
+ * @param[in] properties The #az_iot_message_properties of the received message.
+ * @param[in] payload The received payload.
+ * @param[out] destination The #az_span to write the decompressed payload to.
+ * @param[out] out_payload The decompressed payload, which is either a slice of \p destination or
+ * \p payload itself.
+ * @pre \p properties must not be `NULL`.
+ * @pre \p payload must be a valid span of size greater than or equal to 0.
+ * @pre \p destination must be a valid span of size greater than 0.
+ * @pre \p out_payload must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The operation was performed successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The decompressed payload doesn't fit in \p destination.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The compressed payload is invalid.
+ * @retval #AZ_ERROR_UNEXPECTED_END The compressed payload is incomplete.
+ */
+AZ_NODISCARD az_result az_iot_message_payload_decompress(
+    az_iot_message_properties* properties,
+    az_span payload,
+    az_span destination,
+    az_span* out_payload);
+
+/// The size, in bytes, at the start of an #az_iot_message_queue buffer taken by the headers of the
+/// queue.
+#define AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE 64
+
+/// The size, in bytes, of the header of each message of an #az_iot_message_queue. Messages take
+/// this much on top of their topic and payload, rounded up to a multiple of 4.
+#define AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE 20
+
+/**
+ * @brief A queue of Telemetry messages kept until IoT Hub acknowledges them.
+ *
+ * @details The messages are stored back to back in a caller provided buffer, used as a ring, so
+ * that they can be sent again after a reconnection. Nothing but the buffer holds the state of the
+ * queue: a buffer mapped from a file (for instance with `mmap()` on Linux) keeps the messages of a
+ * device which restarts, and az_iot_message_queue_init() finds them again.
+ *
+ * Each message carries its own sequence number and checksum, and the position of the oldest
+ * message is saved in two alternating headers, so that a write interrupted by a crash costs at
+ * most the message being written. If the buffer must also survive a power loss, the application
+ * needs to flush it to storage (for instance with `msync()`) after
+ * az_iot_message_queue_enqueue() and az_iot_message_queue_ack().
+ */
+typedef struct
+{
+  struct
+  {
+    az_span buffer;
+    int32_t data_size;
+    uint32_t generation;
+    int32_t head;
+    int32_t tail;
+    int32_t send_cursor;
+    uint32_t head_sequence;
+    int32_t count;
+    int32_t unsent_count;
+  } _internal;
+} az_iot_message_queue;
+
+/**
+ * @brief A message of an #az_iot_message_queue to send.
+ *
+ * @details The topic and payload refer to the buffer of the queue. They remain valid until the
+ * message is acknowledged.
+ */
+typedef struct
+{
+  az_span topic; /**< The topic to publish the message to. */
+  az_span payload; /**< The payload of the message. */
+
+  struct
+  {
+    int32_t offset;
+  } _internal;
+} az_iot_message_queue_message;
+
+/**
+ * @brief Initializes an #az_iot_message_queue in a buffer.
+ *
+ * @details If \p buffer already holds a queue of the same size, its messages are recovered: the
+ * ones which were acknowledged are dropped and all the others are to be sent again. Otherwise,
+ * \p buffer is cleared and the queue starts empty.
+ *
+ * @param[out] queue The #az_iot_message_queue to initialize.
+ * @param[in] buffer The #az_span to store the messages in, which the queue uses until it is no
+ * longer needed.
+ * @pre \p queue must not be `NULL`.
+ * @pre \p buffer must be a valid span of size greater than or equal to
+ * #AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE plus twice #AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The queue is initialized.
+ */
+AZ_NODISCARD az_result az_iot_message_queue_init(az_iot_message_queue* queue, az_span buffer);
+
+/**
+ * @brief Adds a message at the end of an #az_iot_message_queue.
+ *
+ * @details The message is copied into the buffer of the queue, in constant time. Its properties
+ * are those encoded in \p topic, as written by az_iot_hub_client_telemetry_get_publish_topic().
+ *
+ * @param[in,out] queue The #az_iot_message_queue to add the message to.
+ * @param[in] topic The topic to publish the message to.
+ * @param[in] payload The payload of the message.
+ * @pre \p queue must not be `NULL`.
+ * @pre \p topic must be a valid span of size greater than 0 and less than or equal to
+ * `UINT16_MAX`.
+ * @pre \p payload must be a valid span of size greater than or equal to 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The message is added.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The queue doesn't have room for the message until older
+ * messages are acknowledged.
+ */
+AZ_NODISCARD az_result
+az_iot_message_queue_enqueue(az_iot_message_queue* queue, az_span topic, az_span payload);
+
+/**
+ * @brief Gets the next messages of an #az_iot_message_queue which haven't been sent yet.
+ *
+ * @details The messages are returned in order, without copying them, and are considered sent from
+ * then on. Once a message is published, its MQTT packet ID must be given to
+ * az_iot_message_queue_set_packet_id() so that the acknowledgement of the packet finds it.
+ *
+ * @param[in,out] queue The #az_iot_message_queue to get the messages of.
+ * @param[out] messages The array of #az_iot_message_queue_message to fill in.
+ * @param[in] messages_length The number of elements of \p messages.
+ * @param[out] out_count The number of messages returned, which is 0 once all are sent.
+ * @pre \p queue must not be `NULL`.
+ * @pre \p messages must not be `NULL`.
+ * @pre \p messages_length must be greater than 0.
+ * @pre \p out_count must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The messages are returned.
+ */
+AZ_NODISCARD az_result az_iot_message_queue_get_unsent(
+    az_iot_message_queue* queue,
+    az_iot_message_queue_message* messages,
+    int32_t messages_length,
+    int32_t* out_count);
+
+/**
+ * @brief Sets the MQTT packet ID a message of an #az_iot_message_queue was published with.
+ *
+ * @param[in,out] queue The #az_iot_message_queue the message belongs to.
+ * @param[in] message The #az_iot_message_queue_message returned by
+ * az_iot_message_queue_get_unsent().
+ * @param[in] packet_id The MQTT packet ID of the message.
+ * @pre \p queue must not be `NULL`.
+ * @pre \p message must not be `NULL`.
+ * @pre \p packet_id must be greater than 0.
+ */
+void az_iot_message_queue_set_packet_id(
+    az_iot_message_queue* queue,
+    az_iot_message_queue_message const* message,
+    uint16_t packet_id);
+
+/**
+ * @brief Releases the message of an #az_iot_message_queue published with an MQTT packet ID, once
+ * IoT Hub acknowledged the packet.
+ *
+ * @details Acknowledgements usually arrive in order, in which case the message is found and
+ * released in constant time. A message acknowledged out of order is released along with the older
+ * messages once they are acknowledged too.
+ *
+ * @param[in,out] queue The #az_iot_message_queue the message belongs to.
+ * @param[in] packet_id The MQTT packet ID of the acknowledgement.
+ * @pre \p queue must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The message is released.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No message sent and not yet acknowledged has this packet ID.
+ */
+AZ_NODISCARD az_result az_iot_message_queue_ack(az_iot_message_queue* queue, uint16_t packet_id);
+
+/**
+ * @brief Marks the messages of an #az_iot_message_queue which were sent but not acknowledged as
+ * unsent, so that they are sent again.
+ *
+ * @details This should be called after reconnecting to IoT Hub, before
+ * az_iot_message_queue_get_unsent().
+ *
+ * @param[in,out] queue The #az_iot_message_queue to rewind.
+ * @pre \p queue must not be `NULL`.
+ */
+void az_iot_message_queue_rewind(az_iot_message_queue* queue);
+
+/**
+ * @brief Gets the number of messages held by an #az_iot_message_queue.
+ *
+ * @param[in] queue The #az_iot_message_queue to get the number of messages of.
+ * @return The number of messages which aren't released yet.
+ */
+AZ_NODISCARD AZ_INLINE int32_t az_iot_message_queue_get_count(az_iot_message_queue const* queue)
+{
+  return queue->_internal.count;
+}
+
 /**
  * @brief Checks if the status indicates a successful operation.
  *
@@ -290,6 +596,131 @@ AZ_NODISCARD int32_t az_iot_calculate_retry_delay(
     int32_t max_retry_delay_msec,
     int32_t random_jitter_msec);
 
+/**
+ * @brief How an #az_iot_retry_policy randomizes its delays.
+ *
+ * @details These are the strategies compared in
+ * https://aws.amazon.com/blogs/architecture/exponential-backoff-and-jitter/. With any of them, a
+ * fleet of devices which lost their connection at the same time spreads its reconnections out.
+ */
+typedef enum
+{
+  /// A random delay between 0 and the exponential backoff.
+  AZ_IOT_RETRY_JITTER_FULL = 0,
+
+  /// Half the exponential backoff, plus a random delay up to the other half.
+  AZ_IOT_RETRY_JITTER_EQUAL = 1,
+
+  /// A random delay between the minimum delay and three times the previous delay, which grows
+  /// about as fast as the exponential backoff but keeps the devices apart from one retry to the
+  /// next.
+  AZ_IOT_RETRY_JITTER_DECORRELATED = 2,
+} az_iot_retry_jitter;
+
+/**
+ * @brief The options of an #az_iot_retry_policy.
+ */
+typedef struct
+{
+  /// The #az_iot_retry_jitter strategy.
+  az_iot_retry_jitter jitter;
+
+  /// The delay before the first retry, in milliseconds, which doubles with each failed attempt.
+  int32_t min_retry_delay_msec;
+
+  /// The longest delay, in milliseconds, unless the service asks for a longer one.
+  int32_t max_retry_delay_msec;
+
+  /// The seed of the random delays, or 0 to derive it from the device ID, which already differs
+  /// from one device to the next.
+  uint32_t seed;
+} az_iot_retry_policy_options;
+
+/**
+ * @brief Keeps track of the attempts of an operation, such as connecting to IoT Hub or registering
+ * with the Device Provisioning Service, and picks the delay before the next attempt.
+ *
+ * @details Unlike az_iot_calculate_retry_delay(), the policy draws the jitter itself, from a random
+ * generator seeded per device, and remembers the previous delay.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_retry_policy_options options;
+    uint32_t random_state;
+    int32_t attempt;
+    int32_t previous_delay_msec;
+  } _internal;
+} az_iot_retry_policy;
+
+/**
+ * @brief Gets the default #az_iot_retry_policy_options.
+ * @details Call this to obtain an initialized #az_iot_retry_policy_options structure that can be
+ * afterwards modified and passed to az_iot_retry_policy_init(). Delays are decorrelated, from 1
+ * second up to 100 seconds.
+ *
+ * @return #az_iot_retry_policy_options.
+ */
+AZ_NODISCARD az_iot_retry_policy_options az_iot_retry_policy_options_default();
+
+/**
+ * @brief Initializes an #az_iot_retry_policy.
+ *
+ * @param[out] policy The #az_iot_retry_policy to initialize.
+ * @param[in] device_id The ID of the device, to seed the random delays with when the seed of
+ * \p options is 0.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_retry_policy_options structure. If
+ * `NULL` is passed, the policy will use the default options.
+ * @pre \p policy must not be `NULL`.
+ * @pre \p device_id must be a valid span of size greater than or equal to 0.
+ * @pre The minimum delay of \p options must be greater than 0, and no greater than the maximum
+ * delay.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The policy was initialized.
+ */
+AZ_NODISCARD az_result az_iot_retry_policy_init(
+    az_iot_retry_policy* policy,
+    az_span device_id,
+    az_iot_retry_policy_options const* options);
+
+/**
+ * @brief Records a failed attempt and gets the delay before the next one.
+ *
+ * @details When the service tells how long to wait, as the `retry-after` of a Device Provisioning
+ * Service response does, the delay is at least that long, plus a random delay up to the minimum
+ * delay: devices told to come back at the same time would otherwise all do so.
+ *
+ * @param[in,out] policy The #az_iot_retry_policy to use for this call.
+ * @param[in] retry_after_msec The delay asked for by the service, in milliseconds, or 0.
+ * @pre \p policy must not be `NULL`.
+ * @pre \p retry_after_msec must be between 0 and INT32_MAX - 1.
+ * @return The delay in milliseconds.
+ */
+AZ_NODISCARD int32_t
+az_iot_retry_policy_get_next_delay(az_iot_retry_policy* policy, int32_t retry_after_msec);
+
+/**
+ * @brief Resets an #az_iot_retry_policy after a successful attempt, so that the next failure is
+ * retried after the minimum delay again.
+ *
+ * @param[in,out] policy The #az_iot_retry_policy to reset.
+ * @pre \p policy must not be `NULL`.
+ */
+void az_iot_retry_policy_reset(az_iot_retry_policy* policy);
+
+/**
+ * @brief Gets the number of failed attempts since an #az_iot_retry_policy was initialized or
+ * reset.
+ *
+ * @param[in] policy The #az_iot_retry_policy to get the number of attempts of.
+ * @return The number of failed attempts.
+ */
+AZ_NODISCARD AZ_INLINE int32_t az_iot_retry_policy_get_attempt(az_iot_retry_policy const* policy)
+{
+  return policy->_internal.attempt;
+}
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_IOT_CORE_H
@@ -17,7 +17,9 @@
 #ifndef _az_IOT_HUB_CLIENT_H
 #define _az_IOT_HUB_CLIENT_H
 
+#include <azure/core/az_context.h>
 #include <azure/core/az_result.h>
+#include <azure/core/az_sha256.h>
 #include <azure/core/az_span.h>
 #include <azure/iot/az_iot_common.h>
 
@@ -81,6 +83,9 @@ typedef struct
     az_span iot_hub_hostname;
     az_span device_id;
     az_iot_hub_client_options options;
+    az_span telemetry_topic_prefix;
+    int32_t* component_name_index;
+    uint32_t component_name_index_mask;
   } _internal;
 } az_iot_hub_client;
 
@@ -117,6 +122,29 @@ AZ_NODISCARD az_result az_iot_hub_client_init(
     az_span device_id,
     az_iot_hub_client_options const* options);
 
+/**
+ * @brief Pre-renders the parts of the MQTT topics which are fixed for this client, so that getting
+ * a topic only needs to copy them.
+ *
+ * @details Call this right after az_iot_hub_client_init(). The Telemetry topic then becomes a
+ * single copy of the cached prefix followed by the properties, and the prefix can also be sent on
+ * its own with az_iot_hub_client_telemetry_get_publish_topic_prefix(). The topics of the other
+ * features don't depend on the client, so they have nothing to cache.
+ *
+ * @param[in,out] client The #az_iot_hub_client to use for this call.
+ * @param[in] topic_prefix_buffer The buffer to render the topic prefixes into. It must outlive the
+ * client and be large enough for the Telemetry topic without properties, that is
+ * `devices/{device_id}/modules/{module_id}/messages/events/`.
+ * @pre \p client must not be `NULL`.
+ * @pre \p topic_prefix_buffer must be a valid span of size greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The topic prefixes were cached successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The \p topic_prefix_buffer is not large enough, in which case
+ * the client keeps rendering topics in full.
+ */
+AZ_NODISCARD az_result
+az_iot_hub_client_cache_topic_prefixes(az_iot_hub_client* client, az_span topic_prefix_buffer);
+
 /**
  * @brief The HTTP URI Path necessary when connecting to IoT Hub using WebSockets.
  */
@@ -293,6 +321,173 @@ AZ_NODISCARD az_result az_iot_hub_client_sas_get_password(
     size_t mqtt_password_size,
     size_t* out_mqtt_password_length);
 
+/**
+ * @brief The options of an #az_iot_sas_token_manager.
+ */
+typedef struct
+{
+  /**
+   * The Shared Access Key Name (Policy Name), or #AZ_SPAN_EMPTY to use the device key. This is
+   * optional. For security reasons we recommend using one key per device instead of using a global
+   * policy key.
+   */
+  az_span key_name;
+
+  /**
+   * How long, in seconds, each token is valid for.
+   */
+  uint32_t token_duration_seconds;
+
+  /**
+   * How long, in seconds, before a token expires it should be renewed, leaving time to reconnect.
+   */
+  uint32_t renewal_margin_seconds;
+
+  /**
+   * Up to how many more seconds, picked at random for each token, to renew it even earlier. This
+   * keeps a fleet of devices which connected at the same time from also renewing at the same time.
+   */
+  uint32_t renewal_jitter_seconds;
+
+  /**
+   * The seed of the random renewal jitter, or 0 to derive it from the device and module IDs, which
+   * already differs from one device to the next.
+   */
+  uint32_t jitter_seed;
+} az_iot_sas_token_manager_options;
+
+/**
+ * @brief Keeps the MQTT password of an #az_iot_hub_client which authenticates with SAS tokens,
+ * signs it and tells when to renew it.
+ *
+ * @details The manager signs the tokens itself, with a key that is processed once at
+ * initialization, and writes the password into a caller provided buffer. When renewing, only the
+ * signature and expiration time at the end of the password are written again.
+ *
+ * Like the other IoT APIs, the manager doesn't read any clock itself. Times are passed in: the
+ * current time since 1/1/1970 in seconds, to set the expiration time of tokens, and the current
+ * value of a monotonic clock in milliseconds, such as the one of az_platform_clock_msec(), to
+ * schedule renewals.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client const* client;
+    az_iot_sas_token_manager_options options;
+    az_hmac_sha256_key key;
+    az_span password_buffer;
+    int32_t password_length;
+    int32_t scope_offset;
+    int32_t scope_length;
+    int32_t signature_offset;
+    uint64_t expiration_epoch_time;
+    int64_t renewal_deadline_msec;
+    uint32_t jitter_state;
+  } _internal;
+} az_iot_sas_token_manager;
+
+/**
+ * @brief Gets the default #az_iot_sas_token_manager_options.
+ * @details Call this to obtain an initialized #az_iot_sas_token_manager_options structure that can
+ * be afterwards modified and passed to az_iot_sas_token_manager_init(). Tokens are valid for an
+ * hour and renewed between 10 and 15 minutes before they expire.
+ *
+ * @return #az_iot_sas_token_manager_options.
+ */
+AZ_NODISCARD az_iot_sas_token_manager_options az_iot_sas_token_manager_options_default();
+
+/**
+ * @brief Initializes an #az_iot_sas_token_manager.
+ *
+ * @param[out] manager The #az_iot_sas_token_manager to initialize.
+ * @param[in] client The #az_iot_hub_client to manage the password of. It must remain valid for as
+ * long as the manager is used.
+ * @param[in] base64_encoded_key The Base64 encoded Shared Access Key, as found in the connection
+ * string of the device. It is not kept by the manager.
+ * @param[in] password_buffer The buffer to keep the MQTT password in. It must remain valid for as
+ * long as the manager is used.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_sas_token_manager_options
+ * structure. If `NULL` is passed, the manager will use the default options.
+ * @pre \p manager must not be `NULL`.
+ * @pre \p client must not be `NULL`.
+ * @pre \p base64_encoded_key must be a valid span whose size is a non-zero multiple of 4.
+ * @pre \p password_buffer must be a valid span of size greater than 0.
+ * @pre The renewal margin and jitter of \p options must add up to less than the token duration.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The manager was initialized.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR \p base64_encoded_key is not valid Base64.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p base64_encoded_key is longer than 128 bytes once decoded.
+ */
+AZ_NODISCARD az_result az_iot_sas_token_manager_init(
+    az_iot_sas_token_manager* manager,
+    az_iot_hub_client const* client,
+    az_span base64_encoded_key,
+    az_span password_buffer,
+    az_iot_sas_token_manager_options const* options);
+
+/**
+ * @brief Signs a new token and updates the MQTT password with it.
+ *
+ * @param[in,out] manager The #az_iot_sas_token_manager to use for this call.
+ * @param[in] current_epoch_time The current time, in seconds, from 1/1/1970.
+ * @param[in] current_clock_msec The current value of the monotonic clock, in milliseconds.
+ * @pre \p manager must not be `NULL`.
+ * @pre \p current_epoch_time must be greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The password was updated.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The password buffer is too small, in which case the manager
+ * has no password until the next successful call.
+ */
+AZ_NODISCARD az_result az_iot_sas_token_manager_generate(
+    az_iot_sas_token_manager* manager,
+    uint64_t current_epoch_time,
+    int64_t current_clock_msec);
+
+/**
+ * @brief Tells whether the token should be renewed, because its renewal deadline has passed or
+ * there is no token yet.
+ *
+ * @param[in] manager The #az_iot_sas_token_manager to use for this call.
+ * @param[in] current_clock_msec The current value of the monotonic clock, in milliseconds.
+ * @pre \p manager must not be `NULL`.
+ * @return `true` if az_iot_sas_token_manager_generate() should be called, `false` otherwise.
+ */
+AZ_NODISCARD bool az_iot_sas_token_manager_needs_renewal(
+    az_iot_sas_token_manager const* manager,
+    int64_t current_clock_msec);
+
+/**
+ * @brief Gets the value of the monotonic clock, in milliseconds, when the token should be renewed.
+ *
+ * @param[in] manager The #az_iot_sas_token_manager to use for this call.
+ * @param[out] out_renewal_deadline_msec The renewal deadline, including its random jitter.
+ * @pre \p manager must not be `NULL`.
+ * @pre \p out_renewal_deadline_msec must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The deadline was returned.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND There is no token yet.
+ */
+AZ_NODISCARD az_result az_iot_sas_token_manager_get_renewal_deadline(
+    az_iot_sas_token_manager const* manager,
+    int64_t* out_renewal_deadline_msec);
+
+/**
+ * @brief Gets the current MQTT password.
+ *
+ * @param[in] manager The #az_iot_sas_token_manager to use for this call.
+ * @param[out] out_password The password, within the password buffer. It is followed by a
+ * null-terminator, so `az_span_ptr(*out_password)` can also be used as a string.
+ * @pre \p manager must not be `NULL`.
+ * @pre \p out_password must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The password was returned.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND There is no token yet.
+ */
+AZ_NODISCARD az_result az_iot_sas_token_manager_get_password(
+    az_iot_sas_token_manager const* manager,
+    az_span* out_password);
+
 /*
  *
  * Telemetry APIs
@@ -323,6 +518,353 @@ AZ_NODISCARD az_result az_iot_hub_client_telemetry_get_publish_topic(
     size_t mqtt_topic_size,
     size_t* out_mqtt_topic_length);
 
+/**
+ * @brief Gets the part of the MQTT topic to publish telemetry to that comes before the properties.
+ *
+ * @details This lets MQTT clients which support scatter-gather writes send the topic as this
+ * prefix followed by the properties, without assembling them in a buffer first. The prefix is
+ * pre-rendered by az_iot_hub_client_cache_topic_prefixes(), which must have been called first.
+ *
+ * @param[in] client The #az_iot_hub_client to use for this call.
+ * @param[out] out_topic_prefix The topic prefix, in the form
+ * `devices/{device_id}/modules/{module_id}/messages/events/`, without a null terminator.
+ * @pre \p client must not be `NULL`.
+ * @pre \p out_topic_prefix must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The topic prefix was retrieved successfully.
+ * @retval #AZ_ERROR_NOT_SUPPORTED The topic prefixes of the client aren't cached.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_get_publish_topic_prefix(
+    az_iot_hub_client const* client,
+    az_span* out_topic_prefix);
+
+/**
+ * @brief The name of the message property marking a telemetry message as a batch of records.
+ * @details Its value is the layout of the batch, either `columnar` or `rows`.
+ */
+#define AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_PROPERTY_NAME "batch"
+
+/**
+ * @brief The maximum size of a device to cloud message accepted by IoT Hub, in bytes.
+ */
+#define AZ_IOT_HUB_CLIENT_TELEMETRY_MAX_MESSAGE_SIZE 262144
+
+/**
+ * @brief The layout of the JSON payload of a telemetry batch.
+ */
+typedef enum
+{
+  /// One array of values per field, i.e. `{"ts":[1,2],"temp":[20.5,21]}`.
+  AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_COLUMNAR = 0,
+
+  /// The field names, followed by one array of values per record, i.e.
+  /// `{"columns":["ts","temp"],"rows":[[1,20.5],[2,21]]}`.
+  AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_ROWS = 1,
+} az_iot_hub_client_telemetry_batch_layout;
+
+/**
+ * @brief The type of a field within the records of a telemetry batch.
+ */
+typedef enum
+{
+  AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_INT32 = 1, ///< An `int32_t` field.
+  AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_INT64 = 2, ///< An `int64_t` field.
+  AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_DOUBLE = 3, ///< A `double` field.
+  AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_BOOL = 4, ///< A `bool` field.
+} az_iot_hub_client_telemetry_batch_field_kind;
+
+/**
+ * @brief Describes a field of the user-defined record structure of a telemetry batch.
+ */
+typedef struct
+{
+  /// The JSON property name of the field.
+  az_span name;
+
+  /// The offset of the field within the record structure, as given by `offsetof`.
+  size_t offset;
+
+  /// The type of the field.
+  az_iot_hub_client_telemetry_batch_field_kind kind;
+
+  /// For #AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_DOUBLE, the number of digits to write after the
+  /// decimal point, between 0 and 15.
+  int32_t fractional_digits;
+} az_iot_hub_client_telemetry_batch_field;
+
+/**
+ * @brief Allows the user to define custom behavior when encoding a telemetry batch.
+ */
+typedef struct
+{
+  /// The maximum size of a payload, in bytes. Defaults to
+  /// #AZ_IOT_HUB_CLIENT_TELEMETRY_MAX_MESSAGE_SIZE, and should be lowered to leave room for the
+  /// MQTT topic and properties if the MQTT client's packet size limit is close to it.
+  int32_t max_payload_size;
+
+  /// The layout of the JSON payload. Defaults to #AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_COLUMNAR.
+  az_iot_hub_client_telemetry_batch_layout layout;
+} az_iot_hub_client_telemetry_batch_options;
+
+/**
+ * @brief A fixed schema, encoding many records of the same shape into a single telemetry payload.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client_telemetry_batch_field const* fields;
+    int32_t field_count;
+    int32_t record_size;
+    az_iot_hub_client_telemetry_batch_options options;
+  } _internal;
+} az_iot_hub_client_telemetry_batch;
+
+/**
+ * @brief Gets the default telemetry batch options.
+ *
+ * @return #az_iot_hub_client_telemetry_batch_options.
+ */
+AZ_NODISCARD az_iot_hub_client_telemetry_batch_options
+az_iot_hub_client_telemetry_batch_options_default();
+
+/**
+ * @brief Initializes a telemetry batch encoder for records of a fixed schema.
+ *
+ * @param[out] out_batch The #az_iot_hub_client_telemetry_batch to initialize.
+ * @param[in] fields The fields of the record structure, in the order they are written. They must
+ * remain valid for as long as the batch is used.
+ * @param[in] field_count The number of elements within \p fields.
+ * @param[in] record_size The size of the record structure, as given by `sizeof`.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_hub_client_telemetry_batch_options
+ * structure. If `NULL` is passed, the default options are used.
+ * @pre \p out_batch must not be `NULL`.
+ * @pre \p fields must not be `NULL`.
+ * @pre \p field_count must be greater than 0.
+ * @pre Each field must have a name of size greater than 0 and lie within \p record_size.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The batch was initialized successfully.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_init(
+    az_iot_hub_client_telemetry_batch* out_batch,
+    az_iot_hub_client_telemetry_batch_field const* fields,
+    int32_t field_count,
+    size_t record_size,
+    az_iot_hub_client_telemetry_batch_options const* options);
+
+/**
+ * @brief Encodes as many of the given records as fit into a single telemetry payload.
+ *
+ * @param[in] batch The #az_iot_hub_client_telemetry_batch to use for this call.
+ * @param[in] records A pointer to an array of record structures.
+ * @param[in] record_count The number of records within \p records.
+ * @param[in] payload A buffer to write the JSON payload into. It bounds the payload size, along
+ * with the `max_payload_size` option, less 64 bytes used as working space.
+ * @param[out] out_payload The slice of \p payload containing the JSON payload.
+ * @param[out] out_records_written The number of records within \p out_payload, which is less than
+ * \p record_count when the batch had to be closed to stay within the size limit.
+ * @pre \p batch must not be `NULL`.
+ * @pre \p records must not be `NULL`.
+ * @pre \p record_count must be greater than 0.
+ * @pre \p payload must be a valid span of size greater than 0.
+ * @pre \p out_payload must not be `NULL`.
+ * @pre \p out_records_written must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK At least one record was encoded successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE Not even the first record fits within the size limit.
+ * @retval #AZ_ERROR_NOT_SUPPORTED A `double` value is infinite or not a number, which JSON can't
+ * represent.
+ *
+ * @remark Field names are escaped as JSON strings as needed. `double` values with an integer
+ * component larger than `2^53 - 1` are written in exponent form, with 15 significant digits.
+ *
+ * @remark Call this again with the remaining records, after publishing \p out_payload, until all
+ * records are written.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_get_payload(
+    az_iot_hub_client_telemetry_batch const* batch,
+    void const* records,
+    int32_t record_count,
+    az_span payload,
+    az_span* out_payload,
+    int32_t* out_records_written);
+
+/**
+ * @brief Appends the property marking a telemetry message as a batch, along with its layout.
+ *
+ * @param[in] batch The #az_iot_hub_client_telemetry_batch to use for this call.
+ * @param[in,out] properties The #az_iot_message_properties to append the property to, before
+ * passing them to #az_iot_hub_client_telemetry_get_publish_topic().
+ * @pre \p batch must not be `NULL`.
+ * @pre \p properties must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The property was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE There was not enough space to append the property.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_append_property(
+    az_iot_hub_client_telemetry_batch const* batch,
+    az_iot_message_properties* properties);
+
+/**
+ * @brief The tiers of IoT Hub, which set how many telemetry messages it accepts per second.
+ */
+typedef enum
+{
+  AZ_IOT_HUB_TIER_FREE = 0, ///< The free tier, F1.
+  AZ_IOT_HUB_TIER_B1 = 1, ///< The basic tier B1.
+  AZ_IOT_HUB_TIER_B2 = 2, ///< The basic tier B2.
+  AZ_IOT_HUB_TIER_B3 = 3, ///< The basic tier B3.
+  AZ_IOT_HUB_TIER_S1 = 4, ///< The standard tier S1.
+  AZ_IOT_HUB_TIER_S2 = 5, ///< The standard tier S2.
+  AZ_IOT_HUB_TIER_S3 = 6, ///< The standard tier S3.
+} az_iot_hub_tier;
+
+/**
+ * @brief The rate at which an #az_iot_hub_client_telemetry_pacer lets messages be sent.
+ */
+typedef struct
+{
+  /// How many messages can be sent per \p period_msec, on average.
+  int32_t messages;
+
+  /// The period over which \p messages can be sent, in milliseconds.
+  int32_t period_msec;
+
+  /// How many messages can be sent at once, after a pause long enough.
+  int32_t burst;
+
+  /// How long, in milliseconds, to stop sending when IoT Hub throttles the device. The rate is
+  /// also halved, and gets back to the configured one as messages are accepted again.
+  int32_t throttled_pause_msec;
+} az_iot_hub_client_telemetry_pacer_options;
+
+/**
+ * @brief Paces the telemetry messages of a device so that they stay within the rate IoT Hub
+ * accepts, smoothing bursts out instead of getting throttled.
+ *
+ * @details The pacer is a generic cell rate algorithm, which is a token bucket holding a single
+ * time: when the next message is due. Like the other IoT APIs, it doesn't read any clock itself.
+ * The current value of a monotonic clock in milliseconds, such as the one of
+ * az_platform_clock_msec(), is passed in.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client_telemetry_pacer_options options;
+    int64_t configured_interval_usec;
+    int64_t interval_usec;
+    int64_t theoretical_arrival_usec;
+  } _internal;
+} az_iot_hub_client_telemetry_pacer;
+
+/**
+ * @brief Gets the default #az_iot_hub_client_telemetry_pacer_options.
+ * @details The default options let a device send 100 messages per second, the least any paid tier
+ * accepts, in bursts of up to 10 messages, and stop for 5 seconds when throttled.
+ *
+ * @return #az_iot_hub_client_telemetry_pacer_options.
+ */
+AZ_NODISCARD az_iot_hub_client_telemetry_pacer_options
+az_iot_hub_client_telemetry_pacer_options_default();
+
+/**
+ * @brief Gets the #az_iot_hub_client_telemetry_pacer_options sharing the telemetry rate of an IoT
+ * Hub equally between its devices.
+ *
+ * @details The rate of the hub is the one of its \p tier and number of \p units, as documented at
+ * https://docs.microsoft.com/azure/iot-hub/iot-hub-devguide-quotas-throttling. Messages are sent
+ * one at a time, so that the bursts of devices connecting at the same time don't add up.
+ *
+ * @param[in] tier The #az_iot_hub_tier of the hub.
+ * @param[in] units The number of units of the hub.
+ * @param[in] device_count The number of devices sending telemetry to the hub.
+ * @pre \p units must be between 1 and 200, the most units a hub can have.
+ * @pre \p device_count must be greater than 0 and less than or equal to 2000000.
+ * @return #az_iot_hub_client_telemetry_pacer_options.
+ */
+AZ_NODISCARD az_iot_hub_client_telemetry_pacer_options
+az_iot_hub_client_telemetry_pacer_options_for_tier(
+    az_iot_hub_tier tier,
+    int32_t units,
+    int32_t device_count);
+
+/**
+ * @brief Initializes an #az_iot_hub_client_telemetry_pacer, which can send a full burst right away.
+ *
+ * @param[out] pacer The #az_iot_hub_client_telemetry_pacer to initialize.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_hub_client_telemetry_pacer_options
+ * structure. If `NULL` is passed, the pacer will use the default options.
+ * @pre \p pacer must not be `NULL`.
+ * @pre The messages, period and burst of \p options must be greater than 0.
+ * @pre The throttled pause of \p options must be greater than or equal to 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The pacer was initialized.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_pacer_init(
+    az_iot_hub_client_telemetry_pacer* pacer,
+    az_iot_hub_client_telemetry_pacer_options const* options);
+
+/**
+ * @brief Records that a message is sent, if the pacer allows it right now.
+ *
+ * @param[in,out] pacer The #az_iot_hub_client_telemetry_pacer to use for this call.
+ * @param[in] current_clock_msec The current value of the monotonic clock, in milliseconds.
+ * @pre \p pacer must not be `NULL`.
+ * @return `true` if the message can be published, `false` if it must wait for
+ * az_iot_hub_client_telemetry_pacer_get_delay_msec().
+ */
+AZ_NODISCARD bool az_iot_hub_client_telemetry_pacer_try_send(
+    az_iot_hub_client_telemetry_pacer* pacer,
+    int64_t current_clock_msec);
+
+/**
+ * @brief Gets how long to wait before the pacer allows the next message.
+ *
+ * @param[in] pacer The #az_iot_hub_client_telemetry_pacer to use for this call.
+ * @param[in] current_clock_msec The current value of the monotonic clock, in milliseconds.
+ * @pre \p pacer must not be `NULL`.
+ * @return The delay in milliseconds, which is 0 if a message can be sent right now.
+ */
+AZ_NODISCARD int32_t az_iot_hub_client_telemetry_pacer_get_delay_msec(
+    az_iot_hub_client_telemetry_pacer const* pacer,
+    int64_t current_clock_msec);
+
+/**
+ * @brief Gets how many queued records to coalesce into each message, such as with
+ * az_iot_hub_client_telemetry_batch_get_payload(), so that the queue goes out with the messages
+ * the pacer allows right now.
+ *
+ * @param[in] pacer The #az_iot_hub_client_telemetry_pacer to use for this call.
+ * @param[in] current_clock_msec The current value of the monotonic clock, in milliseconds.
+ * @param[in] queued_count The number of records waiting to be sent.
+ * @pre \p pacer must not be `NULL`.
+ * @pre \p queued_count must be greater than or equal to 0.
+ * @return The number of records per message, which is 1 when there are fewer records than
+ * messages allowed, and 0 when no message is allowed or no record is queued.
+ */
+AZ_NODISCARD int32_t az_iot_hub_client_telemetry_pacer_get_batch_size(
+    az_iot_hub_client_telemetry_pacer const* pacer,
+    int64_t current_clock_msec,
+    int32_t queued_count);
+
+/**
+ * @brief Adjusts the pacer to the status of a telemetry message, as reported by IoT Hub.
+ *
+ * @details When the status is #AZ_IOT_STATUS_THROTTLED, the pacer stops sending for the throttled
+ * pause of its options and halves its rate, down to 1/64 of the configured rate. Each status which
+ * succeeded then brings the rate a quarter of the way back to the configured one.
+ *
+ * @param[in,out] pacer The #az_iot_hub_client_telemetry_pacer to use for this call.
+ * @param[in] status The #az_iot_status of the message.
+ * @param[in] current_clock_msec The current value of the monotonic clock, in milliseconds.
+ * @pre \p pacer must not be `NULL`.
+ */
+void az_iot_hub_client_telemetry_pacer_report_status(
+    az_iot_hub_client_telemetry_pacer* pacer,
+    az_iot_status status,
+    int64_t current_clock_msec);
+
 /*
  *
  * Cloud-to-device (C2D) APIs
@@ -545,6 +1087,152 @@ AZ_NODISCARD az_result az_iot_hub_client_commands_response_get_publish_topic(
     size_t mqtt_topic_size,
     size_t* out_mqtt_topic_length);
 
+/**
+ * @brief Handles a command request routed by an #az_iot_hub_client_command_dispatcher.
+ *
+ * @param[in] request The #az_iot_hub_client_command_request to handle.
+ * @param[in] user_context The context passed to the dispatch call, such as the payload of the
+ * request and a buffer for the response.
+ * @return An #az_result value, which is returned by the dispatch call.
+ */
+typedef az_result (*az_iot_hub_client_command_handler)(
+    az_iot_hub_client_command_request const* request,
+    void* user_context);
+
+/**
+ * @brief A command of an #az_iot_hub_client_command_dispatcher and the handler it is routed to.
+ */
+typedef struct
+{
+  /// The name of the component of the command, or #AZ_SPAN_EMPTY for the root component.
+  az_span component_name;
+
+  /// The name of the command.
+  az_span command_name;
+
+  /// The handler of the command.
+  az_iot_hub_client_command_handler handler;
+} az_iot_hub_client_command_dispatcher_entry;
+
+/**
+ * @brief Routes command and method requests to their handlers in constant time.
+ *
+ * @details The dispatcher indexes a table of #az_iot_hub_client_command_dispatcher_entry, usually
+ * `static const`, with a perfect hash built by az_iot_hub_client_command_dispatcher_init(). Finding
+ * the entry of a request then takes one hash of its names and a single comparison, whatever the
+ * number of commands.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client_command_dispatcher_entry const* entries;
+    int32_t entries_length;
+    int32_t* index;
+    uint32_t index_mask;
+  } _internal;
+} az_iot_hub_client_command_dispatcher;
+
+/**
+ * @brief Initializes an #az_iot_hub_client_command_dispatcher, building the perfect hash of its
+ * entries.
+ *
+ * @details The entries are hashed into buckets, and each bucket is given the seed which places its
+ * entries in slots no other entry uses, the largest buckets first. Finding the entries of a bucket
+ * can take a pass over the entries, so this is meant to be done once, at startup.
+ *
+ * @param[out] dispatcher The #az_iot_hub_client_command_dispatcher to initialize.
+ * @param[in] entries The entries to route requests to. They must stay valid and unchanged as long
+ * as \p dispatcher is used.
+ * @param[in] entries_length The number of elements of \p entries.
+ * @param[in] index The array to use as the perfect hash of the entries. It needs no
+ * initialization.
+ * @param[in] index_size The number of elements of \p index. It must be a power of two of at least
+ * twice \p entries_length.
+ * @pre \p dispatcher must not be `NULL`.
+ * @pre \p entries must not be `NULL`.
+ * @pre \p entries_length must be greater than 0.
+ * @pre \p index must not be `NULL`.
+ * @pre \p index_size must be a power of two of at least twice \p entries_length.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The dispatcher was initialized.
+ * @retval #AZ_ERROR_ARG Two entries have the same component and command names.
+ * @retval #AZ_ERROR_NOT_SUPPORTED Two entries have different names with the same 32-bit hash,
+ * which the dispatcher can't tell apart. This is very unlikely with real command names.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE No perfect hash of the entries was found in \p index, because
+ * too many entries share a bucket. A larger index spreads them over more buckets.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_command_dispatcher_init(
+    az_iot_hub_client_command_dispatcher* dispatcher,
+    az_iot_hub_client_command_dispatcher_entry const* entries,
+    int32_t entries_length,
+    int32_t* index,
+    int32_t index_size);
+
+/**
+ * @brief Finds the entry of a command in an #az_iot_hub_client_command_dispatcher.
+ *
+ * @param[in] dispatcher The #az_iot_hub_client_command_dispatcher to use for this call.
+ * @param[in] component_name The name of the component of the command, or #AZ_SPAN_EMPTY for the
+ * root component.
+ * @param[in] command_name The name of the command.
+ * @param[out] out_entry The index of the entry in the entries of \p dispatcher.
+ * @pre \p dispatcher must not be `NULL`.
+ * @pre \p component_name must be a valid span.
+ * @pre \p command_name must be a valid span.
+ * @pre \p out_entry must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The entry was found.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No entry has these names.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_command_dispatcher_find(
+    az_iot_hub_client_command_dispatcher const* dispatcher,
+    az_span component_name,
+    az_span command_name,
+    int32_t* out_entry);
+
+/**
+ * @brief Calls the handler of a command request.
+ *
+ * @param[in] dispatcher The #az_iot_hub_client_command_dispatcher to use for this call.
+ * @param[in] request The #az_iot_hub_client_command_request, from
+ * az_iot_hub_client_commands_parse_received_topic().
+ * @param[in] user_context __[nullable]__ The context to pass to the handler.
+ * @pre \p dispatcher must not be `NULL`.
+ * @pre \p request must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No entry has the names of \p request. The command should be
+ * answered with #AZ_IOT_STATUS_NOT_FOUND.
+ * @retval other The result of the handler.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_command_dispatcher_dispatch(
+    az_iot_hub_client_command_dispatcher const* dispatcher,
+    az_iot_hub_client_command_request const* request,
+    void* user_context);
+
+/**
+ * @brief Calls the handler of a method request, as the command request it is.
+ *
+ * @details The method name is split into component and command names as
+ * az_iot_hub_client_commands_parse_received_topic() splits them, so the entries of the root
+ * component match methods by their names.
+ *
+ * @param[in] dispatcher The #az_iot_hub_client_command_dispatcher to use for this call.
+ * @param[in] request The #az_iot_hub_client_method_request, from
+ * az_iot_hub_client_methods_parse_received_topic().
+ * @param[in] user_context __[nullable]__ The context to pass to the handler.
+ * @pre \p dispatcher must not be `NULL`.
+ * @pre \p request must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No entry has the name of \p request. The method should be
+ * answered with #AZ_IOT_STATUS_NOT_FOUND.
+ * @retval other The result of the handler.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_command_dispatcher_dispatch_method(
+    az_iot_hub_client_command_dispatcher const* dispatcher,
+    az_iot_hub_client_method_request const* request,
+    void* user_context);
+
 /*
  *
  * Twin APIs
@@ -817,6 +1505,354 @@ AZ_NODISCARD az_result az_iot_hub_client_properties_get_reported_publish_topic(
     size_t mqtt_topic_size,
     size_t* out_mqtt_topic_length);
 
+/*
+ *
+ * Received topics APIs
+ *
+ */
+
+/**
+ * @brief The kind of message received on a topic, identifying the member of the
+ * #az_iot_hub_client_received_topic union which holds its parsed information.
+ */
+typedef enum
+{
+  AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_C2D = 1, ///< A Cloud-to-Device message, in `c2d_request`.
+  AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_METHOD = 2, ///< A method request, in `method_request`.
+  AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_COMMAND = 3, ///< A command request, in `command_request`.
+  AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_TWIN = 4, ///< A twin response, in `twin_response`.
+  AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_PROPERTIES
+  = 5, ///< A properties message, in `properties_message`.
+} az_iot_hub_client_received_topic_kind;
+
+/**
+ * @brief The parsed information of a message received on any of the IoT Hub topics.
+ *
+ */
+typedef struct
+{
+  /// The parsed information, of which only the member identified by `kind` is valid.
+  union
+  {
+    az_iot_hub_client_c2d_request c2d_request; ///< For #AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_C2D.
+    az_iot_hub_client_method_request
+        method_request; ///< For #AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_METHOD.
+    az_iot_hub_client_command_request
+        command_request; ///< For #AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_COMMAND.
+    az_iot_hub_client_twin_response
+        twin_response; ///< For #AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_TWIN.
+    az_iot_hub_client_properties_message
+        properties_message; ///< For #AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_PROPERTIES.
+  } parsed;
+
+  az_iot_hub_client_received_topic_kind kind; ///< The kind of message received.
+} az_iot_hub_client_received_topic;
+
+/**
+ * @brief Parses a received message's topic, whichever feature it is meant for.
+ *
+ * @details This is equivalent to trying each of az_iot_hub_client_c2d_parse_received_topic(),
+ * az_iot_hub_client_methods_parse_received_topic() and
+ * az_iot_hub_client_twin_parse_received_topic() in turn, except that the topic is classified
+ * up front by its leading segments, so that only the matching parser runs.
+ *
+ * When the client has a model ID, that is, it is an IoT Plug and Play device, method and twin
+ * topics are parsed as commands and properties instead, as with
+ * az_iot_hub_client_commands_parse_received_topic() and
+ * az_iot_hub_client_properties_parse_received_topic().
+ *
+ * @param[in] client The #az_iot_hub_client to use for this call.
+ * @param[in] received_topic An #az_span containing the received topic.
+ * @param[out] out_topic The kind of message received and its parsed information.
+ *
+ * @pre \p client must not be `NULL`.
+ * @pre \p received_topic must be a valid, non-empty #az_span.
+ * @pre \p out_topic must not be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The topic was parsed and \p out_topic was populated with relevant information.
+ * @retval #AZ_ERROR_IOT_TOPIC_NO_MATCH The topic does not match the format of any feature.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_parse_received_topic_any(
+    az_iot_hub_client const* client,
+    az_span received_topic,
+    az_iot_hub_client_received_topic* out_topic);
+
+/*
+ *
+ * Client table APIs
+ *
+ *   Use the following APIs when a single process, such as a gateway, acts on behalf of a large
+ *   number of device identities which all connect to the same IoT Hub with the same options.
+ */
+
+/**
+ * @brief A table of device identities which share the IoT Hub hostname and client options.
+ *
+ * @details Instead of one #az_iot_hub_client per device, which each hold a copy of the hostname
+ * and options, the table only stores the device and module ID of each entry, in caller provided
+ * arrays, along with a hash index to find an entry from its IDs or from a received topic in
+ * constant time. Use az_iot_hub_client_table_get_client() to get an #az_iot_hub_client for an
+ * entry and then call any of the client APIs with it, such as for topics or SAS tokens.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span iot_hub_hostname;
+    az_iot_hub_client_options options;
+    az_span* device_ids;
+    az_span* module_ids;
+    int32_t* hash_index;
+    uint32_t hash_index_mask;
+    int32_t capacity;
+    int32_t count;
+  } _internal;
+} az_iot_hub_client_table;
+
+/**
+ * @brief Initializes an #az_iot_hub_client_table.
+ *
+ * @param[out] table The #az_iot_hub_client_table to initialize.
+ * @param[in] iot_hub_hostname The IoT Hub hostname shared by all entries.
+ * @param[in] options __[nullable]__ The client options shared by all entries, or `NULL` for the
+ * default options. The `module_id` of the options is ignored, since each entry has its own.
+ * @param[in] device_ids The array in which to store the device ID of each entry.
+ * @param[in] module_ids __[nullable]__ The array in which to store the module ID of each entry,
+ * or `NULL` if none of the entries are modules.
+ * @param[in] capacity The number of elements of \p device_ids and \p module_ids, which is the
+ * maximum number of entries.
+ * @param[in] hash_index The array to use as the hash index of the entries. It needs no
+ * initialization.
+ * @param[in] hash_index_size The number of elements of \p hash_index. It must be a power of two
+ * greater than \p capacity. Twice the capacity, or more, keeps lookups fast.
+ * @pre \p table must not be `NULL`.
+ * @pre \p iot_hub_hostname must be a valid span of size greater than 0.
+ * @pre \p device_ids must not be `NULL`.
+ * @pre \p capacity must be greater than 0.
+ * @pre \p hash_index must not be `NULL`.
+ * @pre \p hash_index_size must be a power of two greater than \p capacity.
+ * @return An #az_result value indicating the result of the operation.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_table_init(
+    az_iot_hub_client_table* table,
+    az_span iot_hub_hostname,
+    az_iot_hub_client_options const* options,
+    az_span* device_ids,
+    az_span* module_ids,
+    int32_t capacity,
+    int32_t* hash_index,
+    int32_t hash_index_size);
+
+/**
+ * @brief Adds a device identity to an #az_iot_hub_client_table.
+ *
+ * @param[in,out] table The #az_iot_hub_client_table to use for this call.
+ * @param[in] device_id The Device ID. The span must remain valid for as long as the table is used.
+ * @param[in] module_id The Module ID, or #AZ_SPAN_EMPTY for a device identity. The span must remain
+ * valid for as long as the table is used.
+ * @param[out] out_entry __[nullable]__ The index of the new entry.
+ * @pre \p table must not be `NULL`.
+ * @pre \p device_id must be a valid span of size greater than 0.
+ * @pre \p module_id must be a valid span, and can only be non-empty if the table has
+ * `module_ids`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The entry was added.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The table is full.
+ * @retval #AZ_ERROR_ARG The table already has an entry with the same IDs.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_table_add(
+    az_iot_hub_client_table* table,
+    az_span device_id,
+    az_span module_id,
+    int32_t* out_entry);
+
+/**
+ * @brief Finds the entry of a device identity in an #az_iot_hub_client_table.
+ *
+ * @param[in] table The #az_iot_hub_client_table to use for this call.
+ * @param[in] device_id The Device ID.
+ * @param[in] module_id The Module ID, or #AZ_SPAN_EMPTY for a device identity.
+ * @param[out] out_entry The index of the entry.
+ * @pre \p table must not be `NULL`.
+ * @pre \p device_id must be a valid span of size greater than 0.
+ * @pre \p out_entry must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The entry was found.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The table has no entry with these IDs.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_table_find(
+    az_iot_hub_client_table const* table,
+    az_span device_id,
+    az_span module_id,
+    int32_t* out_entry);
+
+/**
+ * @brief Finds the entry a received topic is meant for, from the identity at the start of the
+ * topic, that is `devices/{device_id}/` or `devices/{device_id}/modules/{module_id}/`.
+ *
+ * @param[in] table The #az_iot_hub_client_table to use for this call.
+ * @param[in] received_topic An #az_span containing the received topic.
+ * @param[out] out_entry The index of the entry.
+ * @pre \p table must not be `NULL`.
+ * @pre \p received_topic must be a valid span of size greater than 0.
+ * @pre \p out_entry must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The entry was found.
+ * @retval #AZ_ERROR_IOT_TOPIC_NO_MATCH The topic doesn't start with a device identity.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The table has no entry for the identity in the topic.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_table_find_by_topic(
+    az_iot_hub_client_table const* table,
+    az_span received_topic,
+    int32_t* out_entry);
+
+/**
+ * @brief Gets an #az_iot_hub_client for an entry of an #az_iot_hub_client_table.
+ *
+ * @details The client refers to the storage of the table, so it is cheap to get one whenever
+ * needed, for instance on the stack before calling a topic or SAS token API.
+ *
+ * @param[in] table The #az_iot_hub_client_table to use for this call.
+ * @param[in] entry The index of the entry.
+ * @param[out] out_client The #az_iot_hub_client of the entry.
+ * @pre \p table must not be `NULL`.
+ * @pre \p entry must be the index of an entry of the table.
+ * @pre \p out_client must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_table_get_client(
+    az_iot_hub_client_table const* table,
+    int32_t entry,
+    az_iot_hub_client* out_client);
+
+/*
+ *
+ * Request table APIs
+ *
+ *   Use the following APIs to issue the request IDs of twin, properties and method requests, and to
+ *   match their responses to the requests, or time them out.
+ */
+
+/// The largest size, in bytes, of a request ID issued by an #az_iot_hub_client_request_table.
+#define AZ_IOT_HUB_CLIENT_REQUEST_ID_MAX_SIZE 10
+
+/**
+ * @brief An in-flight request of an #az_iot_hub_client_request_table.
+ */
+typedef struct
+{
+  struct
+  {
+    az_context const* context;
+    void* user_context;
+    uint32_t request_id;
+    bool is_in_flight;
+  } _internal;
+} az_iot_hub_client_request_table_entry;
+
+/**
+ * @brief A fixed number of in-flight requests, with the IDs they were sent with.
+ *
+ * @details The table issues the request IDs itself, as decimal numbers whose low bits are the
+ * index of the entry of the request. The entry of a response is thus found from its request ID in
+ * constant time, without comparing any strings. IDs increase with each request, so a late response
+ * to a request which was timed out doesn't match a newer request in the same entry.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client_request_table_entry* entries;
+    uint32_t entries_mask;
+    uint32_t next_request_id;
+    int32_t count;
+  } _internal;
+} az_iot_hub_client_request_table;
+
+/**
+ * @brief Initializes an #az_iot_hub_client_request_table.
+ *
+ * @param[out] table The #az_iot_hub_client_request_table to initialize.
+ * @param[in] entries The array in which to store the in-flight requests. It needs no
+ * initialization.
+ * @param[in] capacity The number of elements of \p entries, which is the maximum number of
+ * requests in flight. It must be a power of two.
+ * @pre \p table must not be `NULL`.
+ * @pre \p entries must not be `NULL`.
+ * @pre \p capacity must be a power of two greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_request_table_init(
+    az_iot_hub_client_request_table* table,
+    az_iot_hub_client_request_table_entry* entries,
+    int32_t capacity);
+
+/**
+ * @brief Adds a request to an #az_iot_hub_client_request_table and issues its request ID.
+ *
+ * @param[in,out] table The #az_iot_hub_client_request_table to use for this call.
+ * @param[in] context __[nullable]__ The #az_context whose expiration is the deadline of the
+ * request, or `NULL` if it has none. It must stay valid until the request is removed. Canceling
+ * it makes the request expire.
+ * @param[in] user_context __[nullable]__ The context of the request, returned with its response.
+ * @param[in] request_id_buffer The buffer to write the request ID to.
+ * @param[out] out_request_id The request ID, at the start of \p request_id_buffer, to pass to the
+ * API which gets the topic of the request.
+ * @pre \p table must not be `NULL`.
+ * @pre \p request_id_buffer must be a valid span of at least
+ * #AZ_IOT_HUB_CLIENT_REQUEST_ID_MAX_SIZE bytes.
+ * @pre \p out_request_id must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The request was added.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The table is full.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_request_table_add(
+    az_iot_hub_client_request_table* table,
+    az_context const* context,
+    void* user_context,
+    az_span request_id_buffer,
+    az_span* out_request_id);
+
+/**
+ * @brief Removes the request of a response from an #az_iot_hub_client_request_table.
+ *
+ * @param[in,out] table The #az_iot_hub_client_request_table to use for this call.
+ * @param[in] request_id The request ID of the response, such as the `request_id` of an
+ * #az_iot_hub_client_twin_response.
+ * @param[out] out_user_context __[nullable]__ The context the request was added with.
+ * @pre \p table must not be `NULL`.
+ * @pre \p request_id must be a valid span.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The request was removed.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No request in flight has this ID, such as after it was
+ * removed as expired.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_request_table_remove(
+    az_iot_hub_client_request_table* table,
+    az_span request_id,
+    void** out_user_context);
+
+/**
+ * @brief Removes a request whose deadline has passed from an #az_iot_hub_client_request_table.
+ *
+ * @details Call this periodically, until it returns #AZ_ERROR_ITEM_NOT_FOUND, to time out the
+ * requests which got no response. Each call looks through all the entries.
+ *
+ * @param[in,out] table The #az_iot_hub_client_request_table to use for this call.
+ * @param[in] current_time The current time, in the unit of the expiration of the #az_context of
+ * the requests.
+ * @param[out] out_user_context __[nullable]__ The context the request was added with.
+ * @pre \p table must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK An expired request was removed.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No request has expired.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_request_table_remove_expired(
+    az_iot_hub_client_request_table* table,
+    int64_t current_time,
+    void** out_user_context);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_IOT_HUB_CLIENT_H
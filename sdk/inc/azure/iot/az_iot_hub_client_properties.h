@@ -208,6 +208,78 @@ AZ_NODISCARD az_result az_iot_hub_client_properties_get_properties_version(
     az_iot_hub_client_properties_message_type message_type,
     int32_t* out_version);
 
+/**
+ * @brief The outcome of az_iot_hub_client_properties_apply_writable_patch().
+ */
+typedef enum
+{
+  /// The payload was the next version of the desired properties, which are now up to date.
+  AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED = 1,
+  /// The payload was newer than the next version of the desired properties, so at least one patch
+  /// was missed. It was applied, but the properties it leaves untouched may be out of date. Get
+  /// the properties document with az_iot_hub_client_properties_document_get_publish_topic() to
+  /// bring them up to date.
+  AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED_AFTER_GAP = 2,
+  /// The payload wasn't newer than the desired properties, such as a patch delivered twice. Nothing
+  /// was written.
+  AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_STALE = 3,
+} az_iot_hub_client_properties_patch_status;
+
+/**
+ * @brief Applies the writable properties of a payload to a copy of the desired properties kept by
+ * the device.
+ *
+ * @details A #AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED payload is merged into
+ * \p desired_properties as a JSON merge patch (RFC 7396): properties set to `null` are removed,
+ * objects are merged member by member, and any other value replaces the one it patches. The
+ * `desired` section of a #AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE payload replaces
+ * \p desired_properties instead. Either way, the resulting desired properties are written as a
+ * single JSON object ending with their `$version`, ready to be stored and passed as
+ * \p desired_properties for the next payload.
+ *
+ * The payloads are applied in the order of their `$version`. One which is not newer than
+ * \p desired_properties is ignored, and one which skips a version is reported through
+ * \p out_status, so that the properties document only needs to be requested when a patch was
+ * actually missed.
+ *
+ * @note The merge reads both documents as they are written, without copying them. Their members
+ * are matched by name, with a cost proportional to the number of members of the patch times the
+ * number of members of the desired properties at each level, which suits the small patches sent by
+ * the service.
+ *
+ * @param[in] client The #az_iot_hub_client to use for this call.
+ * @param[in] desired_properties The desired properties kept by the device, as written by a
+ * previous call, or #AZ_SPAN_EMPTY if there are none yet.
+ * @param[in,out] ref_json_reader The #az_json_reader, initialized on the payload in a single
+ * buffer and not yet advanced.
+ * @param[in] message_type The #az_iot_hub_client_properties_message_type of the payload.
+ * @param[in,out] ref_json_writer The #az_json_writer to write the resulting desired properties
+ * to. Its buffer must not overlap \p desired_properties.
+ * @param[out] out_status How the payload relates to \p desired_properties.
+ *
+ * @pre \p client must not be `NULL`.
+ * @pre \p desired_properties must be a valid #az_span.
+ * @pre \p ref_json_reader must not be `NULL` and must be initialized on a single buffer.
+ * @pre \p message_type must be `AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED` or
+ * `AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE`.
+ * @pre \p ref_json_writer must not be `NULL`.
+ * @pre \p out_status must not be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The payload was applied, or ignored as #AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_STALE.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The payload has no `$version`, or no `desired` section.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer of \p ref_json_writer is too small.
+ * @retval #AZ_ERROR_NOT_SUPPORTED A property name with escaped characters is longer than 128
+ * bytes.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_apply_writable_patch(
+    az_iot_hub_client const* client,
+    az_span desired_properties,
+    az_json_reader* ref_json_reader,
+    az_iot_hub_client_properties_message_type message_type,
+    az_json_writer* ref_json_writer,
+    az_iot_hub_client_properties_patch_status* out_status);
+
 /**
  * @brief Property type
  *
@@ -303,6 +375,439 @@ AZ_NODISCARD az_result az_iot_hub_client_properties_get_next_component_property(
     az_iot_hub_client_property_type property_type,
     az_span* out_component_name);
 
+/**
+ * @brief Builds a hash index of the component names of the client, so that finding whether a
+ * property of a payload is a component no longer compares it to each component name in turn.
+ *
+ * @details Once built, the index is used by
+ * az_iot_hub_client_properties_get_next_component_property() and
+ * az_iot_hub_client_properties_index_build(). It refers to the component names of the client
+ * options, which must not change afterwards.
+ *
+ * @param[in,out] client The #az_iot_hub_client to use for this call.
+ * @param[in] component_name_index The array to keep the hash index in. It must remain valid for as
+ * long as \p client is used.
+ * @param[in] component_name_index_size The number of elements of \p component_name_index, which
+ * must be a power of two greater than the number of component names. Twice the number of component
+ * names, rounded up, keeps lookups short.
+ *
+ * @pre \p client must not be `NULL`.
+ * @pre \p component_name_index must not be `NULL`.
+ * @pre \p component_name_index_size must be a power of two greater than the number of component
+ * names.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The index was built.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_build_component_name_index(
+    az_iot_hub_client* client,
+    int32_t* component_name_index,
+    int32_t component_name_index_size);
+
+/**
+ * @brief Where the properties of a component are, within a properties payload.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span component_name;
+    az_iot_hub_client_property_type property_type;
+    az_span json;
+    uint8_t const* name_in_payload;
+  } _internal;
+} az_iot_hub_client_properties_index_entry;
+
+/**
+ * @brief An index of the components of a properties payload, to read the properties of any
+ * component without going through the whole payload again.
+ *
+ * @details The index is built in a single pass over the payload, which records where the
+ * properties of the root component and of each component of the model are, for the writable
+ * properties and, in the response to a properties document request, for the reported properties.
+ * The properties of a component can then be read, in any order and any number of times, with
+ * az_iot_hub_client_properties_index_get_reader() and
+ * az_iot_hub_client_properties_index_get_next_property().
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client const* client;
+    az_iot_hub_client_properties_index_entry* entries;
+    int32_t capacity;
+    int32_t count;
+  } _internal;
+} az_iot_hub_client_properties_index;
+
+/**
+ * @brief Builds an #az_iot_hub_client_properties_index of a properties payload.
+ *
+ * @param[in] client The #az_iot_hub_client to use for this call. It must remain valid for as long
+ * as the index is used.
+ * @param[in] json_payload The properties payload, in a single buffer. It must remain valid and
+ * unchanged for as long as the index is used.
+ * @param[in] message_type The #az_iot_hub_client_properties_message_type representing the message
+ * type associated with the payload.
+ * @param[out] out_index The #az_iot_hub_client_properties_index to build.
+ * @param[in] entries The array to keep the location of each component in. It must remain valid for
+ * as long as the index is used.
+ * @param[in] capacity The number of elements of \p entries. One per section of the payload for
+ * the root component, plus one per component in each section, is enough.
+ *
+ * @pre \p client must not be `NULL`.
+ * @pre \p json_payload must be a valid, non-empty #az_span.
+ * @pre \p message_type must be `AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED` or
+ * `AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE`.
+ * @pre \p out_index must not be `NULL`.
+ * @pre \p entries must not be `NULL`.
+ * @pre \p capacity must be greater than 0.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The index was built.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE There are more components than \p capacity.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The payload is not the expected JSON object.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_index_build(
+    az_iot_hub_client const* client,
+    az_span json_payload,
+    az_iot_hub_client_properties_message_type message_type,
+    az_iot_hub_client_properties_index* out_index,
+    az_iot_hub_client_properties_index_entry* entries,
+    int32_t capacity);
+
+/**
+ * @brief Initializes an #az_json_reader to read the properties of a component.
+ *
+ * @details Only the JSON object holding the properties of the component is read, so the payload
+ * isn't searched again. Use az_iot_hub_client_properties_index_get_next_property() to move the
+ * reader from one property to the next.
+ *
+ * @param[in] index The #az_iot_hub_client_properties_index to use for this call.
+ * @param[in] property_type The #az_iot_hub_client_property_type of the properties to read.
+ * @param[in] component_name The name of the component, or #AZ_SPAN_EMPTY for the root component.
+ * @param[out] out_json_reader The #az_json_reader to initialize.
+ *
+ * @pre \p index must not be `NULL`.
+ * @pre \p property_type must be `AZ_IOT_HUB_CLIENT_PROPERTY_REPORTED_FROM_DEVICE` or
+ * `AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE`.
+ * @pre \p component_name must be a valid #az_span.
+ * @pre \p out_json_reader must not be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The reader was initialized.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The payload has no such properties for the component.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_index_get_reader(
+    az_iot_hub_client_properties_index const* index,
+    az_iot_hub_client_property_type property_type,
+    az_span component_name,
+    az_json_reader* out_json_reader);
+
+/**
+ * @brief Moves a reader initialized by az_iot_hub_client_properties_index_get_reader() to the name
+ * of the next property of its component.
+ *
+ * @details As with az_iot_hub_client_properties_get_next_component_property(), the metadata of the
+ * payload is skipped, and after checking the property name, the reader must be moved past the
+ * property value, including its children, before the next call.
+ *
+ * @param[in] index The #az_iot_hub_client_properties_index to use for this call.
+ * @param[in,out] ref_json_reader The #az_json_reader to move.
+ *
+ * @pre \p index must not be `NULL`.
+ * @pre \p ref_json_reader must not be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The reader is on the name of a property.
+ * @retval #AZ_ERROR_IOT_END_OF_PROPERTIES There are no more properties for the component.
+ * @retval #AZ_ERROR_JSON_INVALID_STATE The reader is not after a property value.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_index_get_next_property(
+    az_iot_hub_client_properties_index const* index,
+    az_json_reader* ref_json_reader);
+
+/*
+ *
+ * Reported properties cache APIs
+ *
+ */
+
+/**
+ * @brief The type of the value of a property kept by an #az_iot_hub_client_properties_cache.
+ */
+typedef enum
+{
+  AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_INT32 = 1, /**< An `int32_t` value. */
+  AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_DOUBLE = 2, /**< A `double` value. */
+  AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_BOOL = 3, /**< A `bool` value. */
+  AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_STRING = 4, /**< A string value, as an #az_span. */
+} az_iot_hub_client_properties_cache_type;
+
+/**
+ * @brief A reported property kept by an #az_iot_hub_client_properties_cache.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span component_name;
+    az_span property_name;
+    az_iot_hub_client_properties_cache_type type;
+    union
+    {
+      int32_t int32_value;
+      double double_value;
+      bool bool_value;
+      az_span string_value;
+    } value;
+    int32_t fractional_digits;
+    uint32_t string_hash;
+    uint8_t flags;
+  } _internal;
+} az_iot_hub_client_properties_cache_slot;
+
+enum
+{
+  // The size of a UUID, which is the longest request ID expected.
+  _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_REQUEST_ID_MAX_SIZE = 36,
+};
+
+/**
+ * @brief Keeps the last values of the reported properties of a device, to send only those which
+ * changed.
+ *
+ * @details The application registers each of its reported properties as a slot, then sets their
+ * values as often as it likes. Setting a property to the value it already has doesn't change it.
+ * az_iot_hub_client_properties_cache_write_patch() writes a reported properties payload with only
+ * the properties which changed since the last payload, and az_iot_hub_client_properties_cache_ack()
+ * tells, when the response to that payload is received, whether they need to be sent again.
+ *
+ * Names and string values are kept by reference. They must remain valid for as long as the cache is
+ * used, though the content of string values can be changed before setting them again.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client_properties_cache_slot* slots;
+    int32_t capacity;
+    int32_t count;
+    uint8_t pending_request_id[_az_IOT_HUB_CLIENT_PROPERTIES_CACHE_REQUEST_ID_MAX_SIZE];
+    int32_t pending_request_id_size;
+  } _internal;
+} az_iot_hub_client_properties_cache;
+
+/**
+ * @brief Initializes an #az_iot_hub_client_properties_cache.
+ *
+ * @param[out] cache The #az_iot_hub_client_properties_cache to initialize.
+ * @param[in] slots The array to keep the properties in. It must remain valid for as long as the
+ * cache is used.
+ * @param[in] capacity The number of elements of \p slots.
+ *
+ * @pre \p cache must not be `NULL`.
+ * @pre \p slots must not be `NULL`.
+ * @pre \p capacity must be greater than 0.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The cache was initialized.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_init(
+    az_iot_hub_client_properties_cache* cache,
+    az_iot_hub_client_properties_cache_slot* slots,
+    int32_t capacity);
+
+/**
+ * @brief Registers a reported property, which has no value until it is set.
+ *
+ * @param[in,out] cache The #az_iot_hub_client_properties_cache to use for this call.
+ * @param[in] component_name The name of the component the property belongs to, or #AZ_SPAN_EMPTY
+ * for a property of the root component.
+ * @param[in] property_name The name of the property.
+ * @param[in] type The #az_iot_hub_client_properties_cache_type of the values of the property.
+ * @param[out] out_slot __[nullable]__ The index of the property, to set its value with.
+ *
+ * @pre \p cache must not be `NULL`.
+ * @pre \p component_name must be a valid #az_span.
+ * @pre \p property_name must be a valid, non-empty #az_span.
+ * @pre \p type must be one of the #az_iot_hub_client_properties_cache_type values.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The property was registered.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE All the slots are used.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_add(
+    az_iot_hub_client_properties_cache* cache,
+    az_span component_name,
+    az_span property_name,
+    az_iot_hub_client_properties_cache_type type,
+    int32_t* out_slot);
+
+/**
+ * @brief Sets the value of an `int32_t` property.
+ *
+ * @param[in,out] cache The #az_iot_hub_client_properties_cache to use for this call.
+ * @param[in] slot The index of the property, as returned by
+ * az_iot_hub_client_properties_cache_add().
+ * @param[in] value The value of the property.
+ *
+ * @pre \p cache must not be `NULL`.
+ * @pre \p slot must be the index of an #AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_INT32 property.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The value was set.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_set_int32(
+    az_iot_hub_client_properties_cache* cache,
+    int32_t slot,
+    int32_t value);
+
+/**
+ * @brief Sets the value of a `double` property.
+ *
+ * @param[in,out] cache The #az_iot_hub_client_properties_cache to use for this call.
+ * @param[in] slot The index of the property, as returned by
+ * az_iot_hub_client_properties_cache_add().
+ * @param[in] value The value of the property.
+ * @param[in] fractional_digits The number of digits to write after the decimal point, as for
+ * az_json_writer_append_double().
+ *
+ * @pre \p cache must not be `NULL`.
+ * @pre \p slot must be the index of an #AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_DOUBLE property.
+ * @pre \p fractional_digits must be between 0 and 15, inclusive.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The value was set.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_set_double(
+    az_iot_hub_client_properties_cache* cache,
+    int32_t slot,
+    double value,
+    int32_t fractional_digits);
+
+/**
+ * @brief Sets the value of a `bool` property.
+ *
+ * @param[in,out] cache The #az_iot_hub_client_properties_cache to use for this call.
+ * @param[in] slot The index of the property, as returned by
+ * az_iot_hub_client_properties_cache_add().
+ * @param[in] value The value of the property.
+ *
+ * @pre \p cache must not be `NULL`.
+ * @pre \p slot must be the index of an #AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_BOOL property.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The value was set.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_set_bool(
+    az_iot_hub_client_properties_cache* cache,
+    int32_t slot,
+    bool value);
+
+/**
+ * @brief Sets the value of a string property.
+ *
+ * @details The value is kept by reference and its content is compared, through a hash, with the
+ * value it replaces. So the same buffer can be updated in place and set again.
+ *
+ * @param[in,out] cache The #az_iot_hub_client_properties_cache to use for this call.
+ * @param[in] slot The index of the property, as returned by
+ * az_iot_hub_client_properties_cache_add().
+ * @param[in] value The value of the property, which is escaped when written.
+ *
+ * @pre \p cache must not be `NULL`.
+ * @pre \p slot must be the index of an #AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_STRING property.
+ * @pre \p value must be a valid #az_span.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The value was set.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_set_string(
+    az_iot_hub_client_properties_cache* cache,
+    int32_t slot,
+    az_span value);
+
+/**
+ * @brief Tells whether any property has changed since the last payload was written.
+ *
+ * @param[in] cache The #az_iot_hub_client_properties_cache to use for this call.
+ *
+ * @pre \p cache must not be `NULL`.
+ *
+ * @return `true` if a property changed since the last call to
+ * az_iot_hub_client_properties_cache_write_patch(), `false` otherwise.
+ */
+AZ_NODISCARD bool az_iot_hub_client_properties_cache_has_changes(
+    az_iot_hub_client_properties_cache const* cache);
+
+/**
+ * @brief Writes a reported properties payload with the properties which changed, grouped by
+ * component.
+ *
+ * @details The properties written are those which changed since the last payload, along with
+ * those of the last payload if it wasn't acknowledged yet, since this payload supersedes it. Send
+ * the payload to the topic given by az_iot_hub_client_properties_get_reported_publish_topic() for
+ * the same \p request_id.
+ *
+ * @param[in,out] cache The #az_iot_hub_client_properties_cache to use for this call.
+ * @param[in] client The #az_iot_hub_client to use for this call.
+ * @param[in,out] ref_json_writer The initialized #az_json_writer to write the whole JSON object
+ * to.
+ * @param[in] request_id The request ID the payload is sent with. It is copied by the cache.
+ *
+ * @pre \p cache must not be `NULL`.
+ * @pre \p client must not be `NULL`.
+ * @pre \p ref_json_writer must not be `NULL`.
+ * @pre \p request_id must be a valid, non-empty #az_span.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The payload was written. It is an empty object if no property changed.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p ref_json_writer ran out of space, or \p request_id is
+ * longer than 36 bytes. The cache is left unchanged.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_write_patch(
+    az_iot_hub_client_properties_cache* cache,
+    az_iot_hub_client const* client,
+    az_json_writer* ref_json_writer,
+    az_span request_id);
+
+/**
+ * @brief Records the response of the service to the last reported properties payload.
+ *
+ * @details If the update succeeded, the properties it carried are up to date. Otherwise, they are
+ * written again by the next call to az_iot_hub_client_properties_cache_write_patch().
+ *
+ * @param[in,out] cache The #az_iot_hub_client_properties_cache to use for this call.
+ * @param[in] request_id The request ID of the response, from
+ * #az_iot_hub_client_properties_message.
+ * @param[in] status The status of the response, from #az_iot_hub_client_properties_message.
+ *
+ * @pre \p cache must not be `NULL`.
+ * @pre \p request_id must be a valid #az_span.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The response was recorded.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND \p request_id is not the one of the last payload, which is
+ * waiting for a response.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_ack(
+    az_iot_hub_client_properties_cache* cache,
+    az_span request_id,
+    az_iot_status status);
+
+/**
+ * @brief Marks every property which has a value as changed, so that the next payload has them all.
+ *
+ * @details Use this when the reported properties of the service may no longer match the device,
+ * such as after it was reprovisioned.
+ *
+ * @param[in,out] cache The #az_iot_hub_client_properties_cache to use for this call.
+ *
+ * @pre \p cache must not be `NULL`.
+ */
+void az_iot_hub_client_properties_cache_invalidate(az_iot_hub_client_properties_cache* cache);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif //_az_IOT_HUB_CLIENT_PROPERTIES_H
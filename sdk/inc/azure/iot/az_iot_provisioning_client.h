@@ -17,6 +17,7 @@
 #ifndef _az_IOT_PROVISIONING_CLIENT_H
 #define _az_IOT_PROVISIONING_CLIENT_H
 
+#include <azure/core/az_context.h>
 #include <azure/core/az_result.h>
 #include <azure/core/az_span.h>
 #include <azure/iot/az_iot_common.h>
@@ -279,6 +280,11 @@ typedef struct
    */
   az_span payload;
 
+  /**
+   * The ETag of the registration, which changes whenever the service updates it.
+   */
+  az_span etag;
+
 } az_iot_provisioning_client_registration_state;
 
 /**
@@ -391,6 +397,71 @@ AZ_INLINE bool az_iot_provisioning_client_operation_complete(
   return (operation_status > AZ_IOT_PROVISIONING_STATUS_ASSIGNING);
 }
 
+/**
+ * @brief The version of the blobs written by
+ * az_iot_provisioning_client_registration_state_serialize().
+ */
+#define AZ_IOT_PROVISIONING_CLIENT_REGISTRATION_STATE_BLOB_VERSION 1
+
+/**
+ * @brief Saves the registration state of an assigned device into a compact blob, to keep in
+ * storage and load at the next startup with
+ * az_iot_provisioning_client_registration_state_deserialize().
+ *
+ * @details The blob holds the assigned hub, device ID, ETag, timestamp and custom payload of the
+ * registration, along with a version, a checksum and a hash of the ID scope and registration ID of
+ * \p client. A device can then connect to its hub right away on startup, and only go through the
+ * Device Provisioning Service again when the hub rejects it, such as with an authorization
+ * failure, after which the blob should be replaced.
+ *
+ * @param[in] client The #az_iot_provisioning_client the device registered with.
+ * @param[in] registration_state The #az_iot_provisioning_client_registration_state of the
+ * assigned device.
+ * @param[out] destination The #az_span to write the blob to.
+ * @param[out] out_blob The slice of \p destination holding the blob.
+ * @pre \p client must not be `NULL`.
+ * @pre \p registration_state must not be `NULL`, and its assigned hub hostname and device ID must
+ * be valid spans of size greater than 0.
+ * @pre \p destination must be a valid span of size greater than 0.
+ * @pre \p out_blob must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The blob was written.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is too small.
+ * @retval #AZ_ERROR_NOT_SUPPORTED A field of \p registration_state other than its payload is
+ * longer than 65535 bytes.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_registration_state_serialize(
+    az_iot_provisioning_client const* client,
+    az_iot_provisioning_client_registration_state const* registration_state,
+    az_span destination,
+    az_span* out_blob);
+
+/**
+ * @brief Loads the registration state saved by
+ * az_iot_provisioning_client_registration_state_serialize(), after checking that the blob is whole
+ * and belongs to the same registration.
+ *
+ * @param[in] client The #az_iot_provisioning_client the device would register with.
+ * @param[in] blob The blob to load.
+ * @param[out] out_registration_state The #az_iot_provisioning_client_registration_state of the
+ * device, whose spans refer to \p blob.
+ * @pre \p client must not be `NULL`.
+ * @pre \p blob must be a valid span of size greater than or equal to 0.
+ * @pre \p out_registration_state must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation. In any case but #AZ_OK, the
+ * device should register with the Device Provisioning Service.
+ * @retval #AZ_OK The registration state was loaded.
+ * @retval #AZ_ERROR_UNEXPECTED_END The blob is truncated.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The blob is corrupted or isn't a registration state blob.
+ * @retval #AZ_ERROR_NOT_SUPPORTED The blob has another version than
+ * #AZ_IOT_PROVISIONING_CLIENT_REGISTRATION_STATE_BLOB_VERSION.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The blob was saved for another ID scope or registration ID.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_registration_state_deserialize(
+    az_iot_provisioning_client const* client,
+    az_span blob,
+    az_iot_provisioning_client_registration_state* out_registration_state);
+
 /**
  * @brief Gets the MQTT topic that must be used to submit a Register request.
  * @remark The payload of the MQTT publish message may contain a JSON document formatted according
@@ -547,6 +618,251 @@ AZ_DEPRECATED AZ_NODISCARD az_result az_iot_provisioning_client_get_request_payl
     size_t mqtt_payload_size,
     size_t* out_mqtt_payload_length);
 
+/**
+ * @brief The request an #az_iot_provisioning_client_poller asks to publish.
+ */
+typedef enum
+{
+  /// Nothing to publish yet.
+  AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_NONE = 0,
+
+  /// Publish a Register request.
+  AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_REGISTER = 1,
+
+  /// Publish a Query Status request, with the operation ID kept by the poller.
+  AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_QUERY_STATUS = 2,
+} az_iot_provisioning_client_poller_action;
+
+/**
+ * @brief The options of an #az_iot_provisioning_client_poller.
+ */
+typedef struct
+{
+  /**
+   * The delays between requests when the service doesn't ask for any, or when requests fail, and
+   * how they are spread between registrations.
+   */
+  az_iot_retry_policy_options retry;
+
+  /**
+   * How long to wait for the response to a request before sending it again, in milliseconds.
+   */
+  int32_t response_timeout_msec;
+} az_iot_provisioning_client_poller_options;
+
+/**
+ * @brief Schedules the requests of a registration with the Device Provisioning Service, from the
+ * Register request to the completion of the operation, without blocking.
+ *
+ * @details The poller never waits nor reads the clock itself: the application passes the time, such
+ * as from az_platform_clock_msec(), and publishes the requests the poller asks for, which lets a
+ * single thread drive the registrations of many devices. The time to query the status of an
+ * operation is taken from the `retry-after` of the service, spread between registrations, or from
+ * a bounded backoff when the service doesn't give one.
+ *
+ * @note You MUST NOT touch the fields of this structure directly.
+ */
+typedef struct
+{
+  struct
+  {
+    az_context const* context;
+    az_span operation_id_buffer;
+    int32_t operation_id_size;
+    int32_t response_timeout_msec;
+    az_iot_retry_policy retry_policy;
+    int64_t start_time_msec;
+    int64_t deadline_msec;
+    bool is_waiting_response;
+    bool is_complete;
+  } _internal;
+} az_iot_provisioning_client_poller;
+
+/**
+ * @brief Gets the default #az_iot_provisioning_client_poller_options.
+ * @details Call this to obtain an initialized #az_iot_provisioning_client_poller_options structure
+ * that can be afterwards modified and passed to az_iot_provisioning_client_poller_init(). Requests
+ * are sent again after 1 to 30 seconds, with decorrelated jitter, and a response is waited for 10
+ * seconds.
+ *
+ * @return #az_iot_provisioning_client_poller_options.
+ */
+AZ_NODISCARD az_iot_provisioning_client_poller_options
+az_iot_provisioning_client_poller_options_default();
+
+/**
+ * @brief Initializes an #az_iot_provisioning_client_poller, which asks for a Register request
+ * right away.
+ *
+ * @param[out] poller The #az_iot_provisioning_client_poller to initialize.
+ * @param[in] client The #az_iot_provisioning_client of the registration, whose registration ID
+ * spreads the requests of the registrations of a gateway.
+ * @param[in] context __[nullable]__ The #az_context bounding the whole registration, or `NULL` for
+ * no bound. It must outlive the poller.
+ * @param[in] operation_id_buffer The #az_span to keep the operation ID of the registration in,
+ * between the responses of the service.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_provisioning_client_poller_options
+ * structure. If `NULL` is passed, the poller will use the default options.
+ * @param[in] current_clock_msec The current time, in milliseconds.
+ * @pre \p poller must not be `NULL`.
+ * @pre \p client must not be `NULL`.
+ * @pre \p operation_id_buffer must be a valid span of size greater than 0.
+ * @pre The response timeout of \p options must be greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The poller was initialized.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_poller_init(
+    az_iot_provisioning_client_poller* poller,
+    az_iot_provisioning_client const* client,
+    az_context const* context,
+    az_span operation_id_buffer,
+    az_iot_provisioning_client_poller_options const* options,
+    int64_t current_clock_msec);
+
+/**
+ * @brief Gets the request to publish now, if any.
+ *
+ * @details Once the application publishes the request, it calls
+ * az_iot_provisioning_client_poller_report_sent(). When the response doesn't come in time, or the
+ * request couldn't be published, the poller asks for it again after a backoff delay.
+ *
+ * @param[in,out] poller The #az_iot_provisioning_client_poller to use for this call.
+ * @param[in] current_clock_msec The current time, in milliseconds.
+ * @param[out] out_action The request to publish, or #AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_NONE
+ * until az_iot_provisioning_client_poller_get_next_deadline_msec().
+ * @pre \p poller must not be `NULL`.
+ * @pre \p out_action must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK \p out_action was set.
+ * @retval #AZ_ERROR_CANCELED The context of the registration expired or was canceled before the
+ * operation completed. The poller is complete.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_poller_get_action(
+    az_iot_provisioning_client_poller* poller,
+    int64_t current_clock_msec,
+    az_iot_provisioning_client_poller_action* out_action);
+
+/**
+ * @brief Records that the request given by az_iot_provisioning_client_poller_get_action() was
+ * published, and starts waiting for its response.
+ *
+ * @param[in,out] poller The #az_iot_provisioning_client_poller to use for this call.
+ * @param[in] current_clock_msec The current time, in milliseconds.
+ * @pre \p poller must not be `NULL`.
+ */
+void az_iot_provisioning_client_poller_report_sent(
+    az_iot_provisioning_client_poller* poller,
+    int64_t current_clock_msec);
+
+/**
+ * @brief Schedules the next request of a registration from the response of the service.
+ *
+ * @details An operation still in progress is queried again after the `retry-after` of \p
+ * response, or after a backoff delay when there is none. Throttled and server errors are retried
+ * the same way. Any other response, including errors which retrying wouldn't fix, completes the
+ * poller.
+ *
+ * @param[in,out] poller The #az_iot_provisioning_client_poller to use for this call.
+ * @param[in] response The #az_iot_provisioning_client_register_response parsed by
+ * az_iot_provisioning_client_parse_received_topic_and_payload().
+ * @param[in] current_clock_msec The current time, in milliseconds.
+ * @pre \p poller must not be `NULL`.
+ * @pre \p response must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The response was taken into account.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The operation ID of \p response doesn't fit in the buffer of
+ * the poller.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_poller_report_response(
+    az_iot_provisioning_client_poller* poller,
+    az_iot_provisioning_client_register_response const* response,
+    int64_t current_clock_msec);
+
+/**
+ * @brief Gets the time at which the poller next has something to do, which is when the
+ * application should call az_iot_provisioning_client_poller_get_action() again.
+ *
+ * @param[in] poller The #az_iot_provisioning_client_poller to use for this call.
+ * @pre \p poller must not be `NULL`.
+ * @return The time, in milliseconds, or `INT64_MAX` once the poller is complete.
+ */
+AZ_NODISCARD int64_t az_iot_provisioning_client_poller_get_next_deadline_msec(
+    az_iot_provisioning_client_poller const* poller);
+
+/**
+ * @brief Finds, among the registrations of a gateway, the first one with a request to publish
+ * now.
+ *
+ * @details This calls az_iot_provisioning_client_poller_get_action() on each poller which isn't
+ * complete, so a single loop drives thousands of registrations: it publishes the request found,
+ * calls again, and once there is nothing left to do, sleeps until \p out_next_deadline_msec or the
+ * next response.
+ *
+ * @param[in,out] pollers The #az_iot_provisioning_client_poller of each registration.
+ * @param[in] pollers_length The number of elements in \p pollers.
+ * @param[in] current_clock_msec The current time, in milliseconds.
+ * @param[out] out_index The index of the poller in \p pollers.
+ * @param[out] out_action The request to publish for that poller.
+ * @param[out] out_next_deadline_msec __[nullable]__ When nothing is due, the earliest time
+ * at which a poller will be, or `INT64_MAX` when all are complete.
+ * @pre \p pollers must not be `NULL`.
+ * @pre \p pollers_length must be greater than or equal to 0.
+ * @pre \p out_index must not be `NULL`.
+ * @pre \p out_action must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The poller at \p out_index has a request to publish.
+ * @retval #AZ_ERROR_CANCELED The context of the poller at \p out_index expired, which is only
+ * reported once, as the poller is then complete.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No poller has anything to publish now.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_poller_get_next(
+    az_iot_provisioning_client_poller* pollers,
+    int32_t pollers_length,
+    int64_t current_clock_msec,
+    int32_t* out_index,
+    az_iot_provisioning_client_poller_action* out_action,
+    int64_t* out_next_deadline_msec);
+
+/**
+ * @brief Gets the operation ID of the registration, to publish Query Status requests with.
+ *
+ * @param[in] poller The #az_iot_provisioning_client_poller to use for this call.
+ * @return The operation ID, which is empty until the service gives one.
+ */
+AZ_NODISCARD AZ_INLINE az_span
+az_iot_provisioning_client_poller_get_operation_id(az_iot_provisioning_client_poller const* poller)
+{
+  return az_span_slice(
+      poller->_internal.operation_id_buffer, 0, poller->_internal.operation_id_size);
+}
+
+/**
+ * @brief Gets how long the registration has been going on.
+ *
+ * @param[in] poller The #az_iot_provisioning_client_poller to use for this call.
+ * @param[in] current_clock_msec The current time, in milliseconds.
+ * @return The time elapsed since the poller was initialized, in milliseconds.
+ */
+AZ_NODISCARD AZ_INLINE int64_t az_iot_provisioning_client_poller_get_elapsed_msec(
+    az_iot_provisioning_client_poller const* poller,
+    int64_t current_clock_msec)
+{
+  return current_clock_msec - poller->_internal.start_time_msec;
+}
+
+/**
+ * @brief Checks whether a registration is over, because the operation completed or the context of
+ * the registration expired.
+ *
+ * @param[in] poller The #az_iot_provisioning_client_poller to use for this call.
+ * @return `true` if the poller is complete, `false` otherwise.
+ */
+AZ_NODISCARD AZ_INLINE bool
+az_iot_provisioning_client_poller_is_complete(az_iot_provisioning_client_poller const* poller)
+{
+  return poller->_internal.is_complete;
+}
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_IOT_PROVISIONING_CLIENT_H
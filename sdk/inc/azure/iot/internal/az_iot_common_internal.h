@@ -32,6 +32,85 @@
  */
 AZ_NODISCARD int32_t _az_iot_u32toa_size(uint32_t number);
 
+/**
+ * @brief The value to start an FNV-1a hash from, before any byte is hashed.
+ */
+#define _az_IOT_FNV1A_OFFSET_BASIS 2166136261U
+
+/**
+ * @brief Adds the bytes of a span to an FNV-1a hash.
+ *
+ * @details FNV-1a is short and spreads similar names and IDs, such as "sensor-01" and
+ * "sensor-02", well, which is what the hashed lookups of the IoT clients need. It is not meant to
+ * resist crafted inputs.
+ *
+ * @param[in] hash The hash so far, or #_az_IOT_FNV1A_OFFSET_BASIS to start a new one.
+ * @param[in] data The bytes to hash.
+ * @return The hash of the bytes so far, followed by those of \p data.
+ */
+AZ_NODISCARD uint32_t _az_iot_fnv1a(uint32_t hash, az_span data);
+
+/**
+ * @brief Advances a xorshift32 random state and returns its new value.
+ *
+ * @details xorshift32 is plenty to spread retries and renewals, and keeps the IoT clients free of
+ * global state. It never leaves 0, so a zero state is taken as 1, and any seed will do.
+ *
+ * @param[in,out] state The random state, seeded with any value.
+ * @return The next random value, which is also the new state.
+ */
+AZ_NODISCARD uint32_t _az_iot_xorshift32(uint32_t* state);
+
+/**
+ * @brief Writes a 16-bit value in little endian, byte by byte, so that \p ptr doesn't need to be
+ * aligned and what is written can be read by another build.
+ *
+ * @param[out] ptr Where to write the 2 bytes of the value.
+ * @param[in] value The value to write.
+ */
+AZ_INLINE void _az_iot_write_le_u16(uint8_t* ptr, uint16_t value)
+{
+  ptr[0] = (uint8_t)value;
+  ptr[1] = (uint8_t)(value >> 8);
+}
+
+/**
+ * @brief Writes a 32-bit value in little endian, the same way as _az_iot_write_le_u16().
+ *
+ * @param[out] ptr Where to write the 4 bytes of the value.
+ * @param[in] value The value to write.
+ */
+AZ_INLINE void _az_iot_write_le_u32(uint8_t* ptr, uint32_t value)
+{
+  ptr[0] = (uint8_t)value;
+  ptr[1] = (uint8_t)(value >> 8);
+  ptr[2] = (uint8_t)(value >> 16);
+  ptr[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Reads a 16-bit value written by _az_iot_write_le_u16().
+ *
+ * @param[in] ptr Where to read the 2 bytes of the value from.
+ * @return The value.
+ */
+AZ_NODISCARD AZ_INLINE uint16_t _az_iot_read_le_u16(uint8_t const* ptr)
+{
+  return (uint16_t)(ptr[0] | (ptr[1] << 8));
+}
+
+/**
+ * @brief Reads a 32-bit value written by _az_iot_write_le_u32().
+ *
+ * @param[in] ptr Where to read the 4 bytes of the value from.
+ * @return The value.
+ */
+AZ_NODISCARD AZ_INLINE uint32_t _az_iot_read_le_u32(uint8_t const* ptr)
+{
+  return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) | ((uint32_t)ptr[2] << 16)
+      | ((uint32_t)ptr[3] << 24);
+}
+
 /**
  * @brief Gives the length, in bytes, of the string that would represent the given number.
  *
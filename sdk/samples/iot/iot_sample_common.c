@@ -27,7 +27,6 @@
 #include <openssl/bio.h>
 #include <openssl/buffer.h>
 #include <openssl/evp.h>
-#include <openssl/hmac.h>
 
 #include <azure/az_core.h>
 #include <azure/az_iot.h>
@@ -453,21 +452,10 @@ static void hmac_sha256_sign_signature(
     az_span signed_signature,
     az_span* out_signed_signature)
 {
-  unsigned int hmac_encode_len;
-  unsigned char const* hmac = HMAC(
-      EVP_sha256(),
-      (void*)az_span_ptr(decoded_key),
-      az_span_size(decoded_key),
-      az_span_ptr(signature),
-      (size_t)az_span_size(signature),
-      az_span_ptr(signed_signature),
-      &hmac_encode_len);
-
-  if (hmac != NULL)
-  {
-    *out_signed_signature = az_span_create(az_span_ptr(signed_signature), (int32_t)hmac_encode_len);
-  }
-  else
+  az_hmac_sha256_key key;
+  if (az_result_failed(az_hmac_sha256_key_init(&key, decoded_key))
+      || az_result_failed(
+          az_hmac_sha256(&key, signature, signed_signature, out_signed_signature)))
   {
     IOT_SAMPLE_LOG_ERROR("Could not sign the signature: Buffer is too small.");
     exit(1);
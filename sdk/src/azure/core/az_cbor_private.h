@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Defines private implementation used by cbor.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_CBOR_PRIVATE_H
+#define _az_CBOR_PRIVATE_H
+
+#include <azure/core/az_cbor.h>
+#include <azure/core/internal/az_precondition_internal.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+enum
+{
+  // This is safe to do because sizeof will not dereference the pointer and is used to find the
+  // number of elements of the array used as the stack.
+  _az_MAX_CBOR_STACK_SIZE = sizeof(((_az_cbor_stack*)0)->_internal.remaining_items)
+      / sizeof(((_az_cbor_stack*)0)->_internal.remaining_items[0]), // 32
+};
+
+// The major type of a data item is within the high-order 3 bits of its initial byte.
+enum
+{
+  _az_CBOR_MAJOR_TYPE_UNSIGNED_INTEGER = 0,
+  _az_CBOR_MAJOR_TYPE_NEGATIVE_INTEGER = 1,
+  _az_CBOR_MAJOR_TYPE_BYTE_STRING = 2,
+  _az_CBOR_MAJOR_TYPE_TEXT_STRING = 3,
+  _az_CBOR_MAJOR_TYPE_ARRAY = 4,
+  _az_CBOR_MAJOR_TYPE_MAP = 5,
+  _az_CBOR_MAJOR_TYPE_TAG = 6,
+  _az_CBOR_MAJOR_TYPE_SIMPLE_AND_FLOAT = 7,
+};
+
+// The additional information within the low-order 5 bits of the initial byte.
+enum
+{
+  _az_CBOR_ADDITIONAL_INFO_MAX_INLINE = 23,
+  _az_CBOR_ADDITIONAL_INFO_ONE_BYTE = 24,
+  _az_CBOR_ADDITIONAL_INFO_TWO_BYTES = 25,
+  _az_CBOR_ADDITIONAL_INFO_FOUR_BYTES = 26,
+  _az_CBOR_ADDITIONAL_INFO_EIGHT_BYTES = 27,
+  _az_CBOR_ADDITIONAL_INFO_INDEFINITE = 31,
+
+  _az_CBOR_SIMPLE_FALSE = 20,
+  _az_CBOR_SIMPLE_TRUE = 21,
+  _az_CBOR_SIMPLE_NULL = 22,
+  _az_CBOR_SIMPLE_UNDEFINED = 23,
+
+  // The initial byte of the "break" stop code, ending an indefinite-length map or array.
+  _az_CBOR_BREAK = 0xFF,
+};
+
+AZ_NODISCARD AZ_INLINE bool _az_cbor_stack_is_object(_az_cbor_stack const* stack)
+{
+  return stack->_internal.current_depth > 0
+      && (stack->_internal.is_object & (1U << (stack->_internal.current_depth - 1))) != 0;
+}
+
+AZ_INLINE void _az_cbor_stack_push(_az_cbor_stack* ref_stack, bool is_object, int32_t items)
+{
+  _az_PRECONDITION(
+      ref_stack->_internal.current_depth >= 0
+      && ref_stack->_internal.current_depth < _az_MAX_CBOR_STACK_SIZE);
+
+  int32_t const depth = ref_stack->_internal.current_depth;
+  ref_stack->_internal.remaining_items[depth] = items;
+  if (is_object)
+  {
+    ref_stack->_internal.is_object |= 1U << depth;
+  }
+  else
+  {
+    ref_stack->_internal.is_object &= ~(1U << depth);
+  }
+  ref_stack->_internal.current_depth++;
+}
+
+AZ_INLINE void _az_cbor_stack_pop(_az_cbor_stack* ref_stack)
+{
+  _az_PRECONDITION(ref_stack->_internal.current_depth > 0);
+
+  // We don't want current_depth to become negative, in case preconditions are off.
+  if (ref_stack->_internal.current_depth > 0)
+  {
+    ref_stack->_internal.current_depth--;
+  }
+}
+
+// Both for definite-length (counting down) and indefinite-length (counting down from -1)
+// containers, reading one more item within the current container is a decrement.
+AZ_INLINE void _az_cbor_stack_count_item(_az_cbor_stack* ref_stack)
+{
+  if (ref_stack->_internal.current_depth > 0)
+  {
+    ref_stack->_internal.remaining_items[ref_stack->_internal.current_depth - 1]--;
+  }
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_CBOR_PRIVATE_H
@@ -0,0 +1,459 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_cbor_private.h"
+#include <azure/core/az_cbor.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+
+#include <string.h>
+
+#include <azure/core/_az_cfg.h>
+
+AZ_NODISCARD az_result az_cbor_reader_init(
+    az_cbor_reader* out_cbor_reader,
+    az_span cbor_buffer,
+    az_cbor_reader_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_cbor_reader);
+  _az_PRECONDITION(az_span_size(cbor_buffer) >= 1);
+
+  *out_cbor_reader = (az_cbor_reader){
+    .token = (az_cbor_token){
+      .slice = AZ_SPAN_EMPTY,
+      .kind = AZ_CBOR_TOKEN_NONE,
+      ._internal = { 0 },
+    },
+    ._internal = {
+      .cbor_buffer = cbor_buffer,
+      .bytes_consumed = 0,
+      .stack = { 0 },
+      .options = options == NULL ? az_cbor_reader_options_default() : *options,
+    },
+  };
+  return AZ_OK;
+}
+
+// Reads the initial byte of a data item and its argument, if any, advancing past them.
+static AZ_NODISCARD az_result _az_cbor_reader_read_head(
+    az_cbor_reader* ref_cbor_reader,
+    uint8_t* out_major_type,
+    uint8_t* out_additional_info,
+    uint64_t* out_argument)
+{
+  az_span const remaining = az_span_slice_to_end(
+      ref_cbor_reader->_internal.cbor_buffer, ref_cbor_reader->_internal.bytes_consumed);
+  int32_t const remaining_size = az_span_size(remaining);
+  if (remaining_size < 1)
+  {
+    return AZ_ERROR_UNEXPECTED_END;
+  }
+
+  uint8_t const* ptr = az_span_ptr(remaining);
+  *out_major_type = (uint8_t)(ptr[0] >> 5U);
+  *out_additional_info = (uint8_t)(ptr[0] & 0x1FU);
+
+  int32_t argument_size = 0;
+  if (*out_additional_info <= _az_CBOR_ADDITIONAL_INFO_MAX_INLINE)
+  {
+    *out_argument = *out_additional_info;
+  }
+  else if (*out_additional_info <= _az_CBOR_ADDITIONAL_INFO_EIGHT_BYTES)
+  {
+    // The additional information values 24 through 27 mean 1, 2, 4, or 8 bytes follow.
+    argument_size = 1 << (*out_additional_info - _az_CBOR_ADDITIONAL_INFO_ONE_BYTE);
+  }
+  else if (*out_additional_info != _az_CBOR_ADDITIONAL_INFO_INDEFINITE)
+  {
+    // The additional information values 28 through 30 are reserved.
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  if (remaining_size < argument_size + 1)
+  {
+    return AZ_ERROR_UNEXPECTED_END;
+  }
+
+  if (argument_size > 0)
+  {
+    // The argument is stored in network byte order (big-endian).
+    uint64_t argument = 0;
+    for (int32_t i = 1; i <= argument_size; i++)
+    {
+      argument = (argument << 8U) | ptr[i];
+    }
+    *out_argument = argument;
+  }
+
+  ref_cbor_reader->_internal.bytes_consumed += argument_size + 1;
+  return AZ_OK;
+}
+
+static double _az_cbor_half_to_double(uint16_t half)
+{
+  uint32_t const sign = (uint32_t)(half & 0x8000U) << 16U;
+  uint32_t const exponent = (half >> 10U) & 0x1FU;
+  uint32_t const mantissa = half & 0x3FFU;
+
+  if (exponent == 0)
+  {
+    // Zero and subnormal numbers, i.e. mantissa * 2^-24.
+    double const value = (double)mantissa / 16777216.0;
+    return sign != 0 ? -value : value;
+  }
+
+  // Widen to single precision, re-biasing the exponent (from 15 to 127), unless it is infinity or
+  // NaN, which keep an all ones exponent.
+  uint32_t const bits = sign | (exponent == 0x1FU ? 0x7F800000U : (exponent + 112U) << 23U)
+      | (mantissa << 13U);
+  float single = 0;
+  memcpy(&single, &bits, sizeof(single));
+  return single;
+}
+
+static AZ_NODISCARD az_result _az_cbor_reader_read_simple_or_float(
+    az_cbor_reader* ref_cbor_reader,
+    uint8_t additional_info,
+    uint64_t argument)
+{
+  az_cbor_token* token = &ref_cbor_reader->token;
+
+  switch (additional_info)
+  {
+    case _az_CBOR_SIMPLE_FALSE:
+      token->kind = AZ_CBOR_TOKEN_FALSE;
+      break;
+    case _az_CBOR_SIMPLE_TRUE:
+      token->kind = AZ_CBOR_TOKEN_TRUE;
+      break;
+    case _az_CBOR_SIMPLE_NULL:
+    case _az_CBOR_SIMPLE_UNDEFINED:
+      token->kind = AZ_CBOR_TOKEN_NULL;
+      break;
+    case _az_CBOR_ADDITIONAL_INFO_TWO_BYTES:
+      token->kind = AZ_CBOR_TOKEN_FLOAT;
+      token->_internal.float_value = _az_cbor_half_to_double((uint16_t)argument);
+      break;
+    case _az_CBOR_ADDITIONAL_INFO_FOUR_BYTES:
+    {
+      uint32_t const bits = (uint32_t)argument;
+      float single = 0;
+      memcpy(&single, &bits, sizeof(single));
+      token->kind = AZ_CBOR_TOKEN_FLOAT;
+      token->_internal.float_value = single;
+      break;
+    }
+    case _az_CBOR_ADDITIONAL_INFO_EIGHT_BYTES:
+      token->kind = AZ_CBOR_TOKEN_FLOAT;
+      memcpy(&token->_internal.float_value, &argument, sizeof(token->_internal.float_value));
+      break;
+    default:
+      // Other simple values have no equivalent in the JSON data model, and a "break" stop code is
+      // only valid where an indefinite-length map or array could end.
+      return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+  return AZ_OK;
+}
+
+// Reads the end of the current map or array, if it has been reached.
+static AZ_NODISCARD az_result
+_az_cbor_reader_read_container_end(az_cbor_reader* ref_cbor_reader, bool* out_is_end)
+{
+  _az_cbor_stack* stack = &ref_cbor_reader->_internal.stack;
+  int32_t const remaining_items
+      = stack->_internal.remaining_items[stack->_internal.current_depth - 1];
+  bool const is_object = _az_cbor_stack_is_object(stack);
+
+  az_span const remaining = az_span_slice_to_end(
+      ref_cbor_reader->_internal.cbor_buffer, ref_cbor_reader->_internal.bytes_consumed);
+
+  az_span slice = AZ_SPAN_EMPTY;
+  if (remaining_items < 0 && az_span_size(remaining) > 0
+      && az_span_ptr(remaining)[0] == _az_CBOR_BREAK)
+  {
+    // An indefinite-length map must not end between a key and its value, i.e. after an odd
+    // number of items.
+    if (is_object && (remaining_items % 2) == 0)
+    {
+      return AZ_ERROR_UNEXPECTED_CHAR;
+    }
+    slice = az_span_slice(remaining, 0, 1);
+    ref_cbor_reader->_internal.bytes_consumed++;
+  }
+  else if (remaining_items != 0)
+  {
+    *out_is_end = false;
+    return AZ_OK;
+  }
+
+  ref_cbor_reader->token = (az_cbor_token){
+    .slice = slice,
+    .kind = is_object ? AZ_CBOR_TOKEN_END_OBJECT : AZ_CBOR_TOKEN_END_ARRAY,
+    ._internal = { 0 },
+  };
+
+  // The map or array counts as a single item within its parent.
+  _az_cbor_stack_pop(stack);
+  _az_cbor_stack_count_item(stack);
+
+  *out_is_end = true;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_reader_next_token(az_cbor_reader* ref_cbor_reader)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_reader);
+
+  _az_cbor_stack* stack = &ref_cbor_reader->_internal.stack;
+  int32_t const depth = stack->_internal.current_depth;
+
+  if (depth == 0 && ref_cbor_reader->token.kind != AZ_CBOR_TOKEN_NONE)
+  {
+    // The root data item has been read, so there should be nothing else after it.
+    return ref_cbor_reader->_internal.bytes_consumed
+            == az_span_size(ref_cbor_reader->_internal.cbor_buffer)
+        ? AZ_ERROR_CBOR_READER_DONE
+        : AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  bool is_property_name = false;
+  if (depth > 0)
+  {
+    bool is_end = false;
+    _az_RETURN_IF_FAILED(_az_cbor_reader_read_container_end(ref_cbor_reader, &is_end));
+    if (is_end)
+    {
+      return AZ_OK;
+    }
+
+    // Within a map, keys and values alternate, starting with a key. A definite-length map counts
+    // its items down from an even number, while an indefinite-length one counts down from -1.
+    int32_t const remaining_items = stack->_internal.remaining_items[depth - 1];
+    is_property_name = _az_cbor_stack_is_object(stack)
+        && (remaining_items >= 0 ? (remaining_items % 2) == 0 : (remaining_items % 2) != 0);
+  }
+
+  uint8_t major_type = 0;
+  uint8_t additional_info = 0;
+  uint64_t argument = 0;
+  int32_t start = 0;
+
+  // Tags only add semantics to the data item that follows, so skip over them.
+  do
+  {
+    start = ref_cbor_reader->_internal.bytes_consumed;
+    _az_RETURN_IF_FAILED(
+        _az_cbor_reader_read_head(ref_cbor_reader, &major_type, &additional_info, &argument));
+  } while (major_type == _az_CBOR_MAJOR_TYPE_TAG
+           && additional_info != _az_CBOR_ADDITIONAL_INFO_INDEFINITE);
+
+  bool const is_indefinite = additional_info == _az_CBOR_ADDITIONAL_INFO_INDEFINITE;
+
+  // Only text strings are supported as map keys, just like JSON property names.
+  if (is_property_name && major_type != _az_CBOR_MAJOR_TYPE_TEXT_STRING)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  int32_t const remaining_size = az_span_size(ref_cbor_reader->_internal.cbor_buffer)
+      - ref_cbor_reader->_internal.bytes_consumed;
+
+  az_cbor_token token = {
+    .slice = az_span_slice(
+        ref_cbor_reader->_internal.cbor_buffer, start, ref_cbor_reader->_internal.bytes_consumed),
+    .kind = AZ_CBOR_TOKEN_NONE,
+    ._internal = { 0 },
+  };
+  ref_cbor_reader->token = token;
+
+  switch (major_type)
+  {
+    case _az_CBOR_MAJOR_TYPE_UNSIGNED_INTEGER:
+    case _az_CBOR_MAJOR_TYPE_NEGATIVE_INTEGER:
+      if (is_indefinite)
+      {
+        return AZ_ERROR_UNEXPECTED_CHAR;
+      }
+      ref_cbor_reader->token.kind = AZ_CBOR_TOKEN_INTEGER;
+      ref_cbor_reader->token._internal.integer_argument = argument;
+      ref_cbor_reader->token._internal.is_negative
+          = major_type == _az_CBOR_MAJOR_TYPE_NEGATIVE_INTEGER;
+      break;
+
+    case _az_CBOR_MAJOR_TYPE_BYTE_STRING:
+    case _az_CBOR_MAJOR_TYPE_TEXT_STRING:
+      // Indefinite-length strings, split into chunks, are not supported.
+      if (is_indefinite)
+      {
+        return AZ_ERROR_UNEXPECTED_CHAR;
+      }
+      if (argument > (uint64_t)remaining_size)
+      {
+        return AZ_ERROR_UNEXPECTED_END;
+      }
+      ref_cbor_reader->token.slice = az_span_slice(
+          ref_cbor_reader->_internal.cbor_buffer,
+          ref_cbor_reader->_internal.bytes_consumed,
+          ref_cbor_reader->_internal.bytes_consumed + (int32_t)argument);
+      ref_cbor_reader->_internal.bytes_consumed += (int32_t)argument;
+
+      if (major_type == _az_CBOR_MAJOR_TYPE_BYTE_STRING)
+      {
+        ref_cbor_reader->token.kind = AZ_CBOR_TOKEN_BYTE_STRING;
+      }
+      else
+      {
+        ref_cbor_reader->token.kind
+            = is_property_name ? AZ_CBOR_TOKEN_PROPERTY_NAME : AZ_CBOR_TOKEN_STRING;
+      }
+      break;
+
+    case _az_CBOR_MAJOR_TYPE_ARRAY:
+    case _az_CBOR_MAJOR_TYPE_MAP:
+    {
+      bool const is_object = major_type == _az_CBOR_MAJOR_TYPE_MAP;
+      if (depth >= _az_MAX_CBOR_STACK_SIZE)
+      {
+        return AZ_ERROR_CBOR_NESTING_OVERFLOW;
+      }
+
+      int32_t items = -1;
+      if (!is_indefinite)
+      {
+        // Every item takes at least one byte, which also keeps the count within range.
+        uint64_t const item_count = is_object ? argument * 2 : argument;
+        if (argument > (uint64_t)remaining_size || item_count > (uint64_t)remaining_size)
+        {
+          return AZ_ERROR_UNEXPECTED_END;
+        }
+        items = (int32_t)item_count;
+      }
+
+      ref_cbor_reader->token.kind
+          = is_object ? AZ_CBOR_TOKEN_BEGIN_OBJECT : AZ_CBOR_TOKEN_BEGIN_ARRAY;
+
+      // The container counts as an item within its parent once it ends.
+      _az_cbor_stack_push(stack, is_object, items);
+      return AZ_OK;
+    }
+
+    case _az_CBOR_MAJOR_TYPE_SIMPLE_AND_FLOAT:
+      _az_RETURN_IF_FAILED(
+          _az_cbor_reader_read_simple_or_float(ref_cbor_reader, additional_info, argument));
+      break;
+
+    default:
+      // An indefinite-length tag.
+      return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  _az_cbor_stack_count_item(stack);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_reader_skip_children(az_cbor_reader* ref_cbor_reader)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_reader);
+
+  if (ref_cbor_reader->token.kind == AZ_CBOR_TOKEN_PROPERTY_NAME)
+  {
+    _az_RETURN_IF_FAILED(az_cbor_reader_next_token(ref_cbor_reader));
+  }
+
+  az_cbor_token_kind const token_kind = ref_cbor_reader->token.kind;
+  if (token_kind == AZ_CBOR_TOKEN_BEGIN_OBJECT || token_kind == AZ_CBOR_TOKEN_BEGIN_ARRAY)
+  {
+    // Keep moving the reader until we come back to the same depth.
+    int32_t const depth = ref_cbor_reader->_internal.stack._internal.current_depth;
+    do
+    {
+      _az_RETURN_IF_FAILED(az_cbor_reader_next_token(ref_cbor_reader));
+    } while (ref_cbor_reader->_internal.stack._internal.current_depth >= depth);
+  }
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_token_get_int64(az_cbor_token const* cbor_token, int64_t* out_value)
+{
+  _az_PRECONDITION_NOT_NULL(cbor_token);
+  _az_PRECONDITION_NOT_NULL(out_value);
+
+  if (cbor_token->kind != AZ_CBOR_TOKEN_INTEGER)
+  {
+    return AZ_ERROR_CBOR_INVALID_STATE;
+  }
+
+  uint64_t const argument = cbor_token->_internal.integer_argument;
+  if (argument > (uint64_t)INT64_MAX)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  *out_value = cbor_token->_internal.is_negative ? -1 - (int64_t)argument : (int64_t)argument;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_token_get_int32(az_cbor_token const* cbor_token, int32_t* out_value)
+{
+  _az_PRECONDITION_NOT_NULL(out_value);
+
+  int64_t value = 0;
+  _az_RETURN_IF_FAILED(az_cbor_token_get_int64(cbor_token, &value));
+
+  if (value < INT32_MIN || value > INT32_MAX)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  *out_value = (int32_t)value;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_token_get_double(az_cbor_token const* cbor_token, double* out_value)
+{
+  _az_PRECONDITION_NOT_NULL(cbor_token);
+  _az_PRECONDITION_NOT_NULL(out_value);
+
+  if (cbor_token->kind == AZ_CBOR_TOKEN_FLOAT)
+  {
+    *out_value = cbor_token->_internal.float_value;
+  }
+  else if (cbor_token->kind == AZ_CBOR_TOKEN_INTEGER)
+  {
+    double const magnitude = (double)cbor_token->_internal.integer_argument;
+    *out_value = cbor_token->_internal.is_negative ? -1.0 - magnitude : magnitude;
+  }
+  else
+  {
+    return AZ_ERROR_CBOR_INVALID_STATE;
+  }
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_token_get_boolean(az_cbor_token const* cbor_token, bool* out_value)
+{
+  _az_PRECONDITION_NOT_NULL(cbor_token);
+  _az_PRECONDITION_NOT_NULL(out_value);
+
+  if (cbor_token->kind != AZ_CBOR_TOKEN_TRUE && cbor_token->kind != AZ_CBOR_TOKEN_FALSE)
+  {
+    return AZ_ERROR_CBOR_INVALID_STATE;
+  }
+
+  *out_value = cbor_token->kind == AZ_CBOR_TOKEN_TRUE;
+  return AZ_OK;
+}
+
+AZ_NODISCARD bool
+az_cbor_token_is_text_equal(az_cbor_token const* cbor_token, az_span expected_text)
+{
+  _az_PRECONDITION_NOT_NULL(cbor_token);
+
+  if (cbor_token->kind != AZ_CBOR_TOKEN_STRING && cbor_token->kind != AZ_CBOR_TOKEN_PROPERTY_NAME)
+  {
+    return false;
+  }
+
+  return az_span_is_content_equal(cbor_token->slice, expected_text);
+}
@@ -0,0 +1,231 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_span_private.h"
+#include <azure/core/az_base64.h>
+#include <azure/core/az_cbor.h>
+#include <azure/core/az_json.h>
+#include <azure/core/internal/az_json_internal.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+enum
+{
+  // Enough for the digits of -2^64, the smallest CBOR integer, including its sign.
+  _az_CBOR_INTEGER_MAX_TEXT_SIZE = 21,
+};
+
+static AZ_NODISCARD az_result _az_cbor_transcode_integer_to_json(
+    az_cbor_token const* cbor_token,
+    az_json_writer* ref_json_writer)
+{
+  int64_t integer = 0;
+  if (az_result_succeeded(az_cbor_token_get_int64(cbor_token, &integer)) && integer >= INT32_MIN
+      && integer <= INT32_MAX)
+  {
+    return az_json_writer_append_int32(ref_json_writer, (int32_t)integer);
+  }
+
+  // The JSON writer has no 64-bit append, and CBOR integers go past the range of an int64_t, so
+  // format the number as JSON text from its CBOR argument instead.
+  uint8_t text[_az_CBOR_INTEGER_MAX_TEXT_SIZE] = { 0 };
+  az_span const number_text = AZ_SPAN_FROM_BUFFER(text);
+  az_span remainder = number_text;
+  uint64_t const argument = cbor_token->_internal.integer_argument;
+  if (!cbor_token->_internal.is_negative)
+  {
+    _az_RETURN_IF_FAILED(az_span_u64toa(remainder, argument, &remainder));
+  }
+  else if (argument < UINT64_MAX)
+  {
+    remainder = az_span_copy_u8(remainder, '-');
+    _az_RETURN_IF_FAILED(az_span_u64toa(remainder, argument + 1, &remainder));
+  }
+  else
+  {
+    // The magnitude of -1 - (2^64 - 1) doesn't fit in a uint64_t.
+    remainder = az_span_copy(remainder, AZ_SPAN_FROM_STR("-18446744073709551616"));
+  }
+
+  return az_json_writer_append_json_text(
+      ref_json_writer, az_span_slice(number_text, 0, _az_span_diff(remainder, number_text)));
+}
+
+static AZ_NODISCARD az_result
+_az_cbor_transcode_double_to_json(double value, az_json_writer* ref_json_writer)
+{
+  // JSON has no representation for infinity or NaN.
+  if (!_az_isfinite(value))
+  {
+    return az_json_writer_append_null(ref_json_writer);
+  }
+
+  // Unlike az_json_writer_append_double, this writes numbers beyond 2^53 in exponent form.
+  return _az_json_writer_append_value(ref_json_writer, _az_JSON_ARRAY_ELEMENT_DOUBLE, &value, 15);
+}
+
+static AZ_NODISCARD az_result _az_cbor_transcode_token_to_json(
+    az_cbor_token const* cbor_token,
+    az_json_writer* ref_json_writer,
+    az_span scratch_buffer)
+{
+  switch (cbor_token->kind)
+  {
+    case AZ_CBOR_TOKEN_BEGIN_OBJECT:
+      return az_json_writer_append_begin_object(ref_json_writer);
+    case AZ_CBOR_TOKEN_END_OBJECT:
+      return az_json_writer_append_end_object(ref_json_writer);
+    case AZ_CBOR_TOKEN_BEGIN_ARRAY:
+      return az_json_writer_append_begin_array(ref_json_writer);
+    case AZ_CBOR_TOKEN_END_ARRAY:
+      return az_json_writer_append_end_array(ref_json_writer);
+    case AZ_CBOR_TOKEN_PROPERTY_NAME:
+      return az_json_writer_append_property_name(ref_json_writer, cbor_token->slice);
+    case AZ_CBOR_TOKEN_STRING:
+      return az_json_writer_append_string(ref_json_writer, cbor_token->slice);
+    case AZ_CBOR_TOKEN_BYTE_STRING:
+    {
+      int32_t encoded_size = 0;
+      if (az_span_size(cbor_token->slice) > 0)
+      {
+        if (az_span_size(scratch_buffer)
+            < az_base64_get_max_encoded_size(az_span_size(cbor_token->slice)))
+        {
+          return AZ_ERROR_NOT_ENOUGH_SPACE;
+        }
+        _az_RETURN_IF_FAILED(az_base64_encode(scratch_buffer, cbor_token->slice, &encoded_size));
+      }
+      return az_json_writer_append_string(
+          ref_json_writer, az_span_slice(scratch_buffer, 0, encoded_size));
+    }
+    case AZ_CBOR_TOKEN_INTEGER:
+      return _az_cbor_transcode_integer_to_json(cbor_token, ref_json_writer);
+    case AZ_CBOR_TOKEN_FLOAT:
+      return _az_cbor_transcode_double_to_json(cbor_token->_internal.float_value, ref_json_writer);
+    case AZ_CBOR_TOKEN_TRUE:
+    case AZ_CBOR_TOKEN_FALSE:
+      return az_json_writer_append_bool(ref_json_writer, cbor_token->kind == AZ_CBOR_TOKEN_TRUE);
+    case AZ_CBOR_TOKEN_NULL:
+      return az_json_writer_append_null(ref_json_writer);
+    case AZ_CBOR_TOKEN_NONE:
+    default:
+      return AZ_ERROR_CBOR_INVALID_STATE;
+  }
+}
+
+AZ_NODISCARD az_result az_cbor_transcode_to_json(
+    az_cbor_reader* ref_cbor_reader,
+    az_json_writer* ref_json_writer,
+    az_span scratch_buffer)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_reader);
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_VALID_SPAN(scratch_buffer, 0, true);
+
+  // Keep going until the reader is back at the depth it started from, with a complete data item.
+  int32_t const depth = ref_cbor_reader->_internal.stack._internal.current_depth;
+  do
+  {
+    _az_RETURN_IF_FAILED(az_cbor_reader_next_token(ref_cbor_reader));
+    _az_RETURN_IF_FAILED(
+        _az_cbor_transcode_token_to_json(&ref_cbor_reader->token, ref_json_writer, scratch_buffer));
+  } while (ref_cbor_reader->_internal.stack._internal.current_depth > depth
+           || ref_cbor_reader->token.kind == AZ_CBOR_TOKEN_PROPERTY_NAME);
+
+  return AZ_OK;
+}
+
+// Gets the contents of a JSON string, avoiding the copy into the scratch buffer when possible.
+static AZ_NODISCARD az_result
+_az_cbor_get_json_string(az_json_token const* json_token, az_span scratch_buffer, az_span* out_text)
+{
+  if (!json_token->_internal.string_has_escaped_chars && !json_token->_internal.is_multisegment)
+  {
+    *out_text = json_token->slice;
+    return AZ_OK;
+  }
+
+  // The JSON token getter also adds a null terminator.
+  if (az_span_size(scratch_buffer) < 1)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  int32_t text_length = 0;
+  _az_RETURN_IF_FAILED(az_json_token_get_string(
+      json_token, (char*)az_span_ptr(scratch_buffer), az_span_size(scratch_buffer), &text_length));
+  *out_text = az_span_slice(scratch_buffer, 0, text_length);
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result _az_cbor_transcode_token_from_json(
+    az_json_token const* json_token,
+    az_cbor_writer* ref_cbor_writer,
+    az_span scratch_buffer)
+{
+  switch (json_token->kind)
+  {
+    case AZ_JSON_TOKEN_BEGIN_OBJECT:
+      return az_cbor_writer_append_begin_object(ref_cbor_writer);
+    case AZ_JSON_TOKEN_END_OBJECT:
+      return az_cbor_writer_append_end_object(ref_cbor_writer);
+    case AZ_JSON_TOKEN_BEGIN_ARRAY:
+      return az_cbor_writer_append_begin_array(ref_cbor_writer);
+    case AZ_JSON_TOKEN_END_ARRAY:
+      return az_cbor_writer_append_end_array(ref_cbor_writer);
+    case AZ_JSON_TOKEN_PROPERTY_NAME:
+    case AZ_JSON_TOKEN_STRING:
+    {
+      az_span text = AZ_SPAN_EMPTY;
+      _az_RETURN_IF_FAILED(_az_cbor_get_json_string(json_token, scratch_buffer, &text));
+      return json_token->kind == AZ_JSON_TOKEN_PROPERTY_NAME
+          ? az_cbor_writer_append_property_name(ref_cbor_writer, text)
+          : az_cbor_writer_append_string(ref_cbor_writer, text);
+    }
+    case AZ_JSON_TOKEN_NUMBER:
+    {
+      int64_t integer = 0;
+      if (az_result_succeeded(az_json_token_get_int64(json_token, &integer)))
+      {
+        return az_cbor_writer_append_int64(ref_cbor_writer, integer);
+      }
+
+      double value = 0;
+      _az_RETURN_IF_FAILED(az_json_token_get_double(json_token, &value));
+      return az_cbor_writer_append_double(ref_cbor_writer, value);
+    }
+    case AZ_JSON_TOKEN_TRUE:
+    case AZ_JSON_TOKEN_FALSE:
+      return az_cbor_writer_append_bool(ref_cbor_writer, json_token->kind == AZ_JSON_TOKEN_TRUE);
+    case AZ_JSON_TOKEN_NULL:
+      return az_cbor_writer_append_null(ref_cbor_writer);
+    case AZ_JSON_TOKEN_NONE:
+    default:
+      return AZ_ERROR_JSON_INVALID_STATE;
+  }
+}
+
+AZ_NODISCARD az_result az_cbor_transcode_from_json(
+    az_json_reader* ref_json_reader,
+    az_cbor_writer* ref_cbor_writer,
+    az_span scratch_buffer)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_reader);
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION_VALID_SPAN(scratch_buffer, 0, true);
+
+  // Keep going until the reader is back at the depth it started from, with a complete value.
+  int32_t const depth = ref_json_reader->_internal.bit_stack._internal.current_depth;
+  do
+  {
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+    _az_RETURN_IF_FAILED(_az_cbor_transcode_token_from_json(
+        &ref_json_reader->token, ref_cbor_writer, scratch_buffer));
+  } while (ref_json_reader->_internal.bit_stack._internal.current_depth > depth
+           || ref_json_reader->token.kind == AZ_JSON_TOKEN_PROPERTY_NAME);
+
+  return AZ_OK;
+}
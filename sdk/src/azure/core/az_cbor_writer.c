@@ -0,0 +1,453 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_cbor_private.h"
+#include "az_span_private.h"
+#include <azure/core/az_cbor.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+
+#include <float.h>
+#include <string.h>
+
+#include <azure/core/_az_cfg.h>
+
+AZ_NODISCARD az_result az_cbor_writer_init(
+    az_cbor_writer* out_cbor_writer,
+    az_span destination_buffer,
+    az_cbor_writer_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_cbor_writer);
+
+  *out_cbor_writer = (az_cbor_writer){
+    .total_bytes_written = 0,
+    ._internal = {
+      .destination_buffer = destination_buffer,
+      .bytes_written = 0,
+      .allocator_callback = NULL,
+      .user_context = NULL,
+      .token_kind = AZ_CBOR_TOKEN_NONE,
+      .stack = { 0 },
+      .options = options == NULL ? az_cbor_writer_options_default() : *options,
+    },
+  };
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_writer_chunked_init(
+    az_cbor_writer* out_cbor_writer,
+    az_span first_destination_buffer,
+    az_span_allocator_fn allocator_callback,
+    void* user_context,
+    az_cbor_writer_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_cbor_writer);
+  _az_PRECONDITION_NOT_NULL(allocator_callback);
+
+  *out_cbor_writer = (az_cbor_writer){
+    .total_bytes_written = 0,
+    ._internal = {
+      .destination_buffer = first_destination_buffer,
+      .bytes_written = 0,
+      .allocator_callback = allocator_callback,
+      .user_context = user_context,
+      .token_kind = AZ_CBOR_TOKEN_NONE,
+      .stack = { 0 },
+      .options = options == NULL ? az_cbor_writer_options_default() : *options,
+    },
+  };
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_span
+_az_cbor_writer_get_remaining_span(az_cbor_writer* ref_cbor_writer, int32_t required_size)
+{
+  _az_PRECONDITION(required_size > 0);
+
+  az_span remaining = az_span_slice_to_end(
+      ref_cbor_writer->_internal.destination_buffer, ref_cbor_writer->_internal.bytes_written);
+
+  if (az_span_size(remaining) < required_size
+      && ref_cbor_writer->_internal.allocator_callback != NULL)
+  {
+    az_span_allocator_context context = {
+      .user_context = ref_cbor_writer->_internal.user_context,
+      .bytes_used = ref_cbor_writer->_internal.bytes_written,
+      .minimum_required_size = required_size,
+    };
+
+    // No more space left in the destination, let the caller fail with AZ_ERROR_NOT_ENOUGH_SPACE.
+    if (az_result_failed(ref_cbor_writer->_internal.allocator_callback(&context, &remaining)))
+    {
+      return AZ_SPAN_EMPTY;
+    }
+    ref_cbor_writer->_internal.destination_buffer = remaining;
+    ref_cbor_writer->_internal.bytes_written = 0;
+  }
+
+  return remaining;
+}
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+// These validation methods mirror the ones of the az_json_writer, since both build the same shape.
+static AZ_NODISCARD bool _az_cbor_writer_is_appending_value_valid(az_cbor_writer const* cbor_writer)
+{
+  az_cbor_token_kind const kind = cbor_writer->_internal.token_kind;
+
+  if (_az_cbor_stack_is_object(&cbor_writer->_internal.stack))
+  {
+    // Values within an object can only be written after a property name.
+    return kind == AZ_CBOR_TOKEN_PROPERTY_NAME;
+  }
+
+  // At the root, only a single value can be written.
+  return cbor_writer->_internal.stack._internal.current_depth > 0 || kind == AZ_CBOR_TOKEN_NONE;
+}
+
+static AZ_NODISCARD bool
+_az_cbor_writer_is_appending_property_name_valid(az_cbor_writer const* cbor_writer)
+{
+  return _az_cbor_stack_is_object(&cbor_writer->_internal.stack)
+      && cbor_writer->_internal.token_kind != AZ_CBOR_TOKEN_PROPERTY_NAME;
+}
+
+static AZ_NODISCARD bool
+_az_cbor_writer_is_appending_container_end_valid(az_cbor_writer const* cbor_writer, bool is_object)
+{
+  return cbor_writer->_internal.stack._internal.current_depth > 0
+      && _az_cbor_stack_is_object(&cbor_writer->_internal.stack) == is_object
+      && cbor_writer->_internal.token_kind != AZ_CBOR_TOKEN_PROPERTY_NAME;
+}
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+// Returns the number of bytes needed for the argument after the initial byte, using the fewest
+// bytes possible, along with the additional information value that indicates it.
+static int32_t _az_cbor_get_argument_size(uint64_t argument, uint8_t* out_additional_info)
+{
+  if (argument <= _az_CBOR_ADDITIONAL_INFO_MAX_INLINE)
+  {
+    // Small values are stored directly within the initial byte.
+    *out_additional_info = (uint8_t)argument;
+    return 0;
+  }
+  if (argument <= UINT8_MAX)
+  {
+    *out_additional_info = _az_CBOR_ADDITIONAL_INFO_ONE_BYTE;
+    return 1;
+  }
+  if (argument <= UINT16_MAX)
+  {
+    *out_additional_info = _az_CBOR_ADDITIONAL_INFO_TWO_BYTES;
+    return 2;
+  }
+  if (argument <= UINT32_MAX)
+  {
+    *out_additional_info = _az_CBOR_ADDITIONAL_INFO_FOUR_BYTES;
+    return 4;
+  }
+  *out_additional_info = _az_CBOR_ADDITIONAL_INFO_EIGHT_BYTES;
+  return 8;
+}
+
+// Writes the initial byte, with the major type and additional information, followed by the
+// argument_size bytes of the argument in network byte order (big-endian).
+static void _az_cbor_write_head(
+    uint8_t* destination,
+    uint8_t major_type,
+    uint8_t additional_info,
+    uint64_t argument,
+    int32_t argument_size)
+{
+  destination[0] = (uint8_t)((major_type << 5U) | additional_info);
+
+  for (int32_t i = argument_size; i > 0; i--)
+  {
+    destination[i] = (uint8_t)(argument & 0xFFU);
+    argument >>= 8U;
+  }
+}
+
+// Writes a data item made up of only its head.
+static AZ_NODISCARD az_result _az_cbor_writer_append_head(
+    az_cbor_writer* ref_cbor_writer,
+    uint8_t major_type,
+    uint64_t argument,
+    az_cbor_token_kind token_kind)
+{
+  uint8_t additional_info = 0;
+  int32_t const argument_size = _az_cbor_get_argument_size(argument, &additional_info);
+  int32_t const required_size = argument_size + 1;
+
+  az_span remaining = _az_cbor_writer_get_remaining_span(ref_cbor_writer, required_size);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining, required_size);
+
+  _az_cbor_write_head(
+      az_span_ptr(remaining), major_type, additional_info, argument, argument_size);
+
+  ref_cbor_writer->_internal.bytes_written += required_size;
+  ref_cbor_writer->total_bytes_written += required_size;
+  ref_cbor_writer->_internal.token_kind = token_kind;
+  return AZ_OK;
+}
+
+// Writes a data item that is made up of a single initial byte.
+static AZ_NODISCARD az_result _az_cbor_writer_append_byte(
+    az_cbor_writer* ref_cbor_writer,
+    uint8_t byte,
+    az_cbor_token_kind token_kind)
+{
+  az_span remaining = _az_cbor_writer_get_remaining_span(ref_cbor_writer, 1);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining, 1);
+
+  az_span_copy_u8(remaining, byte);
+
+  ref_cbor_writer->_internal.bytes_written++;
+  ref_cbor_writer->total_bytes_written++;
+  ref_cbor_writer->_internal.token_kind = token_kind;
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result _az_cbor_writer_append_string_of_type(
+    az_cbor_writer* ref_cbor_writer,
+    uint8_t major_type,
+    az_span value,
+    az_cbor_token_kind token_kind)
+{
+  // With a single destination buffer, fail before writing anything when the whole string can't
+  // fit, same as the az_json_writer.
+  if (ref_cbor_writer->_internal.allocator_callback == NULL)
+  {
+    uint8_t additional_info = 0;
+    int32_t const required_size = 1 + az_span_size(value)
+        + _az_cbor_get_argument_size((uint64_t)az_span_size(value), &additional_info);
+    az_span const remaining = az_span_slice_to_end(
+        ref_cbor_writer->_internal.destination_buffer, ref_cbor_writer->_internal.bytes_written);
+    _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining, required_size);
+  }
+
+  _az_RETURN_IF_FAILED(_az_cbor_writer_append_head(
+      ref_cbor_writer, major_type, (uint64_t)az_span_size(value), token_kind));
+
+  // The payload is copied as is, across as many destination buffers as needed.
+  while (az_span_size(value) > 0)
+  {
+    az_span remaining = _az_cbor_writer_get_remaining_span(ref_cbor_writer, 1);
+    _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining, 1);
+
+    int32_t const size = az_span_size(value) < az_span_size(remaining) ? az_span_size(value)
+                                                                         : az_span_size(remaining);
+    az_span_copy(remaining, az_span_slice(value, 0, size));
+
+    ref_cbor_writer->_internal.bytes_written += size;
+    ref_cbor_writer->total_bytes_written += size;
+    value = az_span_slice_to_end(value, size);
+  }
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_string(az_cbor_writer* ref_cbor_writer, az_span value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION_VALID_SPAN(value, 0, true);
+  _az_PRECONDITION(_az_cbor_writer_is_appending_value_valid(ref_cbor_writer));
+
+  _az_RETURN_IF_FAILED(_az_cbor_writer_append_string_of_type(
+      ref_cbor_writer, _az_CBOR_MAJOR_TYPE_TEXT_STRING, value, AZ_CBOR_TOKEN_STRING));
+  _az_cbor_stack_count_item(&ref_cbor_writer->_internal.stack);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_cbor_writer_append_byte_string(az_cbor_writer* ref_cbor_writer, az_span value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION_VALID_SPAN(value, 0, true);
+  _az_PRECONDITION(_az_cbor_writer_is_appending_value_valid(ref_cbor_writer));
+
+  _az_RETURN_IF_FAILED(_az_cbor_writer_append_string_of_type(
+      ref_cbor_writer, _az_CBOR_MAJOR_TYPE_BYTE_STRING, value, AZ_CBOR_TOKEN_BYTE_STRING));
+  _az_cbor_stack_count_item(&ref_cbor_writer->_internal.stack);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_cbor_writer_append_property_name(az_cbor_writer* ref_cbor_writer, az_span name)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION_VALID_SPAN(name, 0, true);
+  _az_PRECONDITION(_az_cbor_writer_is_appending_property_name_valid(ref_cbor_writer));
+
+  _az_RETURN_IF_FAILED(_az_cbor_writer_append_string_of_type(
+      ref_cbor_writer, _az_CBOR_MAJOR_TYPE_TEXT_STRING, name, AZ_CBOR_TOKEN_PROPERTY_NAME));
+  _az_cbor_stack_count_item(&ref_cbor_writer->_internal.stack);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_bool(az_cbor_writer* ref_cbor_writer, bool value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION(_az_cbor_writer_is_appending_value_valid(ref_cbor_writer));
+
+  _az_RETURN_IF_FAILED(_az_cbor_writer_append_byte(
+      ref_cbor_writer,
+      (uint8_t)((_az_CBOR_MAJOR_TYPE_SIMPLE_AND_FLOAT << 5U)
+                | (value ? _az_CBOR_SIMPLE_TRUE : _az_CBOR_SIMPLE_FALSE)),
+      value ? AZ_CBOR_TOKEN_TRUE : AZ_CBOR_TOKEN_FALSE));
+  _az_cbor_stack_count_item(&ref_cbor_writer->_internal.stack);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_null(az_cbor_writer* ref_cbor_writer)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION(_az_cbor_writer_is_appending_value_valid(ref_cbor_writer));
+
+  _az_RETURN_IF_FAILED(_az_cbor_writer_append_byte(
+      ref_cbor_writer,
+      (uint8_t)((_az_CBOR_MAJOR_TYPE_SIMPLE_AND_FLOAT << 5U) | _az_CBOR_SIMPLE_NULL),
+      AZ_CBOR_TOKEN_NULL));
+  _az_cbor_stack_count_item(&ref_cbor_writer->_internal.stack);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_int64(az_cbor_writer* ref_cbor_writer, int64_t value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION(_az_cbor_writer_is_appending_value_valid(ref_cbor_writer));
+
+  if (value < 0)
+  {
+    // A negative integer n is encoded as the argument -1 - n, which can't overflow for INT64_MIN.
+    _az_RETURN_IF_FAILED(_az_cbor_writer_append_head(
+        ref_cbor_writer,
+        _az_CBOR_MAJOR_TYPE_NEGATIVE_INTEGER,
+        (uint64_t)(-1 - value),
+        AZ_CBOR_TOKEN_INTEGER));
+  }
+  else
+  {
+    _az_RETURN_IF_FAILED(_az_cbor_writer_append_head(
+        ref_cbor_writer,
+        _az_CBOR_MAJOR_TYPE_UNSIGNED_INTEGER,
+        (uint64_t)value,
+        AZ_CBOR_TOKEN_INTEGER));
+  }
+  _az_cbor_stack_count_item(&ref_cbor_writer->_internal.stack);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_int32(az_cbor_writer* ref_cbor_writer, int32_t value)
+{
+  return az_cbor_writer_append_int64(ref_cbor_writer, value);
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_double(az_cbor_writer* ref_cbor_writer, double value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION(_az_cbor_writer_is_appending_value_valid(ref_cbor_writer));
+  // Non-finite numbers are not supported for parity with JSON, which has no way to represent them.
+  _az_PRECONDITION(_az_isfinite(value));
+
+  uint64_t bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  int32_t argument_size = 8;
+  uint8_t additional_info = _az_CBOR_ADDITIONAL_INFO_EIGHT_BYTES;
+
+  // Use single precision when it loses nothing, which is common for sensor readings. The range is
+  // checked first, since converting a double outside of the range of a float is undefined.
+  if (value >= -FLT_MAX && value <= FLT_MAX)
+  {
+    float const single = (float)value;
+    double const widened = single;
+    uint64_t widened_bits = 0;
+    memcpy(&widened_bits, &widened, sizeof(widened_bits));
+
+    if (widened_bits == bits)
+    {
+      uint32_t single_bits = 0;
+      memcpy(&single_bits, &single, sizeof(single_bits));
+      bits = single_bits;
+      argument_size = 4;
+      additional_info = _az_CBOR_ADDITIONAL_INFO_FOUR_BYTES;
+    }
+  }
+
+  int32_t const required_size = argument_size + 1;
+
+  az_span remaining = _az_cbor_writer_get_remaining_span(ref_cbor_writer, required_size);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining, required_size);
+
+  _az_cbor_write_head(
+      az_span_ptr(remaining),
+      _az_CBOR_MAJOR_TYPE_SIMPLE_AND_FLOAT,
+      additional_info,
+      bits,
+      argument_size);
+
+  ref_cbor_writer->_internal.bytes_written += required_size;
+  ref_cbor_writer->total_bytes_written += required_size;
+  ref_cbor_writer->_internal.token_kind = AZ_CBOR_TOKEN_FLOAT;
+  _az_cbor_stack_count_item(&ref_cbor_writer->_internal.stack);
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result
+_az_cbor_writer_append_container_start(az_cbor_writer* ref_cbor_writer, bool is_object)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION(_az_cbor_writer_is_appending_value_valid(ref_cbor_writer));
+
+  // The current depth is equal to or larger than the maximum allowed depth, so we can't write
+  // the next start of an object or array.
+  if (ref_cbor_writer->_internal.stack._internal.current_depth >= _az_MAX_CBOR_STACK_SIZE)
+  {
+    return AZ_ERROR_CBOR_NESTING_OVERFLOW;
+  }
+
+  uint8_t const major_type = is_object ? _az_CBOR_MAJOR_TYPE_MAP : _az_CBOR_MAJOR_TYPE_ARRAY;
+  _az_RETURN_IF_FAILED(_az_cbor_writer_append_byte(
+      ref_cbor_writer,
+      (uint8_t)((major_type << 5U) | _az_CBOR_ADDITIONAL_INFO_INDEFINITE),
+      is_object ? AZ_CBOR_TOKEN_BEGIN_OBJECT : AZ_CBOR_TOKEN_BEGIN_ARRAY));
+
+  // The container counts as an item within its parent once it ends.
+  _az_cbor_stack_push(&ref_cbor_writer->_internal.stack, is_object, -1);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_begin_object(az_cbor_writer* ref_cbor_writer)
+{
+  return _az_cbor_writer_append_container_start(ref_cbor_writer, true);
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_begin_array(az_cbor_writer* ref_cbor_writer)
+{
+  return _az_cbor_writer_append_container_start(ref_cbor_writer, false);
+}
+
+static AZ_NODISCARD az_result
+_az_cbor_writer_append_container_end(az_cbor_writer* ref_cbor_writer, bool is_object)
+{
+  _az_PRECONDITION_NOT_NULL(ref_cbor_writer);
+  _az_PRECONDITION(_az_cbor_writer_is_appending_container_end_valid(ref_cbor_writer, is_object));
+
+  _az_RETURN_IF_FAILED(_az_cbor_writer_append_byte(
+      ref_cbor_writer,
+      _az_CBOR_BREAK,
+      is_object ? AZ_CBOR_TOKEN_END_OBJECT : AZ_CBOR_TOKEN_END_ARRAY));
+
+  _az_cbor_stack_pop(&ref_cbor_writer->_internal.stack);
+  _az_cbor_stack_count_item(&ref_cbor_writer->_internal.stack);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_end_object(az_cbor_writer* ref_cbor_writer)
+{
+  return _az_cbor_writer_append_container_end(ref_cbor_writer, true);
+}
+
+AZ_NODISCARD az_result az_cbor_writer_append_end_array(az_cbor_writer* ref_cbor_writer)
+{
+  return _az_cbor_writer_append_container_end(ref_cbor_writer, false);
+}
@@ -138,6 +138,23 @@ AZ_NODISCARD AZ_INLINE bool _az_is_valid_escaped_character(uint8_t byte)
   }
 }
 
+// Returns the length of the JSON string within the az_span after it has been escaped.
+AZ_NODISCARD int32_t _az_json_writer_escaped_length(
+    az_span value,
+    int32_t* out_index_of_first_escaped_char,
+    bool break_on_first_escaped);
+
+// Escapes and copies the source into the destination, which must be large enough to hold the
+// escaped result, returning the remainder of the destination.
+AZ_NODISCARD az_span _az_json_writer_escape_and_copy(az_span destination, az_span source);
+
+// Updates the JSON writer state as if a value of the given kind was appended, writing only the
+// comma separator if needed, and returns the offset within the destination where the value goes.
+AZ_NODISCARD az_result _az_json_writer_append_placeholder(
+    az_json_writer* ref_json_writer,
+    az_json_token_kind token_kind,
+    int32_t* out_offset);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_SPAN_PRIVATE_H
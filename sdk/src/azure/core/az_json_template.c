@@ -0,0 +1,349 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_json_private.h"
+#include "az_span_private.h"
+#include <azure/core/az_json.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+AZ_NODISCARD az_result az_json_template_init(
+    az_json_template* out_json_template,
+    az_json_template_slot* slots,
+    int32_t slots_capacity)
+{
+  _az_PRECONDITION_NOT_NULL(out_json_template);
+  _az_PRECONDITION(slots_capacity >= 0);
+  _az_PRECONDITION(slots_capacity == 0 || slots != NULL);
+
+  *out_json_template = (az_json_template){
+    ._internal = {
+      .json = AZ_SPAN_EMPTY,
+      .slots = slots,
+      .slots_capacity = slots_capacity,
+      .slot_count = 0,
+    },
+  };
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result _az_json_template_add_slot(
+    az_json_template* ref_json_template,
+    az_json_template_slot_kind kind,
+    int32_t offset,
+    int32_t placeholder_size)
+{
+  if (ref_json_template->_internal.slot_count >= ref_json_template->_internal.slots_capacity)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  ref_json_template->_internal.slots[ref_json_template->_internal.slot_count]
+      = (az_json_template_slot){
+          ._internal = {
+            .kind = kind,
+            .offset = offset,
+            .placeholder_size = placeholder_size,
+          },
+        };
+  ref_json_template->_internal.slot_count++;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_template_append_slot(
+    az_json_template* ref_json_template,
+    az_json_writer* ref_json_writer,
+    az_json_template_slot_kind kind)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_template);
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_RANGE(AZ_JSON_TEMPLATE_SLOT_INT32, kind, AZ_JSON_TEMPLATE_SLOT_BOOL);
+
+  if (ref_json_template->_internal.slot_count >= ref_json_template->_internal.slots_capacity)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  az_json_token_kind token_kind = AZ_JSON_TOKEN_NUMBER;
+  if (kind == AZ_JSON_TEMPLATE_SLOT_STRING)
+  {
+    token_kind = AZ_JSON_TOKEN_STRING;
+  }
+  else if (kind == AZ_JSON_TEMPLATE_SLOT_BOOL)
+  {
+    token_kind = AZ_JSON_TOKEN_TRUE;
+  }
+
+  int32_t offset = 0;
+  _az_RETURN_IF_FAILED(_az_json_writer_append_placeholder(ref_json_writer, token_kind, &offset));
+
+  // Slots recorded from a writer session don't take up any space within the fixed JSON text.
+  return _az_json_template_add_slot(ref_json_template, kind, offset, 0);
+}
+
+AZ_NODISCARD az_result
+az_json_template_complete(az_json_template* ref_json_template, az_json_writer const* json_writer)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_template);
+  _az_PRECONDITION_NOT_NULL(json_writer);
+  // The template must be a complete JSON document, with all objects and arrays closed.
+  _az_PRECONDITION(json_writer->_internal.bit_stack._internal.current_depth == 0);
+  _az_PRECONDITION(json_writer->_internal.token_kind != AZ_JSON_TOKEN_NONE);
+
+  ref_json_template->_internal.json = az_json_writer_get_bytes_used_in_destination(json_writer);
+  return AZ_OK;
+}
+
+static AZ_NODISCARD bool
+_az_json_template_is_placeholder(az_span token_slice, az_json_template_slot_kind* out_kind)
+{
+  if (az_span_is_content_equal(token_slice, AZ_SPAN_FROM_STR("${int32}")))
+  {
+    *out_kind = AZ_JSON_TEMPLATE_SLOT_INT32;
+  }
+  else if (az_span_is_content_equal(token_slice, AZ_SPAN_FROM_STR("${double}")))
+  {
+    *out_kind = AZ_JSON_TEMPLATE_SLOT_DOUBLE;
+  }
+  else if (az_span_is_content_equal(token_slice, AZ_SPAN_FROM_STR("${string}")))
+  {
+    *out_kind = AZ_JSON_TEMPLATE_SLOT_STRING;
+  }
+  else if (az_span_is_content_equal(token_slice, AZ_SPAN_FROM_STR("${bool}")))
+  {
+    *out_kind = AZ_JSON_TEMPLATE_SLOT_BOOL;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+AZ_NODISCARD az_result az_json_template_init_from_json(
+    az_json_template* out_json_template,
+    az_span json_text,
+    az_json_template_slot* slots,
+    int32_t slots_capacity)
+{
+  _az_PRECONDITION_VALID_SPAN(json_text, 1, false);
+
+  _az_RETURN_IF_FAILED(az_json_template_init(out_json_template, slots, slots_capacity));
+
+  az_json_reader reader = { 0 };
+  _az_RETURN_IF_FAILED(az_json_reader_init(&reader, json_text, NULL));
+
+  az_result result = AZ_OK;
+  while (az_result_succeeded(result = az_json_reader_next_token(&reader)))
+  {
+    az_json_template_slot_kind kind = AZ_JSON_TEMPLATE_SLOT_INT32;
+    if (reader.token.kind == AZ_JSON_TOKEN_STRING
+        && !reader.token._internal.string_has_escaped_chars
+        && _az_json_template_is_placeholder(reader.token.slice, &kind))
+    {
+      // The token slice excludes the quotes, which are part of the placeholder to be replaced, so
+      // back up to the opening quote.
+      int32_t const offset
+          = (int32_t)(az_span_ptr(reader.token.slice) - az_span_ptr(json_text)) - 1;
+      _az_RETURN_IF_FAILED(_az_json_template_add_slot(
+          out_json_template, kind, offset, az_span_size(reader.token.slice) + 2));
+    }
+  }
+
+  // Make sure the entire JSON text was read and it isn't incomplete.
+  if (result != AZ_ERROR_JSON_READER_DONE)
+  {
+    return result;
+  }
+
+  out_json_template->_internal.json = json_text;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_template_writer_init(
+    az_json_template_writer* out_template_writer,
+    az_json_template const* json_template,
+    az_span destination_buffer)
+{
+  _az_PRECONDITION_NOT_NULL(out_template_writer);
+  _az_PRECONDITION_NOT_NULL(json_template);
+  _az_PRECONDITION_VALID_SPAN(json_template->_internal.json, 1, false);
+
+  *out_template_writer = (az_json_template_writer){
+    ._internal = {
+      .json_template = json_template,
+      .destination_buffer = destination_buffer,
+      .bytes_written = 0,
+      .json_offset = 0,
+      .slot_index = 0,
+    },
+  };
+  return AZ_OK;
+}
+
+// Copies the fixed JSON text leading up to the next slot, which must be of the expected kind, and
+// returns the remaining destination after it, with at least value_max_size bytes available.
+static AZ_NODISCARD az_result _az_json_template_writer_begin_slot(
+    az_json_template_writer* ref_template_writer,
+    az_json_template_slot_kind kind,
+    int32_t value_max_size,
+    az_span* out_remaining)
+{
+  _az_PRECONDITION_NOT_NULL(ref_template_writer);
+
+  az_json_template const* json_template = ref_template_writer->_internal.json_template;
+  int32_t const slot_index = ref_template_writer->_internal.slot_index;
+
+  // Slots must be filled in order, with values of the kind they were recorded with.
+  _az_PRECONDITION(slot_index < json_template->_internal.slot_count);
+  _az_PRECONDITION(json_template->_internal.slots[slot_index]._internal.kind == kind);
+  (void)kind;
+
+  az_json_template_slot const* slot = &json_template->_internal.slots[slot_index];
+  az_span const fixed_json = az_span_slice(
+      json_template->_internal.json,
+      ref_template_writer->_internal.json_offset,
+      slot->_internal.offset);
+
+  az_span remaining = az_span_slice_to_end(
+      ref_template_writer->_internal.destination_buffer,
+      ref_template_writer->_internal.bytes_written);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining, az_span_size(fixed_json) + value_max_size);
+
+  *out_remaining = az_span_copy(remaining, fixed_json);
+  return AZ_OK;
+}
+
+// Moves past the fixed JSON text and the slot that was just filled, having written value_size
+// bytes for it. Nothing is committed until then, so a failed append can safely be retried.
+AZ_INLINE void
+_az_json_template_writer_end_slot(az_json_template_writer* ref_template_writer, int32_t value_size)
+{
+  az_json_template_slot const* slot
+      = &ref_template_writer->_internal.json_template->_internal
+             .slots[ref_template_writer->_internal.slot_index];
+
+  ref_template_writer->_internal.bytes_written
+      += slot->_internal.offset - ref_template_writer->_internal.json_offset + value_size;
+  ref_template_writer->_internal.json_offset
+      = slot->_internal.offset + slot->_internal.placeholder_size;
+  ref_template_writer->_internal.slot_index++;
+}
+
+AZ_NODISCARD az_result
+az_json_template_writer_append_int32(az_json_template_writer* ref_template_writer, int32_t value)
+{
+  az_span remaining = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_json_template_writer_begin_slot(
+      ref_template_writer, AZ_JSON_TEMPLATE_SLOT_INT32, 0, &remaining));
+
+  az_span leftover;
+  _az_RETURN_IF_FAILED(az_span_i32toa(remaining, value, &leftover));
+
+  _az_json_template_writer_end_slot(ref_template_writer, _az_span_diff(leftover, remaining));
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_template_writer_append_double(
+    az_json_template_writer* ref_template_writer,
+    double value,
+    int32_t fractional_digits)
+{
+  // Non-finite numbers are not supported because they lead to invalid JSON.
+  _az_PRECONDITION(_az_isfinite(value));
+  _az_PRECONDITION_RANGE(0, fractional_digits, _az_MAX_SUPPORTED_FRACTIONAL_DIGITS);
+
+  az_span remaining = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_json_template_writer_begin_slot(
+      ref_template_writer, AZ_JSON_TEMPLATE_SLOT_DOUBLE, 0, &remaining));
+
+  az_span leftover;
+  _az_RETURN_IF_FAILED(az_span_dtoa(remaining, value, fractional_digits, &leftover));
+
+  _az_json_template_writer_end_slot(ref_template_writer, _az_span_diff(leftover, remaining));
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_json_template_writer_append_string(az_json_template_writer* ref_template_writer, az_span value)
+{
+  // An empty span is allowed, and we write an empty JSON string for it.
+  _az_PRECONDITION_VALID_SPAN(value, 0, true);
+  _az_PRECONDITION(az_span_size(value) <= _az_MAX_UNESCAPED_STRING_SIZE);
+
+  int32_t index_of_first_escaped_char = -1;
+  int32_t const required_size
+      = _az_json_writer_escaped_length(value, &index_of_first_escaped_char, false)
+      + 2; // For the surrounding quotes.
+
+  az_span remaining = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_json_template_writer_begin_slot(
+      ref_template_writer, AZ_JSON_TEMPLATE_SLOT_STRING, required_size, &remaining));
+
+  remaining = az_span_copy_u8(remaining, '"');
+
+  if (index_of_first_escaped_char == -1)
+  {
+    remaining = az_span_copy(remaining, value);
+  }
+  else
+  {
+    remaining = az_span_copy(remaining, az_span_slice(value, 0, index_of_first_escaped_char));
+    remaining = _az_json_writer_escape_and_copy(
+        remaining, az_span_slice_to_end(value, index_of_first_escaped_char));
+  }
+
+  az_span_copy_u8(remaining, '"');
+
+  _az_json_template_writer_end_slot(ref_template_writer, required_size);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_json_template_writer_append_bool(az_json_template_writer* ref_template_writer, bool value)
+{
+  az_span const literal = value ? AZ_SPAN_FROM_STR("true") : AZ_SPAN_FROM_STR("false");
+
+  az_span remaining = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_json_template_writer_begin_slot(
+      ref_template_writer, AZ_JSON_TEMPLATE_SLOT_BOOL, az_span_size(literal), &remaining));
+
+  az_span_copy(remaining, literal);
+
+  _az_json_template_writer_end_slot(ref_template_writer, az_span_size(literal));
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_template_writer_complete(
+    az_json_template_writer* ref_template_writer,
+    az_span* out_json_text)
+{
+  _az_PRECONDITION_NOT_NULL(ref_template_writer);
+  _az_PRECONDITION_NOT_NULL(out_json_text);
+
+  az_json_template const* json_template = ref_template_writer->_internal.json_template;
+
+  // All the slots must have been filled.
+  _az_PRECONDITION(
+      ref_template_writer->_internal.slot_index == json_template->_internal.slot_count);
+
+  az_span const fixed_json = az_span_slice_to_end(
+      json_template->_internal.json, ref_template_writer->_internal.json_offset);
+
+  az_span remaining = az_span_slice_to_end(
+      ref_template_writer->_internal.destination_buffer,
+      ref_template_writer->_internal.bytes_written);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining, az_span_size(fixed_json));
+
+  az_span_copy(remaining, fixed_json);
+  ref_template_writer->_internal.bytes_written += az_span_size(fixed_json);
+
+  *out_json_text = az_span_slice(
+      ref_template_writer->_internal.destination_buffer,
+      0,
+      ref_template_writer->_internal.bytes_written);
+  return AZ_OK;
+}
@@ -10,21 +10,57 @@
 #include "az_span_private.h"
 #include <azure/core/_az_cfg.h>
 
-static az_span _az_json_token_copy_into_span_helper(
-    az_json_token const* json_token,
-    az_span destination)
+AZ_NODISCARD static az_json_token_segment_iterator
+_az_json_token_segment_iterator_create(az_json_token const* json_token)
 {
-  _az_PRECONDITION(json_token->_internal.is_multisegment);
+  return (az_json_token_segment_iterator){
+    ._internal = {
+      .json_token = json_token,
+      .next_buffer_index
+      = json_token->_internal.is_multisegment ? json_token->_internal.start_buffer_index : 0,
+    },
+  };
+}
 
-  if (json_token->size == 0)
+AZ_NODISCARD az_result az_json_token_segment_iterator_init(
+    az_json_token_segment_iterator* out_iterator,
+    az_json_token const* json_token)
+{
+  _az_PRECONDITION_NOT_NULL(out_iterator);
+  _az_PRECONDITION_NOT_NULL(json_token);
+
+  *out_iterator = _az_json_token_segment_iterator_create(json_token);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_token_segment_iterator_next(
+    az_json_token_segment_iterator* ref_iterator,
+    az_span* out_segment)
+{
+  _az_PRECONDITION_NOT_NULL(ref_iterator);
+  _az_PRECONDITION_NOT_NULL(out_segment);
+
+  az_json_token const* json_token = ref_iterator->_internal.json_token;
+
+  // Contiguous token
+  if (!json_token->_internal.is_multisegment)
   {
-    return destination;
+    if (ref_iterator->_internal.next_buffer_index != 0 || az_span_size(json_token->slice) == 0)
+    {
+      return AZ_ERROR_ITEM_NOT_FOUND;
+    }
+
+    ref_iterator->_internal.next_buffer_index = 1;
+    *out_segment = json_token->slice;
+    return AZ_OK;
   }
 
-  for (int32_t i = json_token->_internal.start_buffer_index;
-       i <= json_token->_internal.end_buffer_index;
-       i++)
+  // Token straddles more than one segment. The first and last segments can be empty when the token
+  // starts or ends exactly on a buffer boundary, so skip over those.
+  while (ref_iterator->_internal.next_buffer_index <= json_token->_internal.end_buffer_index)
   {
+    int32_t const i = ref_iterator->_internal.next_buffer_index++;
+
     az_span source = json_token->_internal.pointer_to_first_buffer[i];
     if (i == json_token->_internal.start_buffer_index)
     {
@@ -34,6 +70,33 @@ static az_span _az_json_token_copy_into_span_helper(
     {
       source = az_span_slice(source, 0, json_token->_internal.end_buffer_offset);
     }
+
+    if (az_span_size(source) > 0)
+    {
+      *out_segment = source;
+      return AZ_OK;
+    }
+  }
+
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
+
+static az_span _az_json_token_copy_into_span_helper(
+    az_json_token const* json_token,
+    az_span destination)
+{
+  _az_PRECONDITION(json_token->_internal.is_multisegment);
+
+  if (json_token->size == 0)
+  {
+    return destination;
+  }
+
+  az_json_token_segment_iterator iterator = _az_json_token_segment_iterator_create(json_token);
+
+  az_span source = AZ_SPAN_EMPTY;
+  while (az_result_succeeded(az_json_token_segment_iterator_next(&iterator, &source)))
+  {
     destination = az_span_copy(destination, source);
   }
 
@@ -172,20 +235,11 @@ AZ_NODISCARD bool az_json_token_is_text_equal(
     }
 
     // Token straddles more than one segment
-    for (int32_t i = json_token->_internal.start_buffer_index;
-         i <= json_token->_internal.end_buffer_index;
-         i++)
-    {
-      az_span source = json_token->_internal.pointer_to_first_buffer[i];
-      if (i == json_token->_internal.start_buffer_index)
-      {
-        source = az_span_slice_to_end(source, json_token->_internal.start_buffer_offset);
-      }
-      else if (i == json_token->_internal.end_buffer_index)
-      {
-        source = az_span_slice(source, 0, json_token->_internal.end_buffer_offset);
-      }
+    az_json_token_segment_iterator iterator = _az_json_token_segment_iterator_create(json_token);
 
+    az_span source = AZ_SPAN_EMPTY;
+    while (az_result_succeeded(az_json_token_segment_iterator_next(&iterator, &source)))
+    {
       int32_t source_size = az_span_size(source);
       if (az_span_size(expected_text) < source_size
           || !az_span_is_content_equal(source, az_span_slice(expected_text, 0, source_size)))
@@ -217,21 +271,13 @@ AZ_NODISCARD bool az_json_token_is_text_equal(
     return _az_json_token_is_text_equal_helper(token_slice, &expected_text, &next_char_escaped);
   }
 
-  // Token straddles more than one segment
-  for (int32_t i = json_token->_internal.start_buffer_index;
-       i <= json_token->_internal.end_buffer_index;
-       i++)
-  {
-    az_span source = json_token->_internal.pointer_to_first_buffer[i];
-    if (i == json_token->_internal.start_buffer_index)
-    {
-      source = az_span_slice_to_end(source, json_token->_internal.start_buffer_offset);
-    }
-    else if (i == json_token->_internal.end_buffer_index)
-    {
-      source = az_span_slice(source, 0, json_token->_internal.end_buffer_offset);
-    }
+  // Token straddles more than one segment, and an escape sequence could be split between two
+  // consecutive segments.
+  az_json_token_segment_iterator iterator = _az_json_token_segment_iterator_create(json_token);
 
+  az_span source = AZ_SPAN_EMPTY;
+  while (az_result_succeeded(az_json_token_segment_iterator_next(&iterator, &source)))
+  {
     if (!_az_json_token_is_text_equal_helper(source, &expected_text, &next_char_escaped)
         && az_span_size(expected_text) == 0)
     {
@@ -447,20 +493,11 @@ AZ_NODISCARD az_result az_json_token_get_string(
   else
   {
     // Token straddles more than one segment
-    for (int32_t i = json_token->_internal.start_buffer_index;
-         i <= json_token->_internal.end_buffer_index;
-         i++)
-    {
-      az_span source = json_token->_internal.pointer_to_first_buffer[i];
-      if (i == json_token->_internal.start_buffer_index)
-      {
-        source = az_span_slice_to_end(source, json_token->_internal.start_buffer_offset);
-      }
-      else if (i == json_token->_internal.end_buffer_index)
-      {
-        source = az_span_slice(source, 0, json_token->_internal.end_buffer_offset);
-      }
+    az_json_token_segment_iterator iterator = _az_json_token_segment_iterator_create(json_token);
 
+    az_span source = AZ_SPAN_EMPTY;
+    while (az_result_succeeded(az_json_token_segment_iterator_next(&iterator, &source)))
+    {
       _az_RETURN_IF_FAILED(_az_json_token_get_string_helper(
           source, destination, destination_max_size, &dest_idx, &next_char_escaped));
     }
@@ -5,10 +5,12 @@
 #include "az_json_private.h"
 #include "az_span_private.h"
 #include <azure/core/az_json.h>
+#include <azure/core/internal/az_json_internal.h>
 #include <azure/core/internal/az_result_internal.h>
 #include <azure/core/internal/az_span_internal.h>
 
 #include <math.h>
+#include <string.h>
 
 #include <azure/core/_az_cfg.h>
 
@@ -29,9 +31,17 @@ AZ_NODISCARD az_result az_json_writer_init(
       .need_comma = false,
       .token_kind = AZ_JSON_TOKEN_NONE,
       .bit_stack = { 0 },
+      .max_depth = 0,
       .options = options == NULL ? az_json_writer_options_default() : *options,
     },
   };
+
+  // When only computing the size, the destination is reused as scratch space, so it needs to be
+  // large enough to hold the largest chunk the writer ever asks for at once.
+  _az_PRECONDITION(
+      !out_json_writer->_internal.options.compute_size_only
+      || az_span_size(destination_buffer) >= _az_MINIMUM_STRING_CHUNK_SIZE);
+
   return AZ_OK;
 }
 
@@ -55,6 +65,7 @@ AZ_NODISCARD az_result az_json_writer_chunked_init(
       .need_comma = false,
       .token_kind = AZ_JSON_TOKEN_NONE,
       .bit_stack = { 0 },
+      .max_depth = 0,
       .options = options == NULL ? az_json_writer_options_default() : *options,
     },
   };
@@ -70,6 +81,14 @@ _get_remaining_span(az_json_writer* ref_json_writer, int32_t required_size)
   az_span remaining = az_span_slice_to_end(
       ref_json_writer->_internal.destination_buffer, ref_json_writer->_internal.bytes_written);
 
+  if (az_span_size(remaining) < required_size
+      && ref_json_writer->_internal.options.compute_size_only)
+  {
+    // Only the total number of bytes matters, so overwrite the scratch destination from the start.
+    ref_json_writer->_internal.bytes_written = 0;
+    return ref_json_writer->_internal.destination_buffer;
+  }
+
   if (az_span_size(remaining) < required_size
       && ref_json_writer->_internal.allocator_callback != NULL)
   {
@@ -91,6 +110,162 @@ _get_remaining_span(az_json_writer* ref_json_writer, int32_t required_size)
   return remaining;
 }
 
+AZ_NODISCARD az_result az_json_writer_buffer_pool_init(
+    az_json_writer_buffer_pool* out_buffer_pool,
+    az_span* buffers,
+    int32_t buffer_count,
+    az_json_writer_flush_fn flush_callback,
+    az_json_writer_wait_fn wait_callback,
+    void* user_context)
+{
+  _az_PRECONDITION_NOT_NULL(out_buffer_pool);
+  _az_PRECONDITION_NOT_NULL(buffers);
+  // Whether each buffer is in flight is tracked as a bit within a uint32_t.
+  _az_PRECONDITION_RANGE(1, buffer_count, (int32_t)sizeof(uint32_t) * 8);
+  _az_PRECONDITION_NOT_NULL(flush_callback);
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  for (int32_t i = 0; i < buffer_count; i++)
+  {
+    // Each buffer needs to be able to hold the largest chunk the writer ever asks for at once.
+    _az_PRECONDITION_VALID_SPAN(buffers[i], _az_MINIMUM_STRING_CHUNK_SIZE, false);
+  }
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+  *out_buffer_pool = (az_json_writer_buffer_pool){
+    ._internal = {
+      .buffers = buffers,
+      .buffer_count = buffer_count,
+      .current_index = buffer_count - 1,
+      .buffers_in_flight = 0,
+      .flush_callback = flush_callback,
+      .wait_callback = wait_callback,
+      .user_context = user_context,
+    },
+  };
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_writer_buffer_pool_release(
+    az_json_writer_buffer_pool* ref_buffer_pool,
+    int32_t buffer_index)
+{
+  _az_PRECONDITION_NOT_NULL(ref_buffer_pool);
+  _az_PRECONDITION_RANGE(0, buffer_index, ref_buffer_pool->_internal.buffer_count - 1);
+  _az_PRECONDITION((ref_buffer_pool->_internal.buffers_in_flight & (1U << buffer_index)) != 0);
+
+  ref_buffer_pool->_internal.buffers_in_flight &= ~(1U << buffer_index);
+  return AZ_OK;
+}
+
+AZ_NODISCARD int32_t
+az_json_writer_buffer_pool_get_in_flight_count(az_json_writer_buffer_pool const* buffer_pool)
+{
+  _az_PRECONDITION_NOT_NULL(buffer_pool);
+
+  int32_t count = 0;
+  for (uint32_t in_flight = buffer_pool->_internal.buffers_in_flight; in_flight != 0;
+       in_flight &= in_flight - 1)
+  {
+    count++;
+  }
+  return count;
+}
+
+// Hands the bytes used within the current buffer over to the flush callback, leaving it in flight
+// only if the callback took it.
+static AZ_NODISCARD az_result
+_az_json_writer_buffer_pool_flush(az_json_writer_buffer_pool* ref_buffer_pool, int32_t bytes_used)
+{
+  if (bytes_used == 0)
+  {
+    return AZ_OK;
+  }
+
+  // The buffer is marked in flight during the callback, so that the callback may already release
+  // it, such as once it sent the chunk synchronously.
+  int32_t const index = ref_buffer_pool->_internal.current_index;
+  ref_buffer_pool->_internal.buffers_in_flight |= 1U << index;
+
+  az_json_writer_flush_context flush_context = {
+    .user_context = ref_buffer_pool->_internal.user_context,
+    .chunk = az_span_slice(ref_buffer_pool->_internal.buffers[index], 0, bytes_used),
+    .buffer_index = index,
+  };
+  az_result const result = ref_buffer_pool->_internal.flush_callback(&flush_context);
+  if (az_result_failed(result))
+  {
+    // The application didn't take the chunk, so nothing will release the buffer.
+    ref_buffer_pool->_internal.buffers_in_flight &= ~(1U << index);
+  }
+  return result;
+}
+
+// Flushes the current buffer and moves on to the next free one, in round-robin order, waiting for
+// one to be released only when all of them are in flight.
+static AZ_NODISCARD az_result _az_json_writer_buffer_pool_allocator(
+    az_span_allocator_context* allocator_context,
+    az_span* out_next_destination)
+{
+  az_json_writer_buffer_pool* pool = (az_json_writer_buffer_pool*)allocator_context->user_context;
+
+  _az_RETURN_IF_FAILED(_az_json_writer_buffer_pool_flush(pool, allocator_context->bytes_used));
+
+  int32_t const buffer_count = pool->_internal.buffer_count;
+  while (true)
+  {
+    for (int32_t i = 1; i <= buffer_count; i++)
+    {
+      int32_t const index = (pool->_internal.current_index + i) % buffer_count;
+      if ((pool->_internal.buffers_in_flight & (1U << index)) == 0)
+      {
+        pool->_internal.current_index = index;
+        *out_next_destination = pool->_internal.buffers[index];
+        return AZ_OK;
+      }
+    }
+
+    // All the buffers are in flight, so apply back-pressure.
+    if (pool->_internal.wait_callback == NULL)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+    _az_RETURN_IF_FAILED(pool->_internal.wait_callback(pool->_internal.user_context));
+  }
+}
+
+AZ_NODISCARD az_result az_json_writer_buffered_init(
+    az_json_writer* out_json_writer,
+    az_json_writer_buffer_pool* ref_buffer_pool,
+    az_json_writer_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(ref_buffer_pool);
+
+  // Start with an empty destination, so that the first free buffer is picked up on the first write.
+  return az_json_writer_chunked_init(
+      out_json_writer,
+      AZ_SPAN_EMPTY,
+      _az_json_writer_buffer_pool_allocator,
+      ref_buffer_pool,
+      options);
+}
+
+AZ_NODISCARD az_result az_json_writer_buffered_flush(az_json_writer* ref_json_writer)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION(
+      ref_json_writer->_internal.allocator_callback == _az_json_writer_buffer_pool_allocator);
+
+  _az_RETURN_IF_FAILED(_az_json_writer_buffer_pool_flush(
+      (az_json_writer_buffer_pool*)ref_json_writer->_internal.user_context,
+      ref_json_writer->_internal.bytes_written));
+
+  // The flushed buffer is in flight now, so the next write moves on to the next free buffer.
+  ref_json_writer->_internal.destination_buffer = AZ_SPAN_EMPTY;
+  ref_json_writer->_internal.bytes_written = 0;
+  return AZ_OK;
+}
+
 // This validation method is used outside of just preconditions, within
 // az_json_writer_append_json_text.
 static AZ_NODISCARD bool _az_is_appending_value_valid(az_json_writer const* json_writer)
@@ -199,12 +374,65 @@ static AZ_NODISCARD bool _az_is_appending_container_end_valid(
 }
 #endif // AZ_NO_PRECONDITION_CHECKING
 
+// Broadcasts a byte value into each of the 8 bytes of a uint64_t, for word-at-a-time scanning.
+#define _az_JSON_WORD_FROM_BYTE(byte) ((uint64_t)(byte)*UINT64_C(0x0101010101010101))
+
+AZ_NODISCARD AZ_INLINE bool _az_json_writer_byte_needs_escaping(uint8_t byte)
+{
+  // The two-character escape sequences for \b, \f, \n, \r, and \t are all control characters too.
+  return byte < _az_ASCII_SPACE_CHARACTER || byte == '"' || byte == '\\';
+}
+
+// Returns true if any of the 8 bytes packed within the word needs to be escaped.
+// A byte is less than N when subtracting N from it borrows into its high bit, and a byte is zero
+// (i.e. matches after the XOR) when subtracting 1 from it does the same. Masking with ~word drops
+// the bytes that already had their high bit set. Each of these checks is exact for whether any
+// byte within the word matches, even though the individual bit positions may not be.
+AZ_NODISCARD AZ_INLINE bool _az_json_writer_word_needs_escaping(uint64_t word)
+{
+  uint64_t const quotes = word ^ _az_JSON_WORD_FROM_BYTE('"');
+  uint64_t const back_slashes = word ^ _az_JSON_WORD_FROM_BYTE('\\');
+
+  uint64_t const control_chars
+      = (word - _az_JSON_WORD_FROM_BYTE(_az_ASCII_SPACE_CHARACTER)) & ~word;
+  uint64_t const quote_chars = (quotes - _az_JSON_WORD_FROM_BYTE(1)) & ~quotes;
+  uint64_t const back_slash_chars = (back_slashes - _az_JSON_WORD_FROM_BYTE(1)) & ~back_slashes;
+
+  return ((control_chars | quote_chars | back_slash_chars) & _az_JSON_WORD_FROM_BYTE(0x80)) != 0;
+}
+
+// Returns the number of leading bytes that can be copied as is, without needing to be escaped.
+// Most JSON strings are plain text, so skip over 8 bytes at a time and only drop down to checking
+// one byte at a time within the word that contains a character to escape, or at the tail end.
+AZ_NODISCARD static int32_t
+_az_json_writer_unescaped_prefix_length(uint8_t const* ptr, int32_t size)
+{
+  int32_t i = 0;
+
+  for (; i <= size - (int32_t)sizeof(uint64_t); i += (int32_t)sizeof(uint64_t))
+  {
+    uint64_t word = 0;
+    memcpy(&word, ptr + i, sizeof(word)); // The input isn't necessarily aligned.
+    if (_az_json_writer_word_needs_escaping(word))
+    {
+      break;
+    }
+  }
+
+  while (i < size && !_az_json_writer_byte_needs_escaping(ptr[i]))
+  {
+    i++;
+  }
+
+  return i;
+}
+
 // Returns the length of the JSON string within the az_span after it has been escaped.
 // The out parameter contains the index where the first character to escape is found.
 // If no chars need to be escaped then return the size of value with the out parameter set to -1.
 // If break_on_first_escaped is set to true, then it returns as soon as the first character to
 // escape is found.
-static int32_t _az_json_writer_escaped_length(
+AZ_NODISCARD int32_t _az_json_writer_escaped_length(
     az_span value,
     int32_t* out_index_of_first_escaped_char,
     bool break_on_first_escaped)
@@ -223,9 +451,18 @@ static int32_t _az_json_writer_escaped_length(
 
   while (i < value_size)
   {
-    uint8_t const ch = value_ptr[i];
+    // Skip over the run of characters that don't need to be escaped, in bulk.
+    int32_t const unescaped_length
+        = _az_json_writer_unescaped_prefix_length(value_ptr + i, value_size - i);
+    i += unescaped_length;
+    escaped_length += unescaped_length;
+
+    if (i >= value_size)
+    {
+      break;
+    }
 
-    switch (ch)
+    switch (value_ptr[i])
     {
       case '\\':
       case '"':
@@ -240,33 +477,26 @@ static int32_t _az_json_writer_escaped_length(
       }
       default:
       {
-        // Check if the character has to be escaped as a UNICODE escape sequence.
-        if (ch < _az_ASCII_SPACE_CHARACTER)
-        {
-          escaped_length += _az_MAX_EXPANSION_FACTOR_WHILE_ESCAPING;
-        }
-        else
-        {
-          escaped_length++; // No escaping required.
-        }
+        // All other characters that need escaping are control characters, which are escaped as a
+        // UNICODE escape sequence.
+        escaped_length += _az_MAX_EXPANSION_FACTOR_WHILE_ESCAPING;
         break;
       }
     }
 
-    i++;
-
     // If this is the first time that we found a character that needs to be escaped,
     // set out_index_of_first_escaped_char to the corresponding index.
-    // If escaped_length == i, then we haven't found a character that needs to be escaped yet.
-    if (escaped_length != i && *out_index_of_first_escaped_char == -1)
+    if (*out_index_of_first_escaped_char == -1)
     {
-      *out_index_of_first_escaped_char = i - 1;
+      *out_index_of_first_escaped_char = i;
       if (break_on_first_escaped)
       {
         break;
       }
     }
 
+    i++;
+
     // If the length overflows, in case the precondition is not honored, stop processing and break
     // The caller will return AZ_ERROR_NOT_ENOUGH_SPACE since az_span can't contain it.
     // TODO: Consider removing this if it is too costly.
@@ -360,7 +590,7 @@ static int32_t _az_json_writer_escape_next_byte_and_copy(
   return written;
 }
 
-static AZ_NODISCARD az_span _az_json_writer_escape_and_copy(az_span destination, az_span source)
+AZ_NODISCARD az_span _az_json_writer_escape_and_copy(az_span destination, az_span source)
 {
   _az_PRECONDITION_VALID_SPAN(source, 1, false);
 
@@ -375,9 +605,19 @@ static AZ_NODISCARD az_span _az_json_writer_escape_and_copy(az_span destination,
 
   while (i < src_size)
   {
-    uint8_t const ch = value_ptr[i];
-    _az_json_writer_escape_next_byte_and_copy(&remaining_destination, ch);
-    i++;
+    // Bulk copy the characters that don't need to be escaped, only dropping to the byte-by-byte
+    // encode and copy for the ones that do.
+    int32_t const unescaped_length
+        = _az_json_writer_unescaped_prefix_length(value_ptr + i, src_size - i);
+    remaining_destination
+        = az_span_copy(remaining_destination, az_span_slice(source, i, i + unescaped_length));
+    i += unescaped_length;
+
+    if (i < src_size)
+    {
+      _az_json_writer_escape_next_byte_and_copy(&remaining_destination, value_ptr[i]);
+      i++;
+    }
   }
 
   return remaining_destination;
@@ -500,11 +740,11 @@ az_json_writer_append_string_chunked(az_json_writer* ref_json_writer, az_span va
   do
   {
     az_span value_slice = az_span_slice_to_end(value, consumed);
-    int32_t index_of_first_escaped_char = -1;
-    _az_json_writer_escaped_length(value_slice, &index_of_first_escaped_char, true);
+    int32_t const index_of_first_escaped_char = _az_json_writer_unescaped_prefix_length(
+        az_span_ptr(value_slice), az_span_size(value_slice));
 
     // No character needed to be escaped, copy the whole string as is.
-    if (index_of_first_escaped_char == -1)
+    if (index_of_first_escaped_char == az_span_size(value_slice))
     {
       _az_RETURN_IF_FAILED(
           az_json_writer_span_copy_chunked(ref_json_writer, &remaining_json, value_slice));
@@ -642,11 +882,11 @@ az_json_writer_append_property_name_chunked(az_json_writer* ref_json_writer, az_
   do
   {
     az_span value_slice = az_span_slice_to_end(value, consumed);
-    int32_t index_of_first_escaped_char = -1;
-    _az_json_writer_escaped_length(value_slice, &index_of_first_escaped_char, true);
+    int32_t const index_of_first_escaped_char = _az_json_writer_unescaped_prefix_length(
+        az_span_ptr(value_slice), az_span_size(value_slice));
 
     // No character needed to be escaped, copy the whole string as is.
-    if (index_of_first_escaped_char == -1)
+    if (index_of_first_escaped_char == az_span_size(value_slice))
     {
       _az_RETURN_IF_FAILED(
           az_json_writer_span_copy_chunked(ref_json_writer, &remaining_json, value_slice));
@@ -717,9 +957,11 @@ az_json_writer_append_property_name(az_json_writer* ref_json_writer, az_span nam
 static AZ_NODISCARD az_result _az_validate_json(
     az_span json_text,
     az_json_token_kind* first_token_kind,
-    az_json_token_kind* last_token_kind)
+    az_json_token_kind* last_token_kind,
+    int32_t* out_max_depth)
 {
   _az_PRECONDITION_NOT_NULL(first_token_kind);
+  _az_PRECONDITION_NOT_NULL(out_max_depth);
 
   az_json_reader reader = { 0 };
   _az_RETURN_IF_FAILED(az_json_reader_init(&reader, json_text, NULL));
@@ -730,11 +972,16 @@ static AZ_NODISCARD az_result _az_validate_json(
   // This is guaranteed not to be a property name or end object/array.
   // The first token of a valid JSON must either be a value or start object/array.
   *first_token_kind = reader.token.kind;
+  *out_max_depth = reader._internal.bit_stack._internal.current_depth;
 
   // Keep reading until we have finished validating the entire JSON text and make sure it isn't
   // incomplete.
   while (az_result_succeeded(result = az_json_reader_next_token(&reader)))
   {
+    if (reader._internal.bit_stack._internal.current_depth > *out_max_depth)
+    {
+      *out_max_depth = reader._internal.bit_stack._internal.current_depth;
+    }
   }
 
   if (result != AZ_ERROR_JSON_READER_DONE)
@@ -758,10 +1005,12 @@ az_json_writer_append_json_text(az_json_writer* ref_json_writer, az_span json_te
 
   az_json_token_kind first_token_kind = AZ_JSON_TOKEN_NONE;
   az_json_token_kind last_token_kind = AZ_JSON_TOKEN_NONE;
+  int32_t json_text_depth = 0;
 
   // This runtime validation is necessary since the input could be user defined and malformed.
   // This cannot be caught at dev time by a precondition, especially since they can be turned off.
-  _az_RETURN_IF_FAILED(_az_validate_json(json_text, &first_token_kind, &last_token_kind));
+  _az_RETURN_IF_FAILED(
+      _az_validate_json(json_text, &first_token_kind, &last_token_kind, &json_text_depth));
 
   // It is guaranteed that first_token_kind is NOT:
   // AZ_JSON_TOKEN_NONE, AZ_JSON_TOKEN_END_ARRAY, AZ_JSON_TOKEN_END_OBJECT,
@@ -802,6 +1051,13 @@ az_json_writer_append_json_text(az_json_writer* ref_json_writer, az_span json_te
 
   // We already tracked and updated bytes_written while writing, so no need to update it here.
   _az_update_json_writer_state(ref_json_writer, 0, required_size, true, last_token_kind);
+
+  int32_t const depth
+      = ref_json_writer->_internal.bit_stack._internal.current_depth + json_text_depth;
+  if (depth > ref_json_writer->_internal.max_depth)
+  {
+    ref_json_writer->_internal.max_depth = depth;
+  }
   return AZ_OK;
 }
 
@@ -929,6 +1185,345 @@ AZ_NODISCARD az_result az_json_writer_append_double(
   return AZ_OK;
 }
 
+// The largest integer part of a double that az_span_dtoa can write.
+#define _az_JSON_MAX_SAFE_INTEGER 9007199254740991
+
+// Writes a double as az_span_dtoa does, or in exponent form, with a single digit before the
+// decimal point, when its integer part is too large for az_span_dtoa.
+static AZ_NODISCARD az_result _az_json_writer_dtoa(
+    az_span destination,
+    double value,
+    int32_t fractional_digits,
+    az_span* out_span)
+{
+  if (!_az_isfinite(value)
+      || (value >= -_az_JSON_MAX_SAFE_INTEGER && value <= _az_JSON_MAX_SAFE_INTEGER))
+  {
+    return az_span_dtoa(destination, value, fractional_digits, out_span);
+  }
+
+  az_span remainder = destination;
+  if (value < 0)
+  {
+    _az_RETURN_IF_NOT_ENOUGH_SIZE(remainder, 1);
+    remainder = az_span_copy_u8(remainder, '-');
+    value = -value;
+  }
+
+  // Scale by the largest power of ten that is exact first, to round as few times as possible.
+  int32_t exponent = 0;
+  while (value >= 1e16)
+  {
+    value /= 1e16;
+    exponent += 16;
+  }
+  while (value >= 10)
+  {
+    value /= 10;
+    exponent++;
+  }
+
+  _az_RETURN_IF_FAILED(
+      az_span_dtoa(remainder, value, _az_MAX_SUPPORTED_FRACTIONAL_DIGITS - 1, &remainder));
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remainder, 2);
+  remainder = az_span_copy(remainder, AZ_SPAN_FROM_STR("e+"));
+  return az_span_i32toa(remainder, exponent, out_span);
+}
+
+static int32_t _az_json_writer_get_max_element_size(_az_json_array_element_kind element_kind)
+{
+  switch (element_kind)
+  {
+    case _az_JSON_ARRAY_ELEMENT_INT32:
+      return _az_MAX_SIZE_FOR_INT32;
+    case _az_JSON_ARRAY_ELEMENT_INT64:
+      return _az_MAX_SIZE_FOR_INT64;
+    case _az_JSON_ARRAY_ELEMENT_DOUBLE:
+      return _az_MAX_SIZE_FOR_WRITING_DOUBLE;
+    case _az_JSON_ARRAY_ELEMENT_BOOL:
+    default:
+      return 5; // false
+  }
+}
+
+// Writes a value of the given kind into the destination, which must be large enough for any value
+// of that kind. The value isn't necessarily aligned for its type, so it is copied out first.
+static AZ_NODISCARD az_result _az_json_writer_write_element(
+    az_span destination,
+    _az_json_array_element_kind element_kind,
+    uint8_t const* value,
+    int32_t fractional_digits,
+    az_json_token_kind* out_token_kind,
+    az_span* out_leftover)
+{
+  *out_token_kind = AZ_JSON_TOKEN_NUMBER;
+  switch (element_kind)
+  {
+    case _az_JSON_ARRAY_ELEMENT_INT32:
+    {
+      int32_t element = 0;
+      memcpy(&element, value, sizeof(element));
+      return az_span_i32toa(destination, element, out_leftover);
+    }
+    case _az_JSON_ARRAY_ELEMENT_INT64:
+    {
+      int64_t element = 0;
+      memcpy(&element, value, sizeof(element));
+      return az_span_i64toa(destination, element, out_leftover);
+    }
+    case _az_JSON_ARRAY_ELEMENT_DOUBLE:
+    {
+      double element = 0;
+      memcpy(&element, value, sizeof(element));
+      // Non-finite numbers are not supported because they lead to invalid JSON.
+      _az_PRECONDITION(_az_isfinite(element));
+      return _az_json_writer_dtoa(destination, element, fractional_digits, out_leftover);
+    }
+    case _az_JSON_ARRAY_ELEMENT_BOOL:
+    default:
+    {
+      bool element = false;
+      memcpy(&element, value, sizeof(element));
+      *out_token_kind = element ? AZ_JSON_TOKEN_TRUE : AZ_JSON_TOKEN_FALSE;
+      *out_leftover = az_span_copy(
+          destination, element ? AZ_SPAN_FROM_STR("true") : AZ_SPAN_FROM_STR("false"));
+      return AZ_OK;
+    }
+  }
+}
+
+// Returns the space past what has been written so far within the array, which isn't committed to
+// the writer yet, so that the whole array can be abandoned on failure when writing to a single
+// destination buffer.
+static AZ_NODISCARD az_result _az_json_writer_get_remaining_array_span(
+    az_json_writer* ref_json_writer,
+    int32_t required_size,
+    int32_t* ref_pending_size,
+    az_span* out_remaining)
+{
+  az_span remaining = az_span_slice_to_end(
+      ref_json_writer->_internal.destination_buffer,
+      ref_json_writer->_internal.bytes_written + *ref_pending_size);
+
+  if (az_span_size(remaining) < required_size
+      && (ref_json_writer->_internal.allocator_callback != NULL
+          || ref_json_writer->_internal.options.compute_size_only))
+  {
+    // Moving on to the next destination buffer can't be undone, so commit what was written so far.
+    ref_json_writer->_internal.bytes_written += *ref_pending_size;
+    ref_json_writer->total_bytes_written += *ref_pending_size;
+    *ref_pending_size = 0;
+
+    remaining = _get_remaining_span(ref_json_writer, required_size);
+  }
+
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining, required_size);
+  *out_remaining = remaining;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result _az_json_writer_append_array(
+    az_json_writer* ref_json_writer,
+    _az_json_array_element_kind element_kind,
+    void const* values,
+    int32_t count,
+    size_t stride,
+    int32_t fractional_digits)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION(count >= 0);
+  _az_PRECONDITION(count == 0 || values != NULL);
+  _az_PRECONDITION(_az_is_appending_value_valid(ref_json_writer));
+
+  if (ref_json_writer->_internal.bit_stack._internal.current_depth >= _az_MAX_JSON_STACK_SIZE)
+  {
+    return AZ_ERROR_JSON_NESTING_OVERFLOW;
+  }
+
+  int32_t const max_element_size = _az_json_writer_get_max_element_size(element_kind);
+  uint8_t const* const value_bytes = (uint8_t const*)values;
+
+  int32_t pending_size = 0;
+  az_span remaining_json = AZ_SPAN_EMPTY;
+
+  int32_t required_size = 1; // For the start array byte.
+  if (ref_json_writer->_internal.need_comma)
+  {
+    required_size++; // For the leading comma separator.
+  }
+
+  _az_RETURN_IF_FAILED(_az_json_writer_get_remaining_array_span(
+      ref_json_writer, required_size, &pending_size, &remaining_json));
+  if (ref_json_writer->_internal.need_comma)
+  {
+    remaining_json = az_span_copy_u8(remaining_json, ',');
+  }
+  az_span_copy_u8(remaining_json, '[');
+  pending_size += required_size;
+
+  for (int32_t i = 0; i < count; i++)
+  {
+    // Need enough space to write any element, along with its leading comma separator.
+    required_size = i == 0 ? max_element_size : max_element_size + 1;
+    _az_RETURN_IF_FAILED(_az_json_writer_get_remaining_array_span(
+        ref_json_writer, required_size, &pending_size, &remaining_json));
+
+    az_span element = remaining_json;
+    if (i > 0)
+    {
+      element = az_span_copy_u8(element, ',');
+    }
+
+    // Since we asked for the maximum needed space above, this is guaranteed not to fail due to
+    // AZ_ERROR_NOT_ENOUGH_SPACE.
+    az_span leftover = element;
+    az_json_token_kind element_token_kind = AZ_JSON_TOKEN_NONE;
+    _az_RETURN_IF_FAILED(_az_json_writer_write_element(
+        element,
+        element_kind,
+        value_bytes + ((size_t)i * stride),
+        fractional_digits,
+        &element_token_kind,
+        &leftover));
+    pending_size += _az_span_diff(leftover, remaining_json);
+  }
+
+  required_size = 1; // For the end array byte.
+  _az_RETURN_IF_FAILED(_az_json_writer_get_remaining_array_span(
+      ref_json_writer, required_size, &pending_size, &remaining_json));
+  az_span_copy_u8(remaining_json, ']');
+  pending_size += required_size;
+
+  _az_update_json_writer_state(
+      ref_json_writer, pending_size, pending_size, true, AZ_JSON_TOKEN_END_ARRAY);
+
+  if (ref_json_writer->_internal.bit_stack._internal.current_depth + 1
+      > ref_json_writer->_internal.max_depth)
+  {
+    ref_json_writer->_internal.max_depth
+        = ref_json_writer->_internal.bit_stack._internal.current_depth + 1;
+  }
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result _az_json_writer_append_value(
+    az_json_writer* ref_json_writer,
+    _az_json_array_element_kind element_kind,
+    void const* value,
+    int32_t fractional_digits)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_NOT_NULL(value);
+  _az_PRECONDITION(_az_is_appending_value_valid(ref_json_writer));
+
+  // Need enough space to write any value of the kind.
+  int32_t const max_element_size = _az_json_writer_get_max_element_size(element_kind);
+  int32_t required_size = max_element_size;
+
+  if (ref_json_writer->_internal.need_comma)
+  {
+    required_size++; // For the leading comma separator.
+  }
+
+  az_span remaining_json = _get_remaining_span(ref_json_writer, required_size);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining_json, required_size);
+
+  if (ref_json_writer->_internal.need_comma)
+  {
+    remaining_json = az_span_copy_u8(remaining_json, ',');
+  }
+
+  az_span leftover;
+  az_json_token_kind token_kind = AZ_JSON_TOKEN_NONE;
+  _az_RETURN_IF_FAILED(_az_json_writer_write_element(
+      remaining_json,
+      element_kind,
+      (uint8_t const*)value,
+      fractional_digits,
+      &token_kind,
+      &leftover));
+
+  // We already accounted for the maximum size needed in required_size, so subtract that to get the
+  // actual bytes written.
+  int32_t written = required_size + _az_span_diff(leftover, remaining_json) - max_element_size;
+  _az_update_json_writer_state(ref_json_writer, written, written, true, token_kind);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_writer_append_int32_array(
+    az_json_writer* ref_json_writer,
+    int32_t const* values,
+    int32_t count)
+{
+  return _az_json_writer_append_array(
+      ref_json_writer, _az_JSON_ARRAY_ELEMENT_INT32, values, count, sizeof(int32_t), 0);
+}
+
+AZ_NODISCARD az_result az_json_writer_append_int64_array(
+    az_json_writer* ref_json_writer,
+    int64_t const* values,
+    int32_t count)
+{
+  return _az_json_writer_append_array(
+      ref_json_writer, _az_JSON_ARRAY_ELEMENT_INT64, values, count, sizeof(int64_t), 0);
+}
+
+AZ_NODISCARD az_result az_json_writer_append_double_array(
+    az_json_writer* ref_json_writer,
+    double const* values,
+    int32_t count,
+    int32_t fractional_digits)
+{
+  _az_PRECONDITION_RANGE(0, fractional_digits, _az_MAX_SUPPORTED_FRACTIONAL_DIGITS);
+
+  return _az_json_writer_append_array(
+      ref_json_writer,
+      _az_JSON_ARRAY_ELEMENT_DOUBLE,
+      values,
+      count,
+      sizeof(double),
+      fractional_digits);
+}
+
+AZ_NODISCARD az_result az_json_writer_append_bool_array(
+    az_json_writer* ref_json_writer,
+    bool const* values,
+    int32_t count)
+{
+  return _az_json_writer_append_array(
+      ref_json_writer, _az_JSON_ARRAY_ELEMENT_BOOL, values, count, sizeof(bool), 0);
+}
+
+AZ_NODISCARD az_result _az_json_writer_append_placeholder(
+    az_json_writer* ref_json_writer,
+    az_json_token_kind token_kind,
+    int32_t* out_offset)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_NOT_NULL(out_offset);
+  _az_PRECONDITION(_az_is_appending_value_valid(ref_json_writer));
+  // The offset is only meaningful within a single, contiguous destination buffer.
+  _az_PRECONDITION(ref_json_writer->_internal.allocator_callback == NULL);
+  _az_PRECONDITION(!ref_json_writer->_internal.options.compute_size_only);
+
+  int32_t required_size = 0;
+
+  if (ref_json_writer->_internal.need_comma)
+  {
+    required_size++; // For the leading comma separator.
+
+    az_span remaining_json = _get_remaining_span(ref_json_writer, required_size);
+    _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining_json, required_size);
+
+    az_span_copy_u8(remaining_json, ',');
+  }
+
+  *out_offset = ref_json_writer->_internal.bytes_written + required_size;
+
+  _az_update_json_writer_state(ref_json_writer, required_size, required_size, true, token_kind);
+  return AZ_OK;
+}
+
 static AZ_NODISCARD az_result _az_json_writer_append_container_start(
     az_json_writer* ref_json_writer,
     uint8_t byte,
@@ -974,6 +1569,13 @@ static AZ_NODISCARD az_result _az_json_writer_append_container_start(
     _az_json_stack_push(&ref_json_writer->_internal.bit_stack, _az_JSON_STACK_ARRAY);
   }
 
+  if (ref_json_writer->_internal.bit_stack._internal.current_depth
+      > ref_json_writer->_internal.max_depth)
+  {
+    ref_json_writer->_internal.max_depth
+        = ref_json_writer->_internal.bit_stack._internal.current_depth;
+  }
+
   return AZ_OK;
 }
 
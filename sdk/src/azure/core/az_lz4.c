@@ -0,0 +1,340 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_lz4.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <azure/core/_az_cfg.h>
+
+// Matches shorter than this can't be encoded.
+#define _az_LZ4_MIN_MATCH 4
+
+// The block format requires the last 5 bytes to always be literals and the last match to start at
+// least 12 bytes before the end, so that decoders can copy in 8 byte steps without checks.
+#define _az_LZ4_LAST_LITERALS 5
+#define _az_LZ4_MATCH_FIND_LIMIT 12
+
+// A match can only refer back as far as what fits in its 2 byte offset.
+#define _az_LZ4_MAX_OFFSET 65535
+
+// The 4 bits of a sequence's token hold lengths up to 14, with 15 meaning more bytes follow.
+#define _az_LZ4_TOKEN_LENGTH_MAX 15
+
+#define _az_LZ4_HASH_TABLE_BITS 10
+
+static AZ_NODISCARD uint32_t _az_lz4_read32(uint8_t const* bytes)
+{
+  uint32_t value = 0;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+static AZ_NODISCARD uint32_t _az_lz4_hash(uint32_t sequence)
+{
+  // Knuth's multiplicative hash, keeping the top bits which depend on all of the 4 bytes.
+  return (sequence * 2654435761U) >> (32 - _az_LZ4_HASH_TABLE_BITS);
+}
+
+static AZ_NODISCARD int32_t _az_lz4_get_length_size(int32_t length)
+{
+  return length < _az_LZ4_TOKEN_LENGTH_MAX ? 0 : ((length - _az_LZ4_TOKEN_LENGTH_MAX) / 255) + 1;
+}
+
+// Writes the bytes of a length that didn't fit in the 4 bits of the token.
+static uint8_t* _az_lz4_write_length(uint8_t* destination, int32_t length)
+{
+  length -= _az_LZ4_TOKEN_LENGTH_MAX;
+  while (length >= 255)
+  {
+    *destination++ = 255;
+    length -= 255;
+  }
+  *destination++ = (uint8_t)length;
+  return destination;
+}
+
+// Writes a sequence of literals followed by a match, or just literals for the last sequence of the
+// block, which has a match_length of 0.
+static AZ_NODISCARD az_result _az_lz4_write_sequence(
+    uint8_t** ref_destination,
+    uint8_t const* destination_end,
+    uint8_t const* literals,
+    int32_t literal_length,
+    int32_t offset,
+    int32_t match_length)
+{
+  int32_t const encoded_match_length = match_length > 0 ? match_length - _az_LZ4_MIN_MATCH : 0;
+
+  int32_t required_size = 1 + _az_lz4_get_length_size(literal_length) + literal_length;
+  if (match_length > 0)
+  {
+    required_size += 2 + _az_lz4_get_length_size(encoded_match_length);
+  }
+  if (destination_end - *ref_destination < required_size)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  uint8_t* destination = *ref_destination;
+  uint8_t* const token = destination++;
+
+  *token = (uint8_t)(
+      (literal_length < _az_LZ4_TOKEN_LENGTH_MAX ? literal_length : _az_LZ4_TOKEN_LENGTH_MAX) << 4);
+  if (literal_length >= _az_LZ4_TOKEN_LENGTH_MAX)
+  {
+    destination = _az_lz4_write_length(destination, literal_length);
+  }
+
+  if (literal_length > 0)
+  {
+    memcpy(destination, literals, (size_t)literal_length);
+    destination += literal_length;
+  }
+
+  if (match_length > 0)
+  {
+    *destination++ = (uint8_t)(offset & 0xFF);
+    *destination++ = (uint8_t)(offset >> 8);
+
+    *token |= (uint8_t)(encoded_match_length < _az_LZ4_TOKEN_LENGTH_MAX
+                            ? encoded_match_length
+                            : _az_LZ4_TOKEN_LENGTH_MAX);
+    if (encoded_match_length >= _az_LZ4_TOKEN_LENGTH_MAX)
+    {
+      destination = _az_lz4_write_length(destination, encoded_match_length);
+    }
+  }
+
+  *ref_destination = destination;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_lz4_compress(
+    az_lz4_compress_workspace* workspace,
+    az_span destination_bytes,
+    az_span source_bytes,
+    int32_t* out_written)
+{
+  _az_PRECONDITION_NOT_NULL(workspace);
+  _az_PRECONDITION_VALID_SPAN(destination_bytes, 1, false);
+  _az_PRECONDITION_VALID_SPAN(source_bytes, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_written);
+
+  uint8_t const* const source = az_span_ptr(source_bytes);
+  int32_t const source_size = az_span_size(source_bytes);
+  uint8_t* destination = az_span_ptr(destination_bytes);
+  uint8_t const* const destination_end = destination + az_span_size(destination_bytes);
+
+  // The start of the literals that haven't been written yet.
+  int32_t anchor = 0;
+
+  // Anything shorter than the match find limit can only be written as literals.
+  if (source_size > _az_LZ4_MATCH_FIND_LIMIT)
+  {
+    uint32_t* const hash_table = workspace->_internal.hash_table;
+    int32_t const match_start_limit = source_size - _az_LZ4_MATCH_FIND_LIMIT;
+    int32_t const match_end_limit = source_size - _az_LZ4_LAST_LITERALS;
+
+    // Stale positions left in the table are harmless, since every candidate match is verified, but
+    // clearing it keeps the output deterministic.
+    memset(hash_table, 0, sizeof(workspace->_internal.hash_table));
+
+    int32_t position = 1;
+    while (position <= match_start_limit)
+    {
+      uint32_t const sequence = _az_lz4_read32(source + position);
+      uint32_t const hash = _az_lz4_hash(sequence);
+      int32_t match = (int32_t)hash_table[hash];
+      hash_table[hash] = (uint32_t)position;
+
+      if (position - match > _az_LZ4_MAX_OFFSET || _az_lz4_read32(source + match) != sequence)
+      {
+        // Step further ahead the longer no match has been found, which speeds up going through
+        // data that doesn't compress.
+        position += 1 + ((position - anchor) >> 6);
+        continue;
+      }
+
+      // The match may have started before the position where it was found.
+      while (position > anchor && match > 0 && source[position - 1] == source[match - 1])
+      {
+        position--;
+        match--;
+      }
+
+      int32_t length = _az_LZ4_MIN_MATCH;
+      while (position + length < match_end_limit
+             && source[position + length] == source[match + length])
+      {
+        length++;
+      }
+
+      _az_RETURN_IF_FAILED(_az_lz4_write_sequence(
+          &destination,
+          destination_end,
+          source + anchor,
+          position - anchor,
+          position - match,
+          length));
+
+      position += length;
+      anchor = position;
+
+      // Also index a position within the match, which helps find overlapping repetitions.
+      if (position <= match_start_limit)
+      {
+        hash_table[_az_lz4_hash(_az_lz4_read32(source + position - 2))] = (uint32_t)(position - 2);
+      }
+    }
+  }
+
+  _az_RETURN_IF_FAILED(_az_lz4_write_sequence(
+      &destination, destination_end, source + anchor, source_size - anchor, 0, 0));
+
+  *out_written = (int32_t)(destination - az_span_ptr(destination_bytes));
+  return AZ_OK;
+}
+
+AZ_NODISCARD int32_t az_lz4_get_max_compressed_size(int32_t source_bytes_size)
+{
+  _az_PRECONDITION_RANGE(0, source_bytes_size, INT32_MAX - (INT32_MAX / 255) - 16);
+
+  // In the worst case, everything is written as a single run of literals.
+  return source_bytes_size + (source_bytes_size / 255) + 16;
+}
+
+// Reads the bytes of a length that didn't fit in the 4 bits of the token, and fails with the given
+// error once the length exceeds the limit, which also keeps it from overflowing.
+static AZ_NODISCARD az_result _az_lz4_read_length(
+    uint8_t const* source,
+    int32_t source_size,
+    int32_t* ref_position,
+    int32_t limit,
+    az_result limit_error,
+    int32_t* ref_length)
+{
+  uint8_t next = 255;
+  while (next == 255)
+  {
+    if (*ref_position >= source_size)
+    {
+      return AZ_ERROR_UNEXPECTED_END;
+    }
+
+    next = source[(*ref_position)++];
+    *ref_length += next;
+    if (*ref_length > limit)
+    {
+      return limit_error;
+    }
+  }
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_lz4_decompress(az_span destination_bytes, az_span source_lz4_block, int32_t* out_written)
+{
+  _az_PRECONDITION_VALID_SPAN(destination_bytes, 1, false);
+  _az_PRECONDITION_VALID_SPAN(source_lz4_block, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_written);
+
+  uint8_t const* const source = az_span_ptr(source_lz4_block);
+  int32_t const source_size = az_span_size(source_lz4_block);
+  uint8_t* const destination = az_span_ptr(destination_bytes);
+  int32_t const destination_size = az_span_size(destination_bytes);
+
+  int32_t source_position = 0;
+  int32_t written = 0;
+
+  while (true)
+  {
+    if (source_position >= source_size)
+    {
+      return AZ_ERROR_UNEXPECTED_END;
+    }
+    uint8_t const token = source[source_position++];
+
+    int32_t literal_length = token >> 4;
+    if (literal_length == _az_LZ4_TOKEN_LENGTH_MAX)
+    {
+      _az_RETURN_IF_FAILED(_az_lz4_read_length(
+          source,
+          source_size,
+          &source_position,
+          source_size,
+          AZ_ERROR_UNEXPECTED_END,
+          &literal_length));
+    }
+
+    if (source_size - source_position < literal_length)
+    {
+      return AZ_ERROR_UNEXPECTED_END;
+    }
+    if (destination_size - written < literal_length)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+    memcpy(destination + written, source + source_position, (size_t)literal_length);
+    source_position += literal_length;
+    written += literal_length;
+
+    // The last sequence of the block only has literals.
+    if (source_position == source_size)
+    {
+      break;
+    }
+
+    if (source_size - source_position < 2)
+    {
+      return AZ_ERROR_UNEXPECTED_END;
+    }
+    int32_t const offset = source[source_position] | (source[source_position + 1] << 8);
+    source_position += 2;
+    if (offset == 0 || offset > written)
+    {
+      return AZ_ERROR_UNEXPECTED_CHAR;
+    }
+
+    int32_t match_length = token & 0x0F;
+    if (match_length == _az_LZ4_TOKEN_LENGTH_MAX)
+    {
+      _az_RETURN_IF_FAILED(_az_lz4_read_length(
+          source,
+          source_size,
+          &source_position,
+          destination_size,
+          AZ_ERROR_NOT_ENOUGH_SPACE,
+          &match_length));
+    }
+    match_length += _az_LZ4_MIN_MATCH;
+
+    if (destination_size - written < match_length)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+
+    uint8_t* const match_destination = destination + written;
+    uint8_t const* const match_source = match_destination - offset;
+    if (offset >= match_length)
+    {
+      memcpy(match_destination, match_source, (size_t)match_length);
+    }
+    else
+    {
+      // The match overlaps the bytes it produces, which is how runs are encoded, so it has to be
+      // copied one byte at a time.
+      for (int32_t i = 0; i < match_length; i++)
+      {
+        match_destination[i] = match_source[i];
+      }
+    }
+    written += match_length;
+  }
+
+  *out_written = written;
+  return AZ_OK;
+}
@@ -0,0 +1,421 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_sha256.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+
+#include <stdbool.h>
+#include <string.h>
+
+// Use the SHA instructions of the CPU when the compiler targets a CPU which has them.
+#if defined(__SHA__) && defined(__SSE4_1__)
+#define _az_SHA256_X86_SHA_NI
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_SHA2)
+#define _az_SHA256_ARMV8_CRYPTO
+#include <arm_neon.h>
+#endif
+
+#include <azure/core/_az_cfg.h>
+
+#define _az_HMAC_SHA256_INNER_PAD 0x36
+#define _az_HMAC_SHA256_OUTER_PAD 0x5C
+
+static const uint32_t _az_sha256_round_constants[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#if defined(_az_SHA256_X86_SHA_NI)
+
+static void _az_sha256_process_blocks(uint32_t state[8], uint8_t const* data, int32_t block_count)
+{
+  __m128i const byte_swap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+
+  // The instructions work on the state arranged as ABEF and CDGH, rather than ABCD and EFGH.
+  __m128i const dcba = _mm_loadu_si128((__m128i const*)&state[0]);
+  __m128i const hgfe = _mm_loadu_si128((__m128i const*)&state[4]);
+  __m128i const cdab = _mm_shuffle_epi32(dcba, 0xB1);
+  __m128i const efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+  __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+  __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+  for (int32_t block = 0; block < block_count; block++)
+  {
+    uint8_t const* const block_data = data + (block * _az_SHA256_BLOCK_SIZE);
+    __m128i const abef_saved = abef;
+    __m128i const cdgh_saved = cdgh;
+    __m128i schedule[4];
+
+    // Each step does 4 rounds, with the 4 message words which are also added to the schedule.
+    for (int32_t step = 0; step < 16; step++)
+    {
+      __m128i words;
+      if (step < 4)
+      {
+        words = _mm_shuffle_epi8(
+            _mm_loadu_si128((__m128i const*)(block_data + (step * 16))), byte_swap_mask);
+      }
+      else
+      {
+        __m128i const previous = schedule[(step - 1) & 3];
+        words = _mm_sha256msg2_epu32(
+            _mm_add_epi32(
+                _mm_sha256msg1_epu32(schedule[step & 3], schedule[(step - 3) & 3]),
+                _mm_alignr_epi8(previous, schedule[(step - 2) & 3], 4)),
+            previous);
+      }
+      schedule[step & 3] = words;
+
+      __m128i message = _mm_add_epi32(
+          words, _mm_loadu_si128((__m128i const*)&_az_sha256_round_constants[step * 4]));
+      cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+      message = _mm_shuffle_epi32(message, 0x0E);
+      abef = _mm_sha256rnds2_epu32(abef, cdgh, message);
+    }
+
+    abef = _mm_add_epi32(abef, abef_saved);
+    cdgh = _mm_add_epi32(cdgh, cdgh_saved);
+  }
+
+  __m128i const feba = _mm_shuffle_epi32(abef, 0x1B);
+  __m128i const dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+  _mm_storeu_si128((__m128i*)&state[0], _mm_blend_epi16(feba, dchg, 0xF0));
+  _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(dchg, feba, 8));
+}
+
+#elif defined(_az_SHA256_ARMV8_CRYPTO)
+
+static void _az_sha256_process_blocks(uint32_t state[8], uint8_t const* data, int32_t block_count)
+{
+  uint32x4_t abcd = vld1q_u32(&state[0]);
+  uint32x4_t efgh = vld1q_u32(&state[4]);
+
+  for (int32_t block = 0; block < block_count; block++)
+  {
+    uint8_t const* const block_data = data + (block * _az_SHA256_BLOCK_SIZE);
+    uint32x4_t const abcd_saved = abcd;
+    uint32x4_t const efgh_saved = efgh;
+    uint32x4_t schedule[4];
+
+    for (int32_t i = 0; i < 4; i++)
+    {
+      schedule[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(block_data + (i * 16))));
+    }
+
+    // Each step does 4 rounds, and computes 4 more message words while there are rounds left.
+    for (int32_t step = 0; step < 16; step++)
+    {
+      uint32x4_t const message
+          = vaddq_u32(schedule[step & 3], vld1q_u32(&_az_sha256_round_constants[step * 4]));
+      if (step < 12)
+      {
+        schedule[step & 3] = vsha256su1q_u32(
+            vsha256su0q_u32(schedule[step & 3], schedule[(step + 1) & 3]),
+            schedule[(step + 2) & 3],
+            schedule[(step + 3) & 3]);
+      }
+
+      uint32x4_t const abcd_previous = abcd;
+      abcd = vsha256hq_u32(abcd, efgh, message);
+      efgh = vsha256h2q_u32(efgh, abcd_previous, message);
+    }
+
+    abcd = vaddq_u32(abcd, abcd_saved);
+    efgh = vaddq_u32(efgh, efgh_saved);
+  }
+
+  vst1q_u32(&state[0], abcd);
+  vst1q_u32(&state[4], efgh);
+}
+
+#else
+
+#define _az_SHA256_ROTATE_RIGHT(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static AZ_NODISCARD uint32_t _az_sha256_read_big_endian(uint8_t const* bytes)
+{
+  return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8)
+      | (uint32_t)bytes[3];
+}
+
+static void _az_sha256_process_blocks(uint32_t state[8], uint8_t const* data, int32_t block_count)
+{
+  for (int32_t block = 0; block < block_count; block++)
+  {
+    uint8_t const* const block_data = data + (block * _az_SHA256_BLOCK_SIZE);
+
+    // Only the last 16 words of the message schedule are needed at any time.
+    uint32_t schedule[16];
+    for (int32_t i = 0; i < 16; i++)
+    {
+      schedule[i] = _az_sha256_read_big_endian(block_data + (i * 4));
+    }
+
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+    uint32_t f = state[5];
+    uint32_t g = state[6];
+    uint32_t h = state[7];
+
+    for (int32_t round = 0; round < 64; round++)
+    {
+      if (round >= 16)
+      {
+        uint32_t const w15 = schedule[(round - 15) & 15];
+        uint32_t const w2 = schedule[(round - 2) & 15];
+        uint32_t const sigma0
+            = _az_SHA256_ROTATE_RIGHT(w15, 7) ^ _az_SHA256_ROTATE_RIGHT(w15, 18) ^ (w15 >> 3);
+        uint32_t const sigma1
+            = _az_SHA256_ROTATE_RIGHT(w2, 17) ^ _az_SHA256_ROTATE_RIGHT(w2, 19) ^ (w2 >> 10);
+        schedule[round & 15] += sigma0 + schedule[(round - 7) & 15] + sigma1;
+      }
+
+      uint32_t const sum1 = _az_SHA256_ROTATE_RIGHT(e, 6) ^ _az_SHA256_ROTATE_RIGHT(e, 11)
+          ^ _az_SHA256_ROTATE_RIGHT(e, 25);
+      uint32_t const choice = (e & f) ^ (~e & g);
+      uint32_t const temp1
+          = h + sum1 + choice + _az_sha256_round_constants[round] + schedule[round & 15];
+      uint32_t const sum0 = _az_SHA256_ROTATE_RIGHT(a, 2) ^ _az_SHA256_ROTATE_RIGHT(a, 13)
+          ^ _az_SHA256_ROTATE_RIGHT(a, 22);
+      uint32_t const majority = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t const temp2 = sum0 + majority;
+
+      h = g;
+      g = f;
+      f = e;
+      e = d + temp1;
+      d = c;
+      c = b;
+      b = a;
+      a = temp1 + temp2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+#endif
+
+AZ_NODISCARD az_result az_sha256_init(az_sha256_context* context)
+{
+  _az_PRECONDITION_NOT_NULL(context);
+
+  context->_internal.state[0] = 0x6a09e667;
+  context->_internal.state[1] = 0xbb67ae85;
+  context->_internal.state[2] = 0x3c6ef372;
+  context->_internal.state[3] = 0xa54ff53a;
+  context->_internal.state[4] = 0x510e527f;
+  context->_internal.state[5] = 0x9b05688c;
+  context->_internal.state[6] = 0x1f83d9ab;
+  context->_internal.state[7] = 0x5be0cd19;
+  context->_internal.total_size = 0;
+  context->_internal.block_size = 0;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_sha256_update(az_sha256_context* context, az_span data)
+{
+  _az_PRECONDITION_NOT_NULL(context);
+  _az_PRECONDITION_VALID_SPAN(data, 0, true);
+
+  uint8_t const* bytes = az_span_ptr(data);
+  int32_t size = az_span_size(data);
+  context->_internal.total_size += (uint64_t)size;
+
+  // Complete the block left over from the previous update first.
+  if (context->_internal.block_size > 0)
+  {
+    int32_t const missing = _az_SHA256_BLOCK_SIZE - context->_internal.block_size;
+    int32_t const copied = size < missing ? size : missing;
+    memcpy(context->_internal.block + context->_internal.block_size, bytes, (size_t)copied);
+    context->_internal.block_size += copied;
+    bytes += copied;
+    size -= copied;
+
+    if (context->_internal.block_size < _az_SHA256_BLOCK_SIZE)
+    {
+      return AZ_OK;
+    }
+    _az_sha256_process_blocks(context->_internal.state, context->_internal.block, 1);
+    context->_internal.block_size = 0;
+  }
+
+  // Process whole blocks straight from the data, without copying them.
+  int32_t const block_count = size / _az_SHA256_BLOCK_SIZE;
+  if (block_count > 0)
+  {
+    _az_sha256_process_blocks(context->_internal.state, bytes, block_count);
+    bytes += block_count * _az_SHA256_BLOCK_SIZE;
+    size -= block_count * _az_SHA256_BLOCK_SIZE;
+  }
+
+  if (size > 0)
+  {
+    memcpy(context->_internal.block, bytes, (size_t)size);
+    context->_internal.block_size = size;
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_sha256_finalize(az_sha256_context* context, az_span destination, az_span* out_digest)
+{
+  _az_PRECONDITION_NOT_NULL(context);
+  _az_PRECONDITION_VALID_SPAN(destination, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_digest);
+
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(destination, AZ_SHA256_DIGEST_SIZE);
+
+  uint8_t* const block = context->_internal.block;
+  int32_t block_size = context->_internal.block_size;
+  uint64_t const total_bits = context->_internal.total_size * 8;
+
+  // Pad with a 1 bit, then 0 bits up to the 8 last bytes of a block, which hold the size in bits.
+  block[block_size++] = 0x80;
+  if (block_size > _az_SHA256_BLOCK_SIZE - 8)
+  {
+    memset(block + block_size, 0, (size_t)(_az_SHA256_BLOCK_SIZE - block_size));
+    _az_sha256_process_blocks(context->_internal.state, block, 1);
+    block_size = 0;
+  }
+  memset(block + block_size, 0, (size_t)(_az_SHA256_BLOCK_SIZE - 8 - block_size));
+  for (int32_t i = 0; i < 8; i++)
+  {
+    block[_az_SHA256_BLOCK_SIZE - 1 - i] = (uint8_t)(total_bits >> (i * 8));
+  }
+  _az_sha256_process_blocks(context->_internal.state, block, 1);
+
+  uint8_t* const digest = az_span_ptr(destination);
+  for (int32_t i = 0; i < 8; i++)
+  {
+    uint32_t const word = context->_internal.state[i];
+    digest[(i * 4)] = (uint8_t)(word >> 24);
+    digest[(i * 4) + 1] = (uint8_t)(word >> 16);
+    digest[(i * 4) + 2] = (uint8_t)(word >> 8);
+    digest[(i * 4) + 3] = (uint8_t)word;
+  }
+
+  *out_digest = az_span_slice(destination, 0, AZ_SHA256_DIGEST_SIZE);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_sha256(az_span data, az_span destination, az_span* out_digest)
+{
+  az_sha256_context context;
+  _az_RETURN_IF_FAILED(az_sha256_init(&context));
+  _az_RETURN_IF_FAILED(az_sha256_update(&context, data));
+  return az_sha256_finalize(&context, destination, out_digest);
+}
+
+static AZ_NODISCARD az_result
+_az_hmac_sha256_init_padded(az_sha256_context* context, uint8_t const* key_block, uint8_t pad)
+{
+  uint8_t padded_key[_az_SHA256_BLOCK_SIZE];
+  for (int32_t i = 0; i < _az_SHA256_BLOCK_SIZE; i++)
+  {
+    padded_key[i] = (uint8_t)(key_block[i] ^ pad);
+  }
+
+  _az_RETURN_IF_FAILED(az_sha256_init(context));
+  az_result const result = az_sha256_update(context, AZ_SPAN_FROM_BUFFER(padded_key));
+  memset(padded_key, 0, sizeof(padded_key));
+  return result;
+}
+
+AZ_NODISCARD az_result az_hmac_sha256_key_init(az_hmac_sha256_key* key, az_span key_bytes)
+{
+  _az_PRECONDITION_NOT_NULL(key);
+  _az_PRECONDITION_VALID_SPAN(key_bytes, 0, true);
+
+  uint8_t key_block[_az_SHA256_BLOCK_SIZE] = { 0 };
+  if (az_span_size(key_bytes) > _az_SHA256_BLOCK_SIZE)
+  {
+    az_span digest;
+    _az_RETURN_IF_FAILED(az_sha256(key_bytes, AZ_SPAN_FROM_BUFFER(key_block), &digest));
+  }
+  else if (az_span_size(key_bytes) > 0)
+  {
+    memcpy(key_block, az_span_ptr(key_bytes), (size_t)az_span_size(key_bytes));
+  }
+
+  az_result result
+      = _az_hmac_sha256_init_padded(&key->_internal.inner, key_block, _az_HMAC_SHA256_INNER_PAD);
+  if (az_result_succeeded(result))
+  {
+    result = _az_hmac_sha256_init_padded(
+        &key->_internal.outer, key_block, _az_HMAC_SHA256_OUTER_PAD);
+  }
+
+  memset(key_block, 0, sizeof(key_block));
+  return result;
+}
+
+AZ_NODISCARD az_result
+az_hmac_sha256_init(az_hmac_sha256_context* context, az_hmac_sha256_key const* key)
+{
+  _az_PRECONDITION_NOT_NULL(context);
+  _az_PRECONDITION_NOT_NULL(key);
+
+  context->_internal.inner = key->_internal.inner;
+  context->_internal.key = key;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_hmac_sha256_update(az_hmac_sha256_context* context, az_span data)
+{
+  _az_PRECONDITION_NOT_NULL(context);
+
+  return az_sha256_update(&context->_internal.inner, data);
+}
+
+AZ_NODISCARD az_result
+az_hmac_sha256_finalize(az_hmac_sha256_context* context, az_span destination, az_span* out_mac)
+{
+  _az_PRECONDITION_NOT_NULL(context);
+  _az_PRECONDITION_VALID_SPAN(destination, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_mac);
+
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(destination, AZ_SHA256_DIGEST_SIZE);
+
+  uint8_t inner_digest_buffer[AZ_SHA256_DIGEST_SIZE];
+  az_span inner_digest;
+  _az_RETURN_IF_FAILED(az_sha256_finalize(
+      &context->_internal.inner, AZ_SPAN_FROM_BUFFER(inner_digest_buffer), &inner_digest));
+
+  az_sha256_context outer = context->_internal.key->_internal.outer;
+  _az_RETURN_IF_FAILED(az_sha256_update(&outer, inner_digest));
+  return az_sha256_finalize(&outer, destination, out_mac);
+}
+
+AZ_NODISCARD az_result az_hmac_sha256(
+    az_hmac_sha256_key const* key,
+    az_span data,
+    az_span destination,
+    az_span* out_mac)
+{
+  az_hmac_sha256_context context;
+  _az_RETURN_IF_FAILED(az_hmac_sha256_init(&context, key));
+  _az_RETURN_IF_FAILED(az_hmac_sha256_update(&context, data));
+  return az_hmac_sha256_finalize(&context, destination, out_mac);
+}
@@ -563,36 +563,67 @@ AZ_INLINE uint8_t _az_decimal_to_ascii(uint8_t d)
   return (uint8_t)((uint32_t)('0' + d) & (uint8_t)UINT8_MAX);
 }
 
-static AZ_NODISCARD az_result _az_span_builder_append_uint64(az_span* ref_span, uint64_t n)
+// The ASCII digits of every number from 00 to 99, used to format integers two digits at a time.
+static char const _az_two_digit_pairs[] = "00010203040506070809"
+                                          "10111213141516171819"
+                                          "20212223242526272829"
+                                          "30313233343536373839"
+                                          "40414243444546474849"
+                                          "50515253545556575859"
+                                          "60616263646566676869"
+                                          "70717273747576777879"
+                                          "80818283848586878889"
+                                          "90919293949596979899";
+
+// Writes the decimal digits of n backwards, ending right before digits_end, and returns how many
+// were written.
+static int32_t _az_span_format_uint64(uint64_t n, uint8_t* digits_end)
 {
-  _az_RETURN_IF_NOT_ENOUGH_SIZE(*ref_span, 1);
+  uint8_t* ptr = digits_end;
 
-  if (n == 0)
+  // Only divide using 64-bit arithmetic while needed, since it is costly on 32-bit devices.
+  while (n > UINT32_MAX)
   {
-    *ref_span = az_span_copy_u8(*ref_span, '0');
-    return AZ_OK;
+    uint32_t const pair = (uint32_t)(n % 100) * 2;
+    n /= 100;
+    ptr -= 2;
+    ptr[0] = (uint8_t)_az_two_digit_pairs[pair];
+    ptr[1] = (uint8_t)_az_two_digit_pairs[pair + 1];
   }
 
-  uint64_t div = _az_SMALLEST_20_DIGIT_NUMBER;
-  uint64_t nn = n;
-  int32_t digit_count = _az_MAX_SIZE_FOR_UINT64;
-  while (nn / div == 0)
+  uint32_t nn = (uint32_t)n;
+  while (nn >= 100)
   {
-    div /= _az_NUMBER_OF_DECIMAL_VALUES;
-    digit_count--;
+    uint32_t const pair = (nn % 100) * 2;
+    nn /= 100;
+    ptr -= 2;
+    ptr[0] = (uint8_t)_az_two_digit_pairs[pair];
+    ptr[1] = (uint8_t)_az_two_digit_pairs[pair + 1];
   }
 
-  _az_RETURN_IF_NOT_ENOUGH_SIZE(*ref_span, digit_count);
-
-  while (div > 1)
+  if (nn >= 10)
+  {
+    ptr -= 2;
+    ptr[0] = (uint8_t)_az_two_digit_pairs[nn * 2];
+    ptr[1] = (uint8_t)_az_two_digit_pairs[nn * 2 + 1];
+  }
+  else
   {
-    uint8_t value_to_append = _az_decimal_to_ascii((uint8_t)(nn / div));
-    *ref_span = az_span_copy_u8(*ref_span, value_to_append);
-    nn %= div;
-    div /= _az_NUMBER_OF_DECIMAL_VALUES;
+    *--ptr = _az_decimal_to_ascii((uint8_t)nn);
   }
-  uint8_t value_to_append = _az_decimal_to_ascii((uint8_t)nn);
-  *ref_span = az_span_copy_u8(*ref_span, value_to_append);
+
+  return (int32_t)(digits_end - ptr);
+}
+
+static AZ_NODISCARD az_result _az_span_builder_append_uint64(az_span* ref_span, uint64_t n)
+{
+  uint8_t digits[_az_MAX_SIZE_FOR_UINT64];
+  int32_t const digit_count = _az_span_format_uint64(n, digits + _az_MAX_SIZE_FOR_UINT64);
+
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(*ref_span, digit_count);
+
+  *ref_span = az_span_copy(
+      *ref_span, az_span_create(digits + _az_MAX_SIZE_FOR_UINT64 - digit_count, digit_count));
   return AZ_OK;
 }
 
@@ -626,38 +657,13 @@ AZ_NODISCARD az_result az_span_i64toa(az_span destination, int64_t source, az_sp
 static AZ_NODISCARD az_result
 _az_span_builder_append_u32toa(az_span destination, uint32_t n, az_span* out_span)
 {
-  _az_RETURN_IF_NOT_ENOUGH_SIZE(destination, 1);
-
-  if (n == 0)
-  {
-    *out_span = az_span_copy_u8(destination, '0');
-    return AZ_OK;
-  }
-
-  uint32_t div = _az_SMALLEST_10_DIGIT_NUMBER;
-  uint32_t nn = n;
-  int32_t digit_count = _az_MAX_SIZE_FOR_UINT32;
-  while (nn / div == 0)
-  {
-    div /= _az_NUMBER_OF_DECIMAL_VALUES;
-    digit_count--;
-  }
+  uint8_t digits[_az_MAX_SIZE_FOR_UINT32];
+  int32_t const digit_count = _az_span_format_uint64(n, digits + _az_MAX_SIZE_FOR_UINT32);
 
   _az_RETURN_IF_NOT_ENOUGH_SIZE(destination, digit_count);
 
-  *out_span = destination;
-
-  while (div > 1)
-  {
-    uint8_t value_to_append = _az_decimal_to_ascii((uint8_t)(nn / div));
-    *out_span = az_span_copy_u8(*out_span, value_to_append);
-
-    nn %= div;
-    div /= _az_NUMBER_OF_DECIMAL_VALUES;
-  }
-
-  uint8_t value_to_append = _az_decimal_to_ascii((uint8_t)nn);
-  *out_span = az_span_copy_u8(*out_span, value_to_append);
+  *out_span = az_span_copy(
+      destination, az_span_create(digits + _az_MAX_SIZE_FOR_UINT32 - digit_count, digit_count));
   return AZ_OK;
 }
 
@@ -31,6 +31,8 @@ AZ_NODISCARD az_result az_iot_message_properties_init(
   properties->_internal.properties_buffer = buffer;
   properties->_internal.properties_written = written_length;
   properties->_internal.current_property_index = 0;
+  properties->_internal.index = NULL;
+  properties->_internal.index_mask = 0;
 
   return AZ_OK;
 }
@@ -65,6 +67,108 @@ az_iot_message_properties_append(az_iot_message_properties* properties, az_span
   az_span_copy(remainder, value);
 
   properties->_internal.properties_written += required_length;
+  properties->_internal.index = NULL;
+
+  return AZ_OK;
+}
+
+// Returns the index entry of the property with the given name, or the empty entry where it would
+// go.
+static AZ_NODISCARD az_iot_message_properties_index_entry* _az_iot_message_properties_index_find(
+    az_iot_message_properties const* properties,
+    az_span name,
+    uint32_t hash)
+{
+  uint32_t const mask = properties->_internal.index_mask;
+  uint32_t slot = hash & mask;
+
+  // The index is always larger than the number of properties, so there is an empty entry to stop
+  // at.
+  while (true)
+  {
+    az_iot_message_properties_index_entry* const entry = &properties->_internal.index[slot];
+    if (entry->_internal.name_offset == -1
+        || (entry->_internal.name_hash == hash
+            && az_span_is_content_equal(
+                az_span_slice(
+                    properties->_internal.properties_buffer,
+                    entry->_internal.name_offset,
+                    entry->_internal.name_offset + entry->_internal.name_size),
+                name)))
+    {
+      return entry;
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+AZ_NODISCARD az_result az_iot_message_properties_build_index(
+    az_iot_message_properties* properties,
+    az_iot_message_properties_index_entry* index,
+    int32_t index_size)
+{
+  _az_PRECONDITION_NOT_NULL(properties);
+  _az_PRECONDITION_NOT_NULL(index);
+  _az_PRECONDITION(index_size > 0 && (index_size & (index_size - 1)) == 0);
+
+  properties->_internal.index = NULL;
+  for (int32_t i = 0; i < index_size; i++)
+  {
+    index[i]._internal.name_offset = -1;
+  }
+
+  az_iot_message_properties indexed = *properties;
+  indexed._internal.index = index;
+  indexed._internal.index_mask = (uint32_t)index_size - 1;
+
+  az_span const buffer = properties->_internal.properties_buffer;
+  int32_t const written = properties->_internal.properties_written;
+  int32_t count = 0;
+  int32_t position = 0;
+
+  // Split the properties the same way az_iot_message_properties_find() does when it goes through
+  // them, so that both find the same values.
+  while (position < written)
+  {
+    int32_t const name_size
+        = az_span_find(az_span_slice(buffer, position, written), hub_client_param_equals_span);
+    if (name_size == -1)
+    {
+      break;
+    }
+
+    int32_t const value_offset = position + name_size + 1;
+    int32_t value_size = az_span_find(
+        az_span_slice(buffer, value_offset, written), hub_client_param_separator_span);
+    if (value_size == -1)
+    {
+      value_size = written - value_offset;
+    }
+
+    az_span const name = az_span_slice(buffer, position, position + name_size);
+    uint32_t const hash = _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, name);
+    az_iot_message_properties_index_entry* const entry
+        = _az_iot_message_properties_index_find(&indexed, name, hash);
+
+    // Like a lookup without the index, keep the first of several properties with the same name.
+    if (entry->_internal.name_offset == -1)
+    {
+      if (++count == index_size)
+      {
+        return AZ_ERROR_NOT_ENOUGH_SPACE;
+      }
+
+      entry->_internal.name_hash = hash;
+      entry->_internal.name_offset = position;
+      entry->_internal.name_size = name_size;
+      entry->_internal.value_size = value_size;
+    }
+
+    position = value_offset + value_size + 1;
+  }
+
+  properties->_internal.index = index;
+  properties->_internal.index_mask = indexed._internal.index_mask;
 
   return AZ_OK;
 }
@@ -78,6 +182,24 @@ AZ_NODISCARD az_result az_iot_message_properties_find(
   _az_PRECONDITION_VALID_SPAN(name, 1, false);
   _az_PRECONDITION_NOT_NULL(out_value);
 
+  if (properties->_internal.index != NULL)
+  {
+    az_iot_message_properties_index_entry const* const entry
+        = _az_iot_message_properties_index_find(
+            properties, name, _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, name));
+    if (entry->_internal.name_offset == -1)
+    {
+      return AZ_ERROR_ITEM_NOT_FOUND;
+    }
+
+    *out_value = az_span_slice(
+        properties->_internal.properties_buffer,
+        entry->_internal.name_offset + entry->_internal.name_size + 1,
+        entry->_internal.name_offset + entry->_internal.name_size + 1
+            + entry->_internal.value_size);
+    return AZ_OK;
+  }
+
   az_span remaining = az_span_slice(
       properties->_internal.properties_buffer, 0, properties->_internal.properties_written);
 
@@ -101,6 +223,69 @@ AZ_NODISCARD az_result az_iot_message_properties_find(
   return AZ_ERROR_ITEM_NOT_FOUND;
 }
 
+static AZ_NODISCARD int32_t _az_iot_message_properties_hex_digit_value(uint8_t digit)
+{
+  if (digit >= '0' && digit <= '9')
+  {
+    return digit - '0';
+  }
+  if (digit >= 'a' && digit <= 'f')
+  {
+    return digit - 'a' + 10;
+  }
+  if (digit >= 'A' && digit <= 'F')
+  {
+    return digit - 'A' + 10;
+  }
+  return -1;
+}
+
+AZ_NODISCARD az_result
+az_iot_message_properties_url_decode(az_span encoded, az_span destination, az_span* out_decoded)
+{
+  _az_PRECONDITION_VALID_SPAN(encoded, 0, true);
+  _az_PRECONDITION_VALID_SPAN(destination, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_decoded);
+
+  uint8_t const* const source = az_span_ptr(encoded);
+  int32_t const source_size = az_span_size(encoded);
+  uint8_t* const target = az_span_ptr(destination);
+  int32_t const target_size = az_span_size(destination);
+
+  // Each byte is written at or before the position it is read from, so decoding in place works.
+  int32_t written = 0;
+  for (int32_t i = 0; i < source_size; i++)
+  {
+    uint8_t decoded = source[i];
+    if (decoded == '%')
+    {
+      if (source_size - i < 3)
+      {
+        return AZ_ERROR_UNEXPECTED_END;
+      }
+
+      int32_t const high = _az_iot_message_properties_hex_digit_value(source[i + 1]);
+      int32_t const low = _az_iot_message_properties_hex_digit_value(source[i + 2]);
+      if (high == -1 || low == -1)
+      {
+        return AZ_ERROR_UNEXPECTED_CHAR;
+      }
+
+      decoded = (uint8_t)((high << 4) | low);
+      i += 2;
+    }
+
+    if (written == target_size)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+    target[written++] = decoded;
+  }
+
+  *out_decoded = az_span_slice(destination, 0, written);
+  return AZ_OK;
+}
+
 AZ_NODISCARD az_result az_iot_message_properties_next(
     az_iot_message_properties* properties,
     az_span* out_name,
@@ -138,6 +323,79 @@ AZ_NODISCARD az_result az_iot_message_properties_next(
   return AZ_OK;
 }
 
+AZ_NODISCARD az_result az_iot_message_payload_compress(
+    az_lz4_compress_workspace* workspace,
+    az_iot_message_properties* properties,
+    az_span payload,
+    az_span destination,
+    az_span* out_payload)
+{
+  _az_PRECONDITION_NOT_NULL(workspace);
+  _az_PRECONDITION_NOT_NULL(properties);
+  _az_PRECONDITION_VALID_SPAN(payload, 1, false);
+  _az_PRECONDITION_VALID_SPAN(destination, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_payload);
+
+  // Don't let the compressed payload be any larger than the original one.
+  if (az_span_size(destination) >= az_span_size(payload))
+  {
+    destination = az_span_slice(destination, 0, az_span_size(payload) - 1);
+  }
+
+  int32_t compressed_size = 0;
+  if (az_span_size(destination) < 1
+      || az_result_failed(az_lz4_compress(workspace, destination, payload, &compressed_size)))
+  {
+    *out_payload = payload;
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_FAILED(az_iot_message_properties_append(
+      properties,
+      AZ_SPAN_FROM_STR(AZ_IOT_MESSAGE_PROPERTIES_CONTENT_ENCODING),
+      AZ_SPAN_FROM_STR(AZ_IOT_MESSAGE_CONTENT_ENCODING_LZ4)));
+
+  *out_payload = az_span_slice(destination, 0, compressed_size);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_message_payload_decompress(
+    az_iot_message_properties* properties,
+    az_span payload,
+    az_span destination,
+    az_span* out_payload)
+{
+  _az_PRECONDITION_NOT_NULL(properties);
+  _az_PRECONDITION_VALID_SPAN(payload, 0, true);
+  _az_PRECONDITION_VALID_SPAN(destination, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_payload);
+
+  az_span content_encoding = AZ_SPAN_EMPTY;
+  if (az_result_failed(az_iot_message_properties_find(
+          properties,
+          AZ_SPAN_FROM_STR(AZ_IOT_MESSAGE_PROPERTIES_CONTENT_ENCODING),
+          &content_encoding))
+      || !az_span_is_content_equal(
+          content_encoding, AZ_SPAN_FROM_STR(AZ_IOT_MESSAGE_CONTENT_ENCODING_LZ4)))
+  {
+    // Other content encodings, such as a character set, leave the payload as is.
+    *out_payload = payload;
+    return AZ_OK;
+  }
+
+  // An LZ4 block is never empty.
+  if (az_span_size(payload) < 1)
+  {
+    return AZ_ERROR_UNEXPECTED_END;
+  }
+
+  int32_t decompressed_size = 0;
+  _az_RETURN_IF_FAILED(az_lz4_decompress(destination, payload, &decompressed_size));
+
+  *out_payload = az_span_slice(destination, 0, decompressed_size);
+  return AZ_OK;
+}
+
 AZ_NODISCARD int32_t az_iot_calculate_retry_delay(
     int32_t operation_msec,
     int16_t attempt,
@@ -173,6 +431,140 @@ AZ_NODISCARD int32_t az_iot_calculate_retry_delay(
   return delay > 0 ? delay : 0;
 }
 
+AZ_NODISCARD az_iot_retry_policy_options az_iot_retry_policy_options_default()
+{
+  return (az_iot_retry_policy_options){
+    .jitter = AZ_IOT_RETRY_JITTER_DECORRELATED,
+    .min_retry_delay_msec = 1000,
+    .max_retry_delay_msec = 100000,
+    .seed = 0,
+  };
+}
+
+AZ_NODISCARD az_result az_iot_retry_policy_init(
+    az_iot_retry_policy* policy,
+    az_span device_id,
+    az_iot_retry_policy_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(policy);
+  _az_PRECONDITION_VALID_SPAN(device_id, 0, true);
+
+  policy->_internal.options = options == NULL ? az_iot_retry_policy_options_default() : *options;
+
+  _az_PRECONDITION_RANGE(1, policy->_internal.options.min_retry_delay_msec, INT32_MAX - 1);
+  _az_PRECONDITION_RANGE(
+      policy->_internal.options.min_retry_delay_msec,
+      policy->_internal.options.max_retry_delay_msec,
+      INT32_MAX - 1);
+
+  uint32_t seed = policy->_internal.options.seed;
+  if (seed == 0)
+  {
+    seed = _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, device_id);
+  }
+  policy->_internal.random_state = seed;
+
+  az_iot_retry_policy_reset(policy);
+  return AZ_OK;
+}
+
+// Draws a random value between min and max, both included.
+static AZ_NODISCARD int32_t
+_az_iot_retry_policy_random(az_iot_retry_policy* policy, int32_t min, int32_t max)
+{
+  uint32_t const x = _az_iot_xorshift32(&policy->_internal.random_state);
+  return min + (int32_t)(x % ((uint32_t)(max - min) + 1));
+}
+
+AZ_NODISCARD int32_t
+az_iot_retry_policy_get_next_delay(az_iot_retry_policy* policy, int32_t retry_after_msec)
+{
+  _az_PRECONDITION_NOT_NULL(policy);
+  _az_PRECONDITION_RANGE(0, retry_after_msec, INT32_MAX - 1);
+
+  if (_az_LOG_SHOULD_WRITE(AZ_LOG_IOT_RETRY))
+  {
+    _az_LOG_WRITE(AZ_LOG_IOT_RETRY, AZ_SPAN_EMPTY);
+  }
+
+  int32_t const min_delay = policy->_internal.options.min_retry_delay_msec;
+  int32_t const max_delay = policy->_internal.options.max_retry_delay_msec;
+  int32_t const attempt = policy->_internal.attempt;
+  if (attempt < INT32_MAX)
+  {
+    policy->_internal.attempt++;
+  }
+
+  // The exponential backoff, without overflowing, as the maximum delay is reached long before.
+  int64_t const backoff = attempt < 31 ? (int64_t)min_delay << attempt : (int64_t)max_delay;
+  int32_t const capped_backoff = backoff > max_delay ? max_delay : (int32_t)backoff;
+
+  int32_t delay;
+  switch (policy->_internal.options.jitter)
+  {
+    case AZ_IOT_RETRY_JITTER_FULL:
+      delay = _az_iot_retry_policy_random(policy, 0, capped_backoff);
+      break;
+    case AZ_IOT_RETRY_JITTER_EQUAL:
+      delay = (capped_backoff / 2)
+          + _az_iot_retry_policy_random(policy, 0, capped_backoff - (capped_backoff / 2));
+      break;
+    default:
+    {
+      int64_t const upper = (int64_t)policy->_internal.previous_delay_msec * 3;
+      delay = _az_iot_retry_policy_random(
+          policy, min_delay, upper > max_delay ? max_delay : (int32_t)upper);
+      break;
+    }
+  }
+  policy->_internal.previous_delay_msec = delay;
+
+  if (retry_after_msec > 0)
+  {
+    int32_t const max_spread = INT32_MAX - retry_after_msec;
+    int32_t const hinted_delay = retry_after_msec
+        + _az_iot_retry_policy_random(policy, 0, min_delay < max_spread ? min_delay : max_spread);
+    if (delay < hinted_delay)
+    {
+      delay = hinted_delay;
+    }
+  }
+
+  return delay;
+}
+
+void az_iot_retry_policy_reset(az_iot_retry_policy* policy)
+{
+  _az_PRECONDITION_NOT_NULL(policy);
+
+  policy->_internal.attempt = 0;
+  policy->_internal.previous_delay_msec = policy->_internal.options.min_retry_delay_msec;
+}
+
+AZ_NODISCARD uint32_t _az_iot_fnv1a(uint32_t hash, az_span data)
+{
+  uint8_t const* const ptr = az_span_ptr(data);
+  int32_t const size = az_span_size(data);
+  for (int32_t i = 0; i < size; i++)
+  {
+    hash ^= ptr[i];
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+AZ_NODISCARD uint32_t _az_iot_xorshift32(uint32_t* state)
+{
+  _az_PRECONDITION_NOT_NULL(state);
+
+  uint32_t x = *state == 0 ? 1 : *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
 AZ_NODISCARD int32_t _az_iot_u32toa_size(uint32_t number)
 {
   if (number == 0)
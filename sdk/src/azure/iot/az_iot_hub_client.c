@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // SPDX-License-Identifier: MIT
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <azure/core/az_result.h>
@@ -48,6 +49,9 @@ AZ_NODISCARD az_result az_iot_hub_client_init(
   client->_internal.iot_hub_hostname = iot_hub_hostname;
   client->_internal.device_id = device_id;
   client->_internal.options = options == NULL ? az_iot_hub_client_options_default() : *options;
+  client->_internal.telemetry_topic_prefix = AZ_SPAN_EMPTY;
+  client->_internal.component_name_index = NULL;
+  client->_internal.component_name_index_mask = 0;
 
   return AZ_OK;
 }
@@ -179,3 +183,67 @@ AZ_NODISCARD az_result az_iot_hub_client_get_client_id(
 
   return AZ_OK;
 }
+
+static const az_span hub_client_devices_topic_prefix = AZ_SPAN_LITERAL_FROM_STR("devices/");
+static const az_span hub_client_iothub_topic_prefix = AZ_SPAN_LITERAL_FROM_STR("$iothub/");
+
+static AZ_NODISCARD bool _az_iot_hub_client_topic_starts_with(az_span topic, az_span prefix)
+{
+  return az_span_size(topic) >= az_span_size(prefix)
+      && az_span_is_content_equal(az_span_slice(topic, 0, az_span_size(prefix)), prefix);
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_parse_received_topic_any(
+    az_iot_hub_client const* client,
+    az_span received_topic,
+    az_iot_hub_client_received_topic* out_topic)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(received_topic, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_topic);
+
+  bool const is_plug_and_play = az_span_size(client->_internal.options.model_id) > 0;
+  int32_t const prefix_size = az_span_size(hub_client_iothub_topic_prefix);
+
+  // Every topic the service publishes to starts with either "devices/" for C2D messages, or
+  // "$iothub/twin/" or "$iothub/methods/", so looking at the first letter of the topic and of the
+  // feature is enough to pick the one parser which can match.
+  if (_az_iot_hub_client_topic_starts_with(received_topic, hub_client_devices_topic_prefix))
+  {
+    out_topic->kind = AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_C2D;
+    return az_iot_hub_client_c2d_parse_received_topic(
+        client, received_topic, &out_topic->parsed.c2d_request);
+  }
+
+  if (!_az_iot_hub_client_topic_starts_with(received_topic, hub_client_iothub_topic_prefix)
+      || az_span_size(received_topic) == prefix_size)
+  {
+    return AZ_ERROR_IOT_TOPIC_NO_MATCH;
+  }
+
+  switch (az_span_ptr(received_topic)[prefix_size])
+  {
+    case 't':
+      if (is_plug_and_play)
+      {
+        out_topic->kind = AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_PROPERTIES;
+        return az_iot_hub_client_properties_parse_received_topic(
+            client, received_topic, &out_topic->parsed.properties_message);
+      }
+      out_topic->kind = AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_TWIN;
+      return az_iot_hub_client_twin_parse_received_topic(
+          client, received_topic, &out_topic->parsed.twin_response);
+    case 'm':
+      if (is_plug_and_play)
+      {
+        out_topic->kind = AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_COMMAND;
+        return az_iot_hub_client_commands_parse_received_topic(
+            client, received_topic, &out_topic->parsed.command_request);
+      }
+      out_topic->kind = AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_METHOD;
+      return az_iot_hub_client_methods_parse_received_topic(
+          client, received_topic, &out_topic->parsed.method_request);
+    default:
+      return AZ_ERROR_IOT_TOPIC_NO_MATCH;
+  }
+}
@@ -9,14 +9,46 @@
 #include <azure/core/internal/az_precondition_internal.h>
 #include <azure/core/internal/az_result_internal.h>
 #include <azure/iot/az_iot_hub_client.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
 
 #include <azure/core/internal/az_log_internal.h>
 #include <azure/core/internal/az_precondition_internal.h>
 
 #include <azure/core/_az_cfg.h>
 
+// Marks a slot of the dispatcher index which doesn't refer to any entry.
+#define _az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_EMPTY_SLOT (-1)
+
+// The most entries a bucket of the dispatcher index can hold. With at least as many slots as
+// entries, larger buckets are all but impossible unless the hash is degenerate.
+#define _az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_MAX_BUCKET_SIZE 8
+
+// The most seeds tried to place the entries of a bucket, which is plenty unless the index is full.
+#define _az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_MAX_SEED 65536
+
 static const az_span command_separator = AZ_SPAN_LITERAL_FROM_STR("*");
 
+static void _az_iot_hub_client_commands_split_method_name(
+    az_iot_hub_client_method_request const* method_request,
+    az_iot_hub_client_command_request* out_request)
+{
+  out_request->request_id = method_request->request_id;
+
+  int32_t command_separator_index = az_span_find(method_request->name, command_separator);
+  if (command_separator_index > 0)
+  {
+    out_request->component_name = az_span_slice(method_request->name, 0, command_separator_index);
+    out_request->command_name = az_span_slice(
+        method_request->name, command_separator_index + 1, az_span_size(method_request->name));
+  }
+  else
+  {
+    out_request->component_name = AZ_SPAN_EMPTY;
+    out_request->command_name
+        = az_span_slice(method_request->name, 0, az_span_size(method_request->name));
+  }
+}
+
 AZ_NODISCARD az_result az_iot_hub_client_commands_response_get_publish_topic(
     az_iot_hub_client const* client,
     az_span request_id,
@@ -43,21 +75,258 @@ AZ_NODISCARD az_result az_iot_hub_client_commands_parse_received_topic(
   _az_RETURN_IF_FAILED(
       az_iot_hub_client_methods_parse_received_topic(client, received_topic, &method_request));
 
-  out_request->request_id = method_request.request_id;
+  _az_iot_hub_client_commands_split_method_name(&method_request, out_request);
 
-  int32_t command_separator_index = az_span_find(method_request.name, command_separator);
-  if (command_separator_index > 0)
+  return AZ_OK;
+}
+
+static AZ_NODISCARD uint32_t
+_az_iot_hub_client_command_dispatcher_hash(az_span component_name, az_span command_name)
+{
+  uint32_t hash = _az_IOT_FNV1A_OFFSET_BASIS;
+  if (az_span_size(component_name) > 0)
   {
-    out_request->component_name = az_span_slice(method_request.name, 0, command_separator_index);
-    out_request->command_name = az_span_slice(
-        method_request.name, command_separator_index + 1, az_span_size(method_request.name));
+    // Hash the names as the method name they make, "<component_name>*<command_name>".
+    hash = _az_iot_fnv1a(hash, component_name);
+    hash = _az_iot_fnv1a(hash, command_separator);
   }
-  else
+  return _az_iot_fnv1a(hash, command_name);
+}
+
+// Gets the slot of an entry from its hash and the seed of its bucket. The bucket is taken from the
+// low bits of the hash, so the slot mixes all of them (with the finalizer of MurmurHash3), for the
+// entries of a bucket to spread over the whole index.
+static AZ_NODISCARD uint32_t _az_iot_hub_client_command_dispatcher_slot(uint32_t hash, int32_t seed)
+{
+  hash ^= (uint32_t)seed * 0x9E3779B9U;
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6BU;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35U;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+static AZ_NODISCARD bool _az_iot_hub_client_command_dispatcher_entry_matches(
+    az_iot_hub_client_command_dispatcher_entry const* entry,
+    az_span component_name,
+    az_span command_name)
+{
+  return az_span_is_content_equal(entry->component_name, component_name)
+      && az_span_is_content_equal(entry->command_name, command_name);
+}
+
+// Finds a seed which places all the entries of a bucket in empty slots, and places them.
+static AZ_NODISCARD az_result _az_iot_hub_client_command_dispatcher_place_bucket(
+    int32_t* slots,
+    uint32_t mask,
+    int32_t const* bucket_entries,
+    uint32_t const* bucket_hashes,
+    int32_t bucket_size,
+    int32_t* out_seed)
+{
+  for (int32_t seed = 0; seed < _az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_MAX_SEED; seed++)
   {
-    out_request->component_name = AZ_SPAN_EMPTY;
-    out_request->command_name
-        = az_span_slice(method_request.name, 0, az_span_size(method_request.name));
+    int32_t placed = 0;
+    while (placed < bucket_size)
+    {
+      uint32_t const slot
+          = _az_iot_hub_client_command_dispatcher_slot(bucket_hashes[placed], seed) & mask;
+      if (slots[slot] != _az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_EMPTY_SLOT)
+      {
+        break;
+      }
+      slots[slot] = bucket_entries[placed++];
+    }
+
+    if (placed == bucket_size)
+    {
+      *out_seed = seed;
+      return AZ_OK;
+    }
+
+    // Take back the entries placed with this seed before trying the next one.
+    while (placed > 0)
+    {
+      placed--;
+      slots[_az_iot_hub_client_command_dispatcher_slot(bucket_hashes[placed], seed) & mask]
+          = _az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_EMPTY_SLOT;
+    }
   }
 
+  return AZ_ERROR_NOT_ENOUGH_SPACE;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_command_dispatcher_init(
+    az_iot_hub_client_command_dispatcher* dispatcher,
+    az_iot_hub_client_command_dispatcher_entry const* entries,
+    int32_t entries_length,
+    int32_t* index,
+    int32_t index_size)
+{
+  _az_PRECONDITION_NOT_NULL(dispatcher);
+  _az_PRECONDITION_NOT_NULL(entries);
+  _az_PRECONDITION_RANGE(1, entries_length, INT32_MAX / 2);
+  _az_PRECONDITION_NOT_NULL(index);
+  _az_PRECONDITION(index_size / 2 >= entries_length);
+  _az_PRECONDITION((index_size & (index_size - 1)) == 0);
+
+  // The first half of the index holds the seed of each bucket, and the second half the entry of
+  // each slot. While building, a bucket holds the number of its entries until they are placed,
+  // and then the negated seed minus one.
+  int32_t const size = index_size / 2;
+  uint32_t const mask = (uint32_t)size - 1;
+  int32_t* const seeds = index;
+  int32_t* const slots = index + size;
+
+  for (int32_t i = 0; i < size; i++)
+  {
+    seeds[i] = 0;
+    slots[i] = _az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_EMPTY_SLOT;
+  }
+
+  int32_t largest_bucket_size = 0;
+  for (int32_t i = 0; i < entries_length; i++)
+  {
+    uint32_t const bucket
+        = _az_iot_hub_client_command_dispatcher_hash(
+              entries[i].component_name, entries[i].command_name)
+        & mask;
+    if (++seeds[bucket] > largest_bucket_size)
+    {
+      largest_bucket_size = seeds[bucket];
+    }
+  }
+
+  if (largest_bucket_size > _az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_MAX_BUCKET_SIZE)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  int32_t bucket_entries[_az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_MAX_BUCKET_SIZE];
+  uint32_t bucket_hashes[_az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_MAX_BUCKET_SIZE];
+
+  // The largest buckets are placed first, while most slots are still empty. A bucket is met at its
+  // first entry, so only the entries after it need to be searched for the rest of the bucket.
+  for (int32_t bucket_size = largest_bucket_size; bucket_size > 0; bucket_size--)
+  {
+    for (int32_t i = 0; i < entries_length; i++)
+    {
+      uint32_t const hash = _az_iot_hub_client_command_dispatcher_hash(
+          entries[i].component_name, entries[i].command_name);
+      uint32_t const bucket = hash & mask;
+      if (seeds[bucket] != bucket_size)
+      {
+        continue;
+      }
+
+      bucket_entries[0] = i;
+      bucket_hashes[0] = hash;
+      int32_t count = 1;
+      for (int32_t j = i + 1; j < entries_length && count < bucket_size; j++)
+      {
+        uint32_t const other_hash = _az_iot_hub_client_command_dispatcher_hash(
+            entries[j].component_name, entries[j].command_name);
+        if ((other_hash & mask) != bucket)
+        {
+          continue;
+        }
+
+        // Entries with the same hash always get the same slot, whatever the seed, so no perfect
+        // hash can be found for them, be it duplicates or distinct names which collide.
+        for (int32_t k = 0; k < count; k++)
+        {
+          if (bucket_hashes[k] == other_hash)
+          {
+            return _az_iot_hub_client_command_dispatcher_entry_matches(
+                       &entries[bucket_entries[k]],
+                       entries[j].component_name,
+                       entries[j].command_name)
+                ? AZ_ERROR_ARG
+                : AZ_ERROR_NOT_SUPPORTED;
+          }
+        }
+
+        bucket_entries[count] = j;
+        bucket_hashes[count] = other_hash;
+        count++;
+      }
+
+      int32_t seed;
+      _az_RETURN_IF_FAILED(_az_iot_hub_client_command_dispatcher_place_bucket(
+          slots, mask, bucket_entries, bucket_hashes, bucket_size, &seed));
+      seeds[bucket] = -seed - 1;
+    }
+  }
+
+  for (int32_t i = 0; i < size; i++)
+  {
+    seeds[i] = seeds[i] < 0 ? -seeds[i] - 1 : 0;
+  }
+
+  dispatcher->_internal.entries = entries;
+  dispatcher->_internal.entries_length = entries_length;
+  dispatcher->_internal.index = index;
+  dispatcher->_internal.index_mask = mask;
+
   return AZ_OK;
 }
+
+AZ_NODISCARD az_result az_iot_hub_client_command_dispatcher_find(
+    az_iot_hub_client_command_dispatcher const* dispatcher,
+    az_span component_name,
+    az_span command_name,
+    int32_t* out_entry)
+{
+  _az_PRECONDITION_NOT_NULL(dispatcher);
+  _az_PRECONDITION_VALID_SPAN(component_name, 0, true);
+  _az_PRECONDITION_VALID_SPAN(command_name, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_entry);
+
+  uint32_t const mask = dispatcher->_internal.index_mask;
+  int32_t const* const index = dispatcher->_internal.index;
+  uint32_t const hash = _az_iot_hub_client_command_dispatcher_hash(component_name, command_name);
+
+  uint32_t const slot = _az_iot_hub_client_command_dispatcher_slot(hash, index[hash & mask]) & mask;
+  int32_t const entry = index[mask + 1 + slot];
+
+  // Names which aren't in the table still land in some slot, so the entry must be compared.
+  if (entry == _az_IOT_HUB_CLIENT_COMMAND_DISPATCHER_EMPTY_SLOT
+      || !_az_iot_hub_client_command_dispatcher_entry_matches(
+          &dispatcher->_internal.entries[entry], component_name, command_name))
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  *out_entry = entry;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_command_dispatcher_dispatch(
+    az_iot_hub_client_command_dispatcher const* dispatcher,
+    az_iot_hub_client_command_request const* request,
+    void* user_context)
+{
+  _az_PRECONDITION_NOT_NULL(dispatcher);
+  _az_PRECONDITION_NOT_NULL(request);
+
+  int32_t entry;
+  _az_RETURN_IF_FAILED(az_iot_hub_client_command_dispatcher_find(
+      dispatcher, request->component_name, request->command_name, &entry));
+
+  return dispatcher->_internal.entries[entry].handler(request, user_context);
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_command_dispatcher_dispatch_method(
+    az_iot_hub_client_command_dispatcher const* dispatcher,
+    az_iot_hub_client_method_request const* request,
+    void* user_context)
+{
+  _az_PRECONDITION_NOT_NULL(dispatcher);
+  _az_PRECONDITION_NOT_NULL(request);
+
+  az_iot_hub_client_command_request command_request;
+  _az_iot_hub_client_commands_split_method_name(request, &command_request);
+
+  return az_iot_hub_client_command_dispatcher_dispatch(dispatcher, &command_request, user_context);
+}
@@ -2,10 +2,13 @@
 // SPDX-License-Identifier: MIT
 
 #include <azure/iot/az_iot_hub_client_properties.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
 
 #include <azure/core/internal/az_precondition_internal.h>
 #include <azure/core/internal/az_result_internal.h>
 
+#include <string.h>
+
 static const az_span iot_hub_properties_reported = AZ_SPAN_LITERAL_FROM_STR("reported");
 static const az_span iot_hub_properties_desired = AZ_SPAN_LITERAL_FROM_STR("desired");
 static const az_span iot_hub_properties_desired_version = AZ_SPAN_LITERAL_FROM_STR("$version");
@@ -165,6 +168,51 @@ static az_result json_child_token_move(az_json_reader* ref_jr, az_span property_
   return AZ_ERROR_ITEM_NOT_FOUND;
 }
 
+// Marks a slot of the component name index which doesn't refer to any component name.
+#define _az_IOT_HUB_CLIENT_COMPONENT_NAME_INDEX_EMPTY_SLOT (-1)
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_build_component_name_index(
+    az_iot_hub_client* client,
+    int32_t* component_name_index,
+    int32_t component_name_index_size)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(component_name_index);
+  _az_PRECONDITION(component_name_index_size > client->_internal.options.component_names_length);
+  _az_PRECONDITION((component_name_index_size & (component_name_index_size - 1)) == 0);
+
+  uint32_t const mask = (uint32_t)component_name_index_size - 1;
+  for (int32_t i = 0; i < component_name_index_size; i++)
+  {
+    component_name_index[i] = _az_IOT_HUB_CLIENT_COMPONENT_NAME_INDEX_EMPTY_SLOT;
+  }
+
+  az_span const* const component_names = client->_internal.options.component_names;
+  for (int32_t i = 0; i < client->_internal.options.component_names_length; i++)
+  {
+    uint32_t slot = _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, component_names[i]) & mask;
+
+    // The index is always larger than the number of names, so there is an empty slot to stop at.
+    // A repeated name keeps its first slot, which is the one the linear search would find.
+    while (component_name_index[slot] != _az_IOT_HUB_CLIENT_COMPONENT_NAME_INDEX_EMPTY_SLOT
+           && !az_span_is_content_equal(
+               component_names[component_name_index[slot]], component_names[i]))
+    {
+      slot = (slot + 1) & mask;
+    }
+
+    if (component_name_index[slot] == _az_IOT_HUB_CLIENT_COMPONENT_NAME_INDEX_EMPTY_SLOT)
+    {
+      component_name_index[slot] = i;
+    }
+  }
+
+  client->_internal.component_name_index = component_name_index;
+  client->_internal.component_name_index_mask = mask;
+
+  return AZ_OK;
+}
+
 // Check if the component name is in the model.  While this is sometimes
 // indicated in the twin metadata (via "__t":"c" as a child), this metadata will NOT
 // be specified during a TWIN PATCH operation.  Hence we cannot rely on it
@@ -174,6 +222,30 @@ static bool is_component_in_model(
     az_json_token const* component_name,
     az_span* out_component_name)
 {
+  int32_t const* const component_name_index = client->_internal.component_name_index;
+
+  // The index hashes the names as they are, which is how a token is only when it is in a single
+  // buffer and has no escaped characters.
+  if (component_name_index != NULL && !component_name->_internal.is_multisegment
+      && !component_name->_internal.string_has_escaped_chars)
+  {
+    uint32_t const mask = client->_internal.component_name_index_mask;
+    uint32_t slot = _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, component_name->slice) & mask;
+
+    while (component_name_index[slot] != _az_IOT_HUB_CLIENT_COMPONENT_NAME_INDEX_EMPTY_SLOT)
+    {
+      az_span const name = client->_internal.options.component_names[component_name_index[slot]];
+      if (az_span_is_content_equal(name, component_name->slice))
+      {
+        *out_component_name = name;
+        return true;
+      }
+      slot = (slot + 1) & mask;
+    }
+
+    return false;
+  }
+
   int32_t index = 0;
 
   while (index < client->_internal.options.component_names_length)
@@ -226,6 +298,335 @@ AZ_NODISCARD az_result az_iot_hub_client_properties_get_properties_version(
   return AZ_OK;
 }
 
+// The largest property name with escaped characters which a patch can write, as it is unescaped on
+// the stack first.
+#define _az_IOT_HUB_CLIENT_PROPERTIES_PATCH_NAME_MAX_SIZE 128
+
+// Gets the JSON text of the value the reader is on, within the json it reads, and moves the reader
+// to the last token of the value.
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_patch_read_value(
+    az_json_reader* ref_json_reader,
+    az_span json,
+    az_span* out_value)
+{
+  az_json_token_kind const kind = ref_json_reader->token.kind;
+  int32_t start = (int32_t)(az_span_ptr(ref_json_reader->token.slice) - az_span_ptr(json));
+  int32_t end;
+
+  if (kind == AZ_JSON_TOKEN_BEGIN_OBJECT || kind == AZ_JSON_TOKEN_BEGIN_ARRAY)
+  {
+    _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+    end = (int32_t)(az_span_ptr(ref_json_reader->token.slice) - az_span_ptr(json)) + 1;
+  }
+  else if (kind == AZ_JSON_TOKEN_STRING)
+  {
+    // The slice of a string leaves out its quotes.
+    start--;
+    end = start + ref_json_reader->token.size + 2;
+  }
+  else
+  {
+    end = start + ref_json_reader->token.size;
+  }
+
+  *out_value = az_span_slice(json, start, end);
+  return AZ_OK;
+}
+
+static AZ_NODISCARD bool _az_iot_hub_client_properties_patch_names_equal(
+    az_json_token const* name,
+    az_json_token const* other_name)
+{
+  if (!other_name->_internal.string_has_escaped_chars)
+  {
+    return az_json_token_is_text_equal(name, other_name->slice);
+  }
+  if (!name->_internal.string_has_escaped_chars)
+  {
+    return az_json_token_is_text_equal(other_name, name->slice);
+  }
+
+  // Both are escaped, which property names hardly ever are, so they are compared as they are.
+  return az_span_is_content_equal(name->slice, other_name->slice);
+}
+
+// Finds the value of the member of the JSON object with the given name, which is the token of
+// another reader, or name if name_token_or_null is NULL.
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_patch_find(
+    az_span object,
+    az_json_token const* name_token_or_null,
+    az_span name,
+    az_span* out_value)
+{
+  az_json_reader jr;
+  _az_RETURN_IF_FAILED(az_json_reader_init(&jr, object, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+
+  while (jr.token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  {
+    bool const is_match = name_token_or_null == NULL
+        ? az_json_token_is_text_equal(&jr.token, name)
+        : _az_iot_hub_client_properties_patch_names_equal(&jr.token, name_token_or_null);
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+    if (is_match)
+    {
+      return _az_iot_hub_client_properties_patch_read_value(&jr, object, out_value);
+    }
+    _az_RETURN_IF_FAILED(az_json_reader_skip_children(&jr));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  }
+
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
+
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_patch_get_version(
+    az_span object,
+    int32_t* out_version)
+{
+  az_span version;
+  _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_patch_find(
+      object, NULL, iot_hub_properties_desired_version, &version));
+  return az_span_atoi32(version, out_version);
+}
+
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_patch_append_name(
+    az_json_writer* ref_json_writer,
+    az_json_token const* name)
+{
+  if (!name->_internal.string_has_escaped_chars)
+  {
+    return az_json_writer_append_property_name(ref_json_writer, name->slice);
+  }
+
+  // The writer escapes the name again, so it needs it unescaped.
+  uint8_t name_buffer[_az_IOT_HUB_CLIENT_PROPERTIES_PATCH_NAME_MAX_SIZE];
+  if (name->size > _az_IOT_HUB_CLIENT_PROPERTIES_PATCH_NAME_MAX_SIZE)
+  {
+    return AZ_ERROR_NOT_SUPPORTED;
+  }
+  return az_json_writer_append_property_name(
+      ref_json_writer, az_json_string_unescape(name->slice, AZ_SPAN_FROM_BUFFER(name_buffer)));
+}
+
+static AZ_NODISCARD bool _az_iot_hub_client_properties_patch_is_object(az_span value)
+{
+  return az_span_size(value) > 0 && az_span_ptr(value)[0] == '{';
+}
+
+static AZ_NODISCARD bool _az_iot_hub_client_properties_patch_is_null(az_span value)
+{
+  return az_span_size(value) > 0 && az_span_ptr(value)[0] == 'n';
+}
+
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_patch_merge(
+    az_span target,
+    az_span patch,
+    bool is_root,
+    int32_t version,
+    az_json_writer* ref_json_writer);
+
+// Writes the value of a patch for a member whose value in the target is target_value, or empty if
+// the target has no such member.
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_patch_append_value(
+    az_span target_value,
+    az_span patch_value,
+    az_json_writer* ref_json_writer)
+{
+  if (!_az_iot_hub_client_properties_patch_is_object(patch_value))
+  {
+    return az_json_writer_append_json_text(ref_json_writer, patch_value);
+  }
+
+  // An object is merged, even into nothing, so that the nulls it holds are left out.
+  return _az_iot_hub_client_properties_patch_merge(
+      _az_iot_hub_client_properties_patch_is_object(target_value) ? target_value : AZ_SPAN_EMPTY,
+      patch_value,
+      false,
+      0,
+      ref_json_writer);
+}
+
+// Writes the JSON object target, or {} if it is empty, merged with the JSON object patch. The root
+// object ends with version, instead of the versions of target and patch.
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_patch_merge(
+    az_span target,
+    az_span patch,
+    bool is_root,
+    int32_t version,
+    az_json_writer* ref_json_writer)
+{
+  az_json_reader jr;
+  az_span value;
+  az_span patch_value;
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+  // The members of the target, in their order, unless the patch removes them.
+  if (az_span_size(target) > 0)
+  {
+    _az_RETURN_IF_FAILED(az_json_reader_init(&jr, target, NULL));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+
+    while (jr.token.kind != AZ_JSON_TOKEN_END_OBJECT)
+    {
+      az_json_token const name = jr.token;
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+      _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_patch_read_value(&jr, target, &value));
+
+      if (!is_root || !az_json_token_is_text_equal(&name, iot_hub_properties_desired_version))
+      {
+        az_result const result
+            = _az_iot_hub_client_properties_patch_find(patch, &name, AZ_SPAN_EMPTY, &patch_value);
+        if (result == AZ_ERROR_ITEM_NOT_FOUND)
+        {
+          _az_RETURN_IF_FAILED(
+              _az_iot_hub_client_properties_patch_append_name(ref_json_writer, &name));
+          _az_RETURN_IF_FAILED(az_json_writer_append_json_text(ref_json_writer, value));
+        }
+        else
+        {
+          _az_RETURN_IF_FAILED(result);
+          if (!_az_iot_hub_client_properties_patch_is_null(patch_value))
+          {
+            _az_RETURN_IF_FAILED(
+                _az_iot_hub_client_properties_patch_append_name(ref_json_writer, &name));
+            _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_patch_append_value(
+                value, patch_value, ref_json_writer));
+          }
+        }
+      }
+
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+    }
+  }
+
+  // The members which are only in the patch.
+  _az_RETURN_IF_FAILED(az_json_reader_init(&jr, patch, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+
+  while (jr.token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  {
+    az_json_token const name = jr.token;
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+    _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_patch_read_value(&jr, patch, &patch_value));
+
+    if (!_az_iot_hub_client_properties_patch_is_null(patch_value)
+        && (!is_root || !az_json_token_is_text_equal(&name, iot_hub_properties_desired_version)))
+    {
+      az_result result = AZ_ERROR_ITEM_NOT_FOUND;
+      if (az_span_size(target) > 0)
+      {
+        result = _az_iot_hub_client_properties_patch_find(target, &name, AZ_SPAN_EMPTY, &value);
+      }
+
+      if (result == AZ_ERROR_ITEM_NOT_FOUND)
+      {
+        _az_RETURN_IF_FAILED(
+            _az_iot_hub_client_properties_patch_append_name(ref_json_writer, &name));
+        _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_patch_append_value(
+            AZ_SPAN_EMPTY, patch_value, ref_json_writer));
+      }
+      else
+      {
+        _az_RETURN_IF_FAILED(result);
+      }
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  }
+
+  if (is_root)
+  {
+    _az_RETURN_IF_FAILED(
+        az_json_writer_append_property_name(ref_json_writer, iot_hub_properties_desired_version));
+    _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_json_writer, version));
+  }
+
+  return az_json_writer_append_end_object(ref_json_writer);
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_apply_writable_patch(
+    az_iot_hub_client const* client,
+    az_span desired_properties,
+    az_json_reader* ref_json_reader,
+    az_iot_hub_client_properties_message_type message_type,
+    az_json_writer* ref_json_writer,
+    az_iot_hub_client_properties_patch_status* out_status)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(desired_properties, 0, true);
+  _az_PRECONDITION_NOT_NULL(ref_json_reader);
+  _az_PRECONDITION(ref_json_reader->_internal.number_of_buffers == 1);
+  _az_PRECONDITION(
+      (message_type == AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED)
+      || (message_type == AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE));
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_NOT_NULL(out_status);
+
+  (void)client;
+
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  if (ref_json_reader->token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  az_span patch;
+  _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_patch_read_value(
+      ref_json_reader, ref_json_reader->_internal.json_buffer, &patch));
+
+  if (message_type == AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE)
+  {
+    _az_RETURN_IF_FAILED(
+        _az_iot_hub_client_properties_patch_find(patch, NULL, iot_hub_properties_desired, &patch));
+    if (!_az_iot_hub_client_properties_patch_is_object(patch))
+    {
+      return AZ_ERROR_UNEXPECTED_CHAR;
+    }
+  }
+
+  int32_t version;
+  _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_patch_get_version(patch, &version));
+
+  // Desired properties without a version are older than any payload.
+  int32_t desired_version = 0;
+  if (az_span_size(desired_properties) > 0)
+  {
+    az_result const result
+        = _az_iot_hub_client_properties_patch_get_version(desired_properties, &desired_version);
+    if (result != AZ_ERROR_ITEM_NOT_FOUND)
+    {
+      _az_RETURN_IF_FAILED(result);
+    }
+  }
+
+  if (version <= desired_version)
+  {
+    *out_status = AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_STALE;
+    return AZ_OK;
+  }
+
+  if (message_type == AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE)
+  {
+    // The whole document replaces the desired properties, so nothing can be missing from them.
+    _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_patch_merge(
+        AZ_SPAN_EMPTY, patch, true, version, ref_json_writer));
+    *out_status = AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED;
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_patch_merge(
+      desired_properties, patch, true, version, ref_json_writer));
+  *out_status = version == desired_version + 1
+      ? AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED
+      : AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED_AFTER_GAP;
+  return AZ_OK;
+}
+
 // process_first_move_if_needed performs initial setup when beginning to parse
 // the JSON document.  It sets the next read token to the appropriate
 // location based on whether we have a full twin or a patch and what property_type
@@ -484,3 +885,587 @@ AZ_NODISCARD az_result az_iot_hub_client_properties_get_next_component_property(
 
   return AZ_OK;
 }
+
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_index_add(
+    az_iot_hub_client_properties_index* index,
+    az_span component_name,
+    az_iot_hub_client_property_type property_type,
+    az_span json,
+    uint8_t const* name_in_payload)
+{
+  if (index->_internal.count == index->_internal.capacity)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  az_iot_hub_client_properties_index_entry* const entry
+      = &index->_internal.entries[index->_internal.count++];
+  entry->_internal.component_name = component_name;
+  entry->_internal.property_type = property_type;
+  entry->_internal.json = json;
+  entry->_internal.name_in_payload = name_in_payload;
+
+  return AZ_OK;
+}
+
+// Gets where the current token of a reader over a single buffer is within that buffer.
+static AZ_NODISCARD int32_t
+_az_iot_hub_client_properties_index_token_offset(az_span json_payload, az_json_token const* token)
+{
+  return (int32_t)(az_span_ptr(token->slice) - az_span_ptr(json_payload));
+}
+
+// Records the section of the payload the reader is at the beginning of, for the root component,
+// and the components in it. The reader is left at the end of the section.
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_index_add_section(
+    az_iot_hub_client_properties_index* index,
+    az_json_reader* ref_json_reader,
+    az_span json_payload,
+    az_iot_hub_client_property_type property_type)
+{
+  int32_t const section_begin
+      = _az_iot_hub_client_properties_index_token_offset(json_payload, &ref_json_reader->token);
+  int32_t const root_entry = index->_internal.count;
+  _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_index_add(
+      index, AZ_SPAN_EMPTY, property_type, AZ_SPAN_EMPTY, NULL));
+
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  while (ref_json_reader->token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    az_span component_name;
+    bool const is_component
+        = is_component_in_model(index->_internal.client, &ref_json_reader->token, &component_name);
+    uint8_t const* const name_in_payload = az_span_ptr(ref_json_reader->token.slice);
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+    if (is_component && ref_json_reader->token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT)
+    {
+      int32_t const component_begin
+          = _az_iot_hub_client_properties_index_token_offset(json_payload, &ref_json_reader->token);
+      _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+      int32_t const component_end
+          = _az_iot_hub_client_properties_index_token_offset(json_payload, &ref_json_reader->token)
+          + 1 /* END OF OBJECT */;
+      _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_index_add(
+          index,
+          component_name,
+          property_type,
+          az_span_slice(json_payload, component_begin, component_end),
+          name_in_payload));
+    }
+    else
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  int32_t const section_end
+      = _az_iot_hub_client_properties_index_token_offset(json_payload, &ref_json_reader->token)
+      + 1 /* END OF OBJECT */;
+  index->_internal.entries[root_entry]._internal.json
+      = az_span_slice(json_payload, section_begin, section_end);
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_index_build(
+    az_iot_hub_client const* client,
+    az_span json_payload,
+    az_iot_hub_client_properties_message_type message_type,
+    az_iot_hub_client_properties_index* out_index,
+    az_iot_hub_client_properties_index_entry* entries,
+    int32_t capacity)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(json_payload, 1, false);
+  _az_PRECONDITION(
+      (message_type == AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED)
+      || (message_type == AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE));
+  _az_PRECONDITION_NOT_NULL(out_index);
+  _az_PRECONDITION_NOT_NULL(entries);
+  _az_PRECONDITION(capacity > 0);
+
+  out_index->_internal.client = client;
+  out_index->_internal.entries = entries;
+  out_index->_internal.capacity = capacity;
+  out_index->_internal.count = 0;
+
+  az_json_reader jr;
+  _az_RETURN_IF_FAILED(az_json_reader_init(&jr, json_payload, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  if (jr.token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  if (message_type == AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED)
+  {
+    return _az_iot_hub_client_properties_index_add_section(
+        out_index, &jr, json_payload, AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE);
+  }
+
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  while (jr.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    bool const is_desired = az_json_token_is_text_equal(&jr.token, iot_hub_properties_desired);
+    bool const is_reported = az_json_token_is_text_equal(&jr.token, iot_hub_properties_reported);
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+    if ((is_desired || is_reported) && jr.token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT)
+    {
+      _az_RETURN_IF_FAILED(_az_iot_hub_client_properties_index_add_section(
+          out_index,
+          &jr,
+          json_payload,
+          is_desired ? AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE
+                     : AZ_IOT_HUB_CLIENT_PROPERTY_REPORTED_FROM_DEVICE));
+    }
+    else
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_skip_children(&jr));
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_index_get_reader(
+    az_iot_hub_client_properties_index const* index,
+    az_iot_hub_client_property_type property_type,
+    az_span component_name,
+    az_json_reader* out_json_reader)
+{
+  _az_PRECONDITION_NOT_NULL(index);
+  _az_PRECONDITION(
+      (property_type == AZ_IOT_HUB_CLIENT_PROPERTY_REPORTED_FROM_DEVICE)
+      || (property_type == AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE));
+  _az_PRECONDITION_VALID_SPAN(component_name, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_json_reader);
+
+  for (int32_t i = 0; i < index->_internal.count; i++)
+  {
+    az_iot_hub_client_properties_index_entry const* const entry = &index->_internal.entries[i];
+    if (entry->_internal.property_type == property_type
+        && az_span_is_content_equal(entry->_internal.component_name, component_name))
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_init(out_json_reader, entry->_internal.json, NULL));
+      return az_json_reader_next_token(out_json_reader);
+    }
+  }
+
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
+
+// Tells whether the property name a reader is on is the one of a component, whose properties are
+// read with their own reader. Only the readers of the root component come across them.
+static AZ_NODISCARD bool _az_iot_hub_client_properties_index_is_component_name(
+    az_iot_hub_client_properties_index const* index,
+    az_json_reader const* json_reader)
+{
+  uint8_t const* const name = az_span_ptr(json_reader->token.slice);
+  for (int32_t i = 0; i < index->_internal.count; i++)
+  {
+    if (index->_internal.entries[i]._internal.name_in_payload == name)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_index_get_next_property(
+    az_iot_hub_client_properties_index const* index,
+    az_json_reader* ref_json_reader)
+{
+  _az_PRECONDITION_NOT_NULL(index);
+  _az_PRECONDITION_NOT_NULL(ref_json_reader);
+
+  if (ref_json_reader->token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT
+      && ref_json_reader->current_depth == 0)
+  {
+    // The first move, from the beginning of the object.
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  if (ref_json_reader->current_depth > 1
+      || (ref_json_reader->token.kind != AZ_JSON_TOKEN_PROPERTY_NAME
+          && ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT))
+  {
+    return AZ_ERROR_JSON_INVALID_STATE;
+  }
+
+  while (ref_json_reader->token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    if (!az_json_token_is_text_equal(&ref_json_reader->token, iot_hub_properties_desired_version)
+        && !az_json_token_is_text_equal(&ref_json_reader->token, component_properties_label_name)
+        && !_az_iot_hub_client_properties_index_is_component_name(index, ref_json_reader))
+    {
+      return AZ_OK;
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+    _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  return AZ_ERROR_IOT_END_OF_PROPERTIES;
+}
+
+enum
+{
+  // The property has been set at least once.
+  _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_HAS_VALUE = 1,
+  // The value changed since the last payload was written.
+  _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_CHANGED = 2,
+  // The value was written to the payload waiting for a response.
+  _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_IN_FLIGHT = 4,
+};
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_init(
+    az_iot_hub_client_properties_cache* cache,
+    az_iot_hub_client_properties_cache_slot* slots,
+    int32_t capacity)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+  _az_PRECONDITION_NOT_NULL(slots);
+  _az_PRECONDITION(capacity > 0);
+
+  cache->_internal.slots = slots;
+  cache->_internal.capacity = capacity;
+  cache->_internal.count = 0;
+  cache->_internal.pending_request_id_size = 0;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_add(
+    az_iot_hub_client_properties_cache* cache,
+    az_span component_name,
+    az_span property_name,
+    az_iot_hub_client_properties_cache_type type,
+    int32_t* out_slot)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+  _az_PRECONDITION_VALID_SPAN(component_name, 0, true);
+  _az_PRECONDITION_VALID_SPAN(property_name, 1, false);
+  _az_PRECONDITION_RANGE(
+      AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_INT32, type, AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_STRING);
+
+  if (cache->_internal.count == cache->_internal.capacity)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  az_iot_hub_client_properties_cache_slot* const slot
+      = &cache->_internal.slots[cache->_internal.count];
+  slot->_internal.component_name = component_name;
+  slot->_internal.property_name = property_name;
+  slot->_internal.type = type;
+  memset(&slot->_internal.value, 0, sizeof(slot->_internal.value));
+  slot->_internal.fractional_digits = 0;
+  slot->_internal.string_hash = 0;
+  slot->_internal.flags = 0;
+
+  if (out_slot != NULL)
+  {
+    *out_slot = cache->_internal.count;
+  }
+  cache->_internal.count++;
+
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_iot_hub_client_properties_cache_slot*
+_az_iot_hub_client_properties_cache_set(
+    az_iot_hub_client_properties_cache* cache,
+    int32_t slot,
+    bool changed)
+{
+  az_iot_hub_client_properties_cache_slot* const cache_slot = &cache->_internal.slots[slot];
+  if (changed
+      || (cache_slot->_internal.flags & _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_HAS_VALUE) == 0)
+  {
+    cache_slot->_internal.flags |= _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_HAS_VALUE
+        | _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_CHANGED;
+  }
+  return cache_slot;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_set_int32(
+    az_iot_hub_client_properties_cache* cache,
+    int32_t slot,
+    int32_t value)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+  _az_PRECONDITION_RANGE(0, slot, cache->_internal.count - 1);
+  _az_PRECONDITION(
+      cache->_internal.slots[slot]._internal.type == AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_INT32);
+
+  az_iot_hub_client_properties_cache_slot* const cache_slot
+      = _az_iot_hub_client_properties_cache_set(
+          cache, slot, cache->_internal.slots[slot]._internal.value.int32_value != value);
+  cache_slot->_internal.value.int32_value = value;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_set_double(
+    az_iot_hub_client_properties_cache* cache,
+    int32_t slot,
+    double value,
+    int32_t fractional_digits)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+  _az_PRECONDITION_RANGE(0, slot, cache->_internal.count - 1);
+  _az_PRECONDITION(
+      cache->_internal.slots[slot]._internal.type == AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_DOUBLE);
+  _az_PRECONDITION_RANGE(0, fractional_digits, 15);
+
+  // Compare the bits, since a value is only the same if it is written the same way.
+  az_iot_hub_client_properties_cache_slot const* const current = &cache->_internal.slots[slot];
+  bool const changed
+      = memcmp(&current->_internal.value.double_value, &value, sizeof(value)) != 0
+      || current->_internal.fractional_digits != fractional_digits;
+
+  az_iot_hub_client_properties_cache_slot* const cache_slot
+      = _az_iot_hub_client_properties_cache_set(cache, slot, changed);
+  cache_slot->_internal.value.double_value = value;
+  cache_slot->_internal.fractional_digits = fractional_digits;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_set_bool(
+    az_iot_hub_client_properties_cache* cache,
+    int32_t slot,
+    bool value)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+  _az_PRECONDITION_RANGE(0, slot, cache->_internal.count - 1);
+  _az_PRECONDITION(
+      cache->_internal.slots[slot]._internal.type == AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_BOOL);
+
+  az_iot_hub_client_properties_cache_slot* const cache_slot
+      = _az_iot_hub_client_properties_cache_set(
+          cache, slot, cache->_internal.slots[slot]._internal.value.bool_value != value);
+  cache_slot->_internal.value.bool_value = value;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_set_string(
+    az_iot_hub_client_properties_cache* cache,
+    int32_t slot,
+    az_span value)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+  _az_PRECONDITION_RANGE(0, slot, cache->_internal.count - 1);
+  _az_PRECONDITION(
+      cache->_internal.slots[slot]._internal.type == AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_STRING);
+  _az_PRECONDITION_VALID_SPAN(value, 0, true);
+
+  // The previous value may be the same buffer, updated in place, so its content can't be compared
+  // to. A hash of the content is kept instead, along with the size.
+  uint32_t const hash = _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, value);
+
+  az_iot_hub_client_properties_cache_slot const* const current = &cache->_internal.slots[slot];
+  bool const changed = current->_internal.string_hash != hash
+      || az_span_size(current->_internal.value.string_value) != az_span_size(value);
+
+  az_iot_hub_client_properties_cache_slot* const cache_slot
+      = _az_iot_hub_client_properties_cache_set(cache, slot, changed);
+  cache_slot->_internal.value.string_value = value;
+  cache_slot->_internal.string_hash = hash;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD bool az_iot_hub_client_properties_cache_has_changes(
+    az_iot_hub_client_properties_cache const* cache)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+
+  for (int32_t i = 0; i < cache->_internal.count; i++)
+  {
+    if ((cache->_internal.slots[i]._internal.flags & _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_CHANGED)
+        != 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static AZ_NODISCARD bool _az_iot_hub_client_properties_cache_is_written(
+    az_iot_hub_client_properties_cache_slot const* slot)
+{
+  return (slot->_internal.flags
+          & (_az_IOT_HUB_CLIENT_PROPERTIES_CACHE_CHANGED
+             | _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_IN_FLIGHT))
+      != 0;
+}
+
+static AZ_NODISCARD az_result _az_iot_hub_client_properties_cache_write_property(
+    az_iot_hub_client_properties_cache_slot const* slot,
+    az_json_writer* ref_json_writer)
+{
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, slot->_internal.property_name));
+
+  switch (slot->_internal.type)
+  {
+    case AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_INT32:
+      return az_json_writer_append_int32(ref_json_writer, slot->_internal.value.int32_value);
+    case AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_DOUBLE:
+      return az_json_writer_append_double(
+          ref_json_writer, slot->_internal.value.double_value, slot->_internal.fractional_digits);
+    case AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_BOOL:
+      return az_json_writer_append_bool(ref_json_writer, slot->_internal.value.bool_value);
+    default:
+      return az_json_writer_append_string(ref_json_writer, slot->_internal.value.string_value);
+  }
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_write_patch(
+    az_iot_hub_client_properties_cache* cache,
+    az_iot_hub_client const* client,
+    az_json_writer* ref_json_writer,
+    az_span request_id)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_VALID_SPAN(request_id, 1, false);
+
+  if (az_span_size(request_id) > _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_REQUEST_ID_MAX_SIZE)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  az_iot_hub_client_properties_cache_slot* const slots = cache->_internal.slots;
+  int32_t const count = cache->_internal.count;
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+  // The properties of the root component first, then those of each component together, in the
+  // order the components were first registered.
+  for (int32_t i = 0; i < count; i++)
+  {
+    if (az_span_size(slots[i]._internal.component_name) == 0
+        && _az_iot_hub_client_properties_cache_is_written(&slots[i]))
+    {
+      _az_RETURN_IF_FAILED(
+          _az_iot_hub_client_properties_cache_write_property(&slots[i], ref_json_writer));
+    }
+  }
+
+  for (int32_t i = 0; i < count; i++)
+  {
+    az_span const component_name = slots[i]._internal.component_name;
+    if (az_span_size(component_name) == 0
+        || !_az_iot_hub_client_properties_cache_is_written(&slots[i]))
+    {
+      continue;
+    }
+
+    bool already_written = false;
+    for (int32_t j = 0; j < i && !already_written; j++)
+    {
+      already_written = _az_iot_hub_client_properties_cache_is_written(&slots[j])
+          && az_span_is_content_equal(slots[j]._internal.component_name, component_name);
+    }
+    if (already_written)
+    {
+      continue;
+    }
+
+    _az_RETURN_IF_FAILED(az_iot_hub_client_properties_writer_begin_component(
+        client, ref_json_writer, component_name));
+    for (int32_t j = i; j < count; j++)
+    {
+      if (_az_iot_hub_client_properties_cache_is_written(&slots[j])
+          && az_span_is_content_equal(slots[j]._internal.component_name, component_name))
+      {
+        _az_RETURN_IF_FAILED(
+            _az_iot_hub_client_properties_cache_write_property(&slots[j], ref_json_writer));
+      }
+    }
+    _az_RETURN_IF_FAILED(
+        az_iot_hub_client_properties_writer_end_component(client, ref_json_writer));
+  }
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+
+  // Only now that the whole payload is written, the properties in it wait for its response.
+  for (int32_t i = 0; i < count; i++)
+  {
+    if (_az_iot_hub_client_properties_cache_is_written(&slots[i]))
+    {
+      slots[i]._internal.flags = (uint8_t)(
+          (slots[i]._internal.flags & ~_az_IOT_HUB_CLIENT_PROPERTIES_CACHE_CHANGED)
+          | _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_IN_FLIGHT);
+    }
+  }
+
+  az_span_copy(AZ_SPAN_FROM_BUFFER(cache->_internal.pending_request_id), request_id);
+  cache->_internal.pending_request_id_size = az_span_size(request_id);
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_cache_ack(
+    az_iot_hub_client_properties_cache* cache,
+    az_span request_id,
+    az_iot_status status)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+  _az_PRECONDITION_VALID_SPAN(request_id, 0, true);
+
+  if (cache->_internal.pending_request_id_size == 0
+      || !az_span_is_content_equal(
+          request_id,
+          az_span_create(
+              cache->_internal.pending_request_id, cache->_internal.pending_request_id_size)))
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  bool const succeeded = az_iot_status_succeeded(status);
+  for (int32_t i = 0; i < cache->_internal.count; i++)
+  {
+    az_iot_hub_client_properties_cache_slot* const slot = &cache->_internal.slots[i];
+    if ((slot->_internal.flags & _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_IN_FLIGHT) != 0)
+    {
+      slot->_internal.flags
+          = (uint8_t)(slot->_internal.flags & ~_az_IOT_HUB_CLIENT_PROPERTIES_CACHE_IN_FLIGHT);
+      if (!succeeded)
+      {
+        slot->_internal.flags |= _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_CHANGED;
+      }
+    }
+  }
+
+  cache->_internal.pending_request_id_size = 0;
+
+  return AZ_OK;
+}
+
+void az_iot_hub_client_properties_cache_invalidate(az_iot_hub_client_properties_cache* cache)
+{
+  _az_PRECONDITION_NOT_NULL(cache);
+
+  for (int32_t i = 0; i < cache->_internal.count; i++)
+  {
+    az_iot_hub_client_properties_cache_slot* const slot = &cache->_internal.slots[i];
+    if ((slot->_internal.flags & _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_HAS_VALUE) != 0)
+    {
+      slot->_internal.flags |= _az_IOT_HUB_CLIENT_PROPERTIES_CACHE_CHANGED;
+    }
+  }
+}
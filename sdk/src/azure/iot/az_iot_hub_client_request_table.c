@@ -0,0 +1,163 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/az_context.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_hub_client.h>
+
+#include <azure/core/internal/az_precondition_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+static void _az_iot_hub_client_request_table_remove_entry(
+    az_iot_hub_client_request_table* table,
+    az_iot_hub_client_request_table_entry* entry,
+    void** out_user_context)
+{
+  if (out_user_context != NULL)
+  {
+    *out_user_context = entry->_internal.user_context;
+  }
+
+  entry->_internal.is_in_flight = false;
+  entry->_internal.context = NULL;
+  entry->_internal.user_context = NULL;
+  table->_internal.count--;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_request_table_init(
+    az_iot_hub_client_request_table* table,
+    az_iot_hub_client_request_table_entry* entries,
+    int32_t capacity)
+{
+  _az_PRECONDITION_NOT_NULL(table);
+  _az_PRECONDITION_NOT_NULL(entries);
+  _az_PRECONDITION_RANGE(1, capacity, INT32_MAX);
+  _az_PRECONDITION((capacity & (capacity - 1)) == 0);
+
+  table->_internal.entries = entries;
+  table->_internal.entries_mask = (uint32_t)capacity - 1;
+  table->_internal.next_request_id = 1;
+  table->_internal.count = 0;
+
+  for (int32_t i = 0; i < capacity; i++)
+  {
+    entries[i]._internal.context = NULL;
+    entries[i]._internal.user_context = NULL;
+    entries[i]._internal.request_id = 0;
+    entries[i]._internal.is_in_flight = false;
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_request_table_add(
+    az_iot_hub_client_request_table* table,
+    az_context const* context,
+    void* user_context,
+    az_span request_id_buffer,
+    az_span* out_request_id)
+{
+  _az_PRECONDITION_NOT_NULL(table);
+  _az_PRECONDITION_VALID_SPAN(request_id_buffer, AZ_IOT_HUB_CLIENT_REQUEST_ID_MAX_SIZE, false);
+  _az_PRECONDITION_NOT_NULL(out_request_id);
+
+  uint32_t const mask = table->_internal.entries_mask;
+  if ((uint32_t)table->_internal.count > mask)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  // Skip the IDs of the entries still in flight. As the table isn't full, one is free within as
+  // many IDs as there are entries.
+  uint32_t request_id = table->_internal.next_request_id;
+  while (table->_internal.entries[request_id & mask]._internal.is_in_flight)
+  {
+    request_id++;
+  }
+
+  az_span remainder;
+  _az_RETURN_IF_FAILED(az_span_u32toa(request_id_buffer, request_id, &remainder));
+  *out_request_id = az_span_slice(
+      request_id_buffer, 0, az_span_size(request_id_buffer) - az_span_size(remainder));
+
+  az_iot_hub_client_request_table_entry* const entry = &table->_internal.entries[request_id & mask];
+  entry->_internal.context = context;
+  entry->_internal.user_context = user_context;
+  entry->_internal.request_id = request_id;
+  entry->_internal.is_in_flight = true;
+  table->_internal.count++;
+  table->_internal.next_request_id = request_id + 1;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_request_table_remove(
+    az_iot_hub_client_request_table* table,
+    az_span request_id,
+    void** out_user_context)
+{
+  _az_PRECONDITION_NOT_NULL(table);
+  _az_PRECONDITION_VALID_SPAN(request_id, 0, true);
+
+  // Only the digits of an ID issued by the table can match, so anything else is not found rather
+  // than invalid: it is the response to a request made some other way.
+  int32_t const size = az_span_size(request_id);
+  uint8_t const* const ptr = az_span_ptr(request_id);
+  if (size == 0 || size > AZ_IOT_HUB_CLIENT_REQUEST_ID_MAX_SIZE || (ptr[0] == '0' && size > 1))
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  uint64_t value = 0;
+  for (int32_t i = 0; i < size; i++)
+  {
+    if (ptr[i] < '0' || ptr[i] > '9')
+    {
+      return AZ_ERROR_ITEM_NOT_FOUND;
+    }
+    value = (value * 10) + (uint64_t)(ptr[i] - '0');
+  }
+  if (value > UINT32_MAX)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  uint32_t const id = (uint32_t)value;
+  az_iot_hub_client_request_table_entry* const entry
+      = &table->_internal.entries[id & table->_internal.entries_mask];
+  if (!entry->_internal.is_in_flight || entry->_internal.request_id != id)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  _az_iot_hub_client_request_table_remove_entry(table, entry, out_user_context);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_request_table_remove_expired(
+    az_iot_hub_client_request_table* table,
+    int64_t current_time,
+    void** out_user_context)
+{
+  _az_PRECONDITION_NOT_NULL(table);
+
+  uint32_t const mask = table->_internal.entries_mask;
+  for (uint32_t i = 0; i <= mask && table->_internal.count > 0; i++)
+  {
+    az_iot_hub_client_request_table_entry* const entry = &table->_internal.entries[i];
+    if (entry->_internal.is_in_flight && entry->_internal.context != NULL
+        && az_context_has_expired(entry->_internal.context, current_time))
+    {
+      _az_iot_hub_client_request_table_remove_entry(table, entry, out_user_context);
+      return AZ_OK;
+    }
+  }
+
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
@@ -1,8 +1,10 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // SPDX-License-Identifier: MIT
 
+#include <azure/core/az_base64.h>
 #include <azure/core/az_precondition.h>
 #include <azure/core/az_span.h>
+#include <azure/core/internal/az_config_internal.h>
 #include <azure/core/internal/az_result_internal.h>
 #include <azure/iot/az_iot_hub_client.h>
 #include <azure/iot/internal/az_iot_common_internal.h>
@@ -12,6 +14,7 @@
 #include <azure/core/internal/az_span_internal.h>
 
 #include <stdint.h>
+#include <string.h>
 
 #include <azure/core/_az_cfg.h>
 
@@ -170,3 +173,260 @@ AZ_NODISCARD az_result az_iot_hub_client_sas_get_password(
 
   return AZ_OK;
 }
+
+// Azure IoT symmetric keys are 16 to 64 bytes long, this leaves room for longer ones.
+#define _az_IOT_SAS_TOKEN_MANAGER_MAX_KEY_SIZE 128
+
+// The Base64 encoding of an HMAC-SHA256 signature, before it is URL encoded.
+#define _az_IOT_SAS_TOKEN_MANAGER_SIGNATURE_SIZE 44
+
+// The number of digits of UINT64_MAX.
+#define _az_IOT_SAS_TOKEN_MANAGER_EXPIRATION_MAX_SIZE 20
+
+#define _az_IOT_SAS_TOKEN_MANAGER_DEFAULT_DURATION_SECONDS 3600
+#define _az_IOT_SAS_TOKEN_MANAGER_DEFAULT_MARGIN_SECONDS 600
+#define _az_IOT_SAS_TOKEN_MANAGER_DEFAULT_JITTER_SECONDS 300
+
+AZ_NODISCARD az_iot_sas_token_manager_options az_iot_sas_token_manager_options_default()
+{
+  return (az_iot_sas_token_manager_options){
+    .key_name = AZ_SPAN_EMPTY,
+    .token_duration_seconds = _az_IOT_SAS_TOKEN_MANAGER_DEFAULT_DURATION_SECONDS,
+    .renewal_margin_seconds = _az_IOT_SAS_TOKEN_MANAGER_DEFAULT_MARGIN_SECONDS,
+    .renewal_jitter_seconds = _az_IOT_SAS_TOKEN_MANAGER_DEFAULT_JITTER_SECONDS,
+    .jitter_seed = 0,
+  };
+}
+
+static AZ_NODISCARD uint32_t _az_iot_sas_token_manager_next_jitter(
+    az_iot_sas_token_manager* manager)
+{
+  uint32_t const x = _az_iot_xorshift32(&manager->_internal.jitter_state);
+  uint32_t const jitter_seconds = manager->_internal.options.renewal_jitter_seconds;
+  return jitter_seconds == 0 ? 0 : x % (jitter_seconds + 1);
+}
+
+AZ_NODISCARD az_result az_iot_sas_token_manager_init(
+    az_iot_sas_token_manager* manager,
+    az_iot_hub_client const* client,
+    az_span base64_encoded_key,
+    az_span password_buffer,
+    az_iot_sas_token_manager_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(manager);
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(base64_encoded_key, 1, false);
+  _az_PRECONDITION_VALID_SPAN(password_buffer, 1, false);
+
+  manager->_internal.options
+      = options == NULL ? az_iot_sas_token_manager_options_default() : *options;
+  _az_PRECONDITION(
+      (uint64_t)manager->_internal.options.renewal_margin_seconds
+          + manager->_internal.options.renewal_jitter_seconds
+      < manager->_internal.options.token_duration_seconds);
+
+  uint8_t decoded_key[_az_IOT_SAS_TOKEN_MANAGER_MAX_KEY_SIZE];
+  int32_t decoded_key_size = 0;
+  _az_RETURN_IF_FAILED(
+      az_base64_decode(AZ_SPAN_FROM_BUFFER(decoded_key), base64_encoded_key, &decoded_key_size));
+
+  az_result const result = az_hmac_sha256_key_init(
+      &manager->_internal.key, az_span_create(decoded_key, decoded_key_size));
+  memset(decoded_key, 0, sizeof(decoded_key));
+  _az_RETURN_IF_FAILED(result);
+
+  manager->_internal.client = client;
+  manager->_internal.password_buffer = password_buffer;
+  manager->_internal.password_length = 0;
+  manager->_internal.scope_offset = 0;
+  manager->_internal.scope_length = 0;
+  manager->_internal.signature_offset = 0;
+  manager->_internal.expiration_epoch_time = 0;
+  manager->_internal.renewal_deadline_msec = 0;
+
+  uint32_t seed = manager->_internal.options.jitter_seed;
+  if (seed == 0)
+  {
+    seed = _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, client->_internal.device_id);
+    seed = _az_iot_fnv1a(seed, client->_internal.options.module_id);
+  }
+  manager->_internal.jitter_state = seed;
+
+  return AZ_OK;
+}
+
+// Writes the password up to the signature once, with az_iot_hub_client_sas_get_password(), and
+// finds where the scope, which is also what gets signed, and the signature are.
+static AZ_NODISCARD az_result
+_az_iot_sas_token_manager_write_prefix(az_iot_sas_token_manager* manager, uint64_t expiration)
+{
+  az_span const buffer = manager->_internal.password_buffer;
+
+  // Any signature will do, since only what comes before it is kept.
+  _az_RETURN_IF_FAILED(az_iot_hub_client_sas_get_password(
+      manager->_internal.client,
+      expiration,
+      AZ_SPAN_FROM_STR("_"),
+      AZ_SPAN_EMPTY,
+      (char*)az_span_ptr(buffer),
+      (size_t)az_span_size(buffer),
+      NULL));
+
+  int32_t const scope_offset = az_span_size(sr_string) + 1 /* EQUAL_SIGN */;
+  int32_t const scope_length = az_span_find(
+      az_span_slice_to_end(buffer, scope_offset), AZ_SPAN_FROM_STR("&" SAS_TOKEN_SIG "="));
+
+  manager->_internal.scope_offset = scope_offset;
+  manager->_internal.scope_length = scope_length;
+  manager->_internal.signature_offset = scope_offset + scope_length + 1 /* AMPERSAND */
+      + az_span_size(sig_string) + 1 /* EQUAL_SIGN */;
+
+  return AZ_OK;
+}
+
+// Signs the token and writes what follows "sig=" in the password: the signature, the expiration
+// time and the key name.
+static AZ_NODISCARD az_result
+_az_iot_sas_token_manager_write_suffix(az_iot_sas_token_manager* manager, uint64_t expiration)
+{
+  az_span const buffer = manager->_internal.password_buffer;
+
+  uint8_t expiration_buffer[_az_IOT_SAS_TOKEN_MANAGER_EXPIRATION_MAX_SIZE];
+  az_span expiration_remainder;
+  _az_RETURN_IF_FAILED(
+      az_span_u64toa(AZ_SPAN_FROM_BUFFER(expiration_buffer), expiration, &expiration_remainder));
+  az_span const expiration_span = az_span_create(
+      expiration_buffer, (int32_t)sizeof(expiration_buffer) - az_span_size(expiration_remainder));
+
+  // The string to sign is the URL encoded scope, which is already in the password, a line feed and
+  // the expiration time, so it is hashed in pieces instead of being written out.
+  az_hmac_sha256_context context;
+  _az_RETURN_IF_FAILED(az_hmac_sha256_init(&context, &manager->_internal.key));
+  _az_RETURN_IF_FAILED(az_hmac_sha256_update(
+      &context,
+      az_span_slice(
+          buffer,
+          manager->_internal.scope_offset,
+          manager->_internal.scope_offset + manager->_internal.scope_length)));
+  _az_RETURN_IF_FAILED(az_hmac_sha256_update(&context, AZ_SPAN_FROM_STR("\n")));
+  _az_RETURN_IF_FAILED(az_hmac_sha256_update(&context, expiration_span));
+
+  uint8_t mac_buffer[AZ_SHA256_DIGEST_SIZE];
+  az_span mac;
+  _az_RETURN_IF_FAILED(
+      az_hmac_sha256_finalize(&context, AZ_SPAN_FROM_BUFFER(mac_buffer), &mac));
+
+  uint8_t signature_buffer[_az_IOT_SAS_TOKEN_MANAGER_SIGNATURE_SIZE];
+  int32_t signature_size = 0;
+  _az_RETURN_IF_FAILED(
+      az_base64_encode(AZ_SPAN_FROM_BUFFER(signature_buffer), mac, &signature_size));
+
+  az_span remainder = az_span_slice_to_end(buffer, manager->_internal.signature_offset);
+  _az_RETURN_IF_FAILED(_az_span_copy_url_encode(
+      remainder, az_span_create(signature_buffer, signature_size), &remainder));
+
+  az_span const key_name = manager->_internal.options.key_name;
+  int32_t required_length = 1 /* AMPERSAND */ + az_span_size(se_string) + 1 /* EQUAL_SIGN */
+      + az_span_size(expiration_span) + 1 /* NULL TERMINATOR */;
+  if (az_span_size(key_name) > 0)
+  {
+    required_length += 1 /* AMPERSAND */ + az_span_size(skn_string) + 1 /* EQUAL_SIGN */
+        + az_span_size(key_name);
+  }
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remainder, required_length);
+
+  remainder = az_span_copy_u8(remainder, AMPERSAND);
+  remainder = az_span_copy(remainder, se_string);
+  remainder = az_span_copy_u8(remainder, EQUAL_SIGN);
+  remainder = az_span_copy(remainder, expiration_span);
+
+  if (az_span_size(key_name) > 0)
+  {
+    remainder = az_span_copy_u8(remainder, AMPERSAND);
+    remainder = az_span_copy(remainder, skn_string);
+    remainder = az_span_copy_u8(remainder, EQUAL_SIGN);
+    remainder = az_span_copy(remainder, key_name);
+  }
+
+  remainder = az_span_copy_u8(remainder, STRING_NULL_TERMINATOR);
+
+  manager->_internal.password_length
+      = az_span_size(buffer) - az_span_size(remainder) - 1 /* NULL TERMINATOR */;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_sas_token_manager_generate(
+    az_iot_sas_token_manager* manager,
+    uint64_t current_epoch_time,
+    int64_t current_clock_msec)
+{
+  _az_PRECONDITION_NOT_NULL(manager);
+  _az_PRECONDITION(current_epoch_time > 0);
+
+  uint64_t const expiration
+      = current_epoch_time + manager->_internal.options.token_duration_seconds;
+
+  // Until the whole password is written, there is none to use.
+  bool const has_prefix = manager->_internal.signature_offset > 0;
+  manager->_internal.password_length = 0;
+
+  if (!has_prefix)
+  {
+    _az_RETURN_IF_FAILED(_az_iot_sas_token_manager_write_prefix(manager, expiration));
+  }
+  _az_RETURN_IF_FAILED(_az_iot_sas_token_manager_write_suffix(manager, expiration));
+
+  uint32_t const renew_before_seconds = manager->_internal.options.renewal_margin_seconds
+      + _az_iot_sas_token_manager_next_jitter(manager);
+
+  manager->_internal.expiration_epoch_time = expiration;
+  manager->_internal.renewal_deadline_msec = current_clock_msec
+      + ((int64_t)(manager->_internal.options.token_duration_seconds - renew_before_seconds)
+         * _az_TIME_MILLISECONDS_PER_SECOND);
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD bool az_iot_sas_token_manager_needs_renewal(
+    az_iot_sas_token_manager const* manager,
+    int64_t current_clock_msec)
+{
+  _az_PRECONDITION_NOT_NULL(manager);
+
+  return manager->_internal.password_length == 0
+      || current_clock_msec >= manager->_internal.renewal_deadline_msec;
+}
+
+AZ_NODISCARD az_result az_iot_sas_token_manager_get_renewal_deadline(
+    az_iot_sas_token_manager const* manager,
+    int64_t* out_renewal_deadline_msec)
+{
+  _az_PRECONDITION_NOT_NULL(manager);
+  _az_PRECONDITION_NOT_NULL(out_renewal_deadline_msec);
+
+  if (manager->_internal.password_length == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  *out_renewal_deadline_msec = manager->_internal.renewal_deadline_msec;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_sas_token_manager_get_password(
+    az_iot_sas_token_manager const* manager,
+    az_span* out_password)
+{
+  _az_PRECONDITION_NOT_NULL(manager);
+  _az_PRECONDITION_NOT_NULL(out_password);
+
+  if (manager->_internal.password_length == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  *out_password
+      = az_span_slice(manager->_internal.password_buffer, 0, manager->_internal.password_length);
+  return AZ_OK;
+}
@@ -0,0 +1,236 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+#include <azure/iot/az_iot_hub_client.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <azure/core/internal/az_precondition_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+// Marks a slot of the hash index which doesn't refer to any entry.
+#define _az_IOT_HUB_CLIENT_TABLE_EMPTY_SLOT (-1)
+
+static const az_span table_devices_topic_prefix = AZ_SPAN_LITERAL_FROM_STR("devices/");
+static const az_span table_modules_topic_segment = AZ_SPAN_LITERAL_FROM_STR("modules/");
+
+static AZ_NODISCARD uint32_t _az_iot_hub_client_table_hash(az_span device_id, az_span module_id)
+{
+  uint32_t hash = _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, device_id);
+  if (az_span_size(module_id) > 0)
+  {
+    // Separate the IDs so that a device "a/b" and a device "a" with a module "b" differ.
+    hash = _az_iot_fnv1a(hash ^ '/', module_id);
+  }
+  return hash;
+}
+
+static AZ_NODISCARD bool _az_iot_hub_client_table_entry_matches(
+    az_iot_hub_client_table const* table,
+    int32_t entry,
+    az_span device_id,
+    az_span module_id)
+{
+  az_span const entry_module_id = table->_internal.module_ids == NULL
+      ? AZ_SPAN_EMPTY
+      : table->_internal.module_ids[entry];
+
+  return az_span_is_content_equal(table->_internal.device_ids[entry], device_id)
+      && az_span_is_content_equal(entry_module_id, module_id);
+}
+
+// Returns the slot of the hash index holding the entry with the given IDs, or the empty slot where
+// such an entry would go.
+static AZ_NODISCARD uint32_t _az_iot_hub_client_table_find_slot(
+    az_iot_hub_client_table const* table,
+    az_span device_id,
+    az_span module_id)
+{
+  uint32_t const mask = table->_internal.hash_index_mask;
+  uint32_t slot = _az_iot_hub_client_table_hash(device_id, module_id) & mask;
+
+  // The index is always larger than the capacity, so there is at least one empty slot to stop at.
+  while (true)
+  {
+    int32_t const entry = table->_internal.hash_index[slot];
+    if (entry == _az_IOT_HUB_CLIENT_TABLE_EMPTY_SLOT
+        || _az_iot_hub_client_table_entry_matches(table, entry, device_id, module_id))
+    {
+      return slot;
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_table_init(
+    az_iot_hub_client_table* table,
+    az_span iot_hub_hostname,
+    az_iot_hub_client_options const* options,
+    az_span* device_ids,
+    az_span* module_ids,
+    int32_t capacity,
+    int32_t* hash_index,
+    int32_t hash_index_size)
+{
+  _az_PRECONDITION_NOT_NULL(table);
+  _az_PRECONDITION_VALID_SPAN(iot_hub_hostname, 1, false);
+  _az_PRECONDITION_NOT_NULL(device_ids);
+  _az_PRECONDITION_RANGE(1, capacity, INT32_MAX - 1);
+  _az_PRECONDITION_NOT_NULL(hash_index);
+  _az_PRECONDITION(hash_index_size > capacity);
+  _az_PRECONDITION((hash_index_size & (hash_index_size - 1)) == 0);
+
+  table->_internal.iot_hub_hostname = iot_hub_hostname;
+  table->_internal.options = options == NULL ? az_iot_hub_client_options_default() : *options;
+  table->_internal.options.module_id = AZ_SPAN_EMPTY;
+  table->_internal.device_ids = device_ids;
+  table->_internal.module_ids = module_ids;
+  table->_internal.hash_index = hash_index;
+  table->_internal.hash_index_mask = (uint32_t)hash_index_size - 1;
+  table->_internal.capacity = capacity;
+  table->_internal.count = 0;
+
+  for (int32_t i = 0; i < hash_index_size; i++)
+  {
+    hash_index[i] = _az_IOT_HUB_CLIENT_TABLE_EMPTY_SLOT;
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_table_add(
+    az_iot_hub_client_table* table,
+    az_span device_id,
+    az_span module_id,
+    int32_t* out_entry)
+{
+  _az_PRECONDITION_NOT_NULL(table);
+  _az_PRECONDITION_VALID_SPAN(device_id, 1, false);
+  _az_PRECONDITION_VALID_SPAN(module_id, 0, true);
+  _az_PRECONDITION(table->_internal.module_ids != NULL || az_span_size(module_id) == 0);
+
+  if (table->_internal.count == table->_internal.capacity)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  uint32_t const slot = _az_iot_hub_client_table_find_slot(table, device_id, module_id);
+  if (table->_internal.hash_index[slot] != _az_IOT_HUB_CLIENT_TABLE_EMPTY_SLOT)
+  {
+    return AZ_ERROR_ARG;
+  }
+
+  int32_t const entry = table->_internal.count++;
+  table->_internal.device_ids[entry] = device_id;
+  if (table->_internal.module_ids != NULL)
+  {
+    table->_internal.module_ids[entry] = module_id;
+  }
+  table->_internal.hash_index[slot] = entry;
+
+  if (out_entry != NULL)
+  {
+    *out_entry = entry;
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_table_find(
+    az_iot_hub_client_table const* table,
+    az_span device_id,
+    az_span module_id,
+    int32_t* out_entry)
+{
+  _az_PRECONDITION_NOT_NULL(table);
+  _az_PRECONDITION_VALID_SPAN(device_id, 1, false);
+  _az_PRECONDITION_VALID_SPAN(module_id, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_entry);
+
+  int32_t const entry = table->_internal.hash_index[_az_iot_hub_client_table_find_slot(
+      table, device_id, module_id)];
+  if (entry == _az_IOT_HUB_CLIENT_TABLE_EMPTY_SLOT)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  *out_entry = entry;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_table_find_by_topic(
+    az_iot_hub_client_table const* table,
+    az_span received_topic,
+    int32_t* out_entry)
+{
+  _az_PRECONDITION_NOT_NULL(table);
+  _az_PRECONDITION_VALID_SPAN(received_topic, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_entry);
+
+  if (az_span_size(received_topic) <= az_span_size(table_devices_topic_prefix)
+      || !az_span_is_content_equal(
+          az_span_slice(received_topic, 0, az_span_size(table_devices_topic_prefix)),
+          table_devices_topic_prefix))
+  {
+    return AZ_ERROR_IOT_TOPIC_NO_MATCH;
+  }
+
+  az_span remainder
+      = az_span_slice_to_end(received_topic, az_span_size(table_devices_topic_prefix));
+  int32_t const device_id_size = az_span_find(remainder, AZ_SPAN_FROM_STR("/"));
+  if (device_id_size <= 0)
+  {
+    return AZ_ERROR_IOT_TOPIC_NO_MATCH;
+  }
+
+  az_span const device_id = az_span_slice(remainder, 0, device_id_size);
+  remainder = az_span_slice_to_end(remainder, device_id_size + 1);
+
+  az_span module_id = AZ_SPAN_EMPTY;
+  if (table->_internal.module_ids != NULL
+      && az_span_size(remainder) > az_span_size(table_modules_topic_segment)
+      && az_span_is_content_equal(
+          az_span_slice(remainder, 0, az_span_size(table_modules_topic_segment)),
+          table_modules_topic_segment))
+  {
+    remainder = az_span_slice_to_end(remainder, az_span_size(table_modules_topic_segment));
+    int32_t const module_id_size = az_span_find(remainder, AZ_SPAN_FROM_STR("/"));
+    if (module_id_size <= 0)
+    {
+      return AZ_ERROR_IOT_TOPIC_NO_MATCH;
+    }
+    module_id = az_span_slice(remainder, 0, module_id_size);
+  }
+
+  return az_iot_hub_client_table_find(table, device_id, module_id, out_entry);
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_table_get_client(
+    az_iot_hub_client_table const* table,
+    int32_t entry,
+    az_iot_hub_client* out_client)
+{
+  _az_PRECONDITION_NOT_NULL(table);
+  _az_PRECONDITION_RANGE(0, entry, table->_internal.count - 1);
+  _az_PRECONDITION_NOT_NULL(out_client);
+
+  out_client->_internal.iot_hub_hostname = table->_internal.iot_hub_hostname;
+  out_client->_internal.device_id = table->_internal.device_ids[entry];
+  out_client->_internal.options = table->_internal.options;
+  if (table->_internal.module_ids != NULL)
+  {
+    out_client->_internal.options.module_id = table->_internal.module_ids[entry];
+  }
+  out_client->_internal.telemetry_topic_prefix = AZ_SPAN_EMPTY;
+  out_client->_internal.component_name_index = NULL;
+  out_client->_internal.component_name_index_mask = 0;
+
+  return AZ_OK;
+}
@@ -1,13 +1,17 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // SPDX-License-Identifier: MIT
 
+#include <azure/core/az_json.h>
 #include <azure/core/az_precondition.h>
 #include <azure/core/az_result.h>
 #include <azure/core/az_span.h>
+#include <azure/core/internal/az_config_internal.h>
+#include <azure/core/internal/az_json_internal.h>
 #include <azure/core/internal/az_precondition_internal.h>
 #include <azure/core/internal/az_result_internal.h>
 #include <azure/iot/az_iot_hub_client.h>
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <azure/core/_az_cfg.h>
@@ -17,6 +21,55 @@ static const az_span telemetry_topic_prefix = AZ_SPAN_LITERAL_FROM_STR("devices/
 static const az_span telemetry_topic_modules_mid = AZ_SPAN_LITERAL_FROM_STR("/modules/");
 static const az_span telemetry_topic_suffix = AZ_SPAN_LITERAL_FROM_STR("/messages/events/");
 
+// Gets the length of the fixed part of the telemetry topic, i.e.
+// devices/{device_id}/messages/events/ or devices/{device_id}/modules/{module_id}/messages/events/.
+static int32_t _az_iot_hub_client_telemetry_get_topic_prefix_length(az_iot_hub_client const* client)
+{
+  int32_t const module_id_length = az_span_size(client->_internal.options.module_id);
+
+  int32_t length = az_span_size(telemetry_topic_prefix) + az_span_size(client->_internal.device_id)
+      + az_span_size(telemetry_topic_suffix);
+  if (module_id_length > 0)
+  {
+    length += az_span_size(telemetry_topic_modules_mid) + module_id_length;
+  }
+  return length;
+}
+
+// Writes the fixed part of the telemetry topic, returning the rest of the destination.
+static az_span _az_iot_hub_client_telemetry_write_topic_prefix(
+    az_iot_hub_client const* client,
+    az_span destination)
+{
+  az_span const module_id = client->_internal.options.module_id;
+
+  az_span remainder = az_span_copy(destination, telemetry_topic_prefix);
+  remainder = az_span_copy(remainder, client->_internal.device_id);
+
+  if (az_span_size(module_id) > 0)
+  {
+    remainder = az_span_copy(remainder, telemetry_topic_modules_mid);
+    remainder = az_span_copy(remainder, module_id);
+  }
+
+  return az_span_copy(remainder, telemetry_topic_suffix);
+}
+
+AZ_NODISCARD az_result
+az_iot_hub_client_cache_topic_prefixes(az_iot_hub_client* client, az_span topic_prefix_buffer)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(topic_prefix_buffer, 1, false);
+
+  int32_t const required_length = _az_iot_hub_client_telemetry_get_topic_prefix_length(client);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(topic_prefix_buffer, required_length);
+
+  _az_iot_hub_client_telemetry_write_topic_prefix(client, topic_prefix_buffer);
+  client->_internal.telemetry_topic_prefix = az_span_slice(topic_prefix_buffer, 0, required_length);
+
+  return AZ_OK;
+}
+
 AZ_NODISCARD az_result az_iot_hub_client_telemetry_get_publish_topic(
     az_iot_hub_client const* client,
     az_iot_message_properties const* properties,
@@ -28,16 +81,12 @@ AZ_NODISCARD az_result az_iot_hub_client_telemetry_get_publish_topic(
   _az_PRECONDITION_NOT_NULL(mqtt_topic);
   _az_PRECONDITION(mqtt_topic_size > 0);
 
-  const az_span* const module_id = &(client->_internal.options.module_id);
+  az_span const cached_prefix = client->_internal.telemetry_topic_prefix;
 
   az_span mqtt_topic_span = az_span_create((uint8_t*)mqtt_topic, (int32_t)mqtt_topic_size);
-  int32_t required_length = az_span_size(telemetry_topic_prefix)
-      + az_span_size(client->_internal.device_id) + az_span_size(telemetry_topic_suffix);
-  int32_t module_id_length = az_span_size(*module_id);
-  if (module_id_length > 0)
-  {
-    required_length += az_span_size(telemetry_topic_modules_mid) + module_id_length;
-  }
+  int32_t required_length = az_span_size(cached_prefix) > 0
+      ? az_span_size(cached_prefix)
+      : _az_iot_hub_client_telemetry_get_topic_prefix_length(client);
   if (properties != NULL)
   {
     required_length += properties->_internal.properties_written;
@@ -46,16 +95,16 @@ AZ_NODISCARD az_result az_iot_hub_client_telemetry_get_publish_topic(
   _az_RETURN_IF_NOT_ENOUGH_SIZE(
       mqtt_topic_span, required_length + (int32_t)sizeof(null_terminator));
 
-  az_span remainder = az_span_copy(mqtt_topic_span, telemetry_topic_prefix);
-  remainder = az_span_copy(remainder, client->_internal.device_id);
-
-  if (module_id_length > 0)
+  az_span remainder = mqtt_topic_span;
+  if (az_span_size(cached_prefix) > 0)
   {
-    remainder = az_span_copy(remainder, telemetry_topic_modules_mid);
-    remainder = az_span_copy(remainder, *module_id);
+    // The fixed part of the topic was already rendered by az_iot_hub_client_cache_topic_prefixes().
+    remainder = az_span_copy(remainder, cached_prefix);
+  }
+  else
+  {
+    remainder = _az_iot_hub_client_telemetry_write_topic_prefix(client, remainder);
   }
-
-  remainder = az_span_copy(remainder, telemetry_topic_suffix);
 
   if (properties != NULL)
   {
@@ -74,3 +123,507 @@ AZ_NODISCARD az_result az_iot_hub_client_telemetry_get_publish_topic(
 
   return AZ_OK;
 }
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_get_publish_topic_prefix(
+    az_iot_hub_client const* client,
+    az_span* out_topic_prefix)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(out_topic_prefix);
+
+  if (az_span_size(client->_internal.telemetry_topic_prefix) == 0)
+  {
+    return AZ_ERROR_NOT_SUPPORTED;
+  }
+
+  *out_topic_prefix = client->_internal.telemetry_topic_prefix;
+  return AZ_OK;
+}
+
+static const az_span telemetry_batch_columnar_value = AZ_SPAN_LITERAL_FROM_STR("columnar");
+static const az_span telemetry_batch_rows_value = AZ_SPAN_LITERAL_FROM_STR("rows");
+static const az_span telemetry_batch_columns_name = AZ_SPAN_LITERAL_FROM_STR("columns");
+static const az_span telemetry_batch_rows_name = AZ_SPAN_LITERAL_FROM_STR("rows");
+
+enum
+{
+  // The largest space a JSON writer asks for at once, before writing what may be less, which is
+  // also the smallest scratch space it accepts when only computing the size.
+  _az_TELEMETRY_BATCH_JSON_WRITER_CHUNK_SIZE = 64,
+};
+
+AZ_NODISCARD az_iot_hub_client_telemetry_batch_options
+az_iot_hub_client_telemetry_batch_options_default()
+{
+  return (az_iot_hub_client_telemetry_batch_options){
+    .max_payload_size = AZ_IOT_HUB_CLIENT_TELEMETRY_MAX_MESSAGE_SIZE,
+    .layout = AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_COLUMNAR,
+  };
+}
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+static bool _az_iot_hub_client_telemetry_batch_fields_valid(
+    az_iot_hub_client_telemetry_batch_field const* fields,
+    int32_t field_count,
+    size_t record_size)
+{
+  for (int32_t i = 0; i < field_count; i++)
+  {
+    size_t value_size = 0;
+    switch (fields[i].kind)
+    {
+      case AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_INT32:
+        value_size = sizeof(int32_t);
+        break;
+      case AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_INT64:
+        value_size = sizeof(int64_t);
+        break;
+      case AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_DOUBLE:
+        value_size = sizeof(double);
+        if (fields[i].fractional_digits < 0 || fields[i].fractional_digits > 15)
+        {
+          return false;
+        }
+        break;
+      case AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_BOOL:
+        value_size = sizeof(bool);
+        break;
+      default:
+        return false;
+    }
+
+    if (fields[i].offset + value_size > record_size || az_span_size(fields[i].name) < 1)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_init(
+    az_iot_hub_client_telemetry_batch* out_batch,
+    az_iot_hub_client_telemetry_batch_field const* fields,
+    int32_t field_count,
+    size_t record_size,
+    az_iot_hub_client_telemetry_batch_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_batch);
+  _az_PRECONDITION_NOT_NULL(fields);
+  _az_PRECONDITION(field_count > 0);
+  _az_PRECONDITION(record_size > 0 && record_size <= INT32_MAX);
+  _az_PRECONDITION(
+      _az_iot_hub_client_telemetry_batch_fields_valid(fields, field_count, record_size));
+
+  out_batch->_internal.fields = fields;
+  out_batch->_internal.field_count = field_count;
+  out_batch->_internal.record_size = (int32_t)record_size;
+  out_batch->_internal.options
+      = options == NULL ? az_iot_hub_client_telemetry_batch_options_default() : *options;
+
+  return AZ_OK;
+}
+
+static _az_json_array_element_kind _az_iot_hub_client_telemetry_batch_get_element_kind(
+    az_iot_hub_client_telemetry_batch_field_kind kind)
+{
+  switch (kind)
+  {
+    case AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_INT32:
+      return _az_JSON_ARRAY_ELEMENT_INT32;
+    case AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_INT64:
+      return _az_JSON_ARRAY_ELEMENT_INT64;
+    case AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_DOUBLE:
+      return _az_JSON_ARRAY_ELEMENT_DOUBLE;
+    case AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_BOOL:
+    default:
+      return _az_JSON_ARRAY_ELEMENT_BOOL;
+  }
+}
+
+// Appends the value of a field within a record, which isn't necessarily aligned for its type.
+static AZ_NODISCARD az_result _az_iot_hub_client_telemetry_batch_append_value(
+    az_iot_hub_client_telemetry_batch_field const* field,
+    uint8_t const* record,
+    az_json_writer* ref_json_writer)
+{
+  return _az_json_writer_append_value(
+      ref_json_writer,
+      _az_iot_hub_client_telemetry_batch_get_element_kind(field->kind),
+      record + field->offset,
+      field->fractional_digits);
+}
+
+// Writes the payload of the first record_count records, i.e. {"a":[1,2],"b":[3,4]} or
+// {"columns":["a","b"],"rows":[[1,3],[2,4]]}.
+static AZ_NODISCARD az_result _az_iot_hub_client_telemetry_batch_write(
+    az_iot_hub_client_telemetry_batch const* batch,
+    uint8_t const* records,
+    int32_t record_count,
+    az_json_writer* ref_json_writer)
+{
+  az_iot_hub_client_telemetry_batch_field const* const fields = batch->_internal.fields;
+  int32_t const field_count = batch->_internal.field_count;
+  int32_t const record_size = batch->_internal.record_size;
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+  if (batch->_internal.options.layout == AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_ROWS)
+  {
+    _az_RETURN_IF_FAILED(
+        az_json_writer_append_property_name(ref_json_writer, telemetry_batch_columns_name));
+    _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_json_writer));
+    for (int32_t i = 0; i < field_count; i++)
+    {
+      _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_json_writer, fields[i].name));
+    }
+    _az_RETURN_IF_FAILED(az_json_writer_append_end_array(ref_json_writer));
+
+    _az_RETURN_IF_FAILED(
+        az_json_writer_append_property_name(ref_json_writer, telemetry_batch_rows_name));
+    _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_json_writer));
+    for (int32_t r = 0; r < record_count; r++)
+    {
+      uint8_t const* record = records + (r * record_size);
+      _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_json_writer));
+      for (int32_t i = 0; i < field_count; i++)
+      {
+        _az_RETURN_IF_FAILED(
+            _az_iot_hub_client_telemetry_batch_append_value(&fields[i], record, ref_json_writer));
+      }
+      _az_RETURN_IF_FAILED(az_json_writer_append_end_array(ref_json_writer));
+    }
+    _az_RETURN_IF_FAILED(az_json_writer_append_end_array(ref_json_writer));
+  }
+  else
+  {
+    // Each column gathers the same field of every record, so is one array a record size apart.
+    for (int32_t i = 0; i < field_count; i++)
+    {
+      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, fields[i].name));
+      _az_RETURN_IF_FAILED(_az_json_writer_append_array(
+          ref_json_writer,
+          _az_iot_hub_client_telemetry_batch_get_element_kind(fields[i].kind),
+          records + fields[i].offset,
+          record_count,
+          (size_t)record_size,
+          fields[i].fractional_digits));
+    }
+  }
+
+  return az_json_writer_append_end_object(ref_json_writer);
+}
+
+// Counts how many records, from the start, fit within the size limit.
+static AZ_NODISCARD az_result _az_iot_hub_client_telemetry_batch_count_records(
+    az_iot_hub_client_telemetry_batch const* batch,
+    uint8_t const* records,
+    int32_t record_count,
+    int32_t max_size,
+    int32_t* out_record_count)
+{
+  int32_t const field_count = batch->_internal.field_count;
+  bool const is_rows = batch->_internal.options.layout == AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_ROWS;
+
+  uint8_t scratch[_az_TELEMETRY_BATCH_JSON_WRITER_CHUNK_SIZE];
+  az_json_writer_options options = az_json_writer_options_default();
+  options.compute_size_only = true;
+  az_json_writer size_writer;
+
+  // The payload with no records, with the names escaped as needed.
+  _az_RETURN_IF_FAILED(az_json_writer_init(&size_writer, AZ_SPAN_FROM_BUFFER(scratch), &options));
+  _az_RETURN_IF_FAILED(_az_iot_hub_client_telemetry_batch_write(batch, records, 0, &size_writer));
+  int32_t size = size_writer.total_bytes_written;
+
+  // Then the values of each record, in turn, as the elements of a single array. Each one takes a
+  // leading comma, the same as within the columns, except for the first values of all.
+  _az_RETURN_IF_FAILED(az_json_writer_init(&size_writer, AZ_SPAN_FROM_BUFFER(scratch), &options));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(&size_writer));
+
+  int32_t count = 0;
+  for (; count < record_count; count++)
+  {
+    uint8_t const* record = records + (count * batch->_internal.record_size);
+
+    int32_t const start_size = size_writer.total_bytes_written;
+    for (int32_t i = 0; i < field_count; i++)
+    {
+      _az_RETURN_IF_FAILED(_az_iot_hub_client_telemetry_batch_append_value(
+          &batch->_internal.fields[i], record, &size_writer));
+    }
+    int32_t record_size = size_writer.total_bytes_written - start_size;
+
+    if (is_rows)
+    {
+      // For the brackets around the row, which has a comma before it instead of its first value.
+      record_size += 2;
+    }
+    else if (count == 0)
+    {
+      // The first value of each column has no comma before it.
+      record_size -= field_count - 1;
+    }
+
+    if (size + record_size > max_size)
+    {
+      break;
+    }
+    size += record_size;
+  }
+
+  *out_record_count = count;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_get_payload(
+    az_iot_hub_client_telemetry_batch const* batch,
+    void const* records,
+    int32_t record_count,
+    az_span payload,
+    az_span* out_payload,
+    int32_t* out_records_written)
+{
+  _az_PRECONDITION_NOT_NULL(batch);
+  _az_PRECONDITION_NOT_NULL(records);
+  _az_PRECONDITION(record_count > 0);
+  _az_PRECONDITION_VALID_SPAN(payload, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_payload);
+  _az_PRECONDITION_NOT_NULL(out_records_written);
+
+  uint8_t const* const record_bytes = (uint8_t const*)records;
+
+  // The JSON writer asks for room for more than it writes, so keep that much spare at the end of
+  // the payload buffer.
+  int32_t max_size = batch->_internal.options.max_payload_size;
+  if (az_span_size(payload) - _az_TELEMETRY_BATCH_JSON_WRITER_CHUNK_SIZE < max_size)
+  {
+    max_size = az_span_size(payload) - _az_TELEMETRY_BATCH_JSON_WRITER_CHUNK_SIZE;
+  }
+
+  // Sizing the batch first lets it be closed before the record that would exceed the limit, which a
+  // columnar payload otherwise only finds out about in its last column.
+  int32_t count = 0;
+  _az_RETURN_IF_FAILED(_az_iot_hub_client_telemetry_batch_count_records(
+      batch, record_bytes, record_count, max_size, &count));
+  if (count == 0)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  az_json_writer writer;
+  _az_RETURN_IF_FAILED(az_json_writer_init(&writer, payload, NULL));
+  _az_RETURN_IF_FAILED(
+      _az_iot_hub_client_telemetry_batch_write(batch, record_bytes, count, &writer));
+
+  *out_payload = az_json_writer_get_bytes_used_in_destination(&writer);
+  *out_records_written = count;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_append_property(
+    az_iot_hub_client_telemetry_batch const* batch,
+    az_iot_message_properties* properties)
+{
+  _az_PRECONDITION_NOT_NULL(batch);
+  _az_PRECONDITION_NOT_NULL(properties);
+
+  return az_iot_message_properties_append(
+      properties,
+      AZ_SPAN_FROM_STR(AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_PROPERTY_NAME),
+      batch->_internal.options.layout == AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_ROWS
+          ? telemetry_batch_rows_value
+          : telemetry_batch_columnar_value);
+}
+
+enum
+{
+  // How much slower than configured a throttled pacer can get.
+  _az_TELEMETRY_PACER_MAX_SLOWDOWN = 64,
+};
+
+// A theoretical arrival time so far in the past that any time allows a full burst, and the bound of
+// the burst tolerance, which together can't overflow.
+#define _az_TELEMETRY_PACER_FULL_BURST_USEC (INT64_MIN / 4)
+#define _az_TELEMETRY_PACER_MAX_TOLERANCE_USEC (INT64_MAX / 4)
+
+AZ_NODISCARD az_iot_hub_client_telemetry_pacer_options
+az_iot_hub_client_telemetry_pacer_options_default()
+{
+  return (az_iot_hub_client_telemetry_pacer_options){
+    .messages = 100,
+    .period_msec = 1000,
+    .burst = 10,
+    .throttled_pause_msec = 5000,
+  };
+}
+
+AZ_NODISCARD az_iot_hub_client_telemetry_pacer_options
+az_iot_hub_client_telemetry_pacer_options_for_tier(
+    az_iot_hub_tier tier,
+    int32_t units,
+    int32_t device_count)
+{
+  _az_PRECONDITION_RANGE(1, units, 200);
+  _az_PRECONDITION_RANGE(1, device_count, 2000000);
+
+  // The device-to-cloud sends per second of each tier.
+  int32_t messages_per_second;
+  switch (tier)
+  {
+    case AZ_IOT_HUB_TIER_B2:
+    case AZ_IOT_HUB_TIER_S2:
+      messages_per_second = 120 * units;
+      break;
+    case AZ_IOT_HUB_TIER_B3:
+    case AZ_IOT_HUB_TIER_S3:
+      messages_per_second = 6000 * units;
+      break;
+    default:
+      messages_per_second = 12 * units > 100 ? 12 * units : 100;
+      break;
+  }
+
+  az_iot_hub_client_telemetry_pacer_options options
+      = az_iot_hub_client_telemetry_pacer_options_default();
+  options.messages = messages_per_second;
+  options.period_msec = 1000 * device_count;
+  options.burst = 1;
+  return options;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_pacer_init(
+    az_iot_hub_client_telemetry_pacer* pacer,
+    az_iot_hub_client_telemetry_pacer_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(pacer);
+
+  pacer->_internal.options
+      = options == NULL ? az_iot_hub_client_telemetry_pacer_options_default() : *options;
+
+  _az_PRECONDITION_RANGE(1, pacer->_internal.options.messages, INT32_MAX);
+  _az_PRECONDITION_RANGE(1, pacer->_internal.options.period_msec, INT32_MAX);
+  _az_PRECONDITION_RANGE(1, pacer->_internal.options.burst, INT32_MAX);
+  _az_PRECONDITION_RANGE(0, pacer->_internal.options.throttled_pause_msec, INT32_MAX);
+
+  // Microseconds keep the interval accurate for rates of more than a message per millisecond.
+  int64_t const interval_usec
+      = ((int64_t)pacer->_internal.options.period_msec * _az_TIME_MICROSECONDS_PER_MILLISECOND)
+      / pacer->_internal.options.messages;
+  pacer->_internal.configured_interval_usec = interval_usec > 0 ? interval_usec : 1;
+  pacer->_internal.interval_usec = pacer->_internal.configured_interval_usec;
+  pacer->_internal.theoretical_arrival_usec = _az_TELEMETRY_PACER_FULL_BURST_USEC;
+
+  return AZ_OK;
+}
+
+// The generic cell rate algorithm lets a message through when the current time is no earlier than
+// the time the next message is due at the configured rate, minus this tolerance for bursts.
+static AZ_NODISCARD int64_t
+_az_iot_hub_client_telemetry_pacer_tolerance_usec(az_iot_hub_client_telemetry_pacer const* pacer)
+{
+  int64_t const extra_messages = (int64_t)pacer->_internal.options.burst - 1;
+  return extra_messages > _az_TELEMETRY_PACER_MAX_TOLERANCE_USEC / pacer->_internal.interval_usec
+      ? _az_TELEMETRY_PACER_MAX_TOLERANCE_USEC
+      : extra_messages * pacer->_internal.interval_usec;
+}
+
+static AZ_NODISCARD int64_t _az_iot_hub_client_telemetry_pacer_earliest_usec(
+    az_iot_hub_client_telemetry_pacer const* pacer)
+{
+  return pacer->_internal.theoretical_arrival_usec
+      - _az_iot_hub_client_telemetry_pacer_tolerance_usec(pacer);
+}
+
+AZ_NODISCARD bool az_iot_hub_client_telemetry_pacer_try_send(
+    az_iot_hub_client_telemetry_pacer* pacer,
+    int64_t current_clock_msec)
+{
+  _az_PRECONDITION_NOT_NULL(pacer);
+
+  int64_t const current_usec = current_clock_msec * _az_TIME_MICROSECONDS_PER_MILLISECOND;
+  if (current_usec < _az_iot_hub_client_telemetry_pacer_earliest_usec(pacer))
+  {
+    return false;
+  }
+
+  int64_t const due_usec = pacer->_internal.theoretical_arrival_usec > current_usec
+      ? pacer->_internal.theoretical_arrival_usec
+      : current_usec;
+  pacer->_internal.theoretical_arrival_usec = due_usec + pacer->_internal.interval_usec;
+  return true;
+}
+
+AZ_NODISCARD int32_t az_iot_hub_client_telemetry_pacer_get_delay_msec(
+    az_iot_hub_client_telemetry_pacer const* pacer,
+    int64_t current_clock_msec)
+{
+  _az_PRECONDITION_NOT_NULL(pacer);
+
+  int64_t const delay_usec = _az_iot_hub_client_telemetry_pacer_earliest_usec(pacer)
+      - (current_clock_msec * _az_TIME_MICROSECONDS_PER_MILLISECOND);
+  if (delay_usec <= 0)
+  {
+    return 0;
+  }
+
+  int64_t const delay_msec = (delay_usec + _az_TIME_MICROSECONDS_PER_MILLISECOND - 1)
+      / _az_TIME_MICROSECONDS_PER_MILLISECOND;
+  return delay_msec > INT32_MAX ? INT32_MAX : (int32_t)delay_msec;
+}
+
+AZ_NODISCARD int32_t az_iot_hub_client_telemetry_pacer_get_batch_size(
+    az_iot_hub_client_telemetry_pacer const* pacer,
+    int64_t current_clock_msec,
+    int32_t queued_count)
+{
+  _az_PRECONDITION_NOT_NULL(pacer);
+  _az_PRECONDITION_RANGE(0, queued_count, INT32_MAX);
+
+  int64_t const current_usec = current_clock_msec * _az_TIME_MICROSECONDS_PER_MILLISECOND;
+  int64_t const earliest_usec = _az_iot_hub_client_telemetry_pacer_earliest_usec(pacer);
+  if (queued_count == 0 || current_usec < earliest_usec)
+  {
+    return 0;
+  }
+
+  // The messages allowed right now are the one due, plus those the time since then has made room
+  // for, up to a burst.
+  int64_t allowed = ((current_usec - earliest_usec) / pacer->_internal.interval_usec) + 1;
+  if (allowed > pacer->_internal.options.burst)
+  {
+    allowed = pacer->_internal.options.burst;
+  }
+
+  return (int32_t)(((int64_t)queued_count + allowed - 1) / allowed);
+}
+
+void az_iot_hub_client_telemetry_pacer_report_status(
+    az_iot_hub_client_telemetry_pacer* pacer,
+    az_iot_status status,
+    int64_t current_clock_msec)
+{
+  _az_PRECONDITION_NOT_NULL(pacer);
+
+  int64_t const configured_interval_usec = pacer->_internal.configured_interval_usec;
+  if (status == AZ_IOT_STATUS_THROTTLED)
+  {
+    int64_t const max_interval_usec = configured_interval_usec * _az_TELEMETRY_PACER_MAX_SLOWDOWN;
+    pacer->_internal.interval_usec = pacer->_internal.interval_usec > max_interval_usec / 2
+        ? max_interval_usec
+        : pacer->_internal.interval_usec * 2;
+
+    // No message is due before the end of the pause, not even within a burst.
+    int64_t const resume_msec = current_clock_msec + pacer->_internal.options.throttled_pause_msec;
+    int64_t const resume_usec = (resume_msec * _az_TIME_MICROSECONDS_PER_MILLISECOND)
+        + _az_iot_hub_client_telemetry_pacer_tolerance_usec(pacer);
+    if (pacer->_internal.theoretical_arrival_usec < resume_usec)
+    {
+      pacer->_internal.theoretical_arrival_usec = resume_usec;
+    }
+  }
+  else if (az_iot_status_succeeded(status))
+  {
+    pacer->_internal.interval_usec
+        -= (pacer->_internal.interval_usec - configured_interval_usec + 3) / 4;
+  }
+}
@@ -0,0 +1,502 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_common.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <azure/core/internal/az_precondition_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+// The buffer starts with two header slots, written in turn, so that one is always whole:
+// magic, generation, data size, head offset, head sequence, 8 reserved bytes, checksum.
+#define _az_IOT_MESSAGE_QUEUE_SLOT_SIZE (AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE / 2)
+#define _az_IOT_MESSAGE_QUEUE_SLOT_CHECKSUM_OFFSET (_az_IOT_MESSAGE_QUEUE_SLOT_SIZE - 4)
+#define _az_IOT_MESSAGE_QUEUE_MAGIC 0x51544F49U
+
+// Each record is: sequence, payload size, topic size, kind, acknowledged flag, packet ID,
+// 2 reserved bytes and checksum, followed by the topic and the payload. The acknowledged flag and
+// packet ID change after the record is written, so they are left out of the checksum.
+#define _az_IOT_MESSAGE_QUEUE_RECORD_PAYLOAD_SIZE_OFFSET 4
+#define _az_IOT_MESSAGE_QUEUE_RECORD_TOPIC_SIZE_OFFSET 8
+#define _az_IOT_MESSAGE_QUEUE_RECORD_KIND_OFFSET 10
+#define _az_IOT_MESSAGE_QUEUE_RECORD_ACKED_OFFSET 11
+#define _az_IOT_MESSAGE_QUEUE_RECORD_PACKET_ID_OFFSET 12
+#define _az_IOT_MESSAGE_QUEUE_RECORD_CHECKSUM_OFFSET 16
+
+// A message, or the padding which fills the end of the buffer when a message doesn't fit there.
+#define _az_IOT_MESSAGE_QUEUE_KIND_MESSAGE 1
+#define _az_IOT_MESSAGE_QUEUE_KIND_PADDING 2
+
+static AZ_NODISCARD uint8_t* _az_iot_message_queue_data(az_iot_message_queue const* queue)
+{
+  return az_span_ptr(queue->_internal.buffer) + AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE;
+}
+
+static AZ_NODISCARD int32_t _az_iot_message_queue_record_data_size(uint8_t const* record)
+{
+  return (int32_t)_az_iot_read_le_u16(record + _az_IOT_MESSAGE_QUEUE_RECORD_TOPIC_SIZE_OFFSET)
+      + (int32_t)_az_iot_read_le_u32(record + _az_IOT_MESSAGE_QUEUE_RECORD_PAYLOAD_SIZE_OFFSET);
+}
+
+static AZ_NODISCARD int32_t _az_iot_message_queue_record_size(uint8_t const* record)
+{
+  return (AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE + _az_iot_message_queue_record_data_size(record)
+          + 3)
+      & ~3;
+}
+
+static AZ_NODISCARD uint32_t _az_iot_message_queue_record_checksum(uint8_t* record)
+{
+  // FNV-1a, which is enough to tell a whole record from a torn or stale one.
+  uint32_t const hash = _az_iot_fnv1a(
+      _az_IOT_FNV1A_OFFSET_BASIS,
+      az_span_create(record, _az_IOT_MESSAGE_QUEUE_RECORD_ACKED_OFFSET));
+
+  // The content of a padding is whatever was there before.
+  if (record[_az_IOT_MESSAGE_QUEUE_RECORD_KIND_OFFSET] == _az_IOT_MESSAGE_QUEUE_KIND_PADDING)
+  {
+    return hash;
+  }
+
+  return _az_iot_fnv1a(
+      hash,
+      az_span_create(
+          record + AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE,
+          _az_iot_message_queue_record_data_size(record)));
+}
+
+// Moves an offset past the end of a record, to the start of the buffer when no record header fits
+// in what is left.
+static AZ_NODISCARD int32_t
+_az_iot_message_queue_next_offset(az_iot_message_queue const* queue, int32_t offset)
+{
+  bool const is_record_header_fitting
+      = queue->_internal.data_size - offset >= AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE;
+  return is_record_header_fitting ? offset : 0;
+}
+
+static void _az_iot_message_queue_write_record_header(
+    uint8_t* record,
+    uint32_t sequence,
+    uint32_t payload_size,
+    uint16_t topic_size,
+    uint8_t kind)
+{
+  _az_iot_write_le_u32(record, sequence);
+  _az_iot_write_le_u32(record + _az_IOT_MESSAGE_QUEUE_RECORD_PAYLOAD_SIZE_OFFSET, payload_size);
+  _az_iot_write_le_u16(record + _az_IOT_MESSAGE_QUEUE_RECORD_TOPIC_SIZE_OFFSET, topic_size);
+  record[_az_IOT_MESSAGE_QUEUE_RECORD_KIND_OFFSET] = kind;
+  record[_az_IOT_MESSAGE_QUEUE_RECORD_ACKED_OFFSET] = 0;
+  _az_iot_write_le_u16(record + _az_IOT_MESSAGE_QUEUE_RECORD_PACKET_ID_OFFSET, 0);
+  _az_iot_write_le_u16(record + _az_IOT_MESSAGE_QUEUE_RECORD_PACKET_ID_OFFSET + 2, 0);
+}
+
+static void _az_iot_message_queue_write_header(az_iot_message_queue* queue)
+{
+  // The slot not holding the current header is overwritten, so that if this write is torn, the
+  // previous header is still there.
+  queue->_internal.generation++;
+  uint8_t* const slot = az_span_ptr(queue->_internal.buffer)
+      + ((queue->_internal.generation & 1) * _az_IOT_MESSAGE_QUEUE_SLOT_SIZE);
+
+  _az_iot_write_le_u32(slot, _az_IOT_MESSAGE_QUEUE_MAGIC);
+  _az_iot_write_le_u32(slot + 4, queue->_internal.generation);
+  _az_iot_write_le_u32(slot + 8, (uint32_t)queue->_internal.data_size);
+  _az_iot_write_le_u32(slot + 12, (uint32_t)queue->_internal.head);
+  _az_iot_write_le_u32(slot + 16, queue->_internal.head_sequence);
+  _az_iot_write_le_u32(slot + 20, 0);
+  _az_iot_write_le_u32(slot + 24, 0);
+  _az_iot_write_le_u32(
+      slot + _az_IOT_MESSAGE_QUEUE_SLOT_CHECKSUM_OFFSET,
+      _az_iot_fnv1a(
+          _az_IOT_FNV1A_OFFSET_BASIS,
+          az_span_create(slot, _az_IOT_MESSAGE_QUEUE_SLOT_CHECKSUM_OFFSET)));
+}
+
+static AZ_NODISCARD bool _az_iot_message_queue_read_header(
+    az_iot_message_queue const* queue,
+    uint8_t* slot,
+    uint32_t* out_generation,
+    int32_t* out_head,
+    uint32_t* out_head_sequence)
+{
+  uint32_t const head = _az_iot_read_le_u32(slot + 12);
+  if (_az_iot_read_le_u32(slot) != _az_IOT_MESSAGE_QUEUE_MAGIC
+      || _az_iot_read_le_u32(slot + _az_IOT_MESSAGE_QUEUE_SLOT_CHECKSUM_OFFSET)
+          != _az_iot_fnv1a(
+              _az_IOT_FNV1A_OFFSET_BASIS,
+              az_span_create(slot, _az_IOT_MESSAGE_QUEUE_SLOT_CHECKSUM_OFFSET))
+      || _az_iot_read_le_u32(slot + 8) != (uint32_t)queue->_internal.data_size
+      || head >= (uint32_t)queue->_internal.data_size || (head & 3) != 0
+      || _az_iot_message_queue_next_offset(queue, (int32_t)head) != (int32_t)head)
+  {
+    return false;
+  }
+
+  *out_generation = _az_iot_read_le_u32(slot + 4);
+  *out_head = (int32_t)head;
+  *out_head_sequence = _az_iot_read_le_u32(slot + 16);
+  return true;
+}
+
+// Finds the records following the head, up to the first one which is missing, torn or left from an
+// earlier pass over the buffer, which all have another sequence number than expected.
+static void _az_iot_message_queue_recover_records(az_iot_message_queue* queue)
+{
+  uint8_t* const data = _az_iot_message_queue_data(queue);
+  int32_t const data_size = queue->_internal.data_size;
+  uint32_t sequence = queue->_internal.head_sequence;
+  int32_t offset = queue->_internal.head;
+  int32_t used = 0;
+
+  queue->_internal.tail = offset;
+  queue->_internal.count = 0;
+  while (true)
+  {
+    uint8_t* const record = data + offset;
+    uint8_t const kind = record[_az_IOT_MESSAGE_QUEUE_RECORD_KIND_OFFSET];
+    uint32_t const size_left = (uint32_t)(data_size - offset);
+    uint32_t const payload_size
+        = _az_iot_read_le_u32(record + _az_IOT_MESSAGE_QUEUE_RECORD_PAYLOAD_SIZE_OFFSET);
+    if (_az_iot_read_le_u32(record) != sequence
+        || (kind != _az_IOT_MESSAGE_QUEUE_KIND_MESSAGE
+            && kind != _az_IOT_MESSAGE_QUEUE_KIND_PADDING)
+        || payload_size > size_left - AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE)
+    {
+      return;
+    }
+
+    int32_t const size = _az_iot_message_queue_record_size(record);
+    if ((uint32_t)size > size_left || used + size > data_size
+        || (kind == _az_IOT_MESSAGE_QUEUE_KIND_PADDING
+            && (offset == 0 || (uint32_t)size != size_left))
+        || _az_iot_read_le_u32(record + _az_IOT_MESSAGE_QUEUE_RECORD_CHECKSUM_OFFSET)
+            != _az_iot_message_queue_record_checksum(record))
+    {
+      return;
+    }
+
+    used += size;
+    if (kind == _az_IOT_MESSAGE_QUEUE_KIND_PADDING)
+    {
+      // The message following the padding is at the start of the buffer, with the same sequence.
+      offset = 0;
+    }
+    else
+    {
+      offset = _az_iot_message_queue_next_offset(queue, offset + size);
+      sequence++;
+      queue->_internal.tail = offset;
+      queue->_internal.count++;
+    }
+  }
+}
+
+// Releases the acknowledged messages at the head of the queue, and saves the new head.
+static void _az_iot_message_queue_release(az_iot_message_queue* queue)
+{
+  uint8_t* const data = _az_iot_message_queue_data(queue);
+  bool is_moved = false;
+
+  while (queue->_internal.count > 0)
+  {
+    uint8_t const* const record = data + queue->_internal.head;
+    if (record[_az_IOT_MESSAGE_QUEUE_RECORD_KIND_OFFSET] == _az_IOT_MESSAGE_QUEUE_KIND_PADDING)
+    {
+      queue->_internal.head = 0;
+      is_moved = true;
+      continue;
+    }
+
+    if (record[_az_IOT_MESSAGE_QUEUE_RECORD_ACKED_OFFSET] == 0)
+    {
+      break;
+    }
+
+    // A message acknowledged before a rewind may be among the unsent ones, which it is the first of
+    // when no message is in flight.
+    if (queue->_internal.count == queue->_internal.unsent_count)
+    {
+      queue->_internal.unsent_count--;
+    }
+    queue->_internal.head = _az_iot_message_queue_next_offset(
+        queue, queue->_internal.head + _az_iot_message_queue_record_size(record));
+    queue->_internal.head_sequence++;
+    queue->_internal.count--;
+    is_moved = true;
+  }
+
+  if (queue->_internal.count == queue->_internal.unsent_count)
+  {
+    queue->_internal.send_cursor = queue->_internal.head;
+  }
+
+  if (is_moved)
+  {
+    _az_iot_message_queue_write_header(queue);
+  }
+}
+
+AZ_NODISCARD az_result az_iot_message_queue_init(az_iot_message_queue* queue, az_span buffer)
+{
+  _az_PRECONDITION_NOT_NULL(queue);
+  _az_PRECONDITION_VALID_SPAN(
+      buffer,
+      AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE + (2 * AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE),
+      false);
+
+  uint8_t* const ptr = az_span_ptr(buffer);
+  queue->_internal.buffer = buffer;
+  queue->_internal.data_size = (az_span_size(buffer) - AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE) & ~3;
+
+  uint32_t generations[2];
+  int32_t heads[2];
+  uint32_t head_sequences[2];
+  bool const is_valid[2] = {
+    _az_iot_message_queue_read_header(
+        queue, ptr, &generations[0], &heads[0], &head_sequences[0]),
+    _az_iot_message_queue_read_header(
+        queue,
+        ptr + _az_IOT_MESSAGE_QUEUE_SLOT_SIZE,
+        &generations[1],
+        &heads[1],
+        &head_sequences[1]),
+  };
+
+  if (!is_valid[0] && !is_valid[1])
+  {
+    // Nothing to recover. The buffer is cleared, so that no record left in it from an earlier use
+    // can pass for one of this queue.
+    memset(ptr, 0, (size_t)az_span_size(buffer));
+    queue->_internal.generation = UINT32_MAX;
+    queue->_internal.head = 0;
+    queue->_internal.head_sequence = 0;
+    _az_iot_message_queue_write_header(queue);
+  }
+  else
+  {
+    int32_t const slot
+        = (!is_valid[0] || (is_valid[1] && (int32_t)(generations[1] - generations[0]) > 0)) ? 1
+                                                                                              : 0;
+    queue->_internal.generation = generations[slot];
+    queue->_internal.head = heads[slot];
+    queue->_internal.head_sequence = head_sequences[slot];
+  }
+
+  _az_iot_message_queue_recover_records(queue);
+
+  // The packet IDs of the previous connection are meaningless, so every message which isn't
+  // acknowledged is sent again.
+  az_iot_message_queue_rewind(queue);
+  _az_iot_message_queue_release(queue);
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_iot_message_queue_enqueue(az_iot_message_queue* queue, az_span topic, az_span payload)
+{
+  _az_PRECONDITION_NOT_NULL(queue);
+  _az_PRECONDITION_VALID_SPAN(topic, 1, false);
+  _az_PRECONDITION(az_span_size(topic) <= UINT16_MAX);
+  _az_PRECONDITION_VALID_SPAN(payload, 0, true);
+
+  int32_t const data_size = queue->_internal.data_size;
+  int32_t const topic_size = az_span_size(topic);
+  int32_t const payload_size = az_span_size(payload);
+  if (payload_size > data_size - AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE - topic_size)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  bool const is_empty = queue->_internal.count == 0;
+  if (is_empty && queue->_internal.head != 0)
+  {
+    // Start an empty queue over from the start of the buffer, so that any message which fits in the
+    // buffer fits in the queue.
+    queue->_internal.head = 0;
+    queue->_internal.tail = 0;
+    queue->_internal.send_cursor = 0;
+    _az_iot_message_queue_write_header(queue);
+  }
+
+  int32_t const head = queue->_internal.head;
+  int32_t const tail = queue->_internal.tail;
+
+  int32_t const size
+      = (AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE + topic_size + payload_size + 3) & ~3;
+  int32_t offset = tail;
+  if (!is_empty && tail == head)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+  else if (!is_empty && tail < head)
+  {
+    if (size > head - tail)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+  }
+  else if (size > data_size - tail)
+  {
+    if (size > head)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+
+    // Pad the end of the buffer, which always has room for a record header, and start over.
+    uint8_t* const padding = _az_iot_message_queue_data(queue) + tail;
+    uint32_t const sequence = queue->_internal.head_sequence + (uint32_t)queue->_internal.count;
+    _az_iot_message_queue_write_record_header(
+        padding,
+        sequence,
+        (uint32_t)(data_size - tail - AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE),
+        0,
+        _az_IOT_MESSAGE_QUEUE_KIND_PADDING);
+    _az_iot_write_le_u32(
+        padding + _az_IOT_MESSAGE_QUEUE_RECORD_CHECKSUM_OFFSET,
+        _az_iot_message_queue_record_checksum(padding));
+    offset = 0;
+  }
+
+  uint8_t* const record = _az_iot_message_queue_data(queue) + offset;
+  _az_iot_message_queue_write_record_header(
+      record,
+      queue->_internal.head_sequence + (uint32_t)queue->_internal.count,
+      (uint32_t)payload_size,
+      (uint16_t)topic_size,
+      _az_IOT_MESSAGE_QUEUE_KIND_MESSAGE);
+  memcpy(record + AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE, az_span_ptr(topic), (size_t)topic_size);
+  if (payload_size > 0)
+  {
+    memcpy(
+        record + AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE + topic_size,
+        az_span_ptr(payload),
+        (size_t)payload_size);
+  }
+  _az_iot_write_le_u32(
+      record + _az_IOT_MESSAGE_QUEUE_RECORD_CHECKSUM_OFFSET,
+      _az_iot_message_queue_record_checksum(record));
+
+  queue->_internal.tail = _az_iot_message_queue_next_offset(queue, offset + size);
+  queue->_internal.count++;
+  queue->_internal.unsent_count++;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_message_queue_get_unsent(
+    az_iot_message_queue* queue,
+    az_iot_message_queue_message* messages,
+    int32_t messages_length,
+    int32_t* out_count)
+{
+  _az_PRECONDITION_NOT_NULL(queue);
+  _az_PRECONDITION_NOT_NULL(messages);
+  _az_PRECONDITION_RANGE(1, messages_length, INT32_MAX);
+  _az_PRECONDITION_NOT_NULL(out_count);
+
+  uint8_t* const data = _az_iot_message_queue_data(queue);
+  int32_t count = 0;
+  while (count < messages_length && queue->_internal.unsent_count > 0)
+  {
+    int32_t const offset = queue->_internal.send_cursor;
+    uint8_t* const record = data + offset;
+    if (record[_az_IOT_MESSAGE_QUEUE_RECORD_KIND_OFFSET] == _az_IOT_MESSAGE_QUEUE_KIND_PADDING)
+    {
+      queue->_internal.send_cursor = 0;
+      continue;
+    }
+
+    // Messages acknowledged out of order before a rewind aren't sent again.
+    if (record[_az_IOT_MESSAGE_QUEUE_RECORD_ACKED_OFFSET] == 0)
+    {
+      int32_t const topic_size
+          = (int32_t)_az_iot_read_le_u16(record + _az_IOT_MESSAGE_QUEUE_RECORD_TOPIC_SIZE_OFFSET);
+      messages[count].topic
+          = az_span_create(record + AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE, topic_size);
+      messages[count].payload = az_span_create(
+          record + AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE + topic_size,
+          (int32_t)_az_iot_read_le_u32(record + _az_IOT_MESSAGE_QUEUE_RECORD_PAYLOAD_SIZE_OFFSET));
+      messages[count]._internal.offset = offset;
+      count++;
+    }
+
+    queue->_internal.send_cursor = _az_iot_message_queue_next_offset(
+        queue, offset + _az_iot_message_queue_record_size(record));
+    queue->_internal.unsent_count--;
+  }
+
+  *out_count = count;
+  return AZ_OK;
+}
+
+void az_iot_message_queue_set_packet_id(
+    az_iot_message_queue* queue,
+    az_iot_message_queue_message const* message,
+    uint16_t packet_id)
+{
+  _az_PRECONDITION_NOT_NULL(queue);
+  _az_PRECONDITION_NOT_NULL(message);
+  _az_PRECONDITION_RANGE(0, message->_internal.offset, queue->_internal.data_size - 1);
+  _az_PRECONDITION(packet_id > 0);
+
+  _az_iot_write_le_u16(
+      _az_iot_message_queue_data(queue) + message->_internal.offset
+          + _az_IOT_MESSAGE_QUEUE_RECORD_PACKET_ID_OFFSET,
+      packet_id);
+}
+
+AZ_NODISCARD az_result az_iot_message_queue_ack(az_iot_message_queue* queue, uint16_t packet_id)
+{
+  _az_PRECONDITION_NOT_NULL(queue);
+
+  // Only the messages between the head and the send cursor are in flight, and the one acknowledged
+  // is usually the oldest.
+  uint8_t* const data = _az_iot_message_queue_data(queue);
+  int32_t const in_flight_count = queue->_internal.count - queue->_internal.unsent_count;
+  int32_t offset = queue->_internal.head;
+  int32_t i = 0;
+  while (i < in_flight_count)
+  {
+    uint8_t* const record = data + offset;
+    if (record[_az_IOT_MESSAGE_QUEUE_RECORD_KIND_OFFSET] == _az_IOT_MESSAGE_QUEUE_KIND_PADDING)
+    {
+      offset = 0;
+      continue;
+    }
+
+    if (record[_az_IOT_MESSAGE_QUEUE_RECORD_ACKED_OFFSET] == 0
+        && _az_iot_read_le_u16(record + _az_IOT_MESSAGE_QUEUE_RECORD_PACKET_ID_OFFSET) == packet_id)
+    {
+      record[_az_IOT_MESSAGE_QUEUE_RECORD_ACKED_OFFSET] = 1;
+      if (i == 0)
+      {
+        _az_iot_message_queue_release(queue);
+      }
+      return AZ_OK;
+    }
+
+    offset = _az_iot_message_queue_next_offset(
+        queue, offset + _az_iot_message_queue_record_size(record));
+    i++;
+  }
+
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
+
+void az_iot_message_queue_rewind(az_iot_message_queue* queue)
+{
+  _az_PRECONDITION_NOT_NULL(queue);
+
+  queue->_internal.send_cursor = queue->_internal.head;
+  queue->_internal.unsent_count = queue->_internal.count;
+}
@@ -238,7 +238,8 @@ _az_iot_provisioning_registration_state_default()
                                                           .error_message = AZ_SPAN_EMPTY,
                                                           .error_tracking_id = AZ_SPAN_EMPTY,
                                                           .error_timestamp = AZ_SPAN_EMPTY,
-                                                          .payload = { 0 } };
+                                                          .payload = { 0 },
+                                                          .etag = AZ_SPAN_EMPTY };
 }
 
 AZ_INLINE az_iot_status _az_iot_status_from_extended_status(uint32_t extended_status)
@@ -361,6 +362,15 @@ AZ_INLINE az_result _az_iot_provisioning_client_payload_registration_state_parse
       }
       out_state->error_timestamp = jr->token.slice;
     }
+    else if (az_json_token_is_text_equal(&jr->token, AZ_SPAN_FROM_STR("etag")))
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(jr));
+      if (jr->token.kind != AZ_JSON_TOKEN_STRING)
+      {
+        return AZ_ERROR_ITEM_NOT_FOUND;
+      }
+      out_state->etag = jr->token.slice;
+    }
     else if (az_result_succeeded(
                  _az_iot_provisioning_client_parse_payload_error_code(jr, out_state)))
     {
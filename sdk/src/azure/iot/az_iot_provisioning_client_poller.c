@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/az_context.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_common.h>
+#include <azure/iot/az_iot_provisioning_client.h>
+
+#include <azure/core/internal/az_precondition_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+AZ_NODISCARD az_iot_provisioning_client_poller_options
+az_iot_provisioning_client_poller_options_default()
+{
+  az_iot_provisioning_client_poller_options options = {
+    .retry = az_iot_retry_policy_options_default(),
+    .response_timeout_msec = 10000,
+  };
+
+  // Registrations take seconds, so there is no point in backing off for longer than this.
+  options.retry.max_retry_delay_msec = 30000;
+  return options;
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_poller_init(
+    az_iot_provisioning_client_poller* poller,
+    az_iot_provisioning_client const* client,
+    az_context const* context,
+    az_span operation_id_buffer,
+    az_iot_provisioning_client_poller_options const* options,
+    int64_t current_clock_msec)
+{
+  _az_PRECONDITION_NOT_NULL(poller);
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(operation_id_buffer, 1, false);
+
+  az_iot_provisioning_client_poller_options const poller_options
+      = options == NULL ? az_iot_provisioning_client_poller_options_default() : *options;
+  _az_PRECONDITION_RANGE(1, poller_options.response_timeout_msec, INT32_MAX);
+
+  _az_RETURN_IF_FAILED(az_iot_retry_policy_init(
+      &poller->_internal.retry_policy, client->_internal.registration_id, &poller_options.retry));
+
+  poller->_internal.context = context;
+  poller->_internal.operation_id_buffer = operation_id_buffer;
+  poller->_internal.operation_id_size = 0;
+  poller->_internal.response_timeout_msec = poller_options.response_timeout_msec;
+  poller->_internal.start_time_msec = current_clock_msec;
+  poller->_internal.deadline_msec = current_clock_msec;
+  poller->_internal.is_waiting_response = false;
+  poller->_internal.is_complete = false;
+
+  return AZ_OK;
+}
+
+static void _az_iot_provisioning_client_poller_schedule(
+    az_iot_provisioning_client_poller* poller,
+    int32_t retry_after_msec,
+    int64_t current_clock_msec)
+{
+  poller->_internal.is_waiting_response = false;
+  poller->_internal.deadline_msec = current_clock_msec
+      + az_iot_retry_policy_get_next_delay(&poller->_internal.retry_policy, retry_after_msec);
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_poller_get_action(
+    az_iot_provisioning_client_poller* poller,
+    int64_t current_clock_msec,
+    az_iot_provisioning_client_poller_action* out_action)
+{
+  _az_PRECONDITION_NOT_NULL(poller);
+  _az_PRECONDITION_NOT_NULL(out_action);
+
+  *out_action = AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_NONE;
+
+  if (poller->_internal.is_complete)
+  {
+    return AZ_OK;
+  }
+
+  if (poller->_internal.context != NULL
+      && az_context_has_expired(poller->_internal.context, current_clock_msec))
+  {
+    poller->_internal.is_complete = true;
+    return AZ_ERROR_CANCELED;
+  }
+
+  if (current_clock_msec < poller->_internal.deadline_msec)
+  {
+    return AZ_OK;
+  }
+
+  if (poller->_internal.is_waiting_response)
+  {
+    // The request or its response was lost, so send it again once backed off.
+    _az_iot_provisioning_client_poller_schedule(poller, 0, current_clock_msec);
+    return AZ_OK;
+  }
+
+  *out_action = poller->_internal.operation_id_size == 0
+      ? AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_REGISTER
+      : AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_QUERY_STATUS;
+  return AZ_OK;
+}
+
+void az_iot_provisioning_client_poller_report_sent(
+    az_iot_provisioning_client_poller* poller,
+    int64_t current_clock_msec)
+{
+  _az_PRECONDITION_NOT_NULL(poller);
+
+  poller->_internal.is_waiting_response = true;
+  poller->_internal.deadline_msec = current_clock_msec + poller->_internal.response_timeout_msec;
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_poller_report_response(
+    az_iot_provisioning_client_poller* poller,
+    az_iot_provisioning_client_register_response const* response,
+    int64_t current_clock_msec)
+{
+  _az_PRECONDITION_NOT_NULL(poller);
+  _az_PRECONDITION_NOT_NULL(response);
+
+  if (poller->_internal.is_complete)
+  {
+    return AZ_OK;
+  }
+
+  int32_t const operation_id_size = az_span_size(response->operation_id);
+  if (operation_id_size > 0)
+  {
+    _az_RETURN_IF_NOT_ENOUGH_SIZE(poller->_internal.operation_id_buffer, operation_id_size);
+    az_span_copy(poller->_internal.operation_id_buffer, response->operation_id);
+    poller->_internal.operation_id_size = operation_id_size;
+  }
+
+  int32_t const retry_after_msec = response->retry_after_seconds > (INT32_MAX - 1) / 1000
+      ? INT32_MAX - 1
+      : (int32_t)response->retry_after_seconds * 1000;
+
+  if (az_iot_status_retriable(response->status))
+  {
+    // Keep backing off from the previous failures, and at least for as long as asked.
+    _az_iot_provisioning_client_poller_schedule(poller, retry_after_msec, current_clock_msec);
+  }
+  else if (
+      !az_iot_status_succeeded(response->status)
+      || az_iot_provisioning_client_operation_complete(response->operation_status))
+  {
+    poller->_internal.is_waiting_response = false;
+    poller->_internal.is_complete = true;
+  }
+  else
+  {
+    // The service steers the polling while the operation is in progress, so only back off when it
+    // doesn't say when to come back.
+    if (retry_after_msec > 0)
+    {
+      az_iot_retry_policy_reset(&poller->_internal.retry_policy);
+    }
+    _az_iot_provisioning_client_poller_schedule(poller, retry_after_msec, current_clock_msec);
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD int64_t az_iot_provisioning_client_poller_get_next_deadline_msec(
+    az_iot_provisioning_client_poller const* poller)
+{
+  _az_PRECONDITION_NOT_NULL(poller);
+
+  if (poller->_internal.is_complete)
+  {
+    return INT64_MAX;
+  }
+
+  int64_t deadline = poller->_internal.deadline_msec;
+  if (poller->_internal.context != NULL)
+  {
+    // A context only expires once its expiration is past.
+    int64_t const expiration = az_context_get_expiration(poller->_internal.context);
+    if (expiration < deadline - 1)
+    {
+      deadline = expiration + 1;
+    }
+  }
+  return deadline;
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_poller_get_next(
+    az_iot_provisioning_client_poller* pollers,
+    int32_t pollers_length,
+    int64_t current_clock_msec,
+    int32_t* out_index,
+    az_iot_provisioning_client_poller_action* out_action,
+    int64_t* out_next_deadline_msec)
+{
+  _az_PRECONDITION_NOT_NULL(pollers);
+  _az_PRECONDITION_RANGE(0, pollers_length, INT32_MAX);
+  _az_PRECONDITION_NOT_NULL(out_index);
+  _az_PRECONDITION_NOT_NULL(out_action);
+
+  int64_t next_deadline = INT64_MAX;
+  for (int32_t i = 0; i < pollers_length; i++)
+  {
+    az_iot_provisioning_client_poller* const poller = &pollers[i];
+    if (poller->_internal.is_complete)
+    {
+      continue;
+    }
+
+    az_result const result
+        = az_iot_provisioning_client_poller_get_action(poller, current_clock_msec, out_action);
+    if (az_result_failed(result) || *out_action != AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_NONE)
+    {
+      *out_index = i;
+      return result;
+    }
+
+    int64_t const deadline = az_iot_provisioning_client_poller_get_next_deadline_msec(poller);
+    if (deadline < next_deadline)
+    {
+      next_deadline = deadline;
+    }
+  }
+
+  if (out_next_deadline_msec != NULL)
+  {
+    *out_next_deadline_msec = next_deadline;
+  }
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
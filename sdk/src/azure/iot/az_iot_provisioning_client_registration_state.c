@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_provisioning_client.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <azure/core/internal/az_precondition_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+// The blob starts with a fixed header, in little-endian:
+//   [0]  "AZPC"
+//   [4]  Version, then a reserved byte.
+//   [6]  Sizes of the assigned hub hostname, device ID, ETag and timestamp, then a reserved u16.
+//   [16] Size of the custom payload.
+//   [20] Hash of the ID scope and registration ID.
+// followed by the fields in the same order, and a checksum of everything before it.
+#define _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_HEADER_SIZE 24
+#define _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_CHECKSUM_SIZE 4
+#define _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT 5
+
+static const az_span registration_state_blob_magic = AZ_SPAN_LITERAL_FROM_STR("AZPC");
+
+static AZ_NODISCARD uint32_t
+_az_iot_provisioning_registration_state_identity(az_iot_provisioning_client const* client)
+{
+  uint32_t const hash = _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, client->_internal.id_scope);
+  return _az_iot_fnv1a(hash ^ '/', client->_internal.registration_id);
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_registration_state_serialize(
+    az_iot_provisioning_client const* client,
+    az_iot_provisioning_client_registration_state const* registration_state,
+    az_span destination,
+    az_span* out_blob)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(registration_state);
+  _az_PRECONDITION_VALID_SPAN(registration_state->assigned_hub_hostname, 1, false);
+  _az_PRECONDITION_VALID_SPAN(registration_state->device_id, 1, false);
+  _az_PRECONDITION_VALID_SPAN(destination, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_blob);
+
+  az_span const fields[_az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT] = {
+    registration_state->assigned_hub_hostname, registration_state->device_id,
+    registration_state->etag,                  registration_state->error_timestamp,
+    registration_state->payload,
+  };
+
+  int64_t required_size = _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_HEADER_SIZE
+      + _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_CHECKSUM_SIZE;
+  for (int32_t i = 0; i < _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT; i++)
+  {
+    // All but the payload have their size stored on 16 bits, which is plenty for what the service
+    // sends back.
+    if (i < _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT - 1
+        && az_span_size(fields[i]) > UINT16_MAX)
+    {
+      return AZ_ERROR_NOT_SUPPORTED;
+    }
+    required_size += az_span_size(fields[i]);
+  }
+
+  if (required_size > az_span_size(destination))
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+  int32_t const blob_size = (int32_t)required_size;
+
+  uint8_t* const ptr = az_span_ptr(destination);
+  az_span remainder = az_span_copy(destination, registration_state_blob_magic);
+  ptr[4] = AZ_IOT_PROVISIONING_CLIENT_REGISTRATION_STATE_BLOB_VERSION;
+  ptr[5] = 0;
+  for (int32_t i = 0; i < _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT - 1; i++)
+  {
+    _az_iot_write_le_u16(ptr + 6 + (i * 2), (uint16_t)az_span_size(fields[i]));
+  }
+  _az_iot_write_le_u16(ptr + 14, 0);
+  _az_iot_write_le_u32(
+      ptr + 16,
+      (uint32_t)az_span_size(
+          fields[_az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT - 1]));
+  _az_iot_write_le_u32(ptr + 20, _az_iot_provisioning_registration_state_identity(client));
+
+  remainder = az_span_slice_to_end(
+      remainder,
+      _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_HEADER_SIZE
+          - az_span_size(registration_state_blob_magic));
+  for (int32_t i = 0; i < _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT; i++)
+  {
+    remainder = az_span_copy(remainder, fields[i]);
+  }
+
+  int32_t const checksum_offset
+      = blob_size - _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_CHECKSUM_SIZE;
+  _az_iot_write_le_u32(
+      ptr + checksum_offset,
+      _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, az_span_slice(destination, 0, checksum_offset)));
+
+  *out_blob = az_span_slice(destination, 0, blob_size);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_registration_state_deserialize(
+    az_iot_provisioning_client const* client,
+    az_span blob,
+    az_iot_provisioning_client_registration_state* out_registration_state)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(blob, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_registration_state);
+
+  uint8_t const* const ptr = az_span_ptr(blob);
+  int32_t const size = az_span_size(blob);
+  int32_t const magic_size = az_span_size(registration_state_blob_magic);
+
+  // Tell an unrelated or older blob apart from a torn one before trusting any size in it.
+  if (size < magic_size)
+  {
+    return AZ_ERROR_UNEXPECTED_END;
+  }
+  if (!az_span_is_content_equal(az_span_slice(blob, 0, magic_size), registration_state_blob_magic))
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+  if (size < _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_HEADER_SIZE
+          + _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_CHECKSUM_SIZE)
+  {
+    return AZ_ERROR_UNEXPECTED_END;
+  }
+  if (ptr[4] != AZ_IOT_PROVISIONING_CLIENT_REGISTRATION_STATE_BLOB_VERSION)
+  {
+    return AZ_ERROR_NOT_SUPPORTED;
+  }
+
+  int64_t field_sizes[_az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT];
+  int64_t blob_size = _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_HEADER_SIZE
+      + _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_CHECKSUM_SIZE;
+  for (int32_t i = 0; i < _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT - 1; i++)
+  {
+    field_sizes[i] = _az_iot_read_le_u16(ptr + 6 + (i * 2));
+    blob_size += field_sizes[i];
+  }
+  field_sizes[_az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT - 1]
+      = _az_iot_read_le_u32(ptr + 16);
+  blob_size += field_sizes[_az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT - 1];
+
+  // Trailing bytes are allowed, so that a blob can be read back from a larger storage page.
+  if (blob_size > size)
+  {
+    return AZ_ERROR_UNEXPECTED_END;
+  }
+
+  int32_t const checksum_offset
+      = (int32_t)blob_size - _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_CHECKSUM_SIZE;
+  if (_az_iot_read_le_u32(ptr + checksum_offset)
+      != _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, az_span_slice(blob, 0, checksum_offset)))
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  if (_az_iot_read_le_u32(ptr + 20) != _az_iot_provisioning_registration_state_identity(client))
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  az_span fields[_az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT];
+  int32_t offset = _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_HEADER_SIZE;
+  for (int32_t i = 0; i < _az_IOT_PROVISIONING_REGISTRATION_STATE_BLOB_FIELD_COUNT; i++)
+  {
+    fields[i] = az_span_slice(blob, offset, offset + (int32_t)field_sizes[i]);
+    offset += (int32_t)field_sizes[i];
+  }
+
+  if (az_span_size(fields[0]) == 0 || az_span_size(fields[1]) == 0)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  out_registration_state->assigned_hub_hostname = fields[0];
+  out_registration_state->device_id = fields[1];
+  out_registration_state->error_code = AZ_IOT_STATUS_UNKNOWN;
+  out_registration_state->extended_error_code = 0;
+  out_registration_state->error_message = AZ_SPAN_EMPTY;
+  out_registration_state->error_tracking_id = AZ_SPAN_EMPTY;
+  out_registration_state->error_timestamp = fields[3];
+  out_registration_state->payload = fields[4];
+  out_registration_state->etag = fields[2];
+
+  return AZ_OK;
+}
@@ -0,0 +1,578 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_test_definitions.h"
+#include <azure/core/az_cbor.h>
+#include <azure/core/az_json.h>
+#include <azure/core/az_span.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+static az_cbor_token _az_read_single_item(uint8_t* bytes, int32_t size)
+{
+  az_cbor_reader reader = { 0 };
+  assert_int_equal(az_cbor_reader_init(&reader, az_span_create(bytes, size), NULL), AZ_OK);
+  assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+  assert_int_equal(az_cbor_reader_next_token(&reader), AZ_ERROR_CBOR_READER_DONE);
+  return reader.token;
+}
+
+static void _az_assert_integer(uint8_t* bytes, int32_t size, int64_t expected)
+{
+  az_cbor_token token = _az_read_single_item(bytes, size);
+  assert_int_equal(token.kind, AZ_CBOR_TOKEN_INTEGER);
+
+  int64_t value = 0;
+  assert_int_equal(az_cbor_token_get_int64(&token, &value), AZ_OK);
+  assert_true(value == expected);
+}
+
+// Decoding is exact, so compare the bit patterns rather than within some tolerance.
+static bool _az_is_double_identical(double actual, double expected)
+{
+  return memcmp(&actual, &expected, sizeof(actual)) == 0;
+}
+
+static void _az_assert_float(uint8_t* bytes, int32_t size, double expected)
+{
+  az_cbor_token token = _az_read_single_item(bytes, size);
+  assert_int_equal(token.kind, AZ_CBOR_TOKEN_FLOAT);
+
+  double value = 0;
+  assert_int_equal(az_cbor_token_get_double(&token, &value), AZ_OK);
+  assert_true(_az_is_double_identical(value, expected));
+}
+
+static void _az_assert_written(az_cbor_writer const* writer, uint8_t const* expected, size_t size)
+{
+  az_span const written = az_cbor_writer_get_bytes_used_in_destination(writer);
+  assert_int_equal(az_span_size(written), (int32_t)size);
+  assert_memory_equal(az_span_ptr(written), expected, size);
+}
+
+// Test vectors are from RFC 8949, Appendix A.
+static void test_cbor_reader_scalars(void** state)
+{
+  (void)state;
+
+  {
+    uint8_t data[] = { 0x00 };
+    _az_assert_integer(data, sizeof(data), 0);
+  }
+  {
+    uint8_t data[] = { 0x17 };
+    _az_assert_integer(data, sizeof(data), 23);
+  }
+  {
+    uint8_t data[] = { 0x18, 0x18 };
+    _az_assert_integer(data, sizeof(data), 24);
+  }
+  {
+    uint8_t data[] = { 0x19, 0x03, 0xe8 };
+    _az_assert_integer(data, sizeof(data), 1000);
+  }
+  {
+    uint8_t data[] = { 0x1a, 0x00, 0x0f, 0x42, 0x40 };
+    _az_assert_integer(data, sizeof(data), 1000000);
+  }
+  {
+    uint8_t data[] = { 0x1b, 0x00, 0x00, 0x00, 0xe8, 0xd4, 0xa5, 0x10, 0x00 };
+    _az_assert_integer(data, sizeof(data), 1000000000000);
+  }
+  {
+    uint8_t data[] = { 0x20 };
+    _az_assert_integer(data, sizeof(data), -1);
+  }
+  {
+    uint8_t data[] = { 0x39, 0x03, 0xe7 };
+    _az_assert_integer(data, sizeof(data), -1000);
+  }
+  {
+    // 18446744073709551615 doesn't fit in an int64_t, but is still readable as a double.
+    uint8_t data[] = { 0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    az_cbor_token token = _az_read_single_item(data, sizeof(data));
+    int64_t value = 0;
+    assert_int_equal(az_cbor_token_get_int64(&token, &value), AZ_ERROR_UNEXPECTED_CHAR);
+    double double_value = 0;
+    assert_int_equal(az_cbor_token_get_double(&token, &double_value), AZ_OK);
+    assert_true(_az_is_double_identical(double_value, 18446744073709551615.0));
+  }
+  {
+    uint8_t data[] = { 0x1a, 0x80, 0x00, 0x00, 0x00 };
+    az_cbor_token token = _az_read_single_item(data, sizeof(data));
+    int32_t value = 0;
+    assert_int_equal(az_cbor_token_get_int32(&token, &value), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+
+  {
+    uint8_t data[] = { 0xf9, 0x3e, 0x00 };
+    _az_assert_float(data, sizeof(data), 1.5);
+  }
+  {
+    uint8_t data[] = { 0xf9, 0x7b, 0xff };
+    _az_assert_float(data, sizeof(data), 65504.0);
+  }
+  {
+    uint8_t data[] = { 0xf9, 0x00, 0x01 };
+    _az_assert_float(data, sizeof(data), 5.960464477539063e-8);
+  }
+  {
+    uint8_t data[] = { 0xf9, 0xc4, 0x00 };
+    _az_assert_float(data, sizeof(data), -4.0);
+  }
+  {
+    uint8_t data[] = { 0xfa, 0x47, 0xc3, 0x50, 0x00 };
+    _az_assert_float(data, sizeof(data), 100000.0);
+  }
+  {
+    uint8_t data[] = { 0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a };
+    _az_assert_float(data, sizeof(data), 1.1);
+  }
+
+  {
+    uint8_t data[] = { 0xf4 };
+    az_cbor_token token = _az_read_single_item(data, sizeof(data));
+    bool value = true;
+    assert_int_equal(az_cbor_token_get_boolean(&token, &value), AZ_OK);
+    assert_false(value);
+  }
+  {
+    uint8_t data[] = { 0xf5 };
+    az_cbor_token token = _az_read_single_item(data, sizeof(data));
+    bool value = false;
+    assert_int_equal(az_cbor_token_get_boolean(&token, &value), AZ_OK);
+    assert_true(value);
+    int64_t number = 0;
+    assert_int_equal(az_cbor_token_get_int64(&token, &number), AZ_ERROR_CBOR_INVALID_STATE);
+  }
+  {
+    uint8_t data[] = { 0xf6 };
+    assert_int_equal(_az_read_single_item(data, sizeof(data)).kind, AZ_CBOR_TOKEN_NULL);
+  }
+
+  {
+    uint8_t data[] = { 0x60 };
+    az_cbor_token token = _az_read_single_item(data, sizeof(data));
+    assert_int_equal(token.kind, AZ_CBOR_TOKEN_STRING);
+    assert_int_equal(az_span_size(token.slice), 0);
+  }
+  {
+    uint8_t data[] = { 0x64, 0x49, 0x45, 0x54, 0x46 };
+    az_cbor_token token = _az_read_single_item(data, sizeof(data));
+    assert_int_equal(token.kind, AZ_CBOR_TOKEN_STRING);
+    assert_true(az_cbor_token_is_text_equal(&token, AZ_SPAN_FROM_STR("IETF")));
+    assert_false(az_cbor_token_is_text_equal(&token, AZ_SPAN_FROM_STR("IETFX")));
+  }
+  {
+    uint8_t data[] = { 0x44, 0x01, 0x02, 0x03, 0x04 };
+    az_cbor_token token = _az_read_single_item(data, sizeof(data));
+    assert_int_equal(token.kind, AZ_CBOR_TOKEN_BYTE_STRING);
+    assert_int_equal(az_span_size(token.slice), 4);
+    assert_false(az_cbor_token_is_text_equal(&token, AZ_SPAN_FROM_STR("\x01\x02\x03\x04")));
+  }
+  {
+    // Tags are skipped: 1(1363896240)
+    uint8_t data[] = { 0xc1, 0x1a, 0x51, 0x4b, 0x67, 0xb0 };
+    _az_assert_integer(data, sizeof(data), 1363896240);
+  }
+}
+
+static void test_cbor_reader_containers(void** state)
+{
+  (void)state;
+
+  // {"a": 1, "b": [2, 3]}, both with definite and indefinite lengths.
+  uint8_t definite[] = { 0xa2, 0x61, 0x61, 0x01, 0x61, 0x62, 0x82, 0x02, 0x03 };
+  uint8_t indefinite[] = { 0xbf, 0x61, 0x61, 0x01, 0x61, 0x62, 0x9f, 0x02, 0x03, 0xff, 0xff };
+  az_span const inputs[] = { AZ_SPAN_FROM_BUFFER(definite), AZ_SPAN_FROM_BUFFER(indefinite) };
+
+  for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++)
+  {
+    az_cbor_reader reader = { 0 };
+    assert_int_equal(az_cbor_reader_init(&reader, inputs[i], NULL), AZ_OK);
+
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_BEGIN_OBJECT);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_PROPERTY_NAME);
+    assert_true(az_cbor_token_is_text_equal(&reader.token, AZ_SPAN_FROM_STR("a")));
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_INTEGER);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_PROPERTY_NAME);
+    assert_true(az_cbor_token_is_text_equal(&reader.token, AZ_SPAN_FROM_STR("b")));
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_BEGIN_ARRAY);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_INTEGER);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_INTEGER);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_END_ARRAY);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_END_OBJECT);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_ERROR_CBOR_READER_DONE);
+  }
+
+  {
+    // [[], {}]
+    uint8_t data[] = { 0x82, 0x80, 0xa0 };
+    az_cbor_reader reader = { 0 };
+    assert_int_equal(az_cbor_reader_init(&reader, AZ_SPAN_FROM_BUFFER(data), NULL), AZ_OK);
+    az_cbor_token_kind const expected[] = {
+      AZ_CBOR_TOKEN_BEGIN_ARRAY, AZ_CBOR_TOKEN_BEGIN_ARRAY, AZ_CBOR_TOKEN_END_ARRAY,
+      AZ_CBOR_TOKEN_BEGIN_OBJECT, AZ_CBOR_TOKEN_END_OBJECT, AZ_CBOR_TOKEN_END_ARRAY,
+    };
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    {
+      assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+      assert_int_equal(reader.token.kind, expected[i]);
+    }
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_ERROR_CBOR_READER_DONE);
+  }
+
+  {
+    // {"a": [1, {"b": 2}], "c": 3}
+    uint8_t data[] = { 0xa2, 0x61, 0x61, 0x82, 0x01, 0xa1, 0x61, 0x62,
+                       0x02, 0x61, 0x63, 0x03 };
+    az_cbor_reader reader = { 0 };
+    assert_int_equal(az_cbor_reader_init(&reader, AZ_SPAN_FROM_BUFFER(data), NULL), AZ_OK);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_PROPERTY_NAME);
+
+    assert_int_equal(az_cbor_reader_skip_children(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_END_ARRAY);
+
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_true(az_cbor_token_is_text_equal(&reader.token, AZ_SPAN_FROM_STR("c")));
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(az_cbor_reader_skip_children(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_INTEGER);
+    assert_int_equal(az_cbor_reader_next_token(&reader), AZ_OK);
+    assert_int_equal(reader.token.kind, AZ_CBOR_TOKEN_END_OBJECT);
+  }
+}
+
+static az_result _az_read_until_error(uint8_t* bytes, int32_t size)
+{
+  az_cbor_reader reader = { 0 };
+  assert_int_equal(az_cbor_reader_init(&reader, az_span_create(bytes, size), NULL), AZ_OK);
+
+  az_result result = AZ_OK;
+  while (az_result_succeeded(result = az_cbor_reader_next_token(&reader)))
+  {
+  }
+  return result;
+}
+
+static void test_cbor_reader_invalid(void** state)
+{
+  (void)state;
+
+  {
+    uint8_t data[] = { 0x1a, 0x00, 0x00 };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_END);
+  }
+  {
+    uint8_t data[] = { 0x63, 0x61, 0x62 };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_END);
+  }
+  {
+    uint8_t data[] = { 0x83, 0x01, 0x02 };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_END);
+  }
+  {
+    uint8_t data[] = { 0x9f, 0x01 };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_END);
+  }
+  {
+    // Reserved additional information.
+    uint8_t data[] = { 0x1c };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+  {
+    // Integer map key.
+    uint8_t data[] = { 0xa1, 0x01, 0x02 };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+  {
+    // Indefinite-length map ending after a key.
+    uint8_t data[] = { 0xbf, 0x61, 0x61, 0xff };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+  {
+    // Break within a definite-length array.
+    uint8_t data[] = { 0x81, 0xff };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+  {
+    // Indefinite-length string.
+    uint8_t data[] = { 0x7f, 0x61, 0x61, 0xff };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+  {
+    // Trailing data after the root data item.
+    uint8_t data[] = { 0x00, 0x01 };
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+  {
+    uint8_t data[33];
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+      data[i] = 0x9f;
+    }
+    assert_int_equal(_az_read_until_error(data, sizeof(data)), AZ_ERROR_CBOR_NESTING_OVERFLOW);
+  }
+}
+
+static void test_cbor_writer(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[64] = { 0 };
+  az_cbor_writer writer = { 0 };
+
+  {
+    assert_int_equal(az_cbor_writer_init(&writer, AZ_SPAN_FROM_BUFFER(buffer), NULL), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_begin_object(&writer), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("a")), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_int32(&writer, 1), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("b")), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_begin_array(&writer), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_int32(&writer, 2), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_int32(&writer, 3), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_end_array(&writer), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_end_object(&writer), AZ_OK);
+
+    uint8_t const expected[] = { 0xbf, 0x61, 0x61, 0x01, 0x61, 0x62, 0x9f, 0x02, 0x03, 0xff, 0xff };
+    _az_assert_written(&writer, expected, sizeof(expected));
+    assert_int_equal(writer.total_bytes_written, sizeof(expected));
+  }
+
+  {
+    assert_int_equal(az_cbor_writer_init(&writer, AZ_SPAN_FROM_BUFFER(buffer), NULL), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_begin_array(&writer), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_int32(&writer, 24), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_int32(&writer, -1000), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_int64(&writer, 1000000000000), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_int64(&writer, INT64_MIN), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_double(&writer, 100000.0), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_double(&writer, 1.1), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_bool(&writer, true), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_null(&writer), AZ_OK);
+    uint8_t bytes[] = { 0x01, 0x02 };
+    assert_int_equal(
+        az_cbor_writer_append_byte_string(&writer, AZ_SPAN_FROM_BUFFER(bytes)), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_string(&writer, AZ_SPAN_FROM_STR("IETF")), AZ_OK);
+    assert_int_equal(az_cbor_writer_append_end_array(&writer), AZ_OK);
+
+    uint8_t const expected[] = {
+      0x9f, 0x18, 0x18, 0x39, 0x03, 0xe7, 0x1b, 0x00, 0x00, 0x00, 0xe8, 0xd4, 0xa5, 0x10,
+      0x00, 0x3b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfa, 0x47, 0xc3, 0x50,
+      0x00, 0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a, 0xf5, 0xf6, 0x42, 0x01,
+      0x02, 0x64, 0x49, 0x45, 0x54, 0x46, 0xff,
+    };
+    _az_assert_written(&writer, expected, sizeof(expected));
+  }
+
+  {
+    // Nothing is written when the destination is too small.
+    assert_int_equal(az_cbor_writer_init(&writer, az_span_create(buffer, 4), NULL), AZ_OK);
+    assert_int_equal(
+        az_cbor_writer_append_string(&writer, AZ_SPAN_FROM_STR("IETF")),
+        AZ_ERROR_NOT_ENOUGH_SPACE);
+    assert_int_equal(az_span_size(az_cbor_writer_get_bytes_used_in_destination(&writer)), 0);
+  }
+
+  {
+    assert_int_equal(az_cbor_writer_init(&writer, AZ_SPAN_FROM_BUFFER(buffer), NULL), AZ_OK);
+    for (int32_t i = 0; i < 32; i++)
+    {
+      assert_int_equal(az_cbor_writer_append_begin_array(&writer), AZ_OK);
+    }
+    assert_int_equal(az_cbor_writer_append_begin_array(&writer), AZ_ERROR_CBOR_NESTING_OVERFLOW);
+  }
+}
+
+typedef struct
+{
+  uint8_t chunks[16][16];
+  int32_t chunk_index;
+  uint8_t output[128];
+  int32_t output_size;
+} _az_cbor_chunks;
+
+static az_result _az_cbor_next_chunk(az_span_allocator_context* context, az_span* out_next)
+{
+  _az_cbor_chunks* chunks = (_az_cbor_chunks*)context->user_context;
+
+  // Gather what was written into the previous chunk.
+  memcpy(
+      chunks->output + chunks->output_size,
+      chunks->chunks[chunks->chunk_index],
+      (size_t)context->bytes_used);
+  chunks->output_size += context->bytes_used;
+
+  chunks->chunk_index++;
+  if (chunks->chunk_index >= 16 || context->minimum_required_size > 16)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+  *out_next = AZ_SPAN_FROM_BUFFER(chunks->chunks[chunks->chunk_index]);
+  return AZ_OK;
+}
+
+static void test_cbor_writer_chunked(void** state)
+{
+  (void)state;
+
+  _az_cbor_chunks chunks = { 0 };
+  az_cbor_writer writer = { 0 };
+  assert_int_equal(
+      az_cbor_writer_chunked_init(
+          &writer, AZ_SPAN_FROM_BUFFER(chunks.chunks[0]), _az_cbor_next_chunk, &chunks, NULL),
+      AZ_OK);
+
+  assert_int_equal(az_cbor_writer_append_begin_object(&writer), AZ_OK);
+  assert_int_equal(
+      az_cbor_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("temperature")), AZ_OK);
+  assert_int_equal(az_cbor_writer_append_double(&writer, 1.1), AZ_OK);
+  assert_int_equal(
+      az_cbor_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("id")), AZ_OK);
+  assert_int_equal(
+      az_cbor_writer_append_string(&writer, AZ_SPAN_FROM_STR("a longer device identifier")),
+      AZ_OK);
+  assert_int_equal(az_cbor_writer_append_end_object(&writer), AZ_OK);
+
+  az_span const last = az_cbor_writer_get_bytes_used_in_destination(&writer);
+  memcpy(chunks.output + chunks.output_size, az_span_ptr(last), (size_t)az_span_size(last));
+  chunks.output_size += az_span_size(last);
+  assert_int_equal(chunks.output_size, writer.total_bytes_written);
+
+  // The gathered chunks are the same as what a contiguous writer produces.
+  uint8_t buffer[128] = { 0 };
+  az_cbor_writer contiguous = { 0 };
+  assert_int_equal(az_cbor_writer_init(&contiguous, AZ_SPAN_FROM_BUFFER(buffer), NULL), AZ_OK);
+  assert_int_equal(az_cbor_writer_append_begin_object(&contiguous), AZ_OK);
+  assert_int_equal(
+      az_cbor_writer_append_property_name(&contiguous, AZ_SPAN_FROM_STR("temperature")), AZ_OK);
+  assert_int_equal(az_cbor_writer_append_double(&contiguous, 1.1), AZ_OK);
+  assert_int_equal(
+      az_cbor_writer_append_property_name(&contiguous, AZ_SPAN_FROM_STR("id")), AZ_OK);
+  assert_int_equal(
+      az_cbor_writer_append_string(&contiguous, AZ_SPAN_FROM_STR("a longer device identifier")),
+      AZ_OK);
+  assert_int_equal(az_cbor_writer_append_end_object(&contiguous), AZ_OK);
+
+  _az_assert_written(&contiguous, chunks.output, (size_t)chunks.output_size);
+}
+
+static void test_cbor_transcode(void** state)
+{
+  (void)state;
+
+  az_span const json = AZ_SPAN_FROM_STR(
+      "{\"name\":\"dev\\\"ice\",\"values\":[1,-2,3000000000,-5000000000,1.5,true,false,null],"
+      "\"nested\":{\"empty\":[],\"object\":{}}}");
+
+  uint8_t cbor_buffer[128] = { 0 };
+  uint8_t scratch[32] = { 0 };
+
+  az_json_reader json_reader = { 0 };
+  assert_int_equal(az_json_reader_init(&json_reader, json, NULL), AZ_OK);
+  az_cbor_writer cbor_writer = { 0 };
+  assert_int_equal(
+      az_cbor_writer_init(&cbor_writer, AZ_SPAN_FROM_BUFFER(cbor_buffer), NULL), AZ_OK);
+  assert_int_equal(
+      az_cbor_transcode_from_json(&json_reader, &cbor_writer, AZ_SPAN_FROM_BUFFER(scratch)),
+      AZ_OK);
+
+  az_span const cbor = az_cbor_writer_get_bytes_used_in_destination(&cbor_writer);
+  assert_true(az_span_size(cbor) < az_span_size(json));
+
+  uint8_t json_buffer[256] = { 0 };
+  az_cbor_reader cbor_reader = { 0 };
+  assert_int_equal(az_cbor_reader_init(&cbor_reader, cbor, NULL), AZ_OK);
+  az_json_writer json_writer = { 0 };
+  assert_int_equal(
+      az_json_writer_init(&json_writer, AZ_SPAN_FROM_BUFFER(json_buffer), NULL), AZ_OK);
+  assert_int_equal(
+      az_cbor_transcode_to_json(&cbor_reader, &json_writer, AZ_SPAN_FROM_BUFFER(scratch)), AZ_OK);
+  assert_int_equal(az_cbor_reader_next_token(&cbor_reader), AZ_ERROR_CBOR_READER_DONE);
+
+  assert_true(
+      az_span_is_content_equal(json, az_json_writer_get_bytes_used_in_destination(&json_writer)));
+
+  {
+    // Byte strings become base64 encoded strings and non-finite floats become null.
+    uint8_t data[] = { 0x82, 0x44, 0x01, 0x02, 0x03, 0x04, 0xf9, 0x7c, 0x00 };
+    assert_int_equal(az_cbor_reader_init(&cbor_reader, AZ_SPAN_FROM_BUFFER(data), NULL), AZ_OK);
+    assert_int_equal(
+        az_json_writer_init(&json_writer, AZ_SPAN_FROM_BUFFER(json_buffer), NULL), AZ_OK);
+    assert_int_equal(
+        az_cbor_transcode_to_json(&cbor_reader, &json_writer, AZ_SPAN_FROM_BUFFER(scratch)),
+        AZ_OK);
+    assert_true(az_span_is_content_equal(
+        AZ_SPAN_FROM_STR("[\"AQIDBA==\",null]"),
+        az_json_writer_get_bytes_used_in_destination(&json_writer)));
+
+    // The scratch buffer is needed for the byte string.
+    assert_int_equal(az_cbor_reader_init(&cbor_reader, AZ_SPAN_FROM_BUFFER(data), NULL), AZ_OK);
+    assert_int_equal(
+        az_json_writer_init(&json_writer, AZ_SPAN_FROM_BUFFER(json_buffer), NULL), AZ_OK);
+    assert_int_equal(
+        az_cbor_transcode_to_json(&cbor_reader, &json_writer, AZ_SPAN_EMPTY),
+        AZ_ERROR_NOT_ENOUGH_SPACE);
+  }
+
+  {
+    // Integers beyond the int64_t range are written exactly, and large floats in exponent form.
+    uint8_t data[] = {
+      0x86, 0x1b, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 2^63
+      0x3b, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // -1 - 2^63
+      0x3b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // -2^64
+      0xfb, 0x44, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 2^68
+      0xfb, 0xfe, 0x0c, 0xab, 0x7b, 0xd6, 0x66, 0xf3, 0x88, // -1.5e299
+      0xfb, 0x43, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // 2^53 - 1
+    };
+    assert_int_equal(az_cbor_reader_init(&cbor_reader, AZ_SPAN_FROM_BUFFER(data), NULL), AZ_OK);
+    assert_int_equal(
+        az_json_writer_init(&json_writer, AZ_SPAN_FROM_BUFFER(json_buffer), NULL), AZ_OK);
+    assert_int_equal(az_cbor_transcode_to_json(&cbor_reader, &json_writer, AZ_SPAN_EMPTY), AZ_OK);
+    assert_true(az_span_is_content_equal(
+        AZ_SPAN_FROM_STR("[9223372036854775808,-9223372036854775809,-18446744073709551616,"
+                         "2.95147905179352e+20,-1.5e+299,9007199254740991]"),
+        az_json_writer_get_bytes_used_in_destination(&json_writer)));
+  }
+
+  {
+    // The scratch buffer is needed to unescape strings.
+    assert_int_equal(az_json_reader_init(&json_reader, json, NULL), AZ_OK);
+    assert_int_equal(
+        az_cbor_writer_init(&cbor_writer, AZ_SPAN_FROM_BUFFER(cbor_buffer), NULL), AZ_OK);
+    assert_int_equal(
+        az_cbor_transcode_from_json(&json_reader, &cbor_writer, AZ_SPAN_EMPTY),
+        AZ_ERROR_NOT_ENOUGH_SPACE);
+  }
+}
+
+int test_az_cbor()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_cbor_reader_scalars),
+    cmocka_unit_test(test_cbor_reader_containers),
+    cmocka_unit_test(test_cbor_reader_invalid),
+    cmocka_unit_test(test_cbor_writer),
+    cmocka_unit_test(test_cbor_writer_chunked),
+    cmocka_unit_test(test_cbor_transcode),
+  };
+  return cmocka_run_group_tests_name("az_core_cbor", tests, NULL, NULL);
+}
@@ -12,6 +12,8 @@
 #include <math.h>
 #include <setjmp.h>
 #include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
 
 #include <cmocka.h>
 
@@ -1117,6 +1119,577 @@ static void test_json_writer_large_string_chunked(void** state)
   }
 }
 
+// A straightforward byte-at-a-time reference escaper to validate the writer output against.
+static az_span _az_test_escape_json_string(az_span value, az_span destination)
+{
+  uint8_t const* ptr = az_span_ptr(value);
+  for (int32_t i = 0; i < az_span_size(value); i++)
+  {
+    uint8_t const ch = ptr[i];
+    char escaped[8] = { 0 };
+    switch (ch)
+    {
+      case '"':
+        strcpy(escaped, "\\\"");
+        break;
+      case '\\':
+        strcpy(escaped, "\\\\");
+        break;
+      case '\b':
+        strcpy(escaped, "\\b");
+        break;
+      case '\f':
+        strcpy(escaped, "\\f");
+        break;
+      case '\n':
+        strcpy(escaped, "\\n");
+        break;
+      case '\r':
+        strcpy(escaped, "\\r");
+        break;
+      case '\t':
+        strcpy(escaped, "\\t");
+        break;
+      default:
+        if (ch < 0x20)
+        {
+          (void)snprintf(escaped, sizeof(escaped), "\\u%04X", ch);
+        }
+        else
+        {
+          escaped[0] = (char)ch;
+        }
+        break;
+    }
+    destination = az_span_copy(destination, az_span_create_from_str(escaped));
+  }
+  return destination;
+}
+
+static void test_json_writer_escaping_runs(void** state)
+{
+  (void)state;
+
+  uint8_t const special_chars[] = { '"', '\\', '\n', '\t', 0x01, 0x1F, 0x7F, 0x80, 0xE9, ' ' };
+
+  // Place a single special character at every position of strings of varying length, to cover
+  // characters that land within, at the edges of, and after the words scanned in bulk.
+  for (int32_t length = 1; length <= 40; length++)
+  {
+    for (int32_t position = 0; position < length; position++)
+    {
+      for (size_t c = 0; c < sizeof(special_chars); c++)
+      {
+        uint8_t value_buffer[40] = { 0 };
+        for (int32_t i = 0; i < length; i++)
+        {
+          value_buffer[i] = (uint8_t)('a' + (i % 26));
+        }
+        value_buffer[position] = special_chars[c];
+        // Also add a second one at the end, to exercise resuming the bulk scan after an escape.
+        value_buffer[length - 1] = special_chars[(c + 1) % sizeof(special_chars)];
+        az_span value = az_span_create(value_buffer, length);
+
+        uint8_t expected_buffer[512] = { 0 };
+        az_span expected = AZ_SPAN_FROM_BUFFER(expected_buffer);
+        az_span remainder = az_span_copy(expected, AZ_SPAN_FROM_STR("{\""));
+        remainder = _az_test_escape_json_string(value, remainder);
+        remainder = az_span_copy(remainder, AZ_SPAN_FROM_STR("\":\""));
+        remainder = _az_test_escape_json_string(value, remainder);
+        remainder = az_span_copy(remainder, AZ_SPAN_FROM_STR("\"}"));
+        expected = az_span_slice(expected, 0, _az_span_diff(remainder, expected));
+
+        // Contiguous destination
+        uint8_t json_buffer[512] = { 0 };
+        az_json_writer writer = { 0 };
+        TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(json_buffer), NULL));
+        TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&writer));
+        TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(&writer, value));
+        TEST_EXPECT_SUCCESS(az_json_writer_append_string(&writer, value));
+        TEST_EXPECT_SUCCESS(az_json_writer_append_end_object(&writer));
+
+        assert_int_equal(writer.total_bytes_written, az_span_size(expected));
+        assert_true(az_span_is_content_equal(
+            az_json_writer_get_bytes_used_in_destination(&writer), expected));
+
+        // Non-contiguous destination
+        int32_t previous = 0;
+        _az_user_context user_context = { .current_index = &previous };
+        TEST_EXPECT_SUCCESS(az_json_writer_chunked_init(
+            &writer, AZ_SPAN_EMPTY, &test_allocator_chunked, (void*)&user_context, NULL));
+        TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&writer));
+        TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(&writer, value));
+        TEST_EXPECT_SUCCESS(az_json_writer_append_string(&writer, value));
+        TEST_EXPECT_SUCCESS(az_json_writer_append_end_object(&writer));
+
+        assert_int_equal(writer.total_bytes_written, az_span_size(expected));
+
+        uint8_t array[512] = { 0 };
+        az_span entire_json = AZ_SPAN_FROM_BUFFER(array);
+        for (int32_t i = 0; i < previous - 1; i++)
+        {
+          entire_json = az_span_copy(entire_json, json_buffers[i]);
+        }
+        entire_json
+            = az_span_copy(entire_json, az_json_writer_get_bytes_used_in_destination(&writer));
+        az_span const written = AZ_SPAN_FROM_BUFFER(array);
+        assert_true(az_span_is_content_equal(
+            az_span_slice(written, 0, _az_span_diff(entire_json, written)), expected));
+      }
+    }
+  }
+}
+
+typedef struct
+{
+  az_json_writer_buffer_pool* buffer_pool;
+  az_span output;
+  int32_t pending[4];
+  int32_t pending_count;
+  int32_t flush_count;
+  int32_t wait_count;
+  int32_t max_in_flight;
+  bool fail_flush;
+} _az_test_flush_context;
+
+static az_result _az_test_flush(az_json_writer_flush_context* flush_context)
+{
+  _az_test_flush_context* context = (_az_test_flush_context*)flush_context->user_context;
+  if (context->fail_flush)
+  {
+    return AZ_ERROR_ARG;
+  }
+
+  // Pretend to queue the chunk for sending, which completes later, in order.
+  context->output = az_span_copy(context->output, flush_context->chunk);
+  context->pending[context->pending_count++] = flush_context->buffer_index;
+  context->flush_count++;
+
+  int32_t const in_flight = az_json_writer_buffer_pool_get_in_flight_count(context->buffer_pool);
+  if (in_flight > context->max_in_flight)
+  {
+    context->max_in_flight = in_flight;
+  }
+  return AZ_OK;
+}
+
+static az_result _az_test_wait(void* user_context)
+{
+  _az_test_flush_context* context = (_az_test_flush_context*)user_context;
+
+  // Only asked to wait once every buffer is in flight.
+  assert_int_equal(az_json_writer_buffer_pool_get_in_flight_count(context->buffer_pool), 3);
+  context->wait_count++;
+
+  // Complete the oldest send.
+  TEST_EXPECT_SUCCESS(
+      az_json_writer_buffer_pool_release(context->buffer_pool, context->pending[0]));
+  context->pending_count--;
+  for (int32_t i = 0; i < context->pending_count; i++)
+  {
+    context->pending[i] = context->pending[i + 1];
+  }
+  return AZ_OK;
+}
+
+static az_result _az_test_write_buffered_json(az_json_writer* ref_json_writer)
+{
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_json_writer));
+  for (int32_t i = 0; i < 40; i++)
+  {
+    _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_json_writer, i * 1000));
+    _az_RETURN_IF_FAILED(
+        az_json_writer_append_string(ref_json_writer, AZ_SPAN_FROM_STR("a longer string value")));
+  }
+  return az_json_writer_append_end_array(ref_json_writer);
+}
+
+static void test_json_writer_buffered(void** state)
+{
+  (void)state;
+
+  uint8_t expected_buffer[2048] = { 0 };
+  az_json_writer writer = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(expected_buffer), NULL));
+  TEST_EXPECT_SUCCESS(_az_test_write_buffered_json(&writer));
+  az_span const expected = az_json_writer_get_bytes_used_in_destination(&writer);
+
+  uint8_t buffer_storage[3][64] = { { 0 } };
+  az_span buffers[3] = {
+    AZ_SPAN_FROM_BUFFER(buffer_storage[0]),
+    AZ_SPAN_FROM_BUFFER(buffer_storage[1]),
+    AZ_SPAN_FROM_BUFFER(buffer_storage[2]),
+  };
+  az_json_writer_buffer_pool buffer_pool = { 0 };
+
+  // With back-pressure, the whole JSON text makes it through three small buffers.
+  {
+    uint8_t output_buffer[2048] = { 0 };
+    _az_test_flush_context context
+        = { .buffer_pool = &buffer_pool, .output = AZ_SPAN_FROM_BUFFER(output_buffer) };
+    TEST_EXPECT_SUCCESS(az_json_writer_buffer_pool_init(
+        &buffer_pool, buffers, 3, _az_test_flush, _az_test_wait, &context));
+    TEST_EXPECT_SUCCESS(az_json_writer_buffered_init(&writer, &buffer_pool, NULL));
+    TEST_EXPECT_SUCCESS(_az_test_write_buffered_json(&writer));
+    TEST_EXPECT_SUCCESS(az_json_writer_buffered_flush(&writer));
+
+    // Flushing again with nothing new written is a no-op.
+    int32_t const flush_count = context.flush_count;
+    TEST_EXPECT_SUCCESS(az_json_writer_buffered_flush(&writer));
+    assert_int_equal(context.flush_count, flush_count);
+
+    az_span const output = AZ_SPAN_FROM_BUFFER(output_buffer);
+    assert_true(az_span_is_content_equal(
+        az_span_slice(output, 0, _az_span_diff(context.output, output)), expected));
+    assert_int_equal(writer.total_bytes_written, az_span_size(expected));
+    assert_true(context.wait_count > 0);
+    assert_int_equal(context.max_in_flight, 3);
+  }
+
+  // Without a wait callback, the writer fails only once all buffers are in flight.
+  {
+    uint8_t output_buffer[2048] = { 0 };
+    _az_test_flush_context context
+        = { .buffer_pool = &buffer_pool, .output = AZ_SPAN_FROM_BUFFER(output_buffer) };
+    TEST_EXPECT_SUCCESS(
+        az_json_writer_buffer_pool_init(&buffer_pool, buffers, 3, _az_test_flush, NULL, &context));
+    TEST_EXPECT_SUCCESS(az_json_writer_buffered_init(&writer, &buffer_pool, NULL));
+    assert_int_equal(_az_test_write_buffered_json(&writer), AZ_ERROR_NOT_ENOUGH_SPACE);
+    assert_int_equal(context.flush_count, 3);
+    assert_int_equal(az_json_writer_buffer_pool_get_in_flight_count(&buffer_pool), 3);
+  }
+
+  // A failing flush callback stops the writer.
+  {
+    uint8_t output_buffer[2048] = { 0 };
+    _az_test_flush_context context = { .buffer_pool = &buffer_pool,
+                                       .output = AZ_SPAN_FROM_BUFFER(output_buffer),
+                                       .fail_flush = true };
+    TEST_EXPECT_SUCCESS(az_json_writer_buffer_pool_init(
+        &buffer_pool, buffers, 3, _az_test_flush, _az_test_wait, &context));
+    TEST_EXPECT_SUCCESS(az_json_writer_buffered_init(&writer, &buffer_pool, NULL));
+    assert_int_equal(_az_test_write_buffered_json(&writer), AZ_ERROR_NOT_ENOUGH_SPACE);
+    assert_int_equal(context.flush_count, 0);
+
+    // The chunks which weren't taken leave their buffers free for the next attempts.
+    assert_int_equal(az_json_writer_buffer_pool_get_in_flight_count(&buffer_pool), 0);
+    for (int32_t i = 0; i < 3; i++)
+    {
+      assert_int_equal(az_json_writer_buffered_flush(&writer), AZ_ERROR_ARG);
+      assert_int_equal(az_json_writer_buffer_pool_get_in_flight_count(&buffer_pool), 0);
+    }
+
+    context.fail_flush = false;
+    TEST_EXPECT_SUCCESS(az_json_writer_buffered_flush(&writer));
+    assert_int_equal(context.flush_count, 1);
+    assert_int_equal(az_json_writer_buffer_pool_get_in_flight_count(&buffer_pool), 1);
+  }
+}
+
+static az_result _az_test_write_sizing_json(az_json_writer* ref_json_writer)
+{
+  uint8_t long_string[200] = { 0 };
+  for (size_t i = 0; i < sizeof(long_string); i++)
+  {
+    long_string[i] = (i % 17 == 0) ? '\n' : (uint8_t)('a' + (i % 26));
+  }
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("small")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_json_writer, AZ_SPAN_FROM_STR("a\"b")));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_BUFFER(long_string)));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_string(ref_json_writer, AZ_SPAN_FROM_BUFFER(long_string)));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("numbers")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_json_writer, -2147483647 - 1));
+  _az_RETURN_IF_FAILED(az_json_writer_append_double(ref_json_writer, 1234.5678, 4));
+  _az_RETURN_IF_FAILED(az_json_writer_append_bool(ref_json_writer, true));
+  _az_RETURN_IF_FAILED(az_json_writer_append_null(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_array(ref_json_writer));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("nested")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_json_text(
+      ref_json_writer,
+      AZ_SPAN_FROM_STR("{\"a\":[[{\"b\":[1,2,3]}]],\"c\":\"0123456789012345678901234567890123"
+                       "456789012345678901234567890123456789\"}")));
+  return az_json_writer_append_end_object(ref_json_writer);
+}
+
+static void test_json_writer_compute_size_only(void** state)
+{
+  (void)state;
+
+  uint8_t json_buffer[1024] = { 0 };
+  az_json_writer writer = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(json_buffer), NULL));
+  assert_int_equal(az_json_writer_get_max_depth(&writer), 0);
+  TEST_EXPECT_SUCCESS(_az_test_write_sizing_json(&writer));
+  int32_t const expected_size = writer.total_bytes_written;
+  assert_int_equal(
+      expected_size, az_span_size(az_json_writer_get_bytes_used_in_destination(&writer)));
+  // The nested JSON text reaches 5 levels below the property of the outer object.
+  assert_int_equal(az_json_writer_get_max_depth(&writer), 6);
+
+  az_json_writer_options options = az_json_writer_options_default();
+  assert_false(options.compute_size_only);
+  options.compute_size_only = true;
+
+  // A scratch buffer much smaller than the output is enough to compute its exact size.
+  uint8_t scratch[64] = { 0 };
+  az_json_writer size_writer = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&size_writer, AZ_SPAN_FROM_BUFFER(scratch), &options));
+  TEST_EXPECT_SUCCESS(_az_test_write_sizing_json(&size_writer));
+  assert_int_equal(size_writer.total_bytes_written, expected_size);
+  assert_int_equal(az_json_writer_get_max_depth(&size_writer), 6);
+
+  // The computed size is exactly enough for a real write, and one byte less is not.
+  TEST_EXPECT_SUCCESS(
+      az_json_writer_init(&writer, az_span_create(json_buffer, expected_size), NULL));
+  TEST_EXPECT_SUCCESS(_az_test_write_sizing_json(&writer));
+  TEST_EXPECT_SUCCESS(
+      az_json_writer_init(&writer, az_span_create(json_buffer, expected_size - 1), NULL));
+  assert_int_equal(_az_test_write_sizing_json(&writer), AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // Validation still happens while only computing the size.
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&size_writer, AZ_SPAN_FROM_BUFFER(scratch), &options));
+  assert_int_equal(
+      az_json_writer_append_json_text(&size_writer, AZ_SPAN_FROM_STR("{\"a\":")),
+      AZ_ERROR_UNEXPECTED_END);
+  assert_int_equal(size_writer.total_bytes_written, 0);
+}
+
+static az_result _az_test_write_typed_arrays(az_json_writer* ref_json_writer)
+{
+  int32_t const int32_values[] = { 0, -1, INT32_MAX, INT32_MIN, 42 };
+  int64_t const int64_values[] = { INT64_MIN, 5000000000, 0 };
+  double const double_values[] = { 1.5, -0.25, 3, -1.5e299 };
+  bool const bool_values[] = { true, false };
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("i")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int32_array(ref_json_writer, int32_values, 5));
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("l")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int64_array(ref_json_writer, int64_values, 3));
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("d")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_double_array(ref_json_writer, double_values, 4, 2));
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("b")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_bool_array(ref_json_writer, bool_values, 2));
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("e")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int32_array(ref_json_writer, NULL, 0));
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("n")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int32_array(ref_json_writer, int32_values, 2));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int32_array(ref_json_writer, int32_values, 1));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_array(ref_json_writer));
+  return az_json_writer_append_end_object(ref_json_writer);
+}
+
+static void test_json_writer_typed_arrays(void** state)
+{
+  (void)state;
+
+  az_span const expected = AZ_SPAN_FROM_STR(
+      "{\"i\":[0,-1,2147483647,-2147483648,42],\"l\":[-9223372036854775808,5000000000,0],"
+      "\"d\":[1.5,-0.25,3,-1.5e+299],\"b\":[true,false],\"e\":[],\"n\":[[0,-1],[0]]}");
+
+  uint8_t json_buffer[256] = { 0 };
+  az_json_writer writer = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(json_buffer), NULL));
+  TEST_EXPECT_SUCCESS(_az_test_write_typed_arrays(&writer));
+  assert_true(
+      az_span_is_content_equal(expected, az_json_writer_get_bytes_used_in_destination(&writer)));
+  assert_int_equal(writer.total_bytes_written, az_span_size(expected));
+  assert_int_equal(az_json_writer_get_max_depth(&writer), 3);
+
+  // The same size is computed without writing the JSON text.
+  {
+    az_json_writer_options options = az_json_writer_options_default();
+    options.compute_size_only = true;
+    uint8_t scratch[64] = { 0 };
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(scratch), &options));
+    TEST_EXPECT_SUCCESS(_az_test_write_typed_arrays(&writer));
+    assert_int_equal(writer.total_bytes_written, az_span_size(expected));
+  }
+
+  // Nothing is written if the whole array doesn't fit, and the writer can still be used.
+  {
+    int32_t const values[] = { 1, 2, 3 };
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, az_span_create(json_buffer, 12), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+    assert_int_equal(
+        az_json_writer_append_int32_array(&writer, values, 3), AZ_ERROR_NOT_ENOUGH_SPACE);
+    assert_int_equal(writer.total_bytes_written, 1);
+    TEST_EXPECT_SUCCESS(az_json_writer_append_int32(&writer, 7));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_end_array(&writer));
+    assert_true(az_span_is_content_equal(
+        AZ_SPAN_FROM_STR("[7]"), az_json_writer_get_bytes_used_in_destination(&writer)));
+  }
+
+  // A waveform spanning many chunks is the same as when written one element at a time.
+  {
+    double samples[500] = { 0 };
+    for (int32_t i = 0; i < 500; i++)
+    {
+      samples[i] = (i % 7) * 1.25 - 3;
+    }
+
+    uint8_t expected_buffer[4096] = { 0 };
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(expected_buffer), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+    for (int32_t i = 0; i < 500; i++)
+    {
+      TEST_EXPECT_SUCCESS(az_json_writer_append_double(&writer, samples[i], 2));
+    }
+    TEST_EXPECT_SUCCESS(az_json_writer_append_end_array(&writer));
+    az_span const expected_samples = az_json_writer_get_bytes_used_in_destination(&writer);
+
+    uint8_t buffer_storage[3][64] = { { 0 } };
+    az_span buffers[3] = {
+      AZ_SPAN_FROM_BUFFER(buffer_storage[0]),
+      AZ_SPAN_FROM_BUFFER(buffer_storage[1]),
+      AZ_SPAN_FROM_BUFFER(buffer_storage[2]),
+    };
+    az_json_writer_buffer_pool buffer_pool = { 0 };
+    uint8_t output_buffer[4096] = { 0 };
+    _az_test_flush_context context
+        = { .buffer_pool = &buffer_pool, .output = AZ_SPAN_FROM_BUFFER(output_buffer) };
+    TEST_EXPECT_SUCCESS(az_json_writer_buffer_pool_init(
+        &buffer_pool, buffers, 3, _az_test_flush, _az_test_wait, &context));
+    TEST_EXPECT_SUCCESS(az_json_writer_buffered_init(&writer, &buffer_pool, NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_double_array(&writer, samples, 500, 2));
+    TEST_EXPECT_SUCCESS(az_json_writer_buffered_flush(&writer));
+
+    az_span const output = AZ_SPAN_FROM_BUFFER(output_buffer);
+    assert_true(az_span_is_content_equal(
+        az_span_slice(output, 0, _az_span_diff(context.output, output)), expected_samples));
+    assert_int_equal(writer.total_bytes_written, az_span_size(expected_samples));
+  }
+}
+
+static az_result _az_test_fill_json_template(
+    az_json_template const* json_template,
+    az_span destination,
+    az_span* out_json_text)
+{
+  az_json_template_writer template_writer = { 0 };
+  _az_RETURN_IF_FAILED(az_json_template_writer_init(&template_writer, json_template, destination));
+  _az_RETURN_IF_FAILED(az_json_template_writer_append_double(&template_writer, 21.5, 2));
+  _az_RETURN_IF_FAILED(az_json_template_writer_append_int32(&template_writer, -42));
+  _az_RETURN_IF_FAILED(
+      az_json_template_writer_append_string(&template_writer, AZ_SPAN_FROM_STR("a \"b\"\n")));
+  _az_RETURN_IF_FAILED(az_json_template_writer_append_bool(&template_writer, false));
+  return az_json_template_writer_complete(&template_writer, out_json_text);
+}
+
+static void test_json_template(void** state)
+{
+  (void)state;
+
+  az_span const expected = AZ_SPAN_FROM_STR(
+      "{\"temp\":21.5,\"sensor\\n\":{\"count\":-42,\"tags\":[\"a \\\"b\\\"\\n\",false]}}");
+
+  // From a JSON text literal with placeholders.
+  az_json_template_slot literal_slots[4];
+  az_json_template literal_template = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_template_init_from_json(
+      &literal_template,
+      AZ_SPAN_FROM_STR("{\"temp\":\"${double}\",\"sensor\\n\":{\"count\":\"${int32}\",\"tags\":"
+                       "[\"${string}\",\"${bool}\"]}}"),
+      literal_slots,
+      4));
+  assert_int_equal(az_json_template_get_slot_count(&literal_template), 4);
+
+  // From a JSON writer session.
+  uint8_t template_buffer[64] = { 0 };
+  az_json_template_slot writer_slots[4];
+  az_json_template writer_template = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_template_init(&writer_template, writer_slots, 4));
+  az_json_writer writer = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(template_buffer), NULL));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&writer));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("temp")));
+  TEST_EXPECT_SUCCESS(
+      az_json_template_append_slot(&writer_template, &writer, AZ_JSON_TEMPLATE_SLOT_DOUBLE));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("sensor\n")));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&writer));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("count")));
+  TEST_EXPECT_SUCCESS(
+      az_json_template_append_slot(&writer_template, &writer, AZ_JSON_TEMPLATE_SLOT_INT32));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("tags")));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+  TEST_EXPECT_SUCCESS(
+      az_json_template_append_slot(&writer_template, &writer, AZ_JSON_TEMPLATE_SLOT_STRING));
+  TEST_EXPECT_SUCCESS(
+      az_json_template_append_slot(&writer_template, &writer, AZ_JSON_TEMPLATE_SLOT_BOOL));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_end_array(&writer));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_end_object(&writer));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_end_object(&writer));
+  TEST_EXPECT_SUCCESS(az_json_template_complete(&writer_template, &writer));
+  assert_int_equal(az_json_template_get_slot_count(&writer_template), 4);
+
+  az_json_template const* templates[] = { &literal_template, &writer_template };
+  for (size_t t = 0; t < sizeof(templates) / sizeof(templates[0]); t++)
+  {
+    uint8_t json_buffer[128] = { 0 };
+    az_span json_text = AZ_SPAN_EMPTY;
+    TEST_EXPECT_SUCCESS(
+        _az_test_fill_json_template(templates[t], AZ_SPAN_FROM_BUFFER(json_buffer), &json_text));
+    assert_true(az_span_is_content_equal(json_text, expected));
+
+    // The output fits exactly, and any smaller destination fails without overflowing.
+    TEST_EXPECT_SUCCESS(_az_test_fill_json_template(
+        templates[t], az_span_create(json_buffer, az_span_size(expected)), &json_text));
+    for (int32_t size = 0; size < az_span_size(expected); size++)
+    {
+      assert_int_equal(
+          _az_test_fill_json_template(templates[t], az_span_create(json_buffer, size), &json_text),
+          AZ_ERROR_NOT_ENOUGH_SPACE);
+    }
+  }
+
+  // A template with no slots is written as is.
+  az_json_template constant_template = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_template_init_from_json(
+      &constant_template, AZ_SPAN_FROM_STR("[\"${other}\",\"\\u0024{bool}\"]"), NULL, 0));
+  assert_int_equal(az_json_template_get_slot_count(&constant_template), 0);
+  {
+    uint8_t json_buffer[32] = { 0 };
+    az_json_template_writer template_writer = { 0 };
+    az_span json_text = AZ_SPAN_EMPTY;
+    TEST_EXPECT_SUCCESS(az_json_template_writer_init(
+        &template_writer, &constant_template, AZ_SPAN_FROM_BUFFER(json_buffer)));
+    TEST_EXPECT_SUCCESS(az_json_template_writer_complete(&template_writer, &json_text));
+    assert_true(az_span_is_content_equal(
+        json_text, AZ_SPAN_FROM_STR("[\"${other}\",\"\\u0024{bool}\"]")));
+  }
+
+  // Errors
+  az_json_template_slot one_slot[1];
+  assert_int_equal(
+      az_json_template_init_from_json(
+          &literal_template, AZ_SPAN_FROM_STR("[\"${int32}\",\"${bool}\"]"), one_slot, 1),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(
+      az_json_template_init_from_json(
+          &literal_template, AZ_SPAN_FROM_STR("[\"${int32}\""), one_slot, 1),
+      AZ_ERROR_UNEXPECTED_END);
+
+  TEST_EXPECT_SUCCESS(az_json_template_init(&writer_template, NULL, 0));
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(template_buffer), NULL));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+  assert_int_equal(
+      az_json_template_append_slot(&writer_template, &writer, AZ_JSON_TEMPLATE_SLOT_INT32),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  // The writer is left unchanged on failure.
+  assert_int_equal(writer.total_bytes_written, 1);
+}
+
 /** Json reader **/
 az_result read_write(az_span input, az_span* output, int32_t* o);
 az_result read_write_token(
@@ -2872,6 +3445,103 @@ static void test_az_json_token_copy(void** state)
   }
 }
 
+static int32_t _az_json_token_collect_segments(
+    az_json_token const* json_token,
+    az_span destination,
+    az_span* out_collected)
+{
+  az_json_token_segment_iterator iterator = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_token_segment_iterator_init(&iterator, json_token));
+
+  int32_t segment_count = 0;
+  az_span remainder = destination;
+  az_span segment = AZ_SPAN_EMPTY;
+  az_result result = AZ_OK;
+  while (az_result_succeeded(result = az_json_token_segment_iterator_next(&iterator, &segment)))
+  {
+    // Fragments are never empty and always point into the original buffers.
+    assert_true(az_span_size(segment) > 0);
+    remainder = az_span_copy(remainder, segment);
+    segment_count++;
+  }
+  assert_int_equal(result, AZ_ERROR_ITEM_NOT_FOUND);
+
+  // The iterator stays exhausted.
+  assert_int_equal(
+      az_json_token_segment_iterator_next(&iterator, &segment), AZ_ERROR_ITEM_NOT_FOUND);
+
+  *out_collected = az_span_slice(destination, 0, _az_span_diff(remainder, destination));
+  return segment_count;
+}
+
+static void test_az_json_token_segment_iterator(void** state)
+{
+  (void)state;
+
+  uint8_t dest_buffer[128] = { 0 };
+  az_span collected = AZ_SPAN_EMPTY;
+
+  az_span json = AZ_SPAN_FROM_STR("{\"name\":\"a \\\"quoted\\\" value\"}");
+  az_span expected_raw = AZ_SPAN_FROM_STR("a \\\"quoted\\\" value");
+
+  // Contiguous token yields its slice as a single fragment.
+  az_json_reader reader = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, json, NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  assert_int_equal(
+      _az_json_token_collect_segments(&reader.token, AZ_SPAN_FROM_BUFFER(dest_buffer), &collected),
+      1);
+  assert_true(az_span_is_content_equal(collected, AZ_SPAN_FROM_STR("name")));
+
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  assert_int_equal(
+      _az_json_token_collect_segments(&reader.token, AZ_SPAN_FROM_BUFFER(dest_buffer), &collected),
+      1);
+  assert_true(az_span_is_content_equal(collected, expected_raw));
+
+  // Split in 2, with escapes left as is.
+  az_span buffers_half[2] = { 0 };
+  _az_split_buffers(json, buffers_half);
+  TEST_EXPECT_SUCCESS(az_json_reader_chunked_init(&reader, buffers_half, 2, NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  assert_true(reader.token._internal.is_multisegment);
+  assert_int_equal(
+      _az_json_token_collect_segments(&reader.token, AZ_SPAN_FROM_BUFFER(dest_buffer), &collected),
+      2);
+  assert_true(az_span_is_content_equal(collected, expected_raw));
+  assert_true(az_json_token_is_text_equal(&reader.token, AZ_SPAN_FROM_STR("a \"quoted\" value")));
+  assert_false(az_json_token_is_text_equal(&reader.token, AZ_SPAN_FROM_STR("a \"quoted\" valu")));
+
+  // Split into single bytes, where the token starts and ends on buffer boundaries.
+  _az_split_buffers_single_byte(json, _az_buffers64_one);
+  TEST_EXPECT_SUCCESS(
+      az_json_reader_chunked_init(&reader, _az_buffers64_one, az_span_size(json), NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  assert_int_equal(
+      _az_json_token_collect_segments(&reader.token, AZ_SPAN_FROM_BUFFER(dest_buffer), &collected),
+      4);
+  assert_true(az_span_is_content_equal(collected, AZ_SPAN_FROM_STR("name")));
+
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  assert_int_equal(
+      _az_json_token_collect_segments(&reader.token, AZ_SPAN_FROM_BUFFER(dest_buffer), &collected),
+      az_span_size(expected_raw));
+  assert_true(az_span_is_content_equal(collected, expected_raw));
+  assert_true(az_json_token_is_text_equal(&reader.token, AZ_SPAN_FROM_STR("a \"quoted\" value")));
+
+  // Empty string yields no fragments.
+  TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, AZ_SPAN_FROM_STR("\"\""), NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  assert_int_equal(
+      _az_json_token_collect_segments(&reader.token, AZ_SPAN_FROM_BUFFER(dest_buffer), &collected),
+      0);
+  assert_int_equal(az_span_size(collected), 0);
+}
+
 // Imagine your JSON input to parse is " { \"name\": \"some value string\" , \"code\" : 123456 } "
 // Either in one contiguous buffer, or split up within multiple non-contiguous ones.
 typedef struct
@@ -3238,6 +3908,11 @@ int test_az_json()
           cmocka_unit_test(test_json_writer_chunked),
           cmocka_unit_test(test_json_writer_chunked_no_callback),
           cmocka_unit_test(test_json_writer_large_string_chunked),
+          cmocka_unit_test(test_json_writer_escaping_runs),
+          cmocka_unit_test(test_json_writer_buffered),
+          cmocka_unit_test(test_json_writer_typed_arrays),
+          cmocka_unit_test(test_json_writer_compute_size_only),
+          cmocka_unit_test(test_json_template),
           cmocka_unit_test(test_json_reader),
           cmocka_unit_test(test_json_reader_invalid),
           cmocka_unit_test(test_json_reader_incomplete),
@@ -3249,6 +3924,7 @@ int test_az_json()
           cmocka_unit_test(test_az_json_token_number_too_large),
           cmocka_unit_test(test_az_json_token_literal),
           cmocka_unit_test(test_az_json_token_copy),
+          cmocka_unit_test(test_az_json_token_segment_iterator),
           cmocka_unit_test(test_az_json_reader_chunked),
           cmocka_unit_test(test_az_json_string_unescape),
           cmocka_unit_test(test_az_json_string_unescape_same_buffer) };
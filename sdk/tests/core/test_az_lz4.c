@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_test_definitions.h"
+#include <azure/core/az_lz4.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+static az_lz4_compress_workspace test_workspace;
+
+static char test_telemetry[]
+    = "[{\"deviceId\":\"sensor-01\",\"temperature\":21.5,\"humidity\":40,\"status\":\"ok\"},"
+      "{\"deviceId\":\"sensor-02\",\"temperature\":21.7,\"humidity\":41,\"status\":\"ok\"},"
+      "{\"deviceId\":\"sensor-03\",\"temperature\":22.1,\"humidity\":39,\"status\":\"ok\"},"
+      "{\"deviceId\":\"sensor-04\",\"temperature\":20.9,\"humidity\":42,\"status\":\"ok\"}]";
+
+static void _az_lz4_verify_round_trip(az_span source, int32_t* out_compressed_size)
+{
+  uint8_t compressed[1024] = { 0 };
+  uint8_t decompressed[1024] = { 0 };
+  assert_true(az_lz4_get_max_compressed_size(az_span_size(source)) <= (int32_t)sizeof(compressed));
+
+  int32_t compressed_size = 0;
+  assert_int_equal(
+      az_lz4_compress(
+          &test_workspace, AZ_SPAN_FROM_BUFFER(compressed), source, &compressed_size),
+      AZ_OK);
+  assert_true(compressed_size <= az_lz4_get_max_compressed_size(az_span_size(source)));
+
+  int32_t decompressed_size = 0;
+  assert_int_equal(
+      az_lz4_decompress(
+          AZ_SPAN_FROM_BUFFER(decompressed),
+          az_span_create(compressed, compressed_size),
+          &decompressed_size),
+      AZ_OK);
+  assert_int_equal(decompressed_size, az_span_size(source));
+  assert_memory_equal(decompressed, az_span_ptr(source), (size_t)decompressed_size);
+
+  *out_compressed_size = compressed_size;
+}
+
+static void az_lz4_max_compressed_size_test(void** state)
+{
+  (void)state;
+  assert_int_equal(az_lz4_get_max_compressed_size(0), 16);
+  assert_int_equal(az_lz4_get_max_compressed_size(1), 17);
+  assert_int_equal(az_lz4_get_max_compressed_size(255), 272);
+  assert_int_equal(az_lz4_get_max_compressed_size(1000), 1019);
+}
+
+static void az_lz4_round_trip_telemetry_test(void** state)
+{
+  (void)state;
+  int32_t compressed_size = 0;
+  _az_lz4_verify_round_trip(
+      az_span_create((uint8_t*)test_telemetry, sizeof(test_telemetry) - 1), &compressed_size);
+
+  // The repeated property names compress well.
+  assert_true(compressed_size < (int32_t)(sizeof(test_telemetry) - 1) * 2 / 3);
+}
+
+static void az_lz4_round_trip_short_test(void** state)
+{
+  (void)state;
+  int32_t compressed_size = 0;
+
+  // Too short to look for matches, so everything is a single run of literals.
+  _az_lz4_verify_round_trip(AZ_SPAN_FROM_STR("a"), &compressed_size);
+  assert_int_equal(compressed_size, 2);
+  _az_lz4_verify_round_trip(AZ_SPAN_FROM_STR("aaaaaaaaaaaa"), &compressed_size);
+  assert_int_equal(compressed_size, 13);
+
+  _az_lz4_verify_round_trip(AZ_SPAN_FROM_STR("aaaaaaaaaaaaa"), &compressed_size);
+}
+
+static void az_lz4_round_trip_long_lengths_test(void** state)
+{
+  (void)state;
+  uint8_t source[700];
+  int32_t compressed_size = 0;
+
+  // A run of a single byte, encoded as an overlapping match with a long length.
+  memset(source, 'x', sizeof(source));
+  _az_lz4_verify_round_trip(AZ_SPAN_FROM_BUFFER(source), &compressed_size);
+  assert_true(compressed_size < 16);
+
+  // Data with no repetition, encoded as a long run of literals.
+  uint32_t seed = 12345;
+  for (size_t i = 0; i < sizeof(source); i++)
+  {
+    seed = (seed * 1103515245U) + 12345U;
+    source[i] = (uint8_t)(seed >> 16);
+  }
+  _az_lz4_verify_round_trip(AZ_SPAN_FROM_BUFFER(source), &compressed_size);
+  assert_int_equal(compressed_size, 1 + 3 + (int32_t)sizeof(source));
+
+  // Long literals followed by a long match.
+  memset(source + 350, 'y', sizeof(source) - 350);
+  _az_lz4_verify_round_trip(AZ_SPAN_FROM_BUFFER(source), &compressed_size);
+}
+
+static void az_lz4_compress_destination_small_test(void** state)
+{
+  (void)state;
+  uint8_t compressed[64] = { 0 };
+  int32_t compressed_size = 0;
+
+  assert_int_equal(
+      az_lz4_compress(
+          &test_workspace,
+          az_span_create(compressed, 40),
+          az_span_create((uint8_t*)test_telemetry, sizeof(test_telemetry) - 1),
+          &compressed_size),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  assert_int_equal(
+      az_lz4_compress(
+          &test_workspace, az_span_create(compressed, 1), AZ_SPAN_FROM_STR("a"), &compressed_size),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void az_lz4_decompress_test(void** state)
+{
+  (void)state;
+
+  // 3 literals and a match of 8 at offset 3, then 5 literals.
+  uint8_t block[] = { 0x34, 'a', 'b', 'c', 0x03, 0x00, 0x50, 'a', 'b', 'c', 'd', 'e' };
+  char const expected[] = "abcabcabcababcde";
+
+  uint8_t destination[32] = { 0 };
+  int32_t written = 0;
+  assert_int_equal(
+      az_lz4_decompress(AZ_SPAN_FROM_BUFFER(destination), AZ_SPAN_FROM_BUFFER(block), &written),
+      AZ_OK);
+  assert_int_equal(written, sizeof(expected) - 1);
+  assert_memory_equal(destination, expected, sizeof(expected) - 1);
+
+  // Every byte is needed.
+  assert_int_equal(
+      az_lz4_decompress(
+          az_span_create(destination, sizeof(expected) - 2), AZ_SPAN_FROM_BUFFER(block), &written),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(
+      az_lz4_decompress(
+          az_span_create(destination, 10), AZ_SPAN_FROM_BUFFER(block), &written),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void az_lz4_decompress_invalid_test(void** state)
+{
+  (void)state;
+  uint8_t destination[32] = { 0 };
+  int32_t written = 0;
+
+  // Literals cut short.
+  uint8_t truncated_literals[] = { 0x30, 'a', 'b' };
+  assert_int_equal(
+      az_lz4_decompress(
+          AZ_SPAN_FROM_BUFFER(destination), AZ_SPAN_FROM_BUFFER(truncated_literals), &written),
+      AZ_ERROR_UNEXPECTED_END);
+
+  // Offset cut short.
+  uint8_t truncated_offset[] = { 0x14, 'a', 0x01 };
+  assert_int_equal(
+      az_lz4_decompress(
+          AZ_SPAN_FROM_BUFFER(destination), AZ_SPAN_FROM_BUFFER(truncated_offset), &written),
+      AZ_ERROR_UNEXPECTED_END);
+
+  // Length bytes cut short.
+  uint8_t truncated_length[] = { 0xF0, 0xFF };
+  assert_int_equal(
+      az_lz4_decompress(
+          AZ_SPAN_FROM_BUFFER(destination), AZ_SPAN_FROM_BUFFER(truncated_length), &written),
+      AZ_ERROR_UNEXPECTED_END);
+
+  // No sequence after a match.
+  uint8_t missing_last_literals[] = { 0x14, 'a', 0x01, 0x00 };
+  assert_int_equal(
+      az_lz4_decompress(
+          AZ_SPAN_FROM_BUFFER(destination), AZ_SPAN_FROM_BUFFER(missing_last_literals), &written),
+      AZ_ERROR_UNEXPECTED_END);
+
+  // A match referring to before the start of the data.
+  uint8_t offset_too_far[] = { 0x14, 'a', 0x02, 0x00, 0x10, 'b' };
+  assert_int_equal(
+      az_lz4_decompress(
+          AZ_SPAN_FROM_BUFFER(destination), AZ_SPAN_FROM_BUFFER(offset_too_far), &written),
+      AZ_ERROR_UNEXPECTED_CHAR);
+
+  uint8_t offset_zero[] = { 0x14, 'a', 0x00, 0x00, 0x10, 'b' };
+  assert_int_equal(
+      az_lz4_decompress(
+          AZ_SPAN_FROM_BUFFER(destination), AZ_SPAN_FROM_BUFFER(offset_zero), &written),
+      AZ_ERROR_UNEXPECTED_CHAR);
+
+  // A match length far beyond the destination.
+  uint8_t match_too_long[] = { 0x1F, 'a', 0x01, 0x00, 0xFF, 0xFF, 0x10, 'b' };
+  assert_int_equal(
+      az_lz4_decompress(
+          AZ_SPAN_FROM_BUFFER(destination), AZ_SPAN_FROM_BUFFER(match_too_long), &written),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+int test_az_lz4()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(az_lz4_max_compressed_size_test),
+    cmocka_unit_test(az_lz4_round_trip_telemetry_test),
+    cmocka_unit_test(az_lz4_round_trip_short_test),
+    cmocka_unit_test(az_lz4_round_trip_long_lengths_test),
+    cmocka_unit_test(az_lz4_compress_destination_small_test),
+    cmocka_unit_test(az_lz4_decompress_test),
+    cmocka_unit_test(az_lz4_decompress_invalid_test),
+  };
+  return cmocka_run_group_tests_name("az_core_lz4", tests, NULL, NULL);
+}
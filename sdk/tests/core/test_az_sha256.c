@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_test_definitions.h"
+#include <azure/core/az_sha256.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+static void _az_sha256_assert_hex_equal(az_span digest, char const* expected_hex)
+{
+  static char const hex_digits[] = "0123456789abcdef";
+  char actual_hex[(AZ_SHA256_DIGEST_SIZE * 2) + 1] = { 0 };
+
+  assert_int_equal(az_span_size(digest), AZ_SHA256_DIGEST_SIZE);
+  for (int32_t i = 0; i < AZ_SHA256_DIGEST_SIZE; i++)
+  {
+    actual_hex[i * 2] = hex_digits[az_span_ptr(digest)[i] >> 4];
+    actual_hex[(i * 2) + 1] = hex_digits[az_span_ptr(digest)[i] & 0x0F];
+  }
+  assert_string_equal(actual_hex, expected_hex);
+}
+
+static void _az_sha256_assert_repeated(int32_t size, char const* expected_hex)
+{
+  uint8_t data[128];
+  uint8_t digest_buffer[AZ_SHA256_DIGEST_SIZE];
+  az_span digest;
+
+  memset(data, 'a', sizeof(data));
+  assert_int_equal(
+      az_sha256(az_span_create(data, size), AZ_SPAN_FROM_BUFFER(digest_buffer), &digest), AZ_OK);
+  _az_sha256_assert_hex_equal(digest, expected_hex);
+}
+
+static void az_sha256_test(void** state)
+{
+  (void)state;
+  uint8_t digest_buffer[AZ_SHA256_DIGEST_SIZE];
+  az_span digest;
+
+  assert_int_equal(az_sha256(AZ_SPAN_EMPTY, AZ_SPAN_FROM_BUFFER(digest_buffer), &digest), AZ_OK);
+  _az_sha256_assert_hex_equal(
+      digest, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+
+  assert_int_equal(
+      az_sha256(AZ_SPAN_FROM_STR("abc"), AZ_SPAN_FROM_BUFFER(digest_buffer), &digest), AZ_OK);
+  _az_sha256_assert_hex_equal(
+      digest, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+  assert_int_equal(
+      az_sha256(
+          AZ_SPAN_FROM_STR("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+          AZ_SPAN_FROM_BUFFER(digest_buffer),
+          &digest),
+      AZ_OK);
+  _az_sha256_assert_hex_equal(
+      digest, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+static void az_sha256_padding_boundaries_test(void** state)
+{
+  (void)state;
+
+  // Sizes around where the padding and the size no longer fit in the last block.
+  _az_sha256_assert_repeated(
+      55, "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318");
+  _az_sha256_assert_repeated(
+      56, "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a");
+  _az_sha256_assert_repeated(
+      63, "7d3e74a05d7db15bce4ad9ec0658ea98e3f06eeecf16b4c6fff2da457ddc2f34");
+  _az_sha256_assert_repeated(
+      64, "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb");
+  _az_sha256_assert_repeated(
+      65, "635361c48bb9eab14198e76ea8ab7f1a41685d6ad62aa9146d301d4f17eb0ae0");
+  _az_sha256_assert_repeated(
+      119, "31eba51c313a5c08226adf18d4a359cfdfd8d2e816b13f4af952f7ea6584dcfb");
+  _az_sha256_assert_repeated(
+      120, "2f3d335432c70b580af0e8e1b3674a7c020d683aa5f73aaaedfdc55af904c21c");
+}
+
+static void az_sha256_streaming_test(void** state)
+{
+  (void)state;
+  uint8_t data[1000];
+  uint8_t digest_buffer[AZ_SHA256_DIGEST_SIZE];
+  az_span digest;
+  az_sha256_context context;
+
+  memset(data, 'a', sizeof(data));
+  assert_int_equal(az_sha256_init(&context), AZ_OK);
+
+  // A million bytes, in pieces which don't line up with the blocks.
+  int32_t remaining = 1000000;
+  int32_t piece_size = 1;
+  while (remaining > 0)
+  {
+    int32_t const size = piece_size < remaining ? piece_size : remaining;
+    assert_int_equal(az_sha256_update(&context, az_span_create(data, size)), AZ_OK);
+    remaining -= size;
+    piece_size = (piece_size * 7 % (int32_t)sizeof(data)) + 1;
+  }
+  assert_int_equal(az_sha256_update(&context, AZ_SPAN_EMPTY), AZ_OK);
+
+  assert_int_equal(
+      az_sha256_finalize(&context, AZ_SPAN_FROM_BUFFER(digest_buffer), &digest), AZ_OK);
+  _az_sha256_assert_hex_equal(
+      digest, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+static void az_sha256_destination_small_test(void** state)
+{
+  (void)state;
+  uint8_t digest_buffer[AZ_SHA256_DIGEST_SIZE];
+  az_span digest;
+
+  assert_int_equal(
+      az_sha256(
+          AZ_SPAN_FROM_STR("abc"),
+          az_span_create(digest_buffer, AZ_SHA256_DIGEST_SIZE - 1),
+          &digest),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void az_hmac_sha256_test(void** state)
+{
+  (void)state;
+  uint8_t key_bytes[131];
+  uint8_t mac_buffer[AZ_SHA256_DIGEST_SIZE];
+  az_span mac;
+  az_hmac_sha256_key key;
+
+  // The test cases of RFC 4231.
+  memset(key_bytes, 0x0b, 20);
+  assert_int_equal(az_hmac_sha256_key_init(&key, az_span_create(key_bytes, 20)), AZ_OK);
+  assert_int_equal(
+      az_hmac_sha256(&key, AZ_SPAN_FROM_STR("Hi There"), AZ_SPAN_FROM_BUFFER(mac_buffer), &mac),
+      AZ_OK);
+  _az_sha256_assert_hex_equal(
+      mac, "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+
+  assert_int_equal(az_hmac_sha256_key_init(&key, AZ_SPAN_FROM_STR("Jefe")), AZ_OK);
+  assert_int_equal(
+      az_hmac_sha256(
+          &key,
+          AZ_SPAN_FROM_STR("what do ya want for nothing?"),
+          AZ_SPAN_FROM_BUFFER(mac_buffer),
+          &mac),
+      AZ_OK);
+  _az_sha256_assert_hex_equal(
+      mac, "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+  // A key longer than a block is hashed first.
+  memset(key_bytes, 0xaa, sizeof(key_bytes));
+  assert_int_equal(az_hmac_sha256_key_init(&key, AZ_SPAN_FROM_BUFFER(key_bytes)), AZ_OK);
+  assert_int_equal(
+      az_hmac_sha256(
+          &key,
+          AZ_SPAN_FROM_STR("Test Using Larger Than Block-Size Key - Hash Key First"),
+          AZ_SPAN_FROM_BUFFER(mac_buffer),
+          &mac),
+      AZ_OK);
+  _az_sha256_assert_hex_equal(
+      mac, "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+
+  assert_int_equal(az_hmac_sha256_key_init(&key, AZ_SPAN_EMPTY), AZ_OK);
+  assert_int_equal(
+      az_hmac_sha256(&key, AZ_SPAN_EMPTY, AZ_SPAN_FROM_BUFFER(mac_buffer), &mac), AZ_OK);
+  _az_sha256_assert_hex_equal(
+      mac, "b613679a0814d9ec772f95d778c35fc5ff1697c493715653c6c712144292c5ad");
+}
+
+static void az_hmac_sha256_key_reuse_test(void** state)
+{
+  (void)state;
+  uint8_t mac_buffer[AZ_SHA256_DIGEST_SIZE];
+  az_span mac;
+  az_hmac_sha256_key key;
+  az_hmac_sha256_context context;
+
+  assert_int_equal(az_hmac_sha256_key_init(&key, AZ_SPAN_FROM_STR("Jefe")), AZ_OK);
+
+  // The key is left untouched, so it signs the same message the same way each time, streamed or
+  // not.
+  for (int32_t i = 0; i < 2; i++)
+  {
+    assert_int_equal(az_hmac_sha256_init(&context, &key), AZ_OK);
+    assert_int_equal(az_hmac_sha256_update(&context, AZ_SPAN_FROM_STR("what do ya ")), AZ_OK);
+    assert_int_equal(
+        az_hmac_sha256_update(&context, AZ_SPAN_FROM_STR("want for nothing?")), AZ_OK);
+    assert_int_equal(
+        az_hmac_sha256_finalize(&context, AZ_SPAN_FROM_BUFFER(mac_buffer), &mac), AZ_OK);
+    _az_sha256_assert_hex_equal(
+        mac, "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+  }
+
+  assert_int_equal(az_hmac_sha256_init(&context, &key), AZ_OK);
+  assert_int_equal(
+      az_hmac_sha256_finalize(&context, az_span_create(mac_buffer, 16), &mac),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+int test_az_sha256()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(az_sha256_test),
+    cmocka_unit_test(az_sha256_padding_boundaries_test),
+    cmocka_unit_test(az_sha256_streaming_test),
+    cmocka_unit_test(az_sha256_destination_small_test),
+    cmocka_unit_test(az_hmac_sha256_test),
+    cmocka_unit_test(az_hmac_sha256_key_reuse_test),
+  };
+  return cmocka_run_group_tests_name("az_core_sha256", tests, NULL, NULL);
+}
@@ -16,6 +16,7 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <cmocka.h>
 
@@ -166,6 +167,16 @@ static void test_az_iot_message_properties_next_NULL_out_value_fail(void** state
   ASSERT_PRECONDITION_CHECKED(az_iot_message_properties_next(&props, &name, NULL));
 }
 
+static void test_az_iot_message_properties_build_index_not_power_of_two_fail(void** state)
+{
+  (void)state;
+
+  az_iot_message_properties props;
+  az_iot_message_properties_index_entry index[3];
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_message_properties_build_index(&props, index, 3));
+}
+
 static void test_az_iot_message_properties_next_written_less_than_size_succeed(void** state)
 {
   (void)state;
@@ -207,6 +218,38 @@ static void test_az_iot_message_properties_next_written_less_than_size_succeed(v
       az_iot_message_properties_next(&props, &name, &value), AZ_ERROR_IOT_END_OF_PROPERTIES);
 }
 
+static void test_az_iot_message_queue_init_small_buffer_fail(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE + AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE];
+  az_iot_message_queue queue;
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_message_queue_init(&queue, AZ_SPAN_FROM_BUFFER(buffer)));
+}
+
+static void test_az_iot_message_queue_get_unsent_no_messages_fail(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE + TEST_SPAN_BUFFER_SIZE];
+  az_iot_message_queue queue;
+  az_iot_message_queue_message message;
+  int32_t count;
+  assert_int_equal(az_iot_message_queue_init(&queue, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_message_queue_get_unsent(&queue, &message, 0, &count));
+}
+
+static void test_az_iot_retry_policy_init_min_above_max_fail()
+{
+  az_iot_retry_policy_options options = az_iot_retry_policy_options_default();
+  options.min_retry_delay_msec = options.max_retry_delay_msec + 1;
+
+  az_iot_retry_policy policy;
+  ASSERT_PRECONDITION_CHECKED(az_iot_retry_policy_init(&policy, AZ_SPAN_EMPTY, &options));
+}
+
 #endif // AZ_NO_PRECONDITION_CHECKING
 
 static void test_az_iot_u32toa_size_success()
@@ -247,6 +290,23 @@ static void test_az_iot_u64toa_size_success()
   assert_int_equal(_az_iot_u64toa_size(18446744073709551615ul), 20);
 }
 
+static void test_az_iot_xorshift32_success()
+{
+  uint32_t state = 1;
+  assert_int_equal(_az_iot_xorshift32(&state), 270369);
+  assert_int_equal(state, 270369);
+
+  // A zero state never stays stuck at 0, and draws the same values as a state of 1.
+  uint32_t zero_state = 0;
+  state = 1;
+  for (int i = 0; i < 4; i++)
+  {
+    uint32_t const value = _az_iot_xorshift32(&zero_state);
+    assert_int_not_equal(value, 0);
+    assert_int_equal(value, _az_iot_xorshift32(&state));
+  }
+}
+
 static void test_az_iot_is_status_succeeded_translate_success()
 {
   assert_true(az_iot_status_succeeded(AZ_IOT_STATUS_OK));
@@ -349,6 +409,106 @@ static void test_az_iot_calculate_retry_delay_no_logging_succeed()
   az_log_set_classification_filter_callback(NULL);
 }
 
+static void _test_az_iot_assert_in_range(int32_t value, int32_t min, int32_t max)
+{
+  assert_true(value >= min);
+  assert_true(value <= max);
+}
+
+static void test_az_iot_retry_policy_delays_in_range_succeed()
+{
+  az_iot_retry_jitter const jitters[] = {
+    AZ_IOT_RETRY_JITTER_FULL,
+    AZ_IOT_RETRY_JITTER_EQUAL,
+    AZ_IOT_RETRY_JITTER_DECORRELATED,
+  };
+
+  for (int32_t j = 0; j < 3; j++)
+  {
+    az_iot_retry_policy_options options = az_iot_retry_policy_options_default();
+    options.jitter = jitters[j];
+    options.min_retry_delay_msec = 500;
+    options.max_retry_delay_msec = 60000;
+    az_iot_retry_policy policy;
+    assert_int_equal(
+        az_iot_retry_policy_init(&policy, AZ_SPAN_FROM_STR("sensor-01"), &options), AZ_OK);
+
+    int32_t previous_delay = 500;
+    for (int32_t attempt = 0; attempt < 40; attempt++)
+    {
+      assert_int_equal(az_iot_retry_policy_get_attempt(&policy), attempt);
+      int32_t const delay = az_iot_retry_policy_get_next_delay(&policy, 0);
+      int32_t const backoff = attempt < 7 ? 500 << attempt : 60000;
+
+      switch (jitters[j])
+      {
+        case AZ_IOT_RETRY_JITTER_FULL:
+          _test_az_iot_assert_in_range(delay, 0, backoff);
+          break;
+        case AZ_IOT_RETRY_JITTER_EQUAL:
+          _test_az_iot_assert_in_range(delay, backoff / 2, backoff);
+          break;
+        default:
+          _test_az_iot_assert_in_range(
+              delay, 500, previous_delay * 3 < 60000 ? previous_delay * 3 : 60000);
+          break;
+      }
+      previous_delay = delay;
+    }
+
+    az_iot_retry_policy_reset(&policy);
+    assert_int_equal(az_iot_retry_policy_get_attempt(&policy), 0);
+    _test_az_iot_assert_in_range(az_iot_retry_policy_get_next_delay(&policy, 0), 0, 1500);
+  }
+}
+
+static void test_az_iot_retry_policy_retry_after_succeed()
+{
+  az_iot_retry_policy policy;
+  assert_int_equal(az_iot_retry_policy_init(&policy, AZ_SPAN_FROM_STR("sensor-01"), NULL), AZ_OK);
+
+  // The service's delay wins over a shorter one, but isn't shared by every device to the
+  // millisecond.
+  int32_t const delay = az_iot_retry_policy_get_next_delay(&policy, 30000);
+  _test_az_iot_assert_in_range(delay, 30000, 31000);
+  assert_int_equal(az_iot_retry_policy_get_attempt(&policy), 1);
+
+  // The same device, and seed, always gets the same delays.
+  az_iot_retry_policy same_policy;
+  assert_int_equal(
+      az_iot_retry_policy_init(&same_policy, AZ_SPAN_FROM_STR("sensor-01"), NULL), AZ_OK);
+  assert_int_equal(az_iot_retry_policy_get_next_delay(&same_policy, 30000), delay);
+}
+
+static void test_az_iot_retry_policy_spreads_fleet_succeed()
+{
+  // 1000 devices disconnected at the same time retry over the whole range of their first delay,
+  // from 1 to 3 seconds, rather than all at once.
+  int32_t arrivals_per_100_msec[21] = { 0 };
+  for (int32_t i = 0; i < 1000; i++)
+  {
+    uint8_t device_id_buffer[16];
+    az_span device_id_remainder;
+    assert_int_equal(
+        az_span_i32toa(AZ_SPAN_FROM_BUFFER(device_id_buffer), i, &device_id_remainder), AZ_OK);
+    az_span const device_id = az_span_slice(
+        AZ_SPAN_FROM_BUFFER(device_id_buffer),
+        0,
+        (int32_t)sizeof(device_id_buffer) - az_span_size(device_id_remainder));
+
+    az_iot_retry_policy policy;
+    assert_int_equal(az_iot_retry_policy_init(&policy, device_id, NULL), AZ_OK);
+    int32_t const delay = az_iot_retry_policy_get_next_delay(&policy, 0);
+    _test_az_iot_assert_in_range(delay, 1000, 3000);
+    arrivals_per_100_msec[(delay - 1000) / 100]++;
+  }
+
+  for (int32_t i = 0; i < 20; i++)
+  {
+    _test_az_iot_assert_in_range(arrivals_per_100_msec[i], 20, 80);
+  }
+}
+
 static void test_az_span_copy_url_encode_succeed()
 {
   az_span url_decoded_span = AZ_SPAN_FROM_STR("abc/=%012");
@@ -764,6 +924,426 @@ static void test_az_iot_message_properties_next_empty_succeed(void** state)
       az_iot_message_properties_next(&props, &name, &value), AZ_ERROR_IOT_END_OF_PROPERTIES);
 }
 
+static void test_az_iot_message_payload_compress_round_trip_succeed(void** state)
+{
+  (void)state;
+
+  az_span const payload = AZ_SPAN_FROM_STR(
+      "{\"temperature\":21.5,\"humidity\":40},{\"temperature\":21.7,\"humidity\":41},"
+      "{\"temperature\":22.1,\"humidity\":39},{\"temperature\":20.9,\"humidity\":42}");
+
+  static az_lz4_compress_workspace workspace;
+  uint8_t props_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_iot_message_properties props;
+  assert_int_equal(
+      az_iot_message_properties_init(&props, AZ_SPAN_FROM_BUFFER(props_buffer), 0), AZ_OK);
+
+  uint8_t compressed_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span compressed = AZ_SPAN_EMPTY;
+  assert_int_equal(
+      az_iot_message_payload_compress(
+          &workspace, &props, payload, AZ_SPAN_FROM_BUFFER(compressed_buffer), &compressed),
+      AZ_OK);
+  assert_ptr_equal(az_span_ptr(compressed), compressed_buffer);
+  assert_true(az_span_size(compressed) < az_span_size(payload));
+
+  az_span value;
+  assert_int_equal(
+      az_iot_message_properties_find(
+          &props, AZ_SPAN_FROM_STR(AZ_IOT_MESSAGE_PROPERTIES_CONTENT_ENCODING), &value),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("lz4")));
+
+  uint8_t decompressed_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span decompressed = AZ_SPAN_EMPTY;
+  assert_int_equal(
+      az_iot_message_payload_decompress(
+          &props, compressed, AZ_SPAN_FROM_BUFFER(decompressed_buffer), &decompressed),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(decompressed, payload));
+
+  // The decompressed payload has to fit.
+  assert_int_equal(
+      az_iot_message_payload_decompress(
+          &props,
+          compressed,
+          az_span_create(decompressed_buffer, az_span_size(payload) - 1),
+          &decompressed),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_iot_message_payload_compress_not_smaller_succeed(void** state)
+{
+  (void)state;
+
+  az_span const payload = AZ_SPAN_FROM_STR("{\"temperature\":21.5}");
+
+  static az_lz4_compress_workspace workspace;
+  uint8_t props_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_iot_message_properties props;
+  assert_int_equal(
+      az_iot_message_properties_init(&props, AZ_SPAN_FROM_BUFFER(props_buffer), 0), AZ_OK);
+
+  // Nothing repeats, so the payload is sent as is, without a content encoding.
+  uint8_t compressed_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span compressed = AZ_SPAN_EMPTY;
+  assert_int_equal(
+      az_iot_message_payload_compress(
+          &workspace, &props, payload, AZ_SPAN_FROM_BUFFER(compressed_buffer), &compressed),
+      AZ_OK);
+  assert_ptr_equal(az_span_ptr(compressed), az_span_ptr(payload));
+  assert_int_equal(az_span_size(compressed), az_span_size(payload));
+
+  az_span value;
+  assert_int_equal(
+      az_iot_message_properties_find(
+          &props, AZ_SPAN_FROM_STR(AZ_IOT_MESSAGE_PROPERTIES_CONTENT_ENCODING), &value),
+      AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+static void test_az_iot_message_payload_decompress_other_encoding_succeed(void** state)
+{
+  (void)state;
+
+  az_span const payload = AZ_SPAN_FROM_STR("{\"temperature\":21.5}");
+  az_iot_message_properties props;
+  assert_int_equal(
+      az_iot_message_properties_init(
+          &props, AZ_SPAN_FROM_STR("%24.ce=utf-8"), az_span_size(AZ_SPAN_FROM_STR("%24.ce=utf-8"))),
+      AZ_OK);
+
+  uint8_t decompressed_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span decompressed = AZ_SPAN_EMPTY;
+  assert_int_equal(
+      az_iot_message_payload_decompress(
+          &props, payload, AZ_SPAN_FROM_BUFFER(decompressed_buffer), &decompressed),
+      AZ_OK);
+  assert_ptr_equal(az_span_ptr(decompressed), az_span_ptr(payload));
+  assert_int_equal(az_span_size(decompressed), az_span_size(payload));
+}
+
+static void test_az_iot_message_properties_build_index_succeed(void** state)
+{
+  (void)state;
+
+  az_span test_span
+      = az_span_create_from_str(TEST_KEY_VALUE_THREE "&key=value&key_one=duplicate&key_four=");
+  az_iot_message_properties props;
+  az_iot_message_properties_index_entry index[8];
+
+  assert_int_equal(
+      az_iot_message_properties_init(&props, test_span, az_span_size(test_span)), AZ_OK);
+  assert_int_equal(az_iot_message_properties_build_index(&props, index, 8), AZ_OK);
+
+  az_span out_value;
+  assert_int_equal(az_iot_message_properties_find(&props, test_key_one, &out_value), AZ_OK);
+  assert_true(az_span_is_content_equal(out_value, test_value_one));
+  assert_int_equal(az_iot_message_properties_find(&props, test_key_two, &out_value), AZ_OK);
+  assert_true(az_span_is_content_equal(out_value, test_value_two));
+  assert_int_equal(az_iot_message_properties_find(&props, test_key_three, &out_value), AZ_OK);
+  assert_true(az_span_is_content_equal(out_value, test_value_three));
+  assert_int_equal(az_iot_message_properties_find(&props, test_key, &out_value), AZ_OK);
+  assert_true(az_span_is_content_equal(out_value, AZ_SPAN_FROM_STR("value")));
+  assert_int_equal(
+      az_iot_message_properties_find(&props, AZ_SPAN_FROM_STR("key_four"), &out_value), AZ_OK);
+  assert_int_equal(az_span_size(out_value), 0);
+
+  assert_int_equal(
+      az_iot_message_properties_find(&props, AZ_SPAN_FROM_STR("key_"), &out_value),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_message_properties_find(&props, test_value_one, &out_value),
+      AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+static void test_az_iot_message_properties_build_index_small_index_fail(void** state)
+{
+  (void)state;
+
+  az_span test_span = az_span_create_from_str(TEST_KEY_VALUE_THREE);
+  az_iot_message_properties props;
+  az_iot_message_properties_index_entry index[2];
+
+  assert_int_equal(
+      az_iot_message_properties_init(&props, test_span, az_span_size(test_span)), AZ_OK);
+  assert_int_equal(
+      az_iot_message_properties_build_index(&props, index, 2), AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // Lookups still work, without the index.
+  az_span out_value;
+  assert_int_equal(az_iot_message_properties_find(&props, test_key_three, &out_value), AZ_OK);
+  assert_true(az_span_is_content_equal(out_value, test_value_three));
+}
+
+static void test_az_iot_message_properties_build_index_append_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t test_span_buf[TEST_SPAN_BUFFER_SIZE];
+  az_iot_message_properties props;
+  az_iot_message_properties_index_entry index[4];
+
+  assert_int_equal(
+      az_iot_message_properties_init(&props, AZ_SPAN_FROM_BUFFER(test_span_buf), 0), AZ_OK);
+  assert_int_equal(az_iot_message_properties_append(&props, test_key_one, test_value_one), AZ_OK);
+  assert_int_equal(az_iot_message_properties_build_index(&props, index, 4), AZ_OK);
+  assert_int_equal(az_iot_message_properties_append(&props, test_key_two, test_value_two), AZ_OK);
+
+  az_span out_value;
+  assert_int_equal(az_iot_message_properties_find(&props, test_key_two, &out_value), AZ_OK);
+  assert_true(az_span_is_content_equal(out_value, test_value_two));
+
+  assert_int_equal(az_iot_message_properties_build_index(&props, index, 4), AZ_OK);
+  assert_int_equal(az_iot_message_properties_find(&props, test_key_two, &out_value), AZ_OK);
+  assert_true(az_span_is_content_equal(out_value, test_value_two));
+}
+
+static void test_az_iot_message_properties_url_decode_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t decoded_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span decoded;
+
+  assert_int_equal(
+      az_iot_message_properties_url_decode(
+          AZ_SPAN_FROM_STR("%2Fdevices%2fuseragent_c%2Fmessages%2FdeviceBound"),
+          AZ_SPAN_FROM_BUFFER(decoded_buffer),
+          &decoded),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(
+      decoded, AZ_SPAN_FROM_STR("/devices/useragent_c/messages/deviceBound")));
+
+  assert_int_equal(
+      az_iot_message_properties_url_decode(
+          AZ_SPAN_EMPTY, AZ_SPAN_FROM_BUFFER(decoded_buffer), &decoded),
+      AZ_OK);
+  assert_int_equal(az_span_size(decoded), 0);
+
+  // In place.
+  char encoded[] = "%24.mid=a%20b";
+  az_span encoded_span = az_span_create((uint8_t*)encoded, sizeof(encoded) - 1);
+  assert_int_equal(
+      az_iot_message_properties_url_decode(encoded_span, encoded_span, &decoded), AZ_OK);
+  assert_true(az_span_is_content_equal(decoded, AZ_SPAN_FROM_STR("$.mid=a b")));
+}
+
+static void test_az_iot_message_properties_url_decode_fail(void** state)
+{
+  (void)state;
+
+  uint8_t decoded_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span decoded;
+
+  assert_int_equal(
+      az_iot_message_properties_url_decode(
+          AZ_SPAN_FROM_STR("%2Fabc"), az_span_create(decoded_buffer, 3), &decoded),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(
+      az_iot_message_properties_url_decode(
+          AZ_SPAN_FROM_STR("abc%2"), AZ_SPAN_FROM_BUFFER(decoded_buffer), &decoded),
+      AZ_ERROR_UNEXPECTED_END);
+  assert_int_equal(
+      az_iot_message_properties_url_decode(
+          AZ_SPAN_FROM_STR("abc%2G"), AZ_SPAN_FROM_BUFFER(decoded_buffer), &decoded),
+      AZ_ERROR_UNEXPECTED_CHAR);
+}
+
+#define TEST_MESSAGE_QUEUE_DATA_SIZE 160
+
+static void _test_az_iot_message_queue_enqueue(az_iot_message_queue* queue, char payload_char)
+{
+  // Messages of 60 bytes with their header, so that the buffer of the tests holds 2 of them.
+  uint8_t payload[39];
+  memset(payload, payload_char, sizeof(payload));
+  assert_int_equal(
+      az_iot_message_queue_enqueue(queue, AZ_SPAN_FROM_STR("t"), AZ_SPAN_FROM_BUFFER(payload)),
+      AZ_OK);
+}
+
+static void test_az_iot_message_queue_send_and_ack_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE + TEST_SPAN_BUFFER_SIZE];
+  az_iot_message_queue queue;
+  az_iot_message_queue_message messages[4];
+  int32_t count;
+
+  assert_int_equal(az_iot_message_queue_init(&queue, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&queue), 0);
+  assert_int_equal(
+      az_iot_message_queue_enqueue(
+          &queue, AZ_SPAN_FROM_STR("devices/d/messages/events/"), AZ_SPAN_FROM_STR("{\"a\":1}")),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_message_queue_enqueue(
+          &queue, AZ_SPAN_FROM_STR("devices/d/messages/events/a=b"), AZ_SPAN_EMPTY),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_message_queue_enqueue(
+          &queue, AZ_SPAN_FROM_STR("devices/d/messages/events/"), AZ_SPAN_FROM_STR("{\"a\":3}")),
+      AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&queue), 3);
+
+  assert_int_equal(az_iot_message_queue_get_unsent(&queue, messages, 2, &count), AZ_OK);
+  assert_int_equal(count, 2);
+  assert_true(az_span_is_content_equal(
+      messages[0].topic, AZ_SPAN_FROM_STR("devices/d/messages/events/")));
+  assert_true(az_span_is_content_equal(messages[0].payload, AZ_SPAN_FROM_STR("{\"a\":1}")));
+  assert_true(az_span_is_content_equal(
+      messages[1].topic, AZ_SPAN_FROM_STR("devices/d/messages/events/a=b")));
+  assert_int_equal(az_span_size(messages[1].payload), 0);
+  az_iot_message_queue_set_packet_id(&queue, &messages[0], 10);
+  az_iot_message_queue_set_packet_id(&queue, &messages[1], 11);
+
+  assert_int_equal(az_iot_message_queue_get_unsent(&queue, messages, 4, &count), AZ_OK);
+  assert_int_equal(count, 1);
+  assert_true(az_span_is_content_equal(messages[0].payload, AZ_SPAN_FROM_STR("{\"a\":3}")));
+  az_iot_message_queue_set_packet_id(&queue, &messages[0], 12);
+  assert_int_equal(az_iot_message_queue_get_unsent(&queue, messages, 4, &count), AZ_OK);
+  assert_int_equal(count, 0);
+
+  // A message acknowledged out of order is released with the older ones.
+  assert_int_equal(az_iot_message_queue_ack(&queue, 11), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&queue), 3);
+  assert_int_equal(az_iot_message_queue_ack(&queue, 11), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_iot_message_queue_ack(&queue, 13), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_iot_message_queue_ack(&queue, 10), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&queue), 1);
+  assert_int_equal(az_iot_message_queue_ack(&queue, 12), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&queue), 0);
+}
+
+static void test_az_iot_message_queue_rewind_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE + TEST_SPAN_BUFFER_SIZE];
+  az_iot_message_queue queue;
+  az_iot_message_queue_message messages[4];
+  int32_t count;
+
+  assert_int_equal(az_iot_message_queue_init(&queue, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  _test_az_iot_message_queue_enqueue(&queue, '1');
+  _test_az_iot_message_queue_enqueue(&queue, '2');
+  _test_az_iot_message_queue_enqueue(&queue, '3');
+  assert_int_equal(az_iot_message_queue_get_unsent(&queue, messages, 4, &count), AZ_OK);
+  assert_int_equal(count, 3);
+  az_iot_message_queue_set_packet_id(&queue, &messages[0], 1);
+  az_iot_message_queue_set_packet_id(&queue, &messages[1], 2);
+  az_iot_message_queue_set_packet_id(&queue, &messages[2], 3);
+  assert_int_equal(az_iot_message_queue_ack(&queue, 2), AZ_OK);
+
+  // After a reconnection, the messages not acknowledged are sent again, and the packet IDs of the
+  // previous connection no longer match.
+  az_iot_message_queue_rewind(&queue);
+  assert_int_equal(az_iot_message_queue_ack(&queue, 1), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_iot_message_queue_get_unsent(&queue, messages, 1, &count), AZ_OK);
+  assert_int_equal(count, 1);
+  assert_int_equal(az_span_ptr(messages[0].payload)[0], '1');
+  az_iot_message_queue_set_packet_id(&queue, &messages[0], 4);
+
+  // The message acknowledged before is released along, though it was still to be skipped.
+  assert_int_equal(az_iot_message_queue_ack(&queue, 4), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&queue), 1);
+  assert_int_equal(az_iot_message_queue_get_unsent(&queue, messages, 4, &count), AZ_OK);
+  assert_int_equal(count, 1);
+  assert_int_equal(az_span_ptr(messages[0].payload)[0], '3');
+}
+
+static void test_az_iot_message_queue_wrap_and_recover_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE + TEST_MESSAGE_QUEUE_DATA_SIZE];
+  az_iot_message_queue queue;
+  az_iot_message_queue_message messages[4];
+  int32_t count;
+
+  memset(buffer, 0xA5, sizeof(buffer));
+  assert_int_equal(az_iot_message_queue_init(&queue, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&queue), 0);
+  _test_az_iot_message_queue_enqueue(&queue, '1');
+  _test_az_iot_message_queue_enqueue(&queue, '2');
+  assert_int_equal(
+      az_iot_message_queue_enqueue(&queue, AZ_SPAN_FROM_STR("t"), AZ_SPAN_FROM_BUFFER(buffer)),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(az_iot_message_queue_get_unsent(&queue, messages, 1, &count), AZ_OK);
+  az_iot_message_queue_set_packet_id(&queue, &messages[0], 1);
+  assert_int_equal(az_iot_message_queue_ack(&queue, 1), AZ_OK);
+
+  // The third message doesn't fit at the end, so it goes at the start, in place of the first.
+  _test_az_iot_message_queue_enqueue(&queue, '3');
+  assert_int_equal(
+      az_iot_message_queue_enqueue(&queue, AZ_SPAN_FROM_STR("t"), AZ_SPAN_EMPTY),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // The device restarts: the messages not acknowledged are found again, in order.
+  az_iot_message_queue recovered;
+  assert_int_equal(az_iot_message_queue_init(&recovered, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&recovered), 2);
+  assert_int_equal(az_iot_message_queue_get_unsent(&recovered, messages, 4, &count), AZ_OK);
+  assert_int_equal(count, 2);
+  assert_int_equal(az_span_ptr(messages[0].payload)[0], '2');
+  assert_int_equal(az_span_ptr(messages[1].payload)[0], '3');
+  assert_ptr_equal(
+      az_span_ptr(messages[1].topic), buffer + AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE
+          + AZ_IOT_MESSAGE_QUEUE_RECORD_HEADER_SIZE);
+  az_iot_message_queue_set_packet_id(&recovered, &messages[0], 1);
+  az_iot_message_queue_set_packet_id(&recovered, &messages[1], 2);
+  assert_int_equal(az_iot_message_queue_ack(&recovered, 1), AZ_OK);
+  _test_az_iot_message_queue_enqueue(&recovered, '4');
+
+  // A message torn by a crash is dropped, along with any after it.
+  az_span_ptr(messages[1].payload)[0] = 'x';
+  assert_int_equal(az_iot_message_queue_init(&recovered, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&recovered), 0);
+  _test_az_iot_message_queue_enqueue(&recovered, '5');
+  assert_int_equal(az_iot_message_queue_get_count(&recovered), 1);
+
+  // A buffer of another size starts over.
+  assert_int_equal(
+      az_iot_message_queue_init(&recovered, az_span_create(buffer, (int32_t)sizeof(buffer) - 4)),
+      AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&recovered), 0);
+}
+
+static void test_az_iot_message_queue_empty_starts_over_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[AZ_IOT_MESSAGE_QUEUE_HEADER_SIZE + TEST_MESSAGE_QUEUE_DATA_SIZE];
+  uint8_t payload[100];
+  az_iot_message_queue queue;
+  az_iot_message_queue_message messages[2];
+  int32_t count;
+
+  memset(payload, 'p', sizeof(payload));
+  assert_int_equal(az_iot_message_queue_init(&queue, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  _test_az_iot_message_queue_enqueue(&queue, '1');
+  assert_int_equal(az_iot_message_queue_get_unsent(&queue, messages, 2, &count), AZ_OK);
+  az_iot_message_queue_set_packet_id(&queue, &messages[0], 1);
+  assert_int_equal(az_iot_message_queue_ack(&queue, 1), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&queue), 0);
+
+  // Once drained, a message larger than what is left on either side of the old head still fits.
+  assert_int_equal(
+      az_iot_message_queue_enqueue(&queue, AZ_SPAN_FROM_STR("t"), AZ_SPAN_FROM_BUFFER(payload)),
+      AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_unsent(&queue, messages, 2, &count), AZ_OK);
+  assert_int_equal(count, 1);
+  assert_true(az_span_is_content_equal(messages[0].payload, AZ_SPAN_FROM_BUFFER(payload)));
+
+  // The new start is persisted, so the message is found again after a restart.
+  az_iot_message_queue recovered;
+  assert_int_equal(az_iot_message_queue_init(&recovered, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  assert_int_equal(az_iot_message_queue_get_count(&recovered), 1);
+  assert_int_equal(az_iot_message_queue_get_unsent(&recovered, messages, 2, &count), AZ_OK);
+  assert_int_equal(count, 1);
+  assert_true(az_span_is_content_equal(messages[0].payload, AZ_SPAN_FROM_BUFFER(payload)));
+}
+
 #ifdef _MSC_VER
 // warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
 #pragma warning(disable : 4113)
@@ -790,8 +1370,13 @@ int test_az_iot_common()
     cmocka_unit_test(test_az_iot_message_properties_next_NULL_out_name_fail),
     cmocka_unit_test(test_az_iot_message_properties_next_NULL_out_value_fail),
     cmocka_unit_test(test_az_iot_message_properties_next_written_less_than_size_succeed),
+    cmocka_unit_test(test_az_iot_message_properties_build_index_not_power_of_two_fail),
+    cmocka_unit_test(test_az_iot_message_queue_init_small_buffer_fail),
+    cmocka_unit_test(test_az_iot_message_queue_get_unsent_no_messages_fail),
+    cmocka_unit_test(test_az_iot_retry_policy_init_min_above_max_fail),
 #endif // AZ_NO_PRECONDITION_CHECKING
     cmocka_unit_test(test_az_iot_u32toa_size_success),
+    cmocka_unit_test(test_az_iot_xorshift32_success),
     cmocka_unit_test(test_az_iot_u64toa_size_success),
     cmocka_unit_test(test_az_iot_is_status_succeeded_translate_success),
     cmocka_unit_test(test_az_iot_status_retriable_translate_success),
@@ -799,6 +1384,9 @@ int test_az_iot_common()
     cmocka_unit_test(test_az_iot_calculate_retry_delay_overflow_time_success),
     cmocka_unit_test(test_az_iot_calculate_retry_delay_logging_succeed),
     cmocka_unit_test(test_az_iot_calculate_retry_delay_no_logging_succeed),
+    cmocka_unit_test(test_az_iot_retry_policy_delays_in_range_succeed),
+    cmocka_unit_test(test_az_iot_retry_policy_retry_after_succeed),
+    cmocka_unit_test(test_az_iot_retry_policy_spreads_fleet_succeed),
     cmocka_unit_test(test_az_span_copy_url_encode_succeed),
     cmocka_unit_test(test_az_span_copy_url_encode_insufficient_size_fail),
     cmocka_unit_test(test_az_iot_message_properties_init_succeed),
@@ -822,6 +1410,18 @@ int test_az_iot_common()
     cmocka_unit_test(test_az_iot_message_properties_next_succeed),
     cmocka_unit_test(test_az_iot_message_properties_next_twice_succeed),
     cmocka_unit_test(test_az_iot_message_properties_next_empty_succeed),
+    cmocka_unit_test(test_az_iot_message_properties_build_index_succeed),
+    cmocka_unit_test(test_az_iot_message_properties_build_index_small_index_fail),
+    cmocka_unit_test(test_az_iot_message_properties_build_index_append_succeed),
+    cmocka_unit_test(test_az_iot_message_properties_url_decode_succeed),
+    cmocka_unit_test(test_az_iot_message_properties_url_decode_fail),
+    cmocka_unit_test(test_az_iot_message_payload_compress_round_trip_succeed),
+    cmocka_unit_test(test_az_iot_message_payload_compress_not_smaller_succeed),
+    cmocka_unit_test(test_az_iot_message_payload_decompress_other_encoding_succeed),
+    cmocka_unit_test(test_az_iot_message_queue_send_and_ack_succeed),
+    cmocka_unit_test(test_az_iot_message_queue_rewind_succeed),
+    cmocka_unit_test(test_az_iot_message_queue_wrap_and_recover_succeed),
+    cmocka_unit_test(test_az_iot_message_queue_empty_starts_over_succeed),
   };
   return cmocka_run_group_tests_name("az_iot_common", tests, NULL, NULL);
 }
@@ -23,6 +23,8 @@ int main()
   result += test_az_iot_hub_client_twin();
   result += test_az_iot_hub_client_commands();
   result += test_az_iot_hub_client_properties();
+  result += test_az_iot_hub_client_table();
+  result += test_az_iot_hub_client_request_table();
 
   return result;
 }
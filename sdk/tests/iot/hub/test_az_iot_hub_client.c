@@ -466,6 +466,131 @@ static void test_az_iot_hub_client_get_client_id_module_small_buffer_fail(void**
       AZ_ERROR_NOT_ENOUGH_SPACE);
 }
 
+static void test_az_iot_hub_client_parse_received_topic_any_c2d_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(az_iot_hub_client_init(&client, test_hub_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_received_topic topic;
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(
+          &client,
+          AZ_SPAN_FROM_STR("devices/my_device/messages/devicebound/%24.to=%2Fdevices%2Fmy_device"),
+          &topic),
+      AZ_OK);
+  assert_int_equal(topic.kind, AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_C2D);
+
+  az_span value;
+  assert_int_equal(
+      az_iot_message_properties_find(
+          &topic.parsed.c2d_request.properties, AZ_SPAN_FROM_STR("%24.to"), &value),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("%2Fdevices%2Fmy_device")));
+}
+
+static void test_az_iot_hub_client_parse_received_topic_any_method_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(az_iot_hub_client_init(&client, test_hub_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_received_topic topic;
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(
+          &client, AZ_SPAN_FROM_STR("$iothub/methods/POST/component/reboot/?$rid=1"), &topic),
+      AZ_OK);
+  assert_int_equal(topic.kind, AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_METHOD);
+  assert_true(az_span_is_content_equal(
+      topic.parsed.method_request.name, AZ_SPAN_FROM_STR("component/reboot")));
+  assert_true(az_span_is_content_equal(
+      topic.parsed.method_request.request_id, AZ_SPAN_FROM_STR("1")));
+}
+
+static void test_az_iot_hub_client_parse_received_topic_any_twin_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(az_iot_hub_client_init(&client, test_hub_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_received_topic topic;
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(
+          &client, AZ_SPAN_FROM_STR("$iothub/twin/PATCH/properties/desired/?$version=7"), &topic),
+      AZ_OK);
+  assert_int_equal(topic.kind, AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_TWIN);
+  assert_int_equal(
+      topic.parsed.twin_response.response_type,
+      AZ_IOT_HUB_CLIENT_TWIN_RESPONSE_TYPE_DESIRED_PROPERTIES);
+  assert_true(az_span_is_content_equal(topic.parsed.twin_response.version, AZ_SPAN_FROM_STR("7")));
+}
+
+static void test_az_iot_hub_client_parse_received_topic_any_plug_and_play_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_options options = az_iot_hub_client_options_default();
+  options.model_id = AZ_SPAN_FROM_STR(TEST_MODEL_ID);
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_hub_hostname, test_device_id, &options), AZ_OK);
+
+  az_iot_hub_client_received_topic topic;
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(
+          &client, AZ_SPAN_FROM_STR("$iothub/methods/POST/component*reboot/?$rid=1"), &topic),
+      AZ_OK);
+  assert_int_equal(topic.kind, AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_COMMAND);
+  assert_true(az_span_is_content_equal(
+      topic.parsed.command_request.component_name, AZ_SPAN_FROM_STR("component")));
+  assert_true(az_span_is_content_equal(
+      topic.parsed.command_request.command_name, AZ_SPAN_FROM_STR("reboot")));
+
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(
+          &client, AZ_SPAN_FROM_STR("$iothub/twin/res/204/?$rid=2&$version=16"), &topic),
+      AZ_OK);
+  assert_int_equal(topic.kind, AZ_IOT_HUB_CLIENT_RECEIVED_TOPIC_PROPERTIES);
+  assert_int_equal(
+      topic.parsed.properties_message.message_type,
+      AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_ACKNOWLEDGEMENT);
+  assert_int_equal(topic.parsed.properties_message.status, AZ_IOT_STATUS_NO_CONTENT);
+  assert_true(az_span_is_content_equal(
+      topic.parsed.properties_message.request_id, AZ_SPAN_FROM_STR("2")));
+}
+
+static void test_az_iot_hub_client_parse_received_topic_any_no_match_fail(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(az_iot_hub_client_init(&client, test_hub_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_received_topic topic;
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(
+          &client, AZ_SPAN_FROM_STR("$iothub/unknown/topic"), &topic),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(&client, AZ_SPAN_FROM_STR("$iothub/"), &topic),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(
+          &client, AZ_SPAN_FROM_STR("devices/my_device/messages/events/"), &topic),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(
+          &client, AZ_SPAN_FROM_STR("$iothub/methods/res/200/?$rid=1"), &topic),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_client_parse_received_topic_any(&client, AZ_SPAN_FROM_STR("other"), &topic),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+}
+
 int test_az_iot_hub_client()
 {
 #ifndef AZ_NO_PRECONDITION_CHECKING
@@ -502,6 +627,11 @@ int test_az_iot_hub_client()
     cmocka_unit_test(test_az_iot_hub_client_get_client_id_small_buffer_fail),
     cmocka_unit_test(test_az_iot_hub_client_get_client_id_module_succeed),
     cmocka_unit_test(test_az_iot_hub_client_get_client_id_module_small_buffer_fail),
+    cmocka_unit_test(test_az_iot_hub_client_parse_received_topic_any_c2d_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_parse_received_topic_any_method_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_parse_received_topic_any_twin_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_parse_received_topic_any_plug_and_play_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_parse_received_topic_any_no_match_fail),
   };
   return cmocka_run_group_tests_name("az_iot_hub_client", tests, NULL, NULL);
 }
@@ -181,6 +181,19 @@ static void test_az_iot_hub_client_commands_parse_received_topic_NULL_out_reques
       az_iot_hub_client_commands_parse_received_topic(&client, received_topic, NULL));
 }
 
+static void test_az_iot_hub_client_command_dispatcher_init_index_too_small_fail()
+{
+  az_iot_hub_client_command_dispatcher_entry const entries[] = {
+    { AZ_SPAN_LITERAL_FROM_STR(""), AZ_SPAN_LITERAL_FROM_STR("reboot"), NULL },
+    { AZ_SPAN_LITERAL_FROM_STR(""), AZ_SPAN_LITERAL_FROM_STR("reset"), NULL },
+  };
+  az_iot_hub_client_command_dispatcher dispatcher;
+  int32_t index[4];
+
+  ASSERT_PRECONDITION_CHECKED(
+      az_iot_hub_client_command_dispatcher_init(&dispatcher, entries, 2, index, 3));
+}
+
 #endif // AZ_NO_PRECONDITION_CHECKING
 
 static void test_az_iot_hub_client_commands_response_get_publish_topic_succeed()
@@ -522,6 +535,192 @@ static void test_az_iot_hub_client_commands_logging_succeed()
   az_log_set_message_callback(NULL);
 }
 
+typedef struct
+{
+  int32_t calls[3];
+  az_iot_hub_client_command_request request;
+} test_command_dispatcher_context;
+
+static az_result _test_command_handler(
+    int32_t handler,
+    az_iot_hub_client_command_request const* request,
+    void* user_context)
+{
+  test_command_dispatcher_context* const context = (test_command_dispatcher_context*)user_context;
+  context->calls[handler]++;
+  context->request = *request;
+  return handler == 2 ? AZ_ERROR_NOT_SUPPORTED : AZ_OK;
+}
+
+static az_result _test_command_handler_0(
+    az_iot_hub_client_command_request const* request,
+    void* user_context)
+{
+  return _test_command_handler(0, request, user_context);
+}
+
+static az_result _test_command_handler_1(
+    az_iot_hub_client_command_request const* request,
+    void* user_context)
+{
+  return _test_command_handler(1, request, user_context);
+}
+
+static az_result _test_command_handler_2(
+    az_iot_hub_client_command_request const* request,
+    void* user_context)
+{
+  return _test_command_handler(2, request, user_context);
+}
+
+static void test_az_iot_hub_client_command_dispatcher_dispatch_succeed()
+{
+  static az_iot_hub_client_command_dispatcher_entry const entries[] = {
+    { AZ_SPAN_LITERAL_FROM_STR(""), AZ_SPAN_LITERAL_FROM_STR("reboot"), _test_command_handler_0 },
+    { AZ_SPAN_LITERAL_FROM_STR("thermostat1"),
+      AZ_SPAN_LITERAL_FROM_STR("getMaxMinReport"),
+      _test_command_handler_1 },
+    { AZ_SPAN_LITERAL_FROM_STR("thermostat2"),
+      AZ_SPAN_LITERAL_FROM_STR("getMaxMinReport"),
+      _test_command_handler_2 },
+  };
+  az_iot_hub_client_command_dispatcher dispatcher;
+  int32_t index[8];
+  test_command_dispatcher_context context = { 0 };
+
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_init(&dispatcher, entries, 3, index, 8), AZ_OK);
+
+  az_iot_hub_client_command_request request;
+  request.request_id = AZ_SPAN_FROM_STR("1");
+  request.component_name = AZ_SPAN_FROM_STR("thermostat1");
+  request.command_name = AZ_SPAN_FROM_STR("getMaxMinReport");
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_dispatch(&dispatcher, &request, &context), AZ_OK);
+  assert_int_equal(context.calls[1], 1);
+
+  // The result of the handler is returned.
+  request.component_name = AZ_SPAN_FROM_STR("thermostat2");
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_dispatch(&dispatcher, &request, &context),
+      AZ_ERROR_NOT_SUPPORTED);
+  assert_int_equal(context.calls[2], 1);
+
+  request.component_name = AZ_SPAN_FROM_STR("thermostat3");
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_dispatch(&dispatcher, &request, &context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  request.component_name = AZ_SPAN_EMPTY;
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_dispatch(&dispatcher, &request, &context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // Methods are split into the names of commands.
+  az_iot_hub_client_method_request method_request;
+  method_request.request_id = AZ_SPAN_FROM_STR("2");
+  method_request.name = AZ_SPAN_FROM_STR("reboot");
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_dispatch_method(
+          &dispatcher, &method_request, &context),
+      AZ_OK);
+  assert_int_equal(context.calls[0], 1);
+  assert_true(az_span_is_content_equal(context.request.request_id, AZ_SPAN_FROM_STR("2")));
+  assert_int_equal(az_span_size(context.request.component_name), 0);
+
+  method_request.name = AZ_SPAN_FROM_STR("thermostat1*getMaxMinReport");
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_dispatch_method(
+          &dispatcher, &method_request, &context),
+      AZ_OK);
+  assert_int_equal(context.calls[1], 2);
+  assert_true(
+      az_span_is_content_equal(context.request.component_name, AZ_SPAN_FROM_STR("thermostat1")));
+  assert_true(
+      az_span_is_content_equal(context.request.command_name, AZ_SPAN_FROM_STR("getMaxMinReport")));
+
+  method_request.name = AZ_SPAN_FROM_STR("getMaxMinReport");
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_dispatch_method(
+          &dispatcher, &method_request, &context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+#define TEST_COMMAND_DISPATCHER_ENTRIES 500
+
+static void test_az_iot_hub_client_command_dispatcher_many_entries_succeed()
+{
+  static uint8_t names[TEST_COMMAND_DISPATCHER_ENTRIES][8];
+  static az_iot_hub_client_command_dispatcher_entry entries[TEST_COMMAND_DISPATCHER_ENTRIES];
+  static int32_t index[1024];
+  az_span const components[] = { AZ_SPAN_FROM_STR(""),
+                                 AZ_SPAN_FROM_STR("thermostat1"),
+                                 AZ_SPAN_FROM_STR("thermostat2"),
+                                 AZ_SPAN_FROM_STR("deviceInformation") };
+  az_iot_hub_client_command_dispatcher dispatcher;
+  int32_t entry;
+
+  // Names such as "cmd0017", in each component.
+  for (int32_t i = 0; i < TEST_COMMAND_DISPATCHER_ENTRIES; i++)
+  {
+    az_span name = AZ_SPAN_FROM_BUFFER(names[i]);
+    name = az_span_copy(name, AZ_SPAN_FROM_STR("cmd"));
+    for (int32_t divisor = 1000; divisor > 0; divisor /= 10)
+    {
+      name = az_span_copy_u8(name, (uint8_t)('0' + (i / 4 / divisor) % 10));
+    }
+    entries[i].component_name = components[i % 4];
+    entries[i].command_name = az_span_create(names[i], 7);
+    entries[i].handler = _test_command_handler_0;
+  }
+
+  // The smallest index, with barely more slots than entries.
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_init(
+          &dispatcher, entries, TEST_COMMAND_DISPATCHER_ENTRIES, index, 1024),
+      AZ_OK);
+  for (int32_t i = 0; i < TEST_COMMAND_DISPATCHER_ENTRIES; i++)
+  {
+    assert_int_equal(
+        az_iot_hub_client_command_dispatcher_find(
+            &dispatcher, entries[i].component_name, entries[i].command_name, &entry),
+        AZ_OK);
+    assert_int_equal(entry, i);
+  }
+
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_find(
+          &dispatcher, components[1], AZ_SPAN_FROM_STR("cmd0500"), &entry),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_find(
+          &dispatcher, AZ_SPAN_FROM_STR("thermostat"), AZ_SPAN_FROM_STR("1*cmd0001"), &entry),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // A duplicate makes the hash impossible.
+  entries[TEST_COMMAND_DISPATCHER_ENTRIES - 1] = entries[3];
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_init(
+          &dispatcher, entries, TEST_COMMAND_DISPATCHER_ENTRIES, index, 1024),
+      AZ_ERROR_ARG);
+}
+
+static void test_az_iot_hub_client_command_dispatcher_init_colliding_names_fail()
+{
+  // "costarring" and "liquid" have the same FNV-1a hash.
+  az_iot_hub_client_command_dispatcher_entry const entries[] = {
+    { AZ_SPAN_LITERAL_FROM_STR(""), AZ_SPAN_LITERAL_FROM_STR("costarring"), NULL },
+    { AZ_SPAN_LITERAL_FROM_STR(""), AZ_SPAN_LITERAL_FROM_STR("liquid"), NULL },
+  };
+  az_iot_hub_client_command_dispatcher dispatcher;
+  int32_t index[64];
+
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_init(&dispatcher, entries, 2, index, 64),
+      AZ_ERROR_NOT_SUPPORTED);
+  assert_int_equal(
+      az_iot_hub_client_command_dispatcher_init(&dispatcher, entries, 1, index, 64), AZ_OK);
+}
+
 #ifdef _MSC_VER
 // warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
 #pragma warning(disable : 4113)
@@ -550,6 +749,7 @@ int test_az_iot_hub_client_commands()
     cmocka_unit_test(
         test_az_iot_hub_client_commands_parse_received_topic_AZ_SPAN_NULL_received_topic_fail),
     cmocka_unit_test(test_az_iot_hub_client_commands_parse_received_topic_NULL_out_request_fail),
+    cmocka_unit_test(test_az_iot_hub_client_command_dispatcher_init_index_too_small_fail),
 #endif // AZ_NO_PRECONDITION_CHECKING
     cmocka_unit_test(test_az_iot_hub_client_commands_response_get_publish_topic_succeed),
     cmocka_unit_test(
@@ -570,7 +770,10 @@ int test_az_iot_hub_client_commands()
         test_az_iot_hub_client_commands_parse_received_topic_property_patch_topic_fail),
     cmocka_unit_test(test_az_iot_hub_client_commands_parse_received_topic_topic_filter_fail),
     cmocka_unit_test(test_az_iot_hub_client_commands_parse_received_topic_response_topic_fail),
-    cmocka_unit_test(test_az_iot_hub_client_commands_logging_succeed)
+    cmocka_unit_test(test_az_iot_hub_client_commands_logging_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_command_dispatcher_dispatch_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_command_dispatcher_many_entries_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_command_dispatcher_init_colliding_names_fail),
   };
 
   return cmocka_run_group_tests_name("az_iot_hub_commands", tests, NULL, NULL);
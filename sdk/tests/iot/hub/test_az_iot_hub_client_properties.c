@@ -18,6 +18,7 @@
 #include <stdint.h>
 
 #include <math.h>
+#include <string.h>
 
 #include <cmocka.h>
 
@@ -690,6 +691,84 @@ test_az_iot_hub_client_properties_get_next_component_property_invalid_property_t
       &component_name));
 }
 
+static void test_az_iot_hub_client_properties_cache_add_NULL_cache_fails()
+{
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_properties_cache_add(
+      NULL,
+      AZ_SPAN_EMPTY,
+      AZ_SPAN_FROM_STR("interval"),
+      AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_INT32,
+      NULL));
+}
+
+static void test_az_iot_hub_client_properties_cache_set_wrong_type_fails()
+{
+  az_iot_hub_client_properties_cache_slot slots[1];
+  az_iot_hub_client_properties_cache cache;
+  int32_t slot;
+  assert_int_equal(az_iot_hub_client_properties_cache_init(&cache, slots, 1), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_add(
+          &cache,
+          AZ_SPAN_EMPTY,
+          AZ_SPAN_FROM_STR("interval"),
+          AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_INT32,
+          &slot),
+      AZ_OK);
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_properties_cache_set_bool(&cache, slot, true));
+}
+
+static void test_az_iot_hub_client_properties_index_build_NULL_client_fails()
+{
+  az_iot_hub_client_properties_index index;
+  az_iot_hub_client_properties_index_entry entries[4];
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_properties_index_build(
+      NULL,
+      test_property_payload,
+      AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+      &index,
+      entries,
+      4));
+}
+
+static void test_az_iot_hub_client_properties_build_component_name_index_too_small_fails()
+{
+  az_iot_hub_client client;
+  az_iot_hub_client_options options = az_iot_hub_client_options_default();
+  options.component_names = test_components;
+  options.component_names_length = test_components_length;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, &options), AZ_OK);
+
+  int32_t component_name_index[2];
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_properties_build_component_name_index(
+      &client, component_name_index, 2));
+}
+
+static void test_az_iot_hub_client_properties_apply_writable_patch_NULL_status_fails()
+{
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_json_reader jr;
+  assert_int_equal(az_json_reader_init(&jr, AZ_SPAN_FROM_STR("{\"$version\":1}"), NULL), AZ_OK);
+  uint8_t json_buffer[64];
+  az_json_writer jw;
+  assert_int_equal(az_json_writer_init(&jw, AZ_SPAN_FROM_BUFFER(json_buffer), NULL), AZ_OK);
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_properties_apply_writable_patch(
+      &client,
+      AZ_SPAN_EMPTY,
+      &jr,
+      AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+      &jw,
+      NULL));
+}
+
 #endif // AZ_NO_PRECONDITION_CHECKING
 
 // The values in the enumeration of az_iot_hub_client_properties_message_type must map directly
@@ -1853,6 +1932,700 @@ test_az_iot_hub_client_properties_get_next_component_property_long_with_version_
   test_long_with_version_impl(client, jr);
 }
 
+static void test_az_iot_hub_client_properties_get_next_component_property_name_index_succeed()
+{
+  az_iot_hub_client client;
+  az_iot_hub_client_options options = az_iot_hub_client_options_default();
+  options.component_names = test_components;
+  options.component_names_length = test_components_length;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, &options), AZ_OK);
+
+  int32_t component_name_index[4];
+  assert_int_equal(
+      az_iot_hub_client_properties_build_component_name_index(
+          &client, component_name_index, (int32_t)_az_COUNTOF(component_name_index)),
+      AZ_OK);
+
+  az_json_reader jr;
+  assert_int_equal(az_json_reader_init(&jr, test_property_payload, NULL), AZ_OK);
+
+  az_iot_hub_client_properties_message_type message_type
+      = AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED;
+  az_span component_name;
+
+  test_get_next_component_property(
+      &comp1_prop1_expected,
+      message_type,
+      AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE,
+      &client,
+      &jr,
+      &component_name);
+  test_get_next_component_property(
+      &comp1_prop2_expected,
+      message_type,
+      AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE,
+      &client,
+      &jr,
+      &component_name);
+  test_get_next_component_property(
+      &comp2_prop3_expected,
+      message_type,
+      AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE,
+      &client,
+      &jr,
+      &component_name);
+  test_get_next_component_property(
+      &comp2_prop4_expected,
+      message_type,
+      AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE,
+      &client,
+      &jr,
+      &component_name);
+  test_get_next_component_property(
+      &not_component_expected,
+      message_type,
+      AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE,
+      &client,
+      &jr,
+      &component_name);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_get_next_component_property(
+          &client, &jr, message_type, AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE, &component_name),
+      AZ_ERROR_IOT_END_OF_PROPERTIES);
+}
+
+static void test_index_next_property(
+    az_iot_hub_client_properties_index const* index,
+    az_json_reader* jr,
+    const test_az_properties_expected* expected)
+{
+  assert_int_equal(az_iot_hub_client_properties_index_get_next_property(index, jr), AZ_OK);
+  assert_true(az_json_token_is_text_equal(&jr->token, expected->property_name));
+  assert_int_equal(az_json_reader_next_token(jr), AZ_OK);
+  assert_int_equal(jr->token.kind, expected->token_kind);
+
+  if (jr->token.kind == AZ_JSON_TOKEN_NUMBER)
+  {
+    double d;
+    assert_int_equal(az_json_token_get_double(&jr->token, &d), AZ_OK);
+    assert_true(fabs(d - expected->u.number) < test_max_allowed_double_tolerance);
+  }
+  else if (jr->token.kind == AZ_JSON_TOKEN_STRING)
+  {
+    assert_true(az_json_token_is_text_equal(&jr->token, expected->u.string));
+  }
+
+  assert_int_equal(az_json_reader_skip_children(jr), AZ_OK);
+  assert_int_equal(az_json_reader_next_token(jr), AZ_OK);
+}
+
+static void test_az_iot_hub_client_properties_index_get_response_succeed()
+{
+  az_iot_hub_client client;
+  az_iot_hub_client_options options = az_iot_hub_client_options_default();
+  options.component_names = test_temperature_components;
+  options.component_names_length = test_temperature_components_length;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, &options), AZ_OK);
+
+  az_iot_hub_client_properties_index index;
+  az_iot_hub_client_properties_index_entry entries[4];
+  assert_int_equal(
+      az_iot_hub_client_properties_index_build(
+          &client,
+          test_property_payload_long,
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE,
+          &index,
+          entries,
+          (int32_t)_az_COUNTOF(entries)),
+      AZ_OK);
+
+  az_json_reader jr;
+
+  // Components can be read in any order, and any number of times.
+  for (int32_t i = 0; i < 2; i++)
+  {
+    assert_int_equal(
+        az_iot_hub_client_properties_index_get_reader(
+            &index, AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE, AZ_SPAN_FROM_STR("thermostat1"), &jr),
+        AZ_OK);
+    test_index_next_property(&index, &jr, &thermostat_targetTemperature_expected);
+    assert_int_equal(
+        az_iot_hub_client_properties_index_get_next_property(&index, &jr),
+        AZ_ERROR_IOT_END_OF_PROPERTIES);
+  }
+
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_reader(
+          &index, AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE, AZ_SPAN_FROM_STR("thermostat2"), &jr),
+      AZ_OK);
+  test_index_next_property(&index, &jr, &thermostat2_targetTemperature_expected);
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_next_property(&index, &jr),
+      AZ_ERROR_IOT_END_OF_PROPERTIES);
+
+  // The root component skips the components and the version.
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_reader(
+          &index, AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE, AZ_SPAN_EMPTY, &jr),
+      AZ_OK);
+  test_index_next_property(&index, &jr, &not_component_targetTemperature_expected);
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_next_property(&index, &jr),
+      AZ_ERROR_IOT_END_OF_PROPERTIES);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_reader(
+          &index, AZ_IOT_HUB_CLIENT_PROPERTY_REPORTED_FROM_DEVICE, AZ_SPAN_EMPTY, &jr),
+      AZ_OK);
+  test_index_next_property(&index, &jr, &manufacturer_expected);
+  test_index_next_property(&index, &jr, &model_expected);
+  test_index_next_property(&index, &jr, &swVersion_expected);
+  test_index_next_property(&index, &jr, &osName_expected);
+
+  int32_t remaining = 0;
+  while (az_result_succeeded(az_iot_hub_client_properties_index_get_next_property(&index, &jr)))
+  {
+    assert_int_equal(az_json_reader_next_token(&jr), AZ_OK);
+    assert_int_equal(az_json_reader_next_token(&jr), AZ_OK);
+    remaining++;
+  }
+  assert_int_equal(remaining, 4);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_reader(
+          &index,
+          AZ_IOT_HUB_CLIENT_PROPERTY_REPORTED_FROM_DEVICE,
+          AZ_SPAN_FROM_STR("thermostat1"),
+          &jr),
+      AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+static void test_az_iot_hub_client_properties_index_writable_updated_succeed()
+{
+  az_iot_hub_client client;
+  az_iot_hub_client_options options = az_iot_hub_client_options_default();
+  options.component_names = test_components;
+  options.component_names_length = test_components_length;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, &options), AZ_OK);
+
+  int32_t component_name_index[4];
+  assert_int_equal(
+      az_iot_hub_client_properties_build_component_name_index(
+          &client, component_name_index, (int32_t)_az_COUNTOF(component_name_index)),
+      AZ_OK);
+
+  az_iot_hub_client_properties_index index;
+  az_iot_hub_client_properties_index_entry entries[3];
+  assert_int_equal(
+      az_iot_hub_client_properties_index_build(
+          &client,
+          test_property_payload_with_user_object,
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          &index,
+          entries,
+          (int32_t)_az_COUNTOF(entries)),
+      AZ_OK);
+
+  az_json_reader jr;
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_reader(
+          &index, AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE, AZ_SPAN_FROM_STR("component_two"), &jr),
+      AZ_OK);
+  test_index_next_property(&index, &jr, &comp2_prop3_expected);
+  test_index_next_property(&index, &jr, &comp2_prop4_expected);
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_next_property(&index, &jr),
+      AZ_ERROR_IOT_END_OF_PROPERTIES);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_reader(
+          &index, AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE, AZ_SPAN_FROM_STR("component_one"), &jr),
+      AZ_OK);
+  test_index_next_property(&index, &jr, &comp1_prop1_expected);
+  test_index_next_property(&index, &jr, &comp1_prop2_user_object_expected);
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_next_property(&index, &jr),
+      AZ_ERROR_IOT_END_OF_PROPERTIES);
+
+  // A value left unread is an error.
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_reader(
+          &index, AZ_IOT_HUB_CLIENT_PROPERTY_WRITABLE, AZ_SPAN_EMPTY, &jr),
+      AZ_OK);
+  assert_int_equal(az_iot_hub_client_properties_index_get_next_property(&index, &jr), AZ_OK);
+  assert_true(az_json_token_is_text_equal(&jr.token, AZ_SPAN_FROM_STR("not_component")));
+  assert_int_equal(az_json_reader_next_token(&jr), AZ_OK);
+  assert_int_equal(az_json_reader_next_token(&jr), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_next_property(&index, &jr),
+      AZ_ERROR_JSON_INVALID_STATE);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_index_get_reader(
+          &index, AZ_IOT_HUB_CLIENT_PROPERTY_REPORTED_FROM_DEVICE, AZ_SPAN_EMPTY, &jr),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_index_build(
+          &client,
+          test_property_payload_with_user_object,
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          &index,
+          entries,
+          2),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+typedef struct
+{
+  az_iot_hub_client client;
+  az_iot_hub_client_properties_cache_slot slots[4];
+  az_iot_hub_client_properties_cache cache;
+  int32_t interval;
+  int32_t temperature;
+  int32_t state;
+  int32_t on;
+  char json_buffer[256];
+} test_properties_cache;
+
+static void _test_properties_cache_init(test_properties_cache* test)
+{
+  assert_int_equal(
+      az_iot_hub_client_init(&test->client, test_device_hostname, test_device_id, NULL), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_init(
+          &test->cache, test->slots, (int32_t)_az_COUNTOF(test->slots)),
+      AZ_OK);
+
+  // The properties of a component aren't registered together, but are written together.
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_add(
+          &test->cache,
+          AZ_SPAN_EMPTY,
+          AZ_SPAN_FROM_STR("interval"),
+          AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_INT32,
+          &test->interval),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_add(
+          &test->cache,
+          test_component_one,
+          AZ_SPAN_FROM_STR("temperature"),
+          AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_DOUBLE,
+          &test->temperature),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_add(
+          &test->cache,
+          AZ_SPAN_FROM_STR("component_two"),
+          AZ_SPAN_FROM_STR("on"),
+          AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_BOOL,
+          &test->on),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_add(
+          &test->cache,
+          test_component_one,
+          AZ_SPAN_FROM_STR("state"),
+          AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_STRING,
+          &test->state),
+      AZ_OK);
+}
+
+static az_result _test_properties_cache_write_patch(test_properties_cache* test, az_span request_id)
+{
+  az_json_writer jw;
+  memset(test->json_buffer, 0, sizeof(test->json_buffer));
+  assert_int_equal(
+      az_json_writer_init(
+          &jw,
+          az_span_create((uint8_t*)test->json_buffer, (int32_t)sizeof(test->json_buffer) - 1),
+          NULL),
+      AZ_OK);
+  return az_iot_hub_client_properties_cache_write_patch(
+      &test->cache, &test->client, &jw, request_id);
+}
+
+static void test_az_iot_hub_client_properties_cache_write_patch_succeed()
+{
+  test_properties_cache test;
+  _test_properties_cache_init(&test);
+
+  assert_false(az_iot_hub_client_properties_cache_has_changes(&test.cache));
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("1")), AZ_OK);
+  assert_string_equal(test.json_buffer, "{}");
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("1"), AZ_IOT_STATUS_NO_CONTENT),
+      AZ_OK);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_int32(&test.cache, test.interval, 10), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_double(&test.cache, test.temperature, 21.5, 1), AZ_OK);
+  assert_int_equal(az_iot_hub_client_properties_cache_set_bool(&test.cache, test.on, true), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_string(
+          &test.cache, test.state, AZ_SPAN_FROM_STR("ok")),
+      AZ_OK);
+  assert_true(az_iot_hub_client_properties_cache_has_changes(&test.cache));
+
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("2")), AZ_OK);
+  assert_string_equal(
+      test.json_buffer,
+      "{\"interval\":10,\"component_one\":{\"__t\":\"c\",\"temperature\":21.5,\"state\":\"ok\"},"
+      "\"component_two\":{\"__t\":\"c\",\"on\":true}}");
+  assert_false(az_iot_hub_client_properties_cache_has_changes(&test.cache));
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("2"), AZ_IOT_STATUS_NO_CONTENT),
+      AZ_OK);
+
+  // Setting the same values changes nothing.
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_int32(&test.cache, test.interval, 10), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_double(&test.cache, test.temperature, 21.5, 1), AZ_OK);
+  assert_int_equal(az_iot_hub_client_properties_cache_set_bool(&test.cache, test.on, true), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_string(
+          &test.cache, test.state, AZ_SPAN_FROM_STR("ok")),
+      AZ_OK);
+  assert_false(az_iot_hub_client_properties_cache_has_changes(&test.cache));
+
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_double(&test.cache, test.temperature, 22.25, 2),
+      AZ_OK);
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("3")), AZ_OK);
+  assert_string_equal(
+      test.json_buffer, "{\"component_one\":{\"__t\":\"c\",\"temperature\":22.25}}");
+}
+
+static void test_az_iot_hub_client_properties_cache_ack_failure_succeed()
+{
+  test_properties_cache test;
+  _test_properties_cache_init(&test);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_int32(&test.cache, test.interval, 10), AZ_OK);
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("1")), AZ_OK);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("2"), AZ_IOT_STATUS_NO_CONTENT),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("1"), AZ_IOT_STATUS_SERVER_ERROR),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("1"), AZ_IOT_STATUS_NO_CONTENT),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // The rejected update is sent again.
+  assert_true(az_iot_hub_client_properties_cache_has_changes(&test.cache));
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("2")), AZ_OK);
+  assert_string_equal(test.json_buffer, "{\"interval\":10}");
+}
+
+static void test_az_iot_hub_client_properties_cache_superseded_patch_succeed()
+{
+  test_properties_cache test;
+  _test_properties_cache_init(&test);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_int32(&test.cache, test.interval, 10), AZ_OK);
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("1")), AZ_OK);
+
+  // Without a response to the first payload, the second one carries its properties too.
+  assert_int_equal(az_iot_hub_client_properties_cache_set_bool(&test.cache, test.on, false), AZ_OK);
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("2")), AZ_OK);
+  assert_string_equal(
+      test.json_buffer, "{\"interval\":10,\"component_two\":{\"__t\":\"c\",\"on\":false}}");
+
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("1"), AZ_IOT_STATUS_NO_CONTENT),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("2"), AZ_IOT_STATUS_NO_CONTENT),
+      AZ_OK);
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("3")), AZ_OK);
+  assert_string_equal(test.json_buffer, "{}");
+}
+
+static void test_az_iot_hub_client_properties_cache_string_in_place_succeed()
+{
+  test_properties_cache test;
+  _test_properties_cache_init(&test);
+
+  char state_buffer[] = "idle";
+  az_span const state = AZ_SPAN_FROM_BUFFER(state_buffer);
+  az_span const state_value = az_span_slice(state, 0, 4);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_string(&test.cache, test.state, state_value), AZ_OK);
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("1")), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("1"), AZ_IOT_STATUS_NO_CONTENT),
+      AZ_OK);
+
+  az_span_copy(state, AZ_SPAN_FROM_STR("busy"));
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_string(&test.cache, test.state, state_value), AZ_OK);
+  assert_true(az_iot_hub_client_properties_cache_has_changes(&test.cache));
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("2")), AZ_OK);
+  assert_string_equal(test.json_buffer, "{\"component_one\":{\"__t\":\"c\",\"state\":\"busy\"}}");
+}
+
+static void test_az_iot_hub_client_properties_cache_invalidate_succeed()
+{
+  test_properties_cache test;
+  _test_properties_cache_init(&test);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_int32(&test.cache, test.interval, 10), AZ_OK);
+  assert_int_equal(az_iot_hub_client_properties_cache_set_bool(&test.cache, test.on, true), AZ_OK);
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("1")), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("1"), AZ_IOT_STATUS_NO_CONTENT),
+      AZ_OK);
+
+  // Only the properties which have a value are written again.
+  az_iot_hub_client_properties_cache_invalidate(&test.cache);
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("2")), AZ_OK);
+  assert_string_equal(
+      test.json_buffer, "{\"interval\":10,\"component_two\":{\"__t\":\"c\",\"on\":true}}");
+}
+
+static void test_az_iot_hub_client_properties_cache_not_enough_space_fails()
+{
+  test_properties_cache test;
+  _test_properties_cache_init(&test);
+
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_add(
+          &test.cache,
+          AZ_SPAN_EMPTY,
+          AZ_SPAN_FROM_STR("extra"),
+          AZ_IOT_HUB_CLIENT_PROPERTIES_CACHE_INT32,
+          NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  uint8_t long_state[sizeof(test.json_buffer)];
+  memset(long_state, 'a', sizeof(long_state));
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_string(
+          &test.cache, test.state, AZ_SPAN_FROM_BUFFER(long_state)),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_int32(&test.cache, test.interval, 10), AZ_OK);
+  assert_int_equal(
+      _test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("1")), AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(
+      _test_properties_cache_write_patch(
+          &test, AZ_SPAN_FROM_STR("0123456789012345678901234567890123456")),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // Nothing was sent, so nothing waits for a response and everything is still to be written.
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_ack(
+          &test.cache, AZ_SPAN_FROM_STR("1"), AZ_IOT_STATUS_NO_CONTENT),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_properties_cache_set_string(
+          &test.cache, test.state, AZ_SPAN_FROM_STR("ok")),
+      AZ_OK);
+  assert_int_equal(_test_properties_cache_write_patch(&test, AZ_SPAN_FROM_STR("1")), AZ_OK);
+  assert_string_equal(
+      test.json_buffer, "{\"interval\":10,\"component_one\":{\"__t\":\"c\",\"state\":\"ok\"}}");
+}
+
+static az_result _test_apply_writable_patch(
+    char* desired_properties,
+    char* payload,
+    az_iot_hub_client_properties_message_type message_type,
+    char* json_buffer,
+    int32_t json_buffer_size,
+    az_iot_hub_client_properties_patch_status* out_status)
+{
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_json_reader jr;
+  assert_int_equal(az_json_reader_init(&jr, az_span_create_from_str(payload), NULL), AZ_OK);
+  az_json_writer jw;
+  assert_int_equal(
+      az_json_writer_init(
+          &jw, az_span_create((uint8_t*)json_buffer, json_buffer_size - 1), NULL),
+      AZ_OK);
+
+  az_result const result = az_iot_hub_client_properties_apply_writable_patch(
+      &client,
+      az_span_create_from_str(desired_properties),
+      &jr,
+      message_type,
+      &jw,
+      out_status);
+  json_buffer[az_span_size(az_json_writer_get_bytes_used_in_destination(&jw))] = '\0';
+  return result;
+}
+
+static void test_az_iot_hub_client_properties_apply_writable_patch_succeed()
+{
+  char json_buffer[256];
+  az_iot_hub_client_properties_patch_status status;
+
+  // Nulls remove members, even inside objects, but not inside arrays, which are replaced whole.
+  assert_int_equal(
+      _test_apply_writable_patch(
+          "{\"interval\":5,\"limits\":{\"low\":1,\"high\":9},\"mode\":\"eco\",\"$version\":3}",
+          "{\"mode\":null,\"limits\":{\"high\":7,\"unit\":{\"c\":true,\"f\":null}},"
+          "\"name\":\"a\\\"b\",\"tags\":[1,null],\"$version\":4}",
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_OK);
+  assert_int_equal(status, AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED);
+  assert_string_equal(
+      json_buffer,
+      "{\"interval\":5,\"limits\":{\"low\":1,\"high\":7,\"unit\":{\"c\":true}},"
+      "\"name\":\"a\\\"b\",\"tags\":[1,null],\"$version\":4}");
+
+  // A value replaces an object, and an object replaces a value.
+  assert_int_equal(
+      _test_apply_writable_patch(
+          "{\"$version\":1,\"a\":{\"b\":1},\"c\":2}",
+          "{\"a\":3,\"c\":{\"d\":null,\"e\":4},\"$version\":2}",
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_OK);
+  assert_int_equal(status, AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED);
+  assert_string_equal(json_buffer, "{\"a\":3,\"c\":{\"e\":4},\"$version\":2}");
+
+  // Names are matched whether they are escaped or not, and written as the writer escapes them.
+  assert_int_equal(
+      _test_apply_writable_patch(
+          "{\"a\\tb\":1,\"c/d\":5,\"$version\":1}",
+          "{\"a\\tb\":2,\"c\\/d\":null,\"e\\/f\":3,\"$version\":2}",
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_OK);
+  assert_int_equal(status, AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED);
+  assert_string_equal(json_buffer, "{\"a\\tb\":2,\"e/f\":3,\"$version\":2}");
+}
+
+static void test_az_iot_hub_client_properties_apply_writable_patch_version_order_succeed()
+{
+  char json_buffer[128];
+  az_iot_hub_client_properties_patch_status status;
+  char* const desired_properties = "{\"a\":1,\"$version\":3}";
+
+  // A patch delivered again is ignored.
+  assert_int_equal(
+      _test_apply_writable_patch(
+          desired_properties,
+          "{\"a\":2,\"$version\":3}",
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_OK);
+  assert_int_equal(status, AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_STALE);
+  assert_string_equal(json_buffer, "");
+
+  // A patch after a missed one is applied, and reported as such.
+  assert_int_equal(
+      _test_apply_writable_patch(
+          desired_properties,
+          "{\"b\":2,\"$version\":5}",
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_OK);
+  assert_int_equal(status, AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED_AFTER_GAP);
+  assert_string_equal(json_buffer, "{\"a\":1,\"b\":2,\"$version\":5}");
+
+  // Without desired properties, only the first version follows.
+  assert_int_equal(
+      _test_apply_writable_patch(
+          "",
+          "{\"b\":null,\"$version\":1}",
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_OK);
+  assert_int_equal(status, AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED);
+  assert_string_equal(json_buffer, "{\"$version\":1}");
+
+  // The properties document replaces the desired properties when it is newer.
+  char* const document
+      = "{\"desired\":{\"b\":{\"c\":null},\"$version\":7},\"reported\":{\"d\":1,\"$version\":2}}";
+  assert_int_equal(
+      _test_apply_writable_patch(
+          desired_properties,
+          document,
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_OK);
+  assert_int_equal(status, AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_APPLIED);
+  assert_string_equal(json_buffer, "{\"b\":{},\"$version\":7}");
+
+  assert_int_equal(
+      _test_apply_writable_patch(
+          "{\"$version\":7}",
+          document,
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_OK);
+  assert_int_equal(status, AZ_IOT_HUB_CLIENT_PROPERTIES_PATCH_STALE);
+}
+
+static void test_az_iot_hub_client_properties_apply_writable_patch_fails()
+{
+  char json_buffer[16];
+  az_iot_hub_client_properties_patch_status status;
+
+  assert_int_equal(
+      _test_apply_writable_patch(
+          "{\"$version\":1}",
+          "{\"a\":2}",
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      _test_apply_writable_patch(
+          "{\"$version\":1}",
+          "{\"a\":\"0123456789\",\"$version\":2}",
+          AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_WRITABLE_UPDATED,
+          json_buffer,
+          (int32_t)sizeof(json_buffer),
+          &status),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
 #ifdef _MSC_VER
 // warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
 #pragma warning(disable : 4113)
@@ -1907,6 +2680,12 @@ int test_az_iot_hub_client_properties()
         test_az_iot_hub_client_properties_get_next_component_property_invalid_message_type_fails),
     cmocka_unit_test(
         test_az_iot_hub_client_properties_get_next_component_property_invalid_property_type_fails),
+    cmocka_unit_test(test_az_iot_hub_client_properties_index_build_NULL_client_fails),
+    cmocka_unit_test(
+        test_az_iot_hub_client_properties_build_component_name_index_too_small_fails),
+    cmocka_unit_test(test_az_iot_hub_client_properties_cache_add_NULL_cache_fails),
+    cmocka_unit_test(test_az_iot_hub_client_properties_cache_set_wrong_type_fails),
+    cmocka_unit_test(test_az_iot_hub_client_properties_apply_writable_patch_NULL_status_fails),
 #endif // AZ_NO_PRECONDITION_CHECKING
     cmocka_unit_test(test_az_iot_hub_client_properties_enums_equal),
     cmocka_unit_test(test_az_iot_hub_client_properties_document_get_publish_topic_succeed),
@@ -1956,6 +2735,19 @@ int test_az_iot_hub_client_properties()
     cmocka_unit_test(
         test_az_iot_hub_client_properties_writer_begin_response_status_with_component_multiple_values_succeed),
     cmocka_unit_test(test_az_iot_hub_client_properties_writer_end_response_status_succeed),
+    cmocka_unit_test(
+        test_az_iot_hub_client_properties_get_next_component_property_name_index_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_index_get_response_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_index_writable_updated_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_cache_write_patch_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_cache_ack_failure_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_cache_superseded_patch_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_cache_string_in_place_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_cache_invalidate_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_cache_not_enough_space_fails),
+    cmocka_unit_test(test_az_iot_hub_client_properties_apply_writable_patch_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_apply_writable_patch_version_order_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_apply_writable_patch_fails),
   };
 
   return cmocka_run_group_tests_name("az_iot_hub_client_property", tests, NULL, NULL);
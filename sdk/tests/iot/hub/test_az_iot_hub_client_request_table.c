@@ -0,0 +1,218 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_hub_client.h"
+#include <az_test_precondition.h>
+#include <azure/core/az_context.h>
+#include <azure/core/az_precondition.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/iot/az_iot_hub_client.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#define TEST_REQUEST_TABLE_CAPACITY 4
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+ENABLE_PRECONDITION_CHECK_TESTS()
+
+static void test_az_iot_hub_client_request_table_init_capacity_not_power_of_two_fails()
+{
+  az_iot_hub_client_request_table table;
+  az_iot_hub_client_request_table_entry entries[3];
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_request_table_init(&table, entries, 3));
+}
+
+static void test_az_iot_hub_client_request_table_add_small_buffer_fails()
+{
+  az_iot_hub_client_request_table table;
+  az_iot_hub_client_request_table_entry entries[TEST_REQUEST_TABLE_CAPACITY];
+  uint8_t request_id_buffer[AZ_IOT_HUB_CLIENT_REQUEST_ID_MAX_SIZE - 1];
+  az_span request_id;
+  assert_int_equal(
+      az_iot_hub_client_request_table_init(&table, entries, TEST_REQUEST_TABLE_CAPACITY), AZ_OK);
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_request_table_add(
+      &table, NULL, NULL, AZ_SPAN_FROM_BUFFER(request_id_buffer), &request_id));
+}
+
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+static void test_az_iot_hub_client_request_table_add_and_remove_succeed()
+{
+  az_iot_hub_client_request_table table;
+  az_iot_hub_client_request_table_entry entries[TEST_REQUEST_TABLE_CAPACITY];
+  uint8_t request_id_buffers[TEST_REQUEST_TABLE_CAPACITY][AZ_IOT_HUB_CLIENT_REQUEST_ID_MAX_SIZE];
+  az_span request_ids[TEST_REQUEST_TABLE_CAPACITY];
+  int user_contexts[TEST_REQUEST_TABLE_CAPACITY];
+  void* user_context;
+  az_span request_id;
+
+  assert_int_equal(
+      az_iot_hub_client_request_table_init(&table, entries, TEST_REQUEST_TABLE_CAPACITY), AZ_OK);
+
+  for (int32_t i = 0; i < TEST_REQUEST_TABLE_CAPACITY; i++)
+  {
+    assert_int_equal(
+        az_iot_hub_client_request_table_add(
+            &table,
+            NULL,
+            &user_contexts[i],
+            AZ_SPAN_FROM_BUFFER(request_id_buffers[i]),
+            &request_ids[i]),
+        AZ_OK);
+  }
+  assert_true(az_span_is_content_equal(request_ids[0], AZ_SPAN_FROM_STR("1")));
+  assert_true(az_span_is_content_equal(request_ids[3], AZ_SPAN_FROM_STR("4")));
+
+  uint8_t request_id_buffer[AZ_IOT_HUB_CLIENT_REQUEST_ID_MAX_SIZE];
+  assert_int_equal(
+      az_iot_hub_client_request_table_add(
+          &table, NULL, NULL, AZ_SPAN_FROM_BUFFER(request_id_buffer), &request_id),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // Responses can come in any order.
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, request_ids[2], &user_context), AZ_OK);
+  assert_ptr_equal(user_context, &user_contexts[2]);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, request_ids[2], &user_context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, request_ids[0], &user_context), AZ_OK);
+  assert_ptr_equal(user_context, &user_contexts[0]);
+
+  // New IDs skip the entries still in flight, and never repeat those of the freed entries.
+  assert_int_equal(
+      az_iot_hub_client_request_table_add(
+          &table, NULL, NULL, AZ_SPAN_FROM_BUFFER(request_id_buffer), &request_id),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(request_id, AZ_SPAN_FROM_STR("5")));
+  assert_int_equal(
+      az_iot_hub_client_request_table_add(
+          &table, NULL, NULL, AZ_SPAN_FROM_BUFFER(request_id_buffer), &request_id),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(request_id, AZ_SPAN_FROM_STR("7")));
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, AZ_SPAN_FROM_STR("3"), NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_iot_hub_client_request_table_remove(&table, request_id, NULL), AZ_OK);
+}
+
+static void test_az_iot_hub_client_request_table_remove_unknown_fails()
+{
+  az_iot_hub_client_request_table table;
+  az_iot_hub_client_request_table_entry entries[TEST_REQUEST_TABLE_CAPACITY];
+  uint8_t request_id_buffer[AZ_IOT_HUB_CLIENT_REQUEST_ID_MAX_SIZE];
+  az_span request_id;
+
+  assert_int_equal(
+      az_iot_hub_client_request_table_init(&table, entries, TEST_REQUEST_TABLE_CAPACITY), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_request_table_add(
+          &table, NULL, NULL, AZ_SPAN_FROM_BUFFER(request_id_buffer), &request_id),
+      AZ_OK);
+
+  // Only the exact digits of the ID match.
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, AZ_SPAN_EMPTY, NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, AZ_SPAN_FROM_STR("01"), NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, AZ_SPAN_FROM_STR("+1"), NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, AZ_SPAN_FROM_STR("4294967297"), NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, AZ_SPAN_FROM_STR("my-request"), NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, AZ_SPAN_FROM_STR("1"), NULL), AZ_OK);
+}
+
+static void test_az_iot_hub_client_request_table_remove_expired_succeed()
+{
+  az_iot_hub_client_request_table table;
+  az_iot_hub_client_request_table_entry entries[TEST_REQUEST_TABLE_CAPACITY];
+  uint8_t request_id_buffer[AZ_IOT_HUB_CLIENT_REQUEST_ID_MAX_SIZE];
+  az_span request_id;
+  az_span late_request_id;
+  int user_contexts[3];
+  void* user_context;
+
+  az_context early = az_context_create_with_expiration(&az_context_application, 1000);
+  az_context late = az_context_create_with_expiration(&az_context_application, 2000);
+
+  assert_int_equal(
+      az_iot_hub_client_request_table_init(&table, entries, TEST_REQUEST_TABLE_CAPACITY), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_request_table_add(
+          &table, NULL, &user_contexts[0], AZ_SPAN_FROM_BUFFER(request_id_buffer), &request_id),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_request_table_add(
+          &table, &late, &user_contexts[1], AZ_SPAN_FROM_BUFFER(request_id_buffer), &request_id),
+      AZ_OK);
+  late_request_id = request_id;
+  assert_int_equal(
+      az_iot_hub_client_request_table_add(
+          &table, &early, &user_contexts[2], AZ_SPAN_FROM_BUFFER(request_id_buffer), &request_id),
+      AZ_OK);
+
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove_expired(&table, 1000, &user_context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove_expired(&table, 1001, &user_context), AZ_OK);
+  assert_ptr_equal(user_context, &user_contexts[2]);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove_expired(&table, 1001, &user_context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // A canceled context expires its request right away.
+  az_context_cancel(&late);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove_expired(&table, 1001, &user_context), AZ_OK);
+  assert_ptr_equal(user_context, &user_contexts[1]);
+
+  // The response of a timed out request no longer matches.
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove(&table, late_request_id, NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_request_table_remove_expired(&table, INT64_MAX, NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+#ifdef _MSC_VER
+// warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
+#pragma warning(disable : 4113)
+#endif
+
+int test_az_iot_hub_client_request_table()
+{
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  SETUP_PRECONDITION_CHECK_TESTS();
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+  const struct CMUnitTest tests[] = {
+#ifndef AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(test_az_iot_hub_client_request_table_init_capacity_not_power_of_two_fails),
+    cmocka_unit_test(test_az_iot_hub_client_request_table_add_small_buffer_fails),
+#endif // AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(test_az_iot_hub_client_request_table_add_and_remove_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_request_table_remove_unknown_fails),
+    cmocka_unit_test(test_az_iot_hub_client_request_table_remove_expired_succeed),
+  };
+
+  return cmocka_run_group_tests_name("az_iot_hub_client_request_table", tests, NULL, NULL);
+}
@@ -33,6 +33,7 @@ static const az_span test_device_id = AZ_SPAN_LITERAL_FROM_STR(TEST_DEVICE_ID_ST
 static const az_span test_module_id = AZ_SPAN_LITERAL_FROM_STR(TEST_MODULE_ID_STR);
 static const uint32_t test_sas_expiry_time_secs = 1578941692;
 static const az_span test_signature = AZ_SPAN_LITERAL_FROM_STR(TEST_SIG);
+static const az_span test_sas_key = AZ_SPAN_LITERAL_FROM_STR("dGVzdGtleQ==");
 
 #ifndef AZ_NO_PRECONDITION_CHECKING
 ENABLE_PRECONDITION_CHECK_TESTS()
@@ -121,6 +122,37 @@ static void az_iot_hub_client_sas_get_password_empty_password_buffer_span_fails(
       &client, test_sas_expiry_time_secs, test_signature, key_name, password, 0, &length));
 }
 
+static void az_iot_sas_token_manager_init_NULL_manager_fails()
+{
+  az_iot_hub_client client;
+  assert_true(az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL) == AZ_OK);
+
+  uint8_t password_buffer[TEST_SPAN_BUFFER_SIZE];
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_sas_token_manager_init(
+      NULL, &client, test_sas_key, AZ_SPAN_FROM_BUFFER(password_buffer), NULL));
+}
+
+static void az_iot_sas_token_manager_init_margin_too_large_fails()
+{
+  az_iot_hub_client client;
+  assert_true(az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL) == AZ_OK);
+
+  uint8_t password_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_iot_sas_token_manager manager;
+  az_iot_sas_token_manager_options options = az_iot_sas_token_manager_options_default();
+  options.renewal_margin_seconds = options.token_duration_seconds - options.renewal_jitter_seconds;
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_sas_token_manager_init(
+      &manager, &client, test_sas_key, AZ_SPAN_FROM_BUFFER(password_buffer), &options));
+}
+
+static void az_iot_sas_token_manager_generate_NULL_manager_fails()
+{
+  ASSERT_PRECONDITION_CHECKED(
+      az_iot_sas_token_manager_generate(NULL, test_sas_expiry_time_secs, 0));
+}
+
 #endif // AZ_NO_PRECONDITION_CHECKING
 
 static void az_iot_hub_client_sas_get_signature_device_succeeds()
@@ -501,6 +533,192 @@ static void test_az_iot_hub_client_sas_no_logging_succeed()
   az_log_set_classification_filter_callback(NULL);
 }
 
+static void az_iot_sas_token_manager_generate_succeeds()
+{
+  az_iot_hub_client client;
+  assert_true(az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL) == AZ_OK);
+
+  uint8_t password_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_iot_sas_token_manager manager;
+  az_span password;
+  assert_int_equal(
+      az_iot_sas_token_manager_init(
+          &manager, &client, test_sas_key, AZ_SPAN_FROM_BUFFER(password_buffer), NULL),
+      AZ_OK);
+
+  assert_true(az_iot_sas_token_manager_needs_renewal(&manager, 0));
+  assert_int_equal(
+      az_iot_sas_token_manager_get_password(&manager, &password), AZ_ERROR_ITEM_NOT_FOUND);
+
+  assert_int_equal(
+      az_iot_sas_token_manager_generate(&manager, test_sas_expiry_time_secs, 1000), AZ_OK);
+  assert_int_equal(az_iot_sas_token_manager_get_password(&manager, &password), AZ_OK);
+  assert_true(az_span_is_content_equal(
+      password,
+      AZ_SPAN_FROM_STR("SharedAccessSignature "
+                       "sr=myiothub.azure-devices.net%2Fdevices%2Fmy_device"
+                       "&sig=%2FijbvnEKfCKTAX3dg7esWBRu2crV8UM%2Fq3ooVrzvgfI%3D&se=1578945292")));
+  assert_int_equal(password_buffer[az_span_size(password)], '\0');
+
+  // Renewing rewrites the signature and the expiration time in place.
+  assert_int_equal(
+      az_iot_sas_token_manager_generate(&manager, test_sas_expiry_time_secs + 3600, 3601000),
+      AZ_OK);
+  assert_int_equal(az_iot_sas_token_manager_get_password(&manager, &password), AZ_OK);
+  assert_true(az_span_is_content_equal(
+      password,
+      AZ_SPAN_FROM_STR("SharedAccessSignature "
+                       "sr=myiothub.azure-devices.net%2Fdevices%2Fmy_device"
+                       "&sig=%2Bi0mW6rQS8XsccO9XVX9mTHVpo%2FU7CHuoc67Z8YP6d4%3D&se=1578948892")));
+  assert_int_equal(password_buffer[az_span_size(password)], '\0');
+}
+
+static void az_iot_sas_token_manager_generate_with_keyname_succeeds()
+{
+  az_iot_hub_client client;
+  assert_true(az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL) == AZ_OK);
+
+  uint8_t password_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_iot_sas_token_manager manager;
+  az_iot_sas_token_manager_options options = az_iot_sas_token_manager_options_default();
+  options.key_name = AZ_SPAN_FROM_STR(TEST_KEY_NAME);
+  az_span password;
+  assert_int_equal(
+      az_iot_sas_token_manager_init(
+          &manager, &client, test_sas_key, AZ_SPAN_FROM_BUFFER(password_buffer), &options),
+      AZ_OK);
+
+  for (int32_t i = 0; i < 2; i++)
+  {
+    assert_int_equal(
+        az_iot_sas_token_manager_generate(&manager, test_sas_expiry_time_secs, 0), AZ_OK);
+    assert_int_equal(az_iot_sas_token_manager_get_password(&manager, &password), AZ_OK);
+    assert_true(az_span_is_content_equal(
+        password,
+        AZ_SPAN_FROM_STR("SharedAccessSignature "
+                         "sr=myiothub.azure-devices.net%2Fdevices%2Fmy_device"
+                         "&sig=%2FijbvnEKfCKTAX3dg7esWBRu2crV8UM%2Fq3ooVrzvgfI%3D&se=1578945292"
+                         "&skn=" TEST_KEY_NAME)));
+  }
+}
+
+static void az_iot_sas_token_manager_renewal_deadline_succeeds()
+{
+  az_iot_hub_client client;
+  assert_true(az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL) == AZ_OK);
+
+  uint8_t password_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_iot_sas_token_manager manager;
+  int64_t deadline = 0;
+  assert_int_equal(
+      az_iot_sas_token_manager_init(
+          &manager, &client, test_sas_key, AZ_SPAN_FROM_BUFFER(password_buffer), NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_sas_token_manager_get_renewal_deadline(&manager, &deadline),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  int64_t clock_msec = 5000;
+  for (int32_t i = 0; i < 20; i++)
+  {
+    assert_int_equal(
+        az_iot_sas_token_manager_generate(&manager, test_sas_expiry_time_secs, clock_msec),
+        AZ_OK);
+    assert_int_equal(az_iot_sas_token_manager_get_renewal_deadline(&manager, &deadline), AZ_OK);
+
+    // Between 15 and 10 minutes before the hour long token expires.
+    assert_true(deadline >= clock_msec + ((3600 - 900) * 1000));
+    assert_true(deadline <= clock_msec + ((3600 - 600) * 1000));
+
+    assert_false(az_iot_sas_token_manager_needs_renewal(&manager, deadline - 1));
+    assert_true(az_iot_sas_token_manager_needs_renewal(&manager, deadline));
+    clock_msec = deadline;
+  }
+}
+
+static void az_iot_sas_token_manager_jitter_differs_between_devices_succeeds()
+{
+  az_span const device_ids[] = {
+    AZ_SPAN_LITERAL_FROM_STR("sensor-01"),
+    AZ_SPAN_LITERAL_FROM_STR("sensor-02"),
+    AZ_SPAN_LITERAL_FROM_STR("sensor-03"),
+    AZ_SPAN_LITERAL_FROM_STR("sensor-04"),
+  };
+  uint8_t password_buffer[TEST_SPAN_BUFFER_SIZE];
+  int64_t deadlines[_az_COUNTOF(device_ids)];
+
+  for (size_t i = 0; i < _az_COUNTOF(device_ids); i++)
+  {
+    az_iot_hub_client client;
+    az_iot_sas_token_manager manager;
+    assert_true(
+        az_iot_hub_client_init(&client, test_device_hostname, device_ids[i], NULL) == AZ_OK);
+    assert_int_equal(
+        az_iot_sas_token_manager_init(
+            &manager, &client, test_sas_key, AZ_SPAN_FROM_BUFFER(password_buffer), NULL),
+        AZ_OK);
+    assert_int_equal(
+        az_iot_sas_token_manager_generate(&manager, test_sas_expiry_time_secs, 0), AZ_OK);
+    assert_int_equal(
+        az_iot_sas_token_manager_get_renewal_deadline(&manager, &deadlines[i]), AZ_OK);
+  }
+
+  // Devices started together don't all renew together.
+  bool all_equal = true;
+  for (size_t i = 1; i < _az_COUNTOF(device_ids); i++)
+  {
+    all_equal = all_equal && deadlines[i] == deadlines[0];
+  }
+  assert_false(all_equal);
+}
+
+static void az_iot_sas_token_manager_invalid_key_fails()
+{
+  az_iot_hub_client client;
+  assert_true(az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL) == AZ_OK);
+
+  uint8_t password_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_iot_sas_token_manager manager;
+  assert_int_equal(
+      az_iot_sas_token_manager_init(
+          &manager,
+          &client,
+          AZ_SPAN_FROM_STR("not*base64!!"),
+          AZ_SPAN_FROM_BUFFER(password_buffer),
+          NULL),
+      AZ_ERROR_UNEXPECTED_CHAR);
+}
+
+static void az_iot_sas_token_manager_generate_overflow_fails()
+{
+  az_iot_hub_client client;
+  assert_true(az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL) == AZ_OK);
+
+  // Enough for everything but the signature.
+  uint8_t password_buffer[130];
+  az_iot_sas_token_manager manager;
+  az_span password;
+  assert_int_equal(
+      az_iot_sas_token_manager_init(
+          &manager, &client, test_sas_key, AZ_SPAN_FROM_BUFFER(password_buffer), NULL),
+      AZ_OK);
+
+  assert_int_equal(
+      az_iot_sas_token_manager_generate(&manager, test_sas_expiry_time_secs, 0),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(
+      az_iot_sas_token_manager_get_password(&manager, &password), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_true(az_iot_sas_token_manager_needs_renewal(&manager, 0));
+
+  assert_int_equal(
+      az_iot_sas_token_manager_init(
+          &manager, &client, test_sas_key, az_span_create(password_buffer, 20), NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_sas_token_manager_generate(&manager, test_sas_expiry_time_secs, 0),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
 #ifdef _MSC_VER
 // warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
 #pragma warning(disable : 4113)
@@ -520,6 +738,9 @@ int test_az_iot_hub_client_sas_token()
     cmocka_unit_test(az_iot_hub_client_sas_get_password_EMPTY_signature_fails),
     cmocka_unit_test(az_iot_hub_client_sas_get_password_NULL_password_span_fails),
     cmocka_unit_test(az_iot_hub_client_sas_get_password_empty_password_buffer_span_fails),
+    cmocka_unit_test(az_iot_sas_token_manager_init_NULL_manager_fails),
+    cmocka_unit_test(az_iot_sas_token_manager_init_margin_too_large_fails),
+    cmocka_unit_test(az_iot_sas_token_manager_generate_NULL_manager_fails),
 #endif // AZ_NO_PRECONDITION_CHECKING
     cmocka_unit_test(az_iot_hub_client_sas_get_signature_device_succeeds),
     cmocka_unit_test(az_iot_hub_client_sas_get_password_device_no_out_length_succeeds),
@@ -535,6 +756,12 @@ int test_az_iot_hub_client_sas_token()
     cmocka_unit_test(az_iot_hub_client_sas_get_signature_module_signature_overflow_fails),
     cmocka_unit_test(test_az_iot_hub_client_sas_logging_succeed),
     cmocka_unit_test(test_az_iot_hub_client_sas_no_logging_succeed),
+    cmocka_unit_test(az_iot_sas_token_manager_generate_succeeds),
+    cmocka_unit_test(az_iot_sas_token_manager_generate_with_keyname_succeeds),
+    cmocka_unit_test(az_iot_sas_token_manager_renewal_deadline_succeeds),
+    cmocka_unit_test(az_iot_sas_token_manager_jitter_differs_between_devices_succeeds),
+    cmocka_unit_test(az_iot_sas_token_manager_invalid_key_fails),
+    cmocka_unit_test(az_iot_sas_token_manager_generate_overflow_fails),
   };
   return cmocka_run_group_tests_name("az_iot_hub_client_sas", tests, NULL, NULL);
 }
@@ -0,0 +1,355 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_hub_client.h"
+#include <az_test_precondition.h>
+#include <azure/core/az_precondition.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/iot/az_iot_hub_client.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmocka.h>
+
+#define TEST_TABLE_CAPACITY 64
+#define TEST_TABLE_HASH_INDEX_SIZE 128
+#define TEST_SPAN_BUFFER_SIZE 128
+
+#define TEST_DEVICE_HOSTNAME_STR "myiothub.azure-devices.net"
+
+static const az_span test_device_hostname = AZ_SPAN_LITERAL_FROM_STR(TEST_DEVICE_HOSTNAME_STR);
+
+static az_span test_device_ids[TEST_TABLE_CAPACITY];
+static az_span test_module_ids[TEST_TABLE_CAPACITY];
+static int32_t test_hash_index[TEST_TABLE_HASH_INDEX_SIZE];
+static char test_id_buffer[TEST_TABLE_CAPACITY][16];
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+ENABLE_PRECONDITION_CHECK_TESTS()
+
+static void test_az_iot_hub_client_table_init_NULL_table_fails()
+{
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_table_init(
+      NULL,
+      test_device_hostname,
+      NULL,
+      test_device_ids,
+      NULL,
+      TEST_TABLE_CAPACITY,
+      test_hash_index,
+      TEST_TABLE_HASH_INDEX_SIZE));
+}
+
+static void test_az_iot_hub_client_table_init_hash_index_not_power_of_two_fails()
+{
+  az_iot_hub_client_table table;
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_table_init(
+      &table,
+      test_device_hostname,
+      NULL,
+      test_device_ids,
+      NULL,
+      TEST_TABLE_CAPACITY,
+      test_hash_index,
+      TEST_TABLE_CAPACITY + 1));
+}
+
+static void test_az_iot_hub_client_table_init_hash_index_too_small_fails()
+{
+  az_iot_hub_client_table table;
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_table_init(
+      &table,
+      test_device_hostname,
+      NULL,
+      test_device_ids,
+      NULL,
+      TEST_TABLE_CAPACITY,
+      test_hash_index,
+      TEST_TABLE_CAPACITY));
+}
+
+static void test_az_iot_hub_client_table_add_module_without_module_ids_fails()
+{
+  az_iot_hub_client_table table;
+  assert_int_equal(
+      az_iot_hub_client_table_init(
+          &table,
+          test_device_hostname,
+          NULL,
+          test_device_ids,
+          NULL,
+          TEST_TABLE_CAPACITY,
+          test_hash_index,
+          TEST_TABLE_HASH_INDEX_SIZE),
+      AZ_OK);
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_table_add(
+      &table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_FROM_STR("my_module"), NULL));
+}
+
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+static void _az_iot_hub_client_table_init_with_modules(az_iot_hub_client_table* table)
+{
+  az_iot_hub_client_options options = az_iot_hub_client_options_default();
+  options.user_agent = AZ_SPAN_FROM_STR("os=azrtos");
+  options.module_id = AZ_SPAN_FROM_STR("ignored");
+
+  assert_int_equal(
+      az_iot_hub_client_table_init(
+          table,
+          test_device_hostname,
+          &options,
+          test_device_ids,
+          test_module_ids,
+          TEST_TABLE_CAPACITY,
+          test_hash_index,
+          TEST_TABLE_HASH_INDEX_SIZE),
+      AZ_OK);
+}
+
+static void test_az_iot_hub_client_table_add_and_find_succeed()
+{
+  az_iot_hub_client_table table;
+  _az_iot_hub_client_table_init_with_modules(&table);
+
+  for (int32_t i = 0; i < TEST_TABLE_CAPACITY; i++)
+  {
+    int const length = snprintf(test_id_buffer[i], sizeof(test_id_buffer[i]), "sensor-%02d", i);
+    az_span const device_id = az_span_create((uint8_t*)test_id_buffer[i], length);
+
+    // Every other entry is a module of the device before it.
+    int32_t entry = -1;
+    if (i % 2 == 0)
+    {
+      assert_int_equal(
+          az_iot_hub_client_table_add(&table, device_id, AZ_SPAN_EMPTY, &entry), AZ_OK);
+    }
+    else
+    {
+      assert_int_equal(
+          az_iot_hub_client_table_add(&table, test_device_ids[i - 1], device_id, &entry), AZ_OK);
+    }
+    assert_int_equal(entry, i);
+  }
+
+  for (int32_t i = 0; i < TEST_TABLE_CAPACITY; i++)
+  {
+    int32_t entry = -1;
+    assert_int_equal(
+        az_iot_hub_client_table_find(&table, test_device_ids[i], test_module_ids[i], &entry),
+        AZ_OK);
+    assert_int_equal(entry, i);
+  }
+
+  int32_t entry = -1;
+  assert_int_equal(
+      az_iot_hub_client_table_find(&table, AZ_SPAN_FROM_STR("sensor-01"), AZ_SPAN_EMPTY, &entry),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_table_find(
+          &table, AZ_SPAN_FROM_STR("sensor-00"), AZ_SPAN_FROM_STR("sensor-03"), &entry),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(entry, -1);
+}
+
+static void test_az_iot_hub_client_table_add_duplicate_fails()
+{
+  az_iot_hub_client_table table;
+  _az_iot_hub_client_table_init_with_modules(&table);
+
+  assert_int_equal(
+      az_iot_hub_client_table_add(&table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_EMPTY, NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_table_add(
+          &table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_FROM_STR("my_module"), NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_table_add(&table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_EMPTY, NULL),
+      AZ_ERROR_ARG);
+  assert_int_equal(
+      az_iot_hub_client_table_add(
+          &table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_FROM_STR("my_module"), NULL),
+      AZ_ERROR_ARG);
+}
+
+static void test_az_iot_hub_client_table_add_full_fails()
+{
+  az_iot_hub_client_table table;
+  assert_int_equal(
+      az_iot_hub_client_table_init(
+          &table, test_device_hostname, NULL, test_device_ids, NULL, 2, test_hash_index, 4),
+      AZ_OK);
+
+  assert_int_equal(
+      az_iot_hub_client_table_add(&table, AZ_SPAN_FROM_STR("a"), AZ_SPAN_EMPTY, NULL), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_table_add(&table, AZ_SPAN_FROM_STR("b"), AZ_SPAN_EMPTY, NULL), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_table_add(&table, AZ_SPAN_FROM_STR("c"), AZ_SPAN_EMPTY, NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_iot_hub_client_table_find_by_topic_succeed()
+{
+  az_iot_hub_client_table table;
+  _az_iot_hub_client_table_init_with_modules(&table);
+
+  int32_t device_entry = -1;
+  int32_t module_entry = -1;
+  assert_int_equal(
+      az_iot_hub_client_table_add(
+          &table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_EMPTY, &device_entry),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_table_add(
+          &table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_FROM_STR("my_module"), &module_entry),
+      AZ_OK);
+
+  int32_t entry = -1;
+  assert_int_equal(
+      az_iot_hub_client_table_find_by_topic(
+          &table, AZ_SPAN_FROM_STR("devices/my_device/messages/devicebound/abc=123"), &entry),
+      AZ_OK);
+  assert_int_equal(entry, device_entry);
+
+  assert_int_equal(
+      az_iot_hub_client_table_find_by_topic(
+          &table,
+          AZ_SPAN_FROM_STR("devices/my_device/modules/my_module/messages/devicebound/"),
+          &entry),
+      AZ_OK);
+  assert_int_equal(entry, module_entry);
+}
+
+static void test_az_iot_hub_client_table_find_by_topic_fails()
+{
+  az_iot_hub_client_table table;
+  _az_iot_hub_client_table_init_with_modules(&table);
+  assert_int_equal(
+      az_iot_hub_client_table_add(&table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_EMPTY, NULL),
+      AZ_OK);
+
+  int32_t entry = -1;
+  assert_int_equal(
+      az_iot_hub_client_table_find_by_topic(
+          &table, AZ_SPAN_FROM_STR("devices/other_device/messages/devicebound/"), &entry),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_table_find_by_topic(
+          &table, AZ_SPAN_FROM_STR("devices/my_device/modules/my_module/messages/"), &entry),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_client_table_find_by_topic(
+          &table, AZ_SPAN_FROM_STR("$iothub/methods/POST/reboot/?$rid=1"), &entry),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_client_table_find_by_topic(&table, AZ_SPAN_FROM_STR("devices/my_device"), &entry),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_client_table_find_by_topic(
+          &table, AZ_SPAN_FROM_STR("devices/my_device/modules/my_module"), &entry),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(entry, -1);
+}
+
+static void test_az_iot_hub_client_table_get_client_matches_client_succeed()
+{
+  az_iot_hub_client_table table;
+  _az_iot_hub_client_table_init_with_modules(&table);
+
+  int32_t entry = -1;
+  assert_int_equal(
+      az_iot_hub_client_table_add(&table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_EMPTY, NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_table_add(
+          &table, AZ_SPAN_FROM_STR("my_device"), AZ_SPAN_FROM_STR("my_module"), &entry),
+      AZ_OK);
+
+  az_iot_hub_client table_client;
+  assert_int_equal(az_iot_hub_client_table_get_client(&table, entry, &table_client), AZ_OK);
+
+  az_iot_hub_client_options options = az_iot_hub_client_options_default();
+  options.user_agent = AZ_SPAN_FROM_STR("os=azrtos");
+  options.module_id = AZ_SPAN_FROM_STR("my_module");
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(
+          &client, test_device_hostname, AZ_SPAN_FROM_STR("my_device"), &options),
+      AZ_OK);
+
+  char expected[TEST_SPAN_BUFFER_SIZE];
+  char actual[TEST_SPAN_BUFFER_SIZE];
+  size_t expected_length = 0;
+  size_t actual_length = 0;
+
+  assert_int_equal(
+      az_iot_hub_client_get_user_name(&client, expected, sizeof(expected), &expected_length),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_get_user_name(&table_client, actual, sizeof(actual), &actual_length),
+      AZ_OK);
+  assert_int_equal(actual_length, expected_length);
+  assert_memory_equal(actual, expected, expected_length);
+
+  assert_int_equal(
+      az_iot_hub_client_telemetry_get_publish_topic(
+          &client, NULL, expected, sizeof(expected), &expected_length),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_get_publish_topic(
+          &table_client, NULL, actual, sizeof(actual), &actual_length),
+      AZ_OK);
+  assert_int_equal(actual_length, expected_length);
+  assert_memory_equal(actual, expected, expected_length);
+
+  uint8_t expected_signature[TEST_SPAN_BUFFER_SIZE];
+  uint8_t actual_signature[TEST_SPAN_BUFFER_SIZE];
+  az_span expected_signature_span = AZ_SPAN_FROM_BUFFER(expected_signature);
+  az_span actual_signature_span = AZ_SPAN_FROM_BUFFER(actual_signature);
+  assert_int_equal(
+      az_iot_hub_client_sas_get_signature(
+          &client, 1578941692, expected_signature_span, &expected_signature_span),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_sas_get_signature(
+          &table_client, 1578941692, actual_signature_span, &actual_signature_span),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(actual_signature_span, expected_signature_span));
+}
+
+#ifdef _MSC_VER
+// warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
+#pragma warning(disable : 4113)
+#endif
+
+int test_az_iot_hub_client_table()
+{
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  SETUP_PRECONDITION_CHECK_TESTS();
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+  const struct CMUnitTest tests[] = {
+#ifndef AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(test_az_iot_hub_client_table_init_NULL_table_fails),
+    cmocka_unit_test(test_az_iot_hub_client_table_init_hash_index_not_power_of_two_fails),
+    cmocka_unit_test(test_az_iot_hub_client_table_init_hash_index_too_small_fails),
+    cmocka_unit_test(test_az_iot_hub_client_table_add_module_without_module_ids_fails),
+#endif // AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(test_az_iot_hub_client_table_add_and_find_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_table_add_duplicate_fails),
+    cmocka_unit_test(test_az_iot_hub_client_table_add_full_fails),
+    cmocka_unit_test(test_az_iot_hub_client_table_find_by_topic_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_table_find_by_topic_fails),
+    cmocka_unit_test(test_az_iot_hub_client_table_get_client_matches_client_succeed),
+  };
+
+  return cmocka_run_group_tests_name("az_iot_hub_table", tests, NULL, NULL);
+}
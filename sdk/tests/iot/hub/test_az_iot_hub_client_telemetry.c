@@ -12,6 +12,7 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <az_test_precondition.h>
 #include <cmocka.h>
@@ -318,6 +319,447 @@ test_az_iot_hub_client_telemetry_get_publish_topic_with_options_module_id_with_p
       == AZ_ERROR_NOT_ENOUGH_SPACE);
 }
 
+static void test_az_iot_hub_client_telemetry_get_publish_topic_cached_prefix_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_options options = az_iot_hub_client_options_default();
+  options.module_id = test_module_id;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, &options), AZ_OK);
+
+  uint8_t prefix_buffer[sizeof(g_test_correct_topic_with_options_no_props) - 1];
+  assert_int_equal(
+      az_iot_hub_client_cache_topic_prefixes(&client, AZ_SPAN_FROM_BUFFER(prefix_buffer)), AZ_OK);
+
+  az_span prefix;
+  assert_int_equal(az_iot_hub_client_telemetry_get_publish_topic_prefix(&client, &prefix), AZ_OK);
+  assert_int_equal(az_span_size(prefix), sizeof(g_test_correct_topic_with_options_no_props) - 1);
+  assert_memory_equal(
+      az_span_ptr(prefix),
+      g_test_correct_topic_with_options_no_props,
+      (size_t)az_span_size(prefix));
+
+  az_iot_message_properties props;
+  assert_int_equal(
+      az_iot_message_properties_init(&props, test_props, az_span_size(test_props)), AZ_OK);
+
+  char test_buf[TEST_SPAN_BUFFER_SIZE];
+  size_t test_length;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_get_publish_topic(
+          &client, &props, test_buf, sizeof(test_buf), &test_length),
+      AZ_OK);
+  assert_string_equal(g_test_correct_topic_with_options_with_props, test_buf);
+  assert_int_equal(sizeof(g_test_correct_topic_with_options_with_props) - 1, test_length);
+
+  char small_buf[sizeof(g_test_correct_topic_with_options_with_props) - 1];
+  assert_int_equal(
+      az_iot_hub_client_telemetry_get_publish_topic(
+          &client, &props, small_buf, sizeof(small_buf), &test_length),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_iot_hub_client_telemetry_get_publish_topic_prefix_not_cached_fails(
+    void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_span prefix;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_get_publish_topic_prefix(&client, &prefix),
+      AZ_ERROR_NOT_SUPPORTED);
+
+  // A buffer which is too small leaves the topics rendered in full.
+  uint8_t prefix_buffer[sizeof(g_test_correct_topic_no_options_no_props) - 2];
+  assert_int_equal(
+      az_iot_hub_client_cache_topic_prefixes(&client, AZ_SPAN_FROM_BUFFER(prefix_buffer)),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_get_publish_topic_prefix(&client, &prefix),
+      AZ_ERROR_NOT_SUPPORTED);
+
+  char test_buf[TEST_SPAN_BUFFER_SIZE];
+  size_t test_length;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_get_publish_topic(
+          &client, NULL, test_buf, sizeof(test_buf), &test_length),
+      AZ_OK);
+  assert_string_equal(g_test_correct_topic_no_options_no_props, test_buf);
+}
+
+typedef struct
+{
+  int64_t timestamp;
+  double temperature;
+  int32_t humidity;
+  bool door_open;
+} test_telemetry_record;
+
+static const az_iot_hub_client_telemetry_batch_field test_batch_fields[] = {
+  { AZ_SPAN_LITERAL_FROM_STR("ts"),
+    offsetof(test_telemetry_record, timestamp),
+    AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_INT64,
+    0 },
+  { AZ_SPAN_LITERAL_FROM_STR("temp"),
+    offsetof(test_telemetry_record, temperature),
+    AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_DOUBLE,
+    2 },
+  { AZ_SPAN_LITERAL_FROM_STR("hum"),
+    offsetof(test_telemetry_record, humidity),
+    AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_INT32,
+    0 },
+  { AZ_SPAN_LITERAL_FROM_STR("open"),
+    offsetof(test_telemetry_record, door_open),
+    AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_BOOL,
+    0 },
+};
+
+static const test_telemetry_record test_batch_records[] = {
+  { 1600000000000, 20.5, 40, false },
+  { 1600000001000, 21.25, -3, true },
+  { 1600000002000, 19.0, 41, false },
+};
+
+static const char g_test_correct_columnar_batch[]
+    = "{\"ts\":[1600000000000,1600000001000,1600000002000],\"temp\":[20.5,21.25,19],"
+      "\"hum\":[40,-3,41],\"open\":[false,true,false]}";
+static const char g_test_correct_rows_batch[]
+    = "{\"columns\":[\"ts\",\"temp\",\"hum\",\"open\"],\"rows\":[[1600000000000,20.5,40,false],"
+      "[1600000001000,21.25,-3,true],[1600000002000,19,41,false]]}";
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+
+static void test_az_iot_hub_client_telemetry_batch_init_field_out_of_record_fails(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_telemetry_batch batch;
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_telemetry_batch_init(
+      &batch, test_batch_fields, 4, offsetof(test_telemetry_record, door_open), NULL));
+}
+
+static void test_az_iot_hub_client_telemetry_pacer_init_no_burst_fails(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_telemetry_pacer_options options
+      = az_iot_hub_client_telemetry_pacer_options_default();
+  options.burst = 0;
+
+  az_iot_hub_client_telemetry_pacer pacer;
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_telemetry_pacer_init(&pacer, &options));
+}
+
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+static void test_az_iot_hub_client_telemetry_batch_get_payload_columnar_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_telemetry_batch batch;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(
+          &batch, test_batch_fields, 4, sizeof(test_telemetry_record), NULL),
+      AZ_OK);
+
+  uint8_t buffer[256];
+  az_span payload = AZ_SPAN_EMPTY;
+  int32_t written = 0;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_payload(
+          &batch, test_batch_records, 3, AZ_SPAN_FROM_BUFFER(buffer), &payload, &written),
+      AZ_OK);
+
+  assert_int_equal(written, 3);
+  assert_int_equal(az_span_size(payload), sizeof(g_test_correct_columnar_batch) - 1);
+  assert_memory_equal(az_span_ptr(payload), g_test_correct_columnar_batch, az_span_size(payload));
+}
+
+static void test_az_iot_hub_client_telemetry_batch_get_payload_rows_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_telemetry_batch_options options
+      = az_iot_hub_client_telemetry_batch_options_default();
+  options.layout = AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_ROWS;
+
+  az_iot_hub_client_telemetry_batch batch;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(
+          &batch, test_batch_fields, 4, sizeof(test_telemetry_record), &options),
+      AZ_OK);
+
+  uint8_t buffer[256];
+  az_span payload = AZ_SPAN_EMPTY;
+  int32_t written = 0;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_payload(
+          &batch, test_batch_records, 3, AZ_SPAN_FROM_BUFFER(buffer), &payload, &written),
+      AZ_OK);
+
+  assert_int_equal(written, 3);
+  assert_int_equal(az_span_size(payload), sizeof(g_test_correct_rows_batch) - 1);
+  assert_memory_equal(az_span_ptr(payload), g_test_correct_rows_batch, az_span_size(payload));
+}
+
+static void test_az_iot_hub_client_telemetry_batch_get_payload_closes_at_max_size_succeed(
+    void** state)
+{
+  (void)state;
+
+  // Only room for the first two records: {"ts":[..,..],"temp":[..,..],"hum":[..,..],...}
+  char const expected_first[]
+      = "{\"ts\":[1600000000000,1600000001000],\"temp\":[20.5,21.25],\"hum\":[40,-3],"
+        "\"open\":[false,true]}";
+  char const expected_second[]
+      = "{\"ts\":[1600000002000],\"temp\":[19],\"hum\":[41],\"open\":[false]}";
+
+  az_iot_hub_client_telemetry_batch_options options
+      = az_iot_hub_client_telemetry_batch_options_default();
+  options.max_payload_size = (int32_t)sizeof(expected_first) + 5;
+
+  az_iot_hub_client_telemetry_batch batch;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(
+          &batch, test_batch_fields, 4, sizeof(test_telemetry_record), &options),
+      AZ_OK);
+
+  uint8_t buffer[256];
+  az_span payload = AZ_SPAN_EMPTY;
+  int32_t written = 0;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_payload(
+          &batch, test_batch_records, 3, AZ_SPAN_FROM_BUFFER(buffer), &payload, &written),
+      AZ_OK);
+  assert_int_equal(written, 2);
+  assert_int_equal(az_span_size(payload), sizeof(expected_first) - 1);
+  assert_memory_equal(az_span_ptr(payload), expected_first, az_span_size(payload));
+
+  // The rest of the records go in the next batch.
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_payload(
+          &batch,
+          test_batch_records + written,
+          3 - written,
+          AZ_SPAN_FROM_BUFFER(buffer),
+          &payload,
+          &written),
+      AZ_OK);
+  assert_int_equal(written, 1);
+  assert_int_equal(az_span_size(payload), sizeof(expected_second) - 1);
+  assert_memory_equal(az_span_ptr(payload), expected_second, az_span_size(payload));
+}
+
+static void test_az_iot_hub_client_telemetry_batch_get_payload_escaped_name_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_telemetry_batch_field const fields[] = {
+    { AZ_SPAN_LITERAL_FROM_STR("a\"b\n"), 0, AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_FIELD_DOUBLE, 2 },
+  };
+  double const records[] = { 1.5, 295147905179352825856.0, -1e300 };
+
+  az_iot_hub_client_telemetry_batch_options options
+      = az_iot_hub_client_telemetry_batch_options_default();
+  az_iot_hub_client_telemetry_batch batch;
+  uint8_t buffer[256];
+  az_span payload = AZ_SPAN_EMPTY;
+  int32_t written = 0;
+
+  // Names are escaped, and numbers too large for az_span_dtoa are written in exponent form.
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(&batch, fields, 1, sizeof(double), &options), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_payload(
+          &batch, records, 3, AZ_SPAN_FROM_BUFFER(buffer), &payload, &written),
+      AZ_OK);
+  assert_int_equal(written, 3);
+  assert_true(az_span_is_content_equal(
+      payload, AZ_SPAN_FROM_STR("{\"a\\\"b\\n\":[1.5,2.95147905179352e+20,-1e+300]}")));
+
+  options.layout = AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_ROWS;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(&batch, fields, 1, sizeof(double), &options), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_payload(
+          &batch, records, 3, AZ_SPAN_FROM_BUFFER(buffer), &payload, &written),
+      AZ_OK);
+  assert_int_equal(written, 3);
+  assert_true(az_span_is_content_equal(
+      payload,
+      AZ_SPAN_FROM_STR(
+          "{\"columns\":[\"a\\\"b\\n\"],\"rows\":[[1.5],[2.95147905179352e+20],[-1e+300]]}")));
+}
+
+static void test_az_iot_hub_client_telemetry_batch_get_payload_small_buffer_fails(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_telemetry_batch batch;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(
+          &batch, test_batch_fields, 4, sizeof(test_telemetry_record), NULL),
+      AZ_OK);
+
+  uint8_t buffer[40];
+  memset(buffer, '.', sizeof(buffer));
+  az_span payload = AZ_SPAN_EMPTY;
+  int32_t written = 0;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_payload(
+          &batch, test_batch_records, 3, AZ_SPAN_FROM_BUFFER(buffer), &payload, &written),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(buffer[0], '.');
+}
+
+static void test_az_iot_hub_client_telemetry_batch_append_property_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_telemetry_batch batch;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(
+          &batch, test_batch_fields, 4, sizeof(test_telemetry_record), NULL),
+      AZ_OK);
+
+  uint8_t props_buffer[32];
+  az_iot_message_properties props;
+  assert_int_equal(
+      az_iot_message_properties_init(&props, AZ_SPAN_FROM_BUFFER(props_buffer), 0), AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_append_property(&batch, &props), AZ_OK);
+
+  char test_buf[TEST_SPAN_BUFFER_SIZE];
+  size_t test_length;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_get_publish_topic(
+          &client, &props, test_buf, sizeof(test_buf), &test_length),
+      AZ_OK);
+  assert_string_equal("devices/my_device/messages/events/batch=columnar", test_buf);
+}
+
+static void _test_az_iot_hub_client_telemetry_pacer_init(az_iot_hub_client_telemetry_pacer* pacer)
+{
+  // 10 messages per second, in bursts of up to 3.
+  az_iot_hub_client_telemetry_pacer_options options
+      = az_iot_hub_client_telemetry_pacer_options_default();
+  options.messages = 10;
+  options.period_msec = 1000;
+  options.burst = 3;
+  options.throttled_pause_msec = 500;
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_init(pacer, &options), AZ_OK);
+}
+
+static void test_az_iot_hub_client_telemetry_pacer_try_send_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_telemetry_pacer pacer;
+  _test_az_iot_hub_client_telemetry_pacer_init(&pacer);
+
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_delay_msec(&pacer, 1000), 0);
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1000));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1000));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1000));
+  assert_false(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1000));
+
+  // Once the burst is used up, messages go out at the configured rate.
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_delay_msec(&pacer, 1000), 100);
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_delay_msec(&pacer, 1099), 1);
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1100));
+  assert_false(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1150));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1200));
+
+  // A pause makes room for another burst, but no more.
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 5000));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 5000));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 5000));
+  assert_false(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 5000));
+}
+
+static void test_az_iot_hub_client_telemetry_pacer_get_batch_size_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_telemetry_pacer pacer;
+  _test_az_iot_hub_client_telemetry_pacer_init(&pacer);
+
+  // With a full burst allowed, 10 records go out as 3 messages of up to 4 records.
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_batch_size(&pacer, 1000, 10), 4);
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_batch_size(&pacer, 1000, 2), 1);
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_batch_size(&pacer, 1000, 0), 0);
+
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1000));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1000));
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_batch_size(&pacer, 1000, 10), 10);
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1000));
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_batch_size(&pacer, 1000, 10), 0);
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_batch_size(&pacer, 1200, 10), 5);
+}
+
+static void test_az_iot_hub_client_telemetry_pacer_report_status_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_telemetry_pacer pacer;
+  _test_az_iot_hub_client_telemetry_pacer_init(&pacer);
+
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1000));
+  az_iot_hub_client_telemetry_pacer_report_status(&pacer, AZ_IOT_STATUS_THROTTLED, 1000);
+
+  // Throttling stops the messages for the pause, then lets them out at half the rate.
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_delay_msec(&pacer, 1000), 500);
+  assert_false(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1499));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1500));
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_delay_msec(&pacer, 1500), 200);
+
+  // Other errors don't change the rate, while successes bring it back.
+  az_iot_hub_client_telemetry_pacer_report_status(&pacer, AZ_IOT_STATUS_BAD_REQUEST, 1500);
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_delay_msec(&pacer, 1500), 200);
+  for (int32_t i = 0; i < 64; i++)
+  {
+    az_iot_hub_client_telemetry_pacer_report_status(&pacer, AZ_IOT_STATUS_OK, 1500);
+  }
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 10000));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 10000));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 10000));
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_delay_msec(&pacer, 10000), 100);
+}
+
+static void test_az_iot_hub_client_telemetry_pacer_options_for_tier_succeed(void** state)
+{
+  (void)state;
+
+  // 4 devices share the 100 messages per second of a 2 unit S1 hub.
+  az_iot_hub_client_telemetry_pacer_options options
+      = az_iot_hub_client_telemetry_pacer_options_for_tier(AZ_IOT_HUB_TIER_S1, 2, 4);
+  az_iot_hub_client_telemetry_pacer pacer;
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_init(&pacer, &options), AZ_OK);
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 0));
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_get_delay_msec(&pacer, 0), 40);
+
+  // And 12000 devices the 12000 of a 2 unit S3 hub.
+  options = az_iot_hub_client_telemetry_pacer_options_for_tier(AZ_IOT_HUB_TIER_S3, 2, 12000);
+  assert_int_equal(az_iot_hub_client_telemetry_pacer_init(&pacer, &options), AZ_OK);
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 0));
+  assert_false(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 999));
+  assert_true(az_iot_hub_client_telemetry_pacer_try_send(&pacer, 1000));
+
+  options = az_iot_hub_client_telemetry_pacer_options_for_tier(AZ_IOT_HUB_TIER_S1, 20, 1);
+  assert_int_equal(options.messages, 240);
+  assert_int_equal(options.burst, 1);
+}
+
 int test_az_iot_hub_client_telemetry()
 {
 #ifndef AZ_NO_PRECONDITION_CHECKING
@@ -329,6 +771,8 @@ int test_az_iot_hub_client_telemetry()
     cmocka_unit_test(test_az_iot_hub_client_telemetry_get_publish_topic_NULL_client_fails),
     cmocka_unit_test(test_az_iot_hub_client_telemetry_get_publish_topic_NULL_mqtt_topic_fails),
     cmocka_unit_test(test_az_iot_hub_client_telemetry_get_publish_topic_NULL_out_mqtt_topic_fails),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_init_field_out_of_record_fails),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_pacer_init_no_burst_fails),
 #endif // AZ_NO_PRECONDITION_CHECKING
     cmocka_unit_test(
         test_az_iot_hub_client_telemetry_get_publish_topic_no_options_no_props_succeed),
@@ -348,6 +792,20 @@ int test_az_iot_hub_client_telemetry()
         test_az_iot_hub_client_telemetry_get_publish_topic_with_options_module_id_with_props_succeed),
     cmocka_unit_test(
         test_az_iot_hub_client_telemetry_get_publish_topic_with_options_module_id_with_props_small_buffer_fails),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_get_publish_topic_cached_prefix_succeed),
+    cmocka_unit_test(
+        test_az_iot_hub_client_telemetry_get_publish_topic_prefix_not_cached_fails),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_get_payload_columnar_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_get_payload_rows_succeed),
+    cmocka_unit_test(
+        test_az_iot_hub_client_telemetry_batch_get_payload_closes_at_max_size_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_get_payload_escaped_name_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_get_payload_small_buffer_fails),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_append_property_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_pacer_try_send_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_pacer_get_batch_size_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_pacer_report_status_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_pacer_options_for_tier_succeed),
   };
 
   return cmocka_run_group_tests_name("az_iot_hub_client_telemetry", tests, NULL, NULL);
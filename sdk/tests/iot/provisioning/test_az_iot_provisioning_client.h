@@ -7,3 +7,5 @@ int test_az_iot_provisioning_client();
 int test_az_iot_provisioning_client_sas_token();
 int test_az_iot_provisioning_client_parser();
 int test_az_iot_provisioning_client_register_get_request_payload();
+int test_az_iot_provisioning_client_registration_state();
+int test_az_iot_provisioning_client_poller();
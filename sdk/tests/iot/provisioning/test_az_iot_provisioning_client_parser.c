@@ -695,6 +695,9 @@ test_az_iot_provisioning_client_parse_received_topic_and_payload_json_custom_pay
       az_span_ptr(response.registration_state.payload),
       TEST_JSON_PAYLOAD,
       strlen(TEST_JSON_PAYLOAD));
+  assert_true(az_span_is_content_equal(
+      response.registration_state.etag,
+      AZ_SPAN_FROM_STR("IjYxMDA4ZDQ2LTAwMDAtMDEwMC0wMDAwLTVlOGZlM2QxMDAwMCI=")));
 
   assert_int_equal(0, response.registration_state.error_code);
   assert_int_equal(0, response.registration_state.extended_error_code);
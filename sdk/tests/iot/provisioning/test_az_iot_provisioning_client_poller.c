@@ -0,0 +1,354 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_provisioning_client.h"
+#include <az_test_precondition.h>
+#include <azure/core/az_context.h>
+#include <azure/core/az_precondition.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/iot/az_iot_provisioning_client.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_GLOBAL_DEVICE_HOSTNAME "global.azure-devices-provisioning.net"
+#define TEST_ID_SCOPE "0neFEEDC0DE"
+#define TEST_REGISTRATION_ID "myRegistrationId"
+#define TEST_OPERATION_ID "4.d0a671905ea5b2c8.42d78160-4c78-479e-8be7-61d5e55dac0d"
+#define TEST_OPERATION_ID_BUFFER_SIZE 64
+#define TEST_GATEWAY_DEVICE_COUNT 8
+
+static void _test_az_iot_provisioning_client_init(
+    az_iot_provisioning_client* client,
+    az_span registration_id)
+{
+  assert_int_equal(
+      az_iot_provisioning_client_init(
+          client,
+          AZ_SPAN_FROM_STR(TEST_GLOBAL_DEVICE_HOSTNAME),
+          AZ_SPAN_FROM_STR(TEST_ID_SCOPE),
+          registration_id,
+          NULL),
+      AZ_OK);
+}
+
+static az_iot_provisioning_client_register_response _test_az_iot_provisioning_response(
+    az_iot_status status,
+    az_iot_provisioning_client_operation_status operation_status,
+    uint32_t retry_after_seconds)
+{
+  az_iot_provisioning_client_register_response response = { 0 };
+  response.status = status;
+  response.operation_status = operation_status;
+  response.retry_after_seconds = retry_after_seconds;
+  response.operation_id = az_iot_status_succeeded(status) ? AZ_SPAN_FROM_STR(TEST_OPERATION_ID)
+                                                          : AZ_SPAN_EMPTY;
+  return response;
+}
+
+static void _test_az_iot_provisioning_client_poller_assert_action(
+    az_iot_provisioning_client_poller* poller,
+    int64_t current_clock_msec,
+    az_iot_provisioning_client_poller_action expected_action)
+{
+  az_iot_provisioning_client_poller_action action;
+  assert_int_equal(
+      az_iot_provisioning_client_poller_get_action(poller, current_clock_msec, &action), AZ_OK);
+  assert_int_equal(action, expected_action);
+}
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+ENABLE_PRECONDITION_CHECK_TESTS()
+
+static void test_az_iot_provisioning_client_poller_init_empty_operation_id_buffer_fails()
+{
+  az_iot_provisioning_client client;
+  az_iot_provisioning_client_poller poller;
+
+  _test_az_iot_provisioning_client_init(&client, AZ_SPAN_FROM_STR(TEST_REGISTRATION_ID));
+
+  ASSERT_PRECONDITION_CHECKED(
+      az_iot_provisioning_client_poller_init(&poller, &client, NULL, AZ_SPAN_EMPTY, NULL, 0));
+}
+
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+static void test_az_iot_provisioning_client_poller_retry_after_succeed()
+{
+  az_iot_provisioning_client client;
+  az_iot_provisioning_client_poller poller;
+  uint8_t operation_id_buffer[TEST_OPERATION_ID_BUFFER_SIZE];
+  az_iot_provisioning_client_register_response response;
+
+  _test_az_iot_provisioning_client_init(&client, AZ_SPAN_FROM_STR(TEST_REGISTRATION_ID));
+  assert_int_equal(
+      az_iot_provisioning_client_poller_init(
+          &poller, &client, NULL, AZ_SPAN_FROM_BUFFER(operation_id_buffer), NULL, 5000),
+      AZ_OK);
+
+  // The Register request is due right away, until it is sent.
+  _test_az_iot_provisioning_client_poller_assert_action(
+      &poller, 5000, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_REGISTER);
+  _test_az_iot_provisioning_client_poller_assert_action(
+      &poller, 5001, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_REGISTER);
+  az_iot_provisioning_client_poller_report_sent(&poller, 5001);
+  _test_az_iot_provisioning_client_poller_assert_action(
+      &poller, 5002, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_NONE);
+  assert_int_equal(az_span_size(az_iot_provisioning_client_poller_get_operation_id(&poller)), 0);
+
+  // Each poll in progress comes after the retry-after of the service, however many there are.
+  int64_t now = 5100;
+  for (int32_t i = 0; i < 10; i++)
+  {
+    response = _test_az_iot_provisioning_response(
+        AZ_IOT_STATUS_ACCEPTED, AZ_IOT_PROVISIONING_STATUS_ASSIGNING, 3);
+    assert_int_equal(
+        az_iot_provisioning_client_poller_report_response(&poller, &response, now), AZ_OK);
+    assert_true(az_span_is_content_equal(
+        az_iot_provisioning_client_poller_get_operation_id(&poller),
+        AZ_SPAN_FROM_STR(TEST_OPERATION_ID)));
+
+    int64_t const deadline = az_iot_provisioning_client_poller_get_next_deadline_msec(&poller);
+    assert_true(deadline >= now + 3000 && deadline <= now + 4000);
+    _test_az_iot_provisioning_client_poller_assert_action(
+        &poller, deadline - 1, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_NONE);
+    _test_az_iot_provisioning_client_poller_assert_action(
+        &poller, deadline, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_QUERY_STATUS);
+    az_iot_provisioning_client_poller_report_sent(&poller, deadline);
+    now = deadline + 100;
+  }
+
+  response = _test_az_iot_provisioning_response(
+      AZ_IOT_STATUS_OK, AZ_IOT_PROVISIONING_STATUS_ASSIGNED, 0);
+  assert_int_equal(
+      az_iot_provisioning_client_poller_report_response(&poller, &response, now), AZ_OK);
+  assert_true(az_iot_provisioning_client_poller_is_complete(&poller));
+  assert_true(az_iot_provisioning_client_poller_get_next_deadline_msec(&poller) == INT64_MAX);
+  _test_az_iot_provisioning_client_poller_assert_action(
+      &poller, INT64_MAX, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_NONE);
+  assert_true(az_iot_provisioning_client_poller_get_elapsed_msec(&poller, now) == now - 5000);
+}
+
+static void test_az_iot_provisioning_client_poller_backoff_succeed()
+{
+  az_iot_provisioning_client client;
+  az_iot_provisioning_client_poller poller;
+  uint8_t operation_id_buffer[TEST_OPERATION_ID_BUFFER_SIZE];
+  az_iot_provisioning_client_register_response response;
+  az_iot_provisioning_client_poller_options options
+      = az_iot_provisioning_client_poller_options_default();
+
+  _test_az_iot_provisioning_client_init(&client, AZ_SPAN_FROM_STR(TEST_REGISTRATION_ID));
+  assert_int_equal(
+      az_iot_provisioning_client_poller_init(
+          &poller, &client, NULL, AZ_SPAN_FROM_BUFFER(operation_id_buffer), &options, 0),
+      AZ_OK);
+
+  // A lost response: the Register request is sent again after the timeout and a backoff.
+  az_iot_provisioning_client_poller_report_sent(&poller, 0);
+  assert_true(
+      az_iot_provisioning_client_poller_get_next_deadline_msec(&poller)
+      == options.response_timeout_msec);
+  _test_az_iot_provisioning_client_poller_assert_action(
+      &poller, options.response_timeout_msec, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_NONE);
+  int64_t now = az_iot_provisioning_client_poller_get_next_deadline_msec(&poller);
+  assert_true(now > options.response_timeout_msec);
+  _test_az_iot_provisioning_client_poller_assert_action(
+      &poller, now, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_REGISTER);
+  az_iot_provisioning_client_poller_report_sent(&poller, now);
+
+  // Throttling is retried, and the Register request is sent again as there is no operation yet.
+  response = _test_az_iot_provisioning_response(
+      AZ_IOT_STATUS_THROTTLED, AZ_IOT_PROVISIONING_STATUS_FAILED, 0);
+  assert_int_equal(
+      az_iot_provisioning_client_poller_report_response(&poller, &response, now), AZ_OK);
+  now = az_iot_provisioning_client_poller_get_next_deadline_msec(&poller);
+  _test_az_iot_provisioning_client_poller_assert_action(
+      &poller, now, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_REGISTER);
+  az_iot_provisioning_client_poller_report_sent(&poller, now);
+
+  // Without a retry-after, polls back off up to the maximum delay.
+  int64_t longest_delay = 0;
+  for (int32_t i = 0; i < 20; i++)
+  {
+    response = _test_az_iot_provisioning_response(
+        AZ_IOT_STATUS_ACCEPTED, AZ_IOT_PROVISIONING_STATUS_ASSIGNING, 0);
+    assert_int_equal(
+        az_iot_provisioning_client_poller_report_response(&poller, &response, now), AZ_OK);
+
+    int64_t const deadline = az_iot_provisioning_client_poller_get_next_deadline_msec(&poller);
+    assert_true(deadline - now >= options.retry.min_retry_delay_msec);
+    assert_true(deadline - now <= options.retry.max_retry_delay_msec);
+    longest_delay = deadline - now > longest_delay ? deadline - now : longest_delay;
+    _test_az_iot_provisioning_client_poller_assert_action(
+        &poller, deadline, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_QUERY_STATUS);
+    az_iot_provisioning_client_poller_report_sent(&poller, deadline);
+    now = deadline;
+  }
+  assert_true(longest_delay > 3 * options.retry.min_retry_delay_msec);
+
+  // An error which retrying wouldn't fix ends the registration.
+  response = _test_az_iot_provisioning_response(
+      AZ_IOT_STATUS_UNAUTHORIZED, AZ_IOT_PROVISIONING_STATUS_FAILED, 0);
+  assert_int_equal(
+      az_iot_provisioning_client_poller_report_response(&poller, &response, now), AZ_OK);
+  assert_true(az_iot_provisioning_client_poller_is_complete(&poller));
+
+  // The operation ID must fit in the buffer of the poller.
+  assert_int_equal(
+      az_iot_provisioning_client_poller_init(
+          &poller, &client, NULL, az_span_create(operation_id_buffer, 8), NULL, 0),
+      AZ_OK);
+  response = _test_az_iot_provisioning_response(
+      AZ_IOT_STATUS_ACCEPTED, AZ_IOT_PROVISIONING_STATUS_ASSIGNING, 3);
+  assert_int_equal(
+      az_iot_provisioning_client_poller_report_response(&poller, &response, 0),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_iot_provisioning_client_poller_context_expired_fails()
+{
+  az_iot_provisioning_client client;
+  az_iot_provisioning_client_poller poller;
+  uint8_t operation_id_buffer[TEST_OPERATION_ID_BUFFER_SIZE];
+  az_iot_provisioning_client_poller_action action;
+
+  az_context context = az_context_create_with_expiration(&az_context_application, 2000);
+
+  _test_az_iot_provisioning_client_init(&client, AZ_SPAN_FROM_STR(TEST_REGISTRATION_ID));
+  assert_int_equal(
+      az_iot_provisioning_client_poller_init(
+          &poller, &client, &context, AZ_SPAN_FROM_BUFFER(operation_id_buffer), NULL, 0),
+      AZ_OK);
+  az_iot_provisioning_client_poller_report_sent(&poller, 0);
+
+  // The response timeout is past the expiration, so the context is what the poller waits for.
+  int64_t const deadline = az_iot_provisioning_client_poller_get_next_deadline_msec(&poller);
+  assert_true(deadline == 2001);
+  assert_int_equal(
+      az_iot_provisioning_client_poller_get_action(&poller, deadline - 1, &action), AZ_OK);
+  assert_int_equal(action, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_NONE);
+  assert_int_equal(
+      az_iot_provisioning_client_poller_get_action(&poller, deadline, &action),
+      AZ_ERROR_CANCELED);
+  assert_true(az_iot_provisioning_client_poller_is_complete(&poller));
+  assert_true(az_iot_provisioning_client_poller_get_elapsed_msec(&poller, deadline) == 2001);
+}
+
+static void test_az_iot_provisioning_client_poller_get_next_succeed()
+{
+  az_iot_provisioning_client clients[TEST_GATEWAY_DEVICE_COUNT];
+  az_iot_provisioning_client_poller pollers[TEST_GATEWAY_DEVICE_COUNT];
+  uint8_t operation_id_buffers[TEST_GATEWAY_DEVICE_COUNT][TEST_OPERATION_ID_BUFFER_SIZE];
+  char registration_ids[TEST_GATEWAY_DEVICE_COUNT][8]
+      = { "dev-0", "dev-1", "dev-2", "dev-3", "dev-4", "dev-5", "dev-6", "dev-7" };
+  az_iot_provisioning_client_register_response response;
+  az_iot_provisioning_client_poller_action action;
+  int32_t index;
+  int64_t next_deadline;
+
+  for (int32_t i = 0; i < TEST_GATEWAY_DEVICE_COUNT; i++)
+  {
+    _test_az_iot_provisioning_client_init(
+        &clients[i], az_span_create_from_str(registration_ids[i]));
+    assert_int_equal(
+        az_iot_provisioning_client_poller_init(
+            &pollers[i],
+            &clients[i],
+            NULL,
+            AZ_SPAN_FROM_BUFFER(operation_id_buffers[i]),
+            NULL,
+            0),
+        AZ_OK);
+  }
+
+  // Every registration starts with a Register request, one after the other.
+  for (int32_t i = 0; i < TEST_GATEWAY_DEVICE_COUNT; i++)
+  {
+    assert_int_equal(
+        az_iot_provisioning_client_poller_get_next(
+            pollers, TEST_GATEWAY_DEVICE_COUNT, 0, &index, &action, NULL),
+        AZ_OK);
+    assert_int_equal(index, i);
+    assert_int_equal(action, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_REGISTER);
+    az_iot_provisioning_client_poller_report_sent(&pollers[index], 0);
+  }
+  assert_int_equal(
+      az_iot_provisioning_client_poller_get_next(
+          pollers, TEST_GATEWAY_DEVICE_COUNT, 0, &index, &action, &next_deadline),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // The same retry-after for all, yet the polls don't all come at once.
+  response = _test_az_iot_provisioning_response(
+      AZ_IOT_STATUS_ACCEPTED, AZ_IOT_PROVISIONING_STATUS_ASSIGNING, 3);
+  int64_t earliest = INT64_MAX;
+  int64_t latest = 0;
+  for (int32_t i = 0; i < TEST_GATEWAY_DEVICE_COUNT; i++)
+  {
+    assert_int_equal(
+        az_iot_provisioning_client_poller_report_response(&pollers[i], &response, 100), AZ_OK);
+    int64_t const deadline = az_iot_provisioning_client_poller_get_next_deadline_msec(&pollers[i]);
+    earliest = deadline < earliest ? deadline : earliest;
+    latest = deadline > latest ? deadline : latest;
+  }
+  assert_true(latest > earliest);
+  assert_int_equal(
+      az_iot_provisioning_client_poller_get_next(
+          pollers, TEST_GATEWAY_DEVICE_COUNT, 100, &index, &action, &next_deadline),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_true(next_deadline == earliest);
+
+  // Completed registrations are skipped.
+  response = _test_az_iot_provisioning_response(
+      AZ_IOT_STATUS_OK, AZ_IOT_PROVISIONING_STATUS_ASSIGNED, 0);
+  assert_int_equal(
+      az_iot_provisioning_client_poller_report_response(&pollers[0], &response, 200), AZ_OK);
+  int32_t polls = 0;
+  while (az_iot_provisioning_client_poller_get_next(
+             pollers, TEST_GATEWAY_DEVICE_COUNT, latest, &index, &action, &next_deadline)
+         == AZ_OK)
+  {
+    assert_int_not_equal(index, 0);
+    assert_int_equal(action, AZ_IOT_PROVISIONING_CLIENT_POLLER_ACTION_QUERY_STATUS);
+    az_iot_provisioning_client_poller_report_sent(&pollers[index], latest);
+    polls++;
+  }
+  assert_int_equal(polls, TEST_GATEWAY_DEVICE_COUNT - 1);
+
+  assert_int_equal(
+      az_iot_provisioning_client_poller_get_next(
+          pollers, 0, latest, &index, &action, &next_deadline),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_true(next_deadline == INT64_MAX);
+}
+
+#ifdef _MSC_VER
+// warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
+#pragma warning(disable : 4113)
+#endif
+
+int test_az_iot_provisioning_client_poller()
+{
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  SETUP_PRECONDITION_CHECK_TESTS();
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+  const struct CMUnitTest tests[] = {
+#ifndef AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(test_az_iot_provisioning_client_poller_init_empty_operation_id_buffer_fails),
+#endif // AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(test_az_iot_provisioning_client_poller_retry_after_succeed),
+    cmocka_unit_test(test_az_iot_provisioning_client_poller_backoff_succeed),
+    cmocka_unit_test(test_az_iot_provisioning_client_poller_context_expired_fails),
+    cmocka_unit_test(test_az_iot_provisioning_client_poller_get_next_succeed),
+  };
+
+  return cmocka_run_group_tests_name("az_iot_provisioning_client_poller", tests, NULL, NULL);
+}
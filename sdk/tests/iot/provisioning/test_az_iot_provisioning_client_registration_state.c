@@ -0,0 +1,244 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_provisioning_client.h"
+#include <az_test_precondition.h>
+#include <azure/core/az_precondition.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/iot/az_iot_provisioning_client.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_GLOBAL_DEVICE_HOSTNAME "global.azure-devices-provisioning.net"
+#define TEST_ID_SCOPE "0neFEEDC0DE"
+#define TEST_REGISTRATION_ID "myRegistrationId"
+#define TEST_HUB_HOSTNAME "contoso.azure-devices.net"
+#define TEST_DEVICE_ID "my-device-id1"
+#define TEST_ETAG "IjYxMDA4ZDQ2LTAwMDAtMDEwMC0wMDAwLTVlOGZlM2QxMDAwMCI="
+#define TEST_TIMESTAMP "2020-04-10T03:11:13.2096201Z"
+#define TEST_JSON_PAYLOAD "{\"hello\":\"world\"}"
+
+// The blob of the test registration state, which is 24 bytes of header, the fields and a 4 bytes
+// checksum.
+#define TEST_BLOB_SIZE                                                                         \
+  ((int32_t)(24 + sizeof(TEST_HUB_HOSTNAME) - 1 + sizeof(TEST_DEVICE_ID) - 1 + sizeof(TEST_ETAG) \
+             - 1 + sizeof(TEST_TIMESTAMP) - 1 + sizeof(TEST_JSON_PAYLOAD) - 1 + 4))
+
+static void _test_az_iot_provisioning_client_init(
+    az_iot_provisioning_client* client,
+    az_span registration_id)
+{
+  assert_int_equal(
+      az_iot_provisioning_client_init(
+          client,
+          AZ_SPAN_FROM_STR(TEST_GLOBAL_DEVICE_HOSTNAME),
+          AZ_SPAN_FROM_STR(TEST_ID_SCOPE),
+          registration_id,
+          NULL),
+      AZ_OK);
+}
+
+static az_iot_provisioning_client_registration_state _test_az_iot_registration_state()
+{
+  az_iot_provisioning_client_registration_state registration_state = { 0 };
+  registration_state.assigned_hub_hostname = AZ_SPAN_FROM_STR(TEST_HUB_HOSTNAME);
+  registration_state.device_id = AZ_SPAN_FROM_STR(TEST_DEVICE_ID);
+  registration_state.etag = AZ_SPAN_FROM_STR(TEST_ETAG);
+  registration_state.error_timestamp = AZ_SPAN_FROM_STR(TEST_TIMESTAMP);
+  registration_state.payload = AZ_SPAN_FROM_STR(TEST_JSON_PAYLOAD);
+  return registration_state;
+}
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+ENABLE_PRECONDITION_CHECK_TESTS()
+
+static void test_az_iot_provisioning_client_registration_state_serialize_no_device_id_fails()
+{
+  az_iot_provisioning_client client;
+  az_iot_provisioning_client_registration_state registration_state
+      = _test_az_iot_registration_state();
+  uint8_t buffer[TEST_BLOB_SIZE];
+  az_span blob;
+
+  _test_az_iot_provisioning_client_init(&client, AZ_SPAN_FROM_STR(TEST_REGISTRATION_ID));
+  registration_state.device_id = AZ_SPAN_EMPTY;
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_provisioning_client_registration_state_serialize(
+      &client, &registration_state, AZ_SPAN_FROM_BUFFER(buffer), &blob));
+}
+
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+static void test_az_iot_provisioning_client_registration_state_round_trip_succeed()
+{
+  az_iot_provisioning_client client;
+  az_iot_provisioning_client_registration_state registration_state
+      = _test_az_iot_registration_state();
+  az_iot_provisioning_client_registration_state loaded;
+  uint8_t buffer[TEST_BLOB_SIZE + 16];
+  az_span blob;
+
+  _test_az_iot_provisioning_client_init(&client, AZ_SPAN_FROM_STR(TEST_REGISTRATION_ID));
+
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_serialize(
+          &client, &registration_state, az_span_create(buffer, TEST_BLOB_SIZE - 1), &blob),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_serialize(
+          &client, &registration_state, AZ_SPAN_FROM_BUFFER(buffer), &blob),
+      AZ_OK);
+  assert_int_equal(az_span_size(blob), TEST_BLOB_SIZE);
+  assert_ptr_equal(az_span_ptr(blob), buffer);
+
+  // Reading back the whole storage page, past the end of the blob, works too.
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_deserialize(
+          &client, AZ_SPAN_FROM_BUFFER(buffer), &loaded),
+      AZ_OK);
+  assert_true(
+      az_span_is_content_equal(loaded.assigned_hub_hostname, AZ_SPAN_FROM_STR(TEST_HUB_HOSTNAME)));
+  assert_true(az_span_is_content_equal(loaded.device_id, AZ_SPAN_FROM_STR(TEST_DEVICE_ID)));
+  assert_true(az_span_is_content_equal(loaded.etag, AZ_SPAN_FROM_STR(TEST_ETAG)));
+  assert_true(az_span_is_content_equal(loaded.error_timestamp, AZ_SPAN_FROM_STR(TEST_TIMESTAMP)));
+  assert_true(az_span_is_content_equal(loaded.payload, AZ_SPAN_FROM_STR(TEST_JSON_PAYLOAD)));
+  assert_int_equal(loaded.error_code, AZ_IOT_STATUS_UNKNOWN);
+  assert_int_equal(az_span_size(loaded.error_message), 0);
+
+  // The loaded state refers to the blob rather than to copies.
+  assert_true(
+      az_span_ptr(loaded.device_id) >= buffer
+      && az_span_ptr(loaded.device_id) < buffer + TEST_BLOB_SIZE);
+
+  // Optional fields may be empty.
+  registration_state.etag = AZ_SPAN_EMPTY;
+  registration_state.error_timestamp = AZ_SPAN_EMPTY;
+  registration_state.payload = AZ_SPAN_EMPTY;
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_serialize(
+          &client, &registration_state, AZ_SPAN_FROM_BUFFER(buffer), &blob),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_deserialize(&client, blob, &loaded), AZ_OK);
+  assert_true(az_span_is_content_equal(loaded.device_id, AZ_SPAN_FROM_STR(TEST_DEVICE_ID)));
+  assert_int_equal(az_span_size(loaded.etag), 0);
+  assert_int_equal(az_span_size(loaded.payload), 0);
+}
+
+static void test_az_iot_provisioning_client_registration_state_deserialize_invalid_fails()
+{
+  az_iot_provisioning_client client;
+  az_iot_provisioning_client_registration_state registration_state
+      = _test_az_iot_registration_state();
+  az_iot_provisioning_client_registration_state loaded;
+  uint8_t buffer[TEST_BLOB_SIZE];
+  az_span blob;
+
+  _test_az_iot_provisioning_client_init(&client, AZ_SPAN_FROM_STR(TEST_REGISTRATION_ID));
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_serialize(
+          &client, &registration_state, AZ_SPAN_FROM_BUFFER(buffer), &blob),
+      AZ_OK);
+
+  // Blank or foreign storage.
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_deserialize(&client, AZ_SPAN_EMPTY, &loaded),
+      AZ_ERROR_UNEXPECTED_END);
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_deserialize(
+          &client, AZ_SPAN_FROM_STR("{\"assignedHub\":\"\"}"), &loaded),
+      AZ_ERROR_UNEXPECTED_CHAR);
+
+  // Torn writes.
+  for (int32_t size = 4; size < TEST_BLOB_SIZE; size += 7)
+  {
+    assert_int_equal(
+        az_iot_provisioning_client_registration_state_deserialize(
+            &client, az_span_slice(blob, 0, size), &loaded),
+        AZ_ERROR_UNEXPECTED_END);
+  }
+
+  // A flipped bit anywhere is caught by the checksum.
+  for (int32_t i = 5; i < TEST_BLOB_SIZE; i++)
+  {
+    buffer[i] ^= 0x10;
+    az_result const result
+        = az_iot_provisioning_client_registration_state_deserialize(&client, blob, &loaded);
+    assert_true(result == AZ_ERROR_UNEXPECTED_CHAR || result == AZ_ERROR_UNEXPECTED_END);
+    buffer[i] ^= 0x10;
+  }
+
+  buffer[4] = AZ_IOT_PROVISIONING_CLIENT_REGISTRATION_STATE_BLOB_VERSION + 1;
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_deserialize(&client, blob, &loaded),
+      AZ_ERROR_NOT_SUPPORTED);
+  buffer[4] = AZ_IOT_PROVISIONING_CLIENT_REGISTRATION_STATE_BLOB_VERSION;
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_deserialize(&client, blob, &loaded), AZ_OK);
+
+  // The blob of another registration, such as after the device was given new credentials.
+  az_iot_provisioning_client other_client;
+  _test_az_iot_provisioning_client_init(&other_client, AZ_SPAN_FROM_STR("otherRegistrationId"));
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_deserialize(&other_client, blob, &loaded),
+      AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+static void test_az_iot_provisioning_client_registration_state_serialize_long_field_fails()
+{
+  // Only the size of the payload is stored on 32 bits.
+  static uint8_t long_field[UINT16_MAX + 1];
+  az_iot_provisioning_client client;
+  az_iot_provisioning_client_registration_state registration_state
+      = _test_az_iot_registration_state();
+  uint8_t buffer[TEST_BLOB_SIZE];
+  az_span blob;
+
+  _test_az_iot_provisioning_client_init(&client, AZ_SPAN_FROM_STR(TEST_REGISTRATION_ID));
+
+  registration_state.etag = AZ_SPAN_FROM_BUFFER(long_field);
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_serialize(
+          &client, &registration_state, AZ_SPAN_FROM_BUFFER(buffer), &blob),
+      AZ_ERROR_NOT_SUPPORTED);
+
+  registration_state.etag = az_span_slice(AZ_SPAN_FROM_BUFFER(long_field), 0, UINT16_MAX);
+  assert_int_equal(
+      az_iot_provisioning_client_registration_state_serialize(
+          &client, &registration_state, AZ_SPAN_FROM_BUFFER(buffer), &blob),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+#ifdef _MSC_VER
+// warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
+#pragma warning(disable : 4113)
+#endif
+
+int test_az_iot_provisioning_client_registration_state()
+{
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  SETUP_PRECONDITION_CHECK_TESTS();
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+  const struct CMUnitTest tests[] = {
+#ifndef AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(
+        test_az_iot_provisioning_client_registration_state_serialize_no_device_id_fails),
+#endif // AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(test_az_iot_provisioning_client_registration_state_round_trip_succeed),
+    cmocka_unit_test(test_az_iot_provisioning_client_registration_state_serialize_long_field_fails),
+    cmocka_unit_test(
+        test_az_iot_provisioning_client_registration_state_deserialize_invalid_fails),
+  };
+
+  return cmocka_run_group_tests_name(
+      "az_iot_provisioning_client_registration_state", tests, NULL, NULL);
+}